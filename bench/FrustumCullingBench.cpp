@@ -0,0 +1,86 @@
+// Measures the culling throughput (objects/ms) of every FrustumCuller backend.
+// Usage: ./bin/culling-bench [objectCount] [iterations]
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../src/FrustumCuller.hpp"
+#include "../src/Math.hpp"
+
+template <typename Bounds>
+static void Run(const char *label, const Frustum &frustum, const Bounds &bounds, uint32_t iterations, size_t expectedVisible)
+{
+    uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    std::vector<uint32_t> threadCounts{1};
+    if (hardwareThreads > 1)
+        threadCounts.push_back(hardwareThreads);
+
+    std::vector<uint32_t> visible;
+    for (CullingBackend backend : {CullingBackend::Scalar, CullingBackend::SSE, CullingBackend::AVX})
+    {
+        if (!FrustumCuller::IsBackendAvailable(backend))
+            continue;
+
+        for (uint32_t threads : threadCounts)
+        {
+            FrustumCuller culler(threads);
+            culler.SetBackend(backend);
+            culler.Cull(frustum, bounds, visible); // Warm up
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < iterations; i++)
+                culler.Cull(frustum, bounds, visible);
+            auto end = std::chrono::steady_clock::now();
+
+            double ms = std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+            std::cout << label << " " << FrustumCuller::GetBackendName(backend) << " x" << threads << ": "
+                      << ms << " ms/cull, " << (bounds.GetCount() / ms) << " objects/ms, "
+                      << visible.size() << " visible"
+                      << (visible.size() != expectedVisible ? " (MISMATCH with scalar!)" : "") << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t objectCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000000;
+    uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 50;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> position(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.5f, 4.0f);
+
+    BoundingSpheres spheres;
+    BoundingBoxes boxes;
+    spheres.Reserve(objectCount);
+    boxes.Reserve(objectCount);
+    for (uint32_t i = 0; i < objectCount; i++)
+    {
+        float x = position(rng), y = position(rng), z = position(rng);
+        spheres.Add(x, y, z, size(rng));
+        boxes.Add(x, y, z, size(rng), size(rng), size(rng));
+    }
+
+    // The camera sits at the origin with an identity view, so the projection is the view-projection
+    Mat4 viewProjection = Mat4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, 150.0f);
+    Frustum frustum = Frustum::FromViewProjection(viewProjection.Data());
+
+    std::cout << objectCount << " objects, " << iterations << " iterations" << std::endl;
+
+    std::vector<uint32_t> reference;
+    FrustumCuller scalar;
+    scalar.SetBackend(CullingBackend::Scalar);
+
+    scalar.Cull(frustum, spheres, reference);
+    Run("spheres", frustum, spheres, iterations, reference.size());
+
+    scalar.Cull(frustum, boxes, reference);
+    Run("boxes  ", frustum, boxes, iterations, reference.size());
+
+    return 0;
+}
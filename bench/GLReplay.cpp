@@ -0,0 +1,136 @@
+// Replays a GL trace recorded with `./bin/main --capture PATH` and reports the CPU and GPU cost of its frames.
+// Usage: ./bin/gl-replay trace.gltrace [iterations]
+//
+// Unlike the other benchmarks, this one needs a GL context (a hidden window). The per-call times include
+// the cost of reading the clock around every call, compare them with each other rather than in absolute.
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+#include "../src/GLTraceReplay.hpp"
+
+// Average, min, p95 and max of one of the frame times
+static void PrintFrameTimes(const char *label, const std::vector<GLTraceFrameStats> &frames, double GLTraceFrameStats::*member)
+{
+    std::vector<double> times;
+    times.reserve(frames.size());
+    double sum = 0.0;
+    for (const GLTraceFrameStats &frame : frames)
+    {
+        times.push_back(frame.*member);
+        sum += frame.*member;
+    }
+    std::sort(times.begin(), times.end());
+
+    printf("%-6s avg %8.3f  min %8.3f  p95 %8.3f  max %8.3f ms/frame\n", label, sum / times.size(), times.front(),
+           times[(times.size() - 1) * 95 / 100], times.back());
+}
+
+static int Replay(const char *path, uint32_t iterations)
+{
+    GLTraceReplay replay(path);
+    const GLTraceHeader &header = replay.GetHeader();
+    std::cout << path << ": " << header.frameCount << " frames at " << header.viewportWidth << "x" << header.viewportHeight
+              << ", " << header.setupSize / 1024 << " KiB of setup, " << header.framesSize / 1024 << " KiB of frames"
+              << std::endl;
+
+    replay.Setup();
+    replay.RunFrames(); // Warm up
+    replay.ResetStats();
+
+    for (uint32_t i = 0; i < iterations; i++)
+        replay.RunFrames();
+
+    const std::vector<GLTraceFrameStats> &frames = replay.GetFrameStats();
+    std::cout << iterations << " runs, " << frames.size() << " frames:" << std::endl;
+    PrintFrameTimes("CPU", frames, &GLTraceFrameStats::cpuMs);
+    PrintFrameTimes("GPU", frames, &GLTraceFrameStats::gpuMs);
+    PrintFrameTimes("Total", frames, &GLTraceFrameStats::totalMs);
+
+    // Calls by total time, most expensive first
+    std::vector<GLTraceOp> ops;
+    for (uint16_t i = 0; i < (uint16_t)GLTraceOp::Count; i++)
+        if (replay.GetCallStats((GLTraceOp)i).count != 0)
+            ops.push_back((GLTraceOp)i);
+    std::sort(ops.begin(), ops.end(), [&replay](GLTraceOp a, GLTraceOp b)
+              { return replay.GetCallStats(a).cpuMs > replay.GetCallStats(b).cpuMs; });
+
+    printf("\n%-32s %12s %12s %12s\n", "Call", "calls/frame", "ms/frame", "ns/call");
+    for (GLTraceOp op : ops)
+    {
+        const GLTraceCallStats &stats = replay.GetCallStats(op);
+        printf("gl%-30s %12.1f %12.4f %12.0f\n", GetGLTraceOpName(op), (double)stats.count / frames.size(),
+               stats.cpuMs / frames.size(), stats.cpuMs * 1e6 / stats.count);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " trace.gltrace [iterations]" << std::endl;
+        return 1;
+    }
+    const char *path = argv[1];
+    uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 100;
+    if (iterations == 0)
+        iterations = 1;
+
+    // The window must exist before the trace is loaded, only the header is needed to size it
+    GLTraceHeader header;
+    FILE *file = fopen(path, "rb");
+    if (!file || fread(&header, sizeof(header), 1, file) != 1)
+    {
+        std::cerr << "Can't read " << path << std::endl;
+        if (file)
+            fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    if (!glfwInit())
+        return 1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(header.viewportWidth > 0 ? header.viewportWidth : 640,
+                                          header.viewportHeight > 0 ? header.viewportHeight : 480, "GL replay", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    int result = 1;
+    if (glewInit() != GLEW_OK)
+        std::cerr << "GLEW failed to initialize" << std::endl;
+    else
+    {
+        try
+        {
+            result = Replay(path, iterations);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}
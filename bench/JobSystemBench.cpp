@@ -0,0 +1,134 @@
+// Measures how JobSystem scales from 1 to N threads on a synthetic workload (many small
+// independent jobs, plus a chain of dependent batches) and on decoding a batch of PNGs with stbi_load.
+// Usage: ./bin/job-bench [jobCount] [imageCount] [imagePath]
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/JobSystem.hpp"
+#include "../src/Timing.hpp"
+#include "../src/vendor/stb_image/stb_image.h"
+
+// Roughly 10-20 microseconds of arithmetic that the compiler can't throw away
+static float SyntheticWork(uint32_t seed)
+{
+    float value = (float)seed;
+    for (uint32_t i = 0; i < 400; i++)
+        value = sinf(value) * 0.5f + cosf(value * 0.25f) + 1.0f;
+    return value;
+}
+
+static std::vector<uint32_t> GetThreadCounts()
+{
+    uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    std::vector<uint32_t> threadCounts;
+    for (uint32_t threads = 1; threads < hardwareThreads; threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(hardwareThreads ? hardwareThreads : 1);
+    return threadCounts;
+}
+
+static void Report(const char *label, uint32_t threads, double ms, double baselineMs)
+{
+    std::cout << label << " x" << threads << ": " << ms << " ms, speedup " << (baselineMs / ms) << "x" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t jobCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 20000;
+    uint32_t imageCount = argc > 2 ? (uint32_t)atoi(argv[2]) : 64;
+    std::string imagePath = argc > 3 ? argv[3] : "res/textures/minecraft.png";
+
+    std::vector<float> results(jobCount);
+
+    // Independent jobs, one ParallelFor with a small grain so stealing has to balance the load
+    double baselineMs = 0.0;
+    for (uint32_t threads : GetThreadCounts())
+    {
+        JobSystem jobs(threads);
+        auto start = std::chrono::steady_clock::now();
+        jobs.ParallelFor(jobCount, 16, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++)
+                results[i] = SyntheticWork(i);
+        });
+        double ms = ElapsedMs(start);
+        if (threads == 1)
+            baselineMs = ms;
+        Report("parallel-for", threads, ms, baselineMs);
+    }
+
+    // Batches that each depend on the previous one (e.g. animation -> transforms -> culling),
+    // submitted all at once: counters chain them without the main thread waiting in between
+    const uint32_t BATCHES = 8;
+    for (uint32_t threads : GetThreadCounts())
+    {
+        JobSystem jobs(threads);
+        std::vector<JobCounter> counters(BATCHES);
+        uint32_t perBatch = jobCount / BATCHES;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t batch = 0; batch < BATCHES; batch++)
+        {
+            JobCounter *dependency = batch > 0 ? &counters[batch - 1] : nullptr;
+            for (uint32_t i = 0; i < perBatch; i++)
+            {
+                float *out = &results[batch * perBatch + i];
+                uint32_t seed = batch * perBatch + i;
+                jobs.Submit([out, seed]() { *out = SyntheticWork(seed); }, &counters[batch], dependency);
+            }
+        }
+        for (JobCounter &counter : counters)
+            jobs.Wait(counter);
+        double ms = ElapsedMs(start);
+        if (threads == 1)
+            baselineMs = ms;
+        Report("dependent-batches", threads, ms, baselineMs);
+    }
+
+    // PNG decoding, one job per image
+    int width = 0, height = 0, bpp = 0;
+    if (!stbi_info(imagePath.c_str(), &width, &height, &bpp))
+    {
+        std::cout << "png-decode: can't open " << imagePath << " (run from the repository root)" << std::endl;
+        return 0;
+    }
+    std::cout << "png-decode: " << imageCount << " x " << imagePath << " (" << width << "x" << height << ")" << std::endl;
+
+    std::vector<uint8_t *> images(imageCount, nullptr);
+    for (uint32_t threads : GetThreadCounts())
+    {
+        JobSystem jobs(threads);
+        JobCounter counter;
+
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < imageCount; i++)
+        {
+            uint8_t **out = &images[i];
+            const std::string *path = &imagePath;
+            jobs.Submit([out, path]() {
+                int w, h, channels;
+                stbi_set_flip_vertically_on_load_thread(true);
+                *out = stbi_load(path->c_str(), &w, &h, &channels, 4);
+            }, &counter);
+        }
+        jobs.Wait(counter);
+        double ms = ElapsedMs(start);
+        if (threads == 1)
+            baselineMs = ms;
+        Report("png-decode", threads, ms, baselineMs);
+
+        for (uint8_t *&image : images)
+        {
+            stbi_image_free(image);
+            image = nullptr;
+        }
+    }
+
+    return 0;
+}
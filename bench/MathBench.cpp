@@ -0,0 +1,82 @@
+// Compares the SIMD batch operations of Math.hpp against their scalar reference.
+// Usage: ./bin/math-bench [count] [iterations]
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../src/Math.hpp"
+
+template <typename Function>
+static double TimeMs(uint32_t iterations, Function function)
+{
+    function(); // Warm up
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; i++)
+        function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+static float MaxDifference(const float *a, const float *b, size_t count)
+{
+    float difference = 0.0f;
+    for (size_t i = 0; i < count; i++)
+        difference = fmaxf(difference, fabsf(a[i] - b[i]));
+    return difference;
+}
+
+static void Report(const char *name, size_t count, double scalarMs, double simdMs, float maxDifference)
+{
+    std::cout << name << ": scalar " << scalarMs * 1e6 / count << " ns/op, "
+              << MATH_SIMD_NAME << " " << simdMs * 1e6 / count << " ns/op, "
+              << "speedup " << scalarMs / simdMs << "x, max difference " << maxDifference << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? (size_t)atoi(argv[1]) : 100000;
+    uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 100;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> value(-10.0f, 10.0f);
+
+    Mat4 transform = Mat4::Perspective(1.0f, 1.5f, 0.1f, 100.0f) *
+                     Mat4::LookAt(Vec3(3.0f, 4.0f, 5.0f), Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<Vec3> points(count), pointsScalar(count), pointsSimd(count);
+    std::vector<Vec4> vectors(count), vectorsScalar(count), vectorsSimd(count);
+    std::vector<Mat4> lhs(count), rhs(count), matricesScalar(count), matricesSimd(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        points[i] = Vec3(value(rng), value(rng), value(rng));
+        vectors[i] = Vec4(value(rng), value(rng), value(rng), 1.0f);
+        lhs[i] = ComposeTransform(points[i], Quat::FromAxisAngle(Vec3(value(rng), value(rng), value(rng)), value(rng)), Vec3(1.0f, 2.0f, 3.0f));
+        rhs[i] = Mat4::Rotate(value(rng), Vec3(0.0f, 1.0f, 0.0f)) * Mat4::Translate(points[i]);
+    }
+
+    std::cout << count << " elements, " << iterations << " iterations, backend " << MATH_SIMD_NAME << std::endl;
+
+    double scalarMs = TimeMs(iterations, [&]() { TransformPointsScalar(transform, points.data(), pointsScalar.data(), count); });
+    double simdMs = TimeMs(iterations, [&]() { TransformPoints(transform, points.data(), pointsSimd.data(), count); });
+    Report("TransformPoints      ", count, scalarMs, simdMs, MaxDifference(&pointsScalar[0].x, &pointsSimd[0].x, count * 3));
+
+    scalarMs = TimeMs(iterations, [&]() { TransformVectorsScalar(transform, vectors.data(), vectorsScalar.data(), count); });
+    simdMs = TimeMs(iterations, [&]() { TransformVectors(transform, vectors.data(), vectorsSimd.data(), count); });
+    Report("TransformVectors     ", count, scalarMs, simdMs, MaxDifference(&vectorsScalar[0].x, &vectorsSimd[0].x, count * 4));
+
+    scalarMs = TimeMs(iterations, [&]() { MultiplyMatricesScalar(lhs.data(), rhs.data(), matricesScalar.data(), count); });
+    simdMs = TimeMs(iterations, [&]() { MultiplyMatrices(lhs.data(), rhs.data(), matricesSimd.data(), count); });
+    Report("MultiplyMatrices     ", count, scalarMs, simdMs, MaxDifference(matricesScalar[0].Data(), matricesSimd[0].Data(), count * 16));
+
+    scalarMs = TimeMs(iterations, [&]() { MultiplyMatricesScalar(transform, rhs.data(), matricesScalar.data(), count); });
+    simdMs = TimeMs(iterations, [&]() { MultiplyMatrices(transform, rhs.data(), matricesSimd.data(), count); });
+    Report("MultiplyMatrices(1xN)", count, scalarMs, simdMs, MaxDifference(matricesScalar[0].Data(), matricesSimd[0].Data(), count * 16));
+
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Measures the OcclusionCuller on a dense city: buildings as occluders, small props in the streets.
+// Reports how many props survive frustum culling, how many of those are hidden, and the time of each stage.
+// Usage: ./bin/occlusion-bench [objectCount] [iterations]
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/FrustumCuller.hpp"
+#include "../src/JobSystem.hpp"
+#include "../src/Math.hpp"
+#include "../src/OcclusionCuller.hpp"
+#include "../src/Timing.hpp"
+
+static const uint32_t BLOCKS = 24;         // The city is BLOCKS x BLOCKS buildings
+static const float BLOCK_SIZE = 20.0f;     // Building and street
+static const float BUILDING_SIZE = 14.0f;  // Footprint of a building, the rest is the street
+
+struct Building
+{
+    Vec3 center, extent;
+};
+
+// Renders the occluders and culls the props iterations times, visible gets the props left to draw
+static void Run(const char *label, JobSystem *jobSystem, const std::vector<Building> &buildings, const BoundingBoxes &props,
+                const Mat4 &viewProjection, uint32_t iterations, std::vector<uint32_t> &visible)
+{
+    // Unit cube, counter-clockwise from the outside
+    const Vec3 cube[8] = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+    const uint32_t cubeIndices[36] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                      3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+
+    OcclusionCuller occlusion(256, 128, jobSystem);
+    uint32_t cubeMesh = occlusion.AddMesh(cube, 8, cubeIndices, 36);
+    for (const Building &building : buildings)
+        occlusion.AddOccluder(cubeMesh, Mat4::Translate(building.center) * Mat4::Scale(building.extent));
+
+    FrustumCuller frustumCuller;
+    frustumCuller.SetJobSystem(jobSystem);
+    Frustum frustum = Frustum::FromViewProjection(viewProjection.Data());
+
+    double frustumMs = 0.0, rasterMs = 0.0, pyramidMs = 0.0, testMs = 0.0, totalMs = 0.0;
+    size_t frustumVisible = 0;
+    for (uint32_t i = 0; i <= iterations; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        occlusion.RenderOccluders(viewProjection);
+        auto frustumStart = std::chrono::steady_clock::now();
+        frustumCuller.Cull(frustum, props, visible);
+        frustumVisible = visible.size();
+        auto frustumEnd = std::chrono::steady_clock::now();
+        occlusion.Cull(props, visible);
+        auto end = std::chrono::steady_clock::now();
+
+        if (i == 0)
+            continue; // Warm up
+
+        const OcclusionCullerStats &stats = occlusion.GetStats();
+        frustumMs += ElapsedMs(frustumStart, frustumEnd);
+        rasterMs += stats.rasterMs;
+        pyramidMs += stats.pyramidMs;
+        testMs += stats.testMs;
+        totalMs += ElapsedMs(start, end);
+    }
+
+    const OcclusionCullerStats &stats = occlusion.GetStats();
+    std::cout << label << ": " << stats.rasterizedTriangles << "/" << stats.occluderTriangles << " occluder triangles rasterized, "
+              << frustumVisible << " props in the frustum, " << stats.culled << " hidden, " << visible.size() << " drawn" << std::endl;
+    std::cout << "    frustum " << frustumMs / iterations << " ms, occluders " << rasterMs / iterations << " ms, pyramid "
+              << pyramidMs / iterations << " ms, occlusion test " << testMs / iterations << " ms, total "
+              << totalMs / iterations << " ms/frame" << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t objectCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 200000;
+    uint32_t iterations = argc > 2 ? (uint32_t)atoi(argv[2]) : 100;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> height(8.0f, 60.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> block(0, BLOCKS - 1);
+
+    std::vector<Building> buildings;
+    for (uint32_t z = 0; z < BLOCKS; z++)
+    {
+        for (uint32_t x = 0; x < BLOCKS; x++)
+        {
+            float halfHeight = height(rng) * 0.5f;
+            buildings.push_back(Building{Vec3{(x + 0.5f) * BLOCK_SIZE, halfHeight, (z + 0.5f) * BLOCK_SIZE},
+                                         Vec3{BUILDING_SIZE * 0.5f, halfHeight, BUILDING_SIZE * 0.5f}});
+        }
+    }
+
+    // Props along the streets, between the buildings
+    BoundingBoxes props;
+    props.Reserve(objectCount);
+    float street = BLOCK_SIZE - BUILDING_SIZE;
+    for (uint32_t i = 0; i < objectCount; i++)
+    {
+        float along = unit(rng) * BLOCKS * BLOCK_SIZE;
+        float across = block(rng) * BLOCK_SIZE + (unit(rng) - 0.5f) * street;
+        float size = 0.3f + unit(rng);
+        if (i & 1)
+            props.Add(along, size, across, size, size, size);
+        else
+            props.Add(across, size, along, size, size, size);
+    }
+
+    // Standing in a street near a corner of the city, looking diagonally across it
+    Vec3 eye{BLOCK_SIZE * 2.0f, 1.8f, BLOCK_SIZE * 2.0f};
+    Vec3 target{BLOCK_SIZE * BLOCKS * 0.5f, 4.0f, BLOCK_SIZE * BLOCKS * 0.7f};
+    Mat4 viewProjection = Mat4::Perspective(1.0f, 16.0f / 9.0f, 0.1f, 1000.0f) * Mat4::LookAt(eye, target, Vec3{0.0f, 1.0f, 0.0f});
+
+    std::cout << buildings.size() << " buildings, " << objectCount << " props, " << iterations << " iterations" << std::endl;
+
+    std::vector<uint32_t> reference, visible;
+    Run("1 thread", nullptr, buildings, props, viewProjection, iterations, reference);
+
+    uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    if (hardwareThreads > 1)
+    {
+        JobSystem jobs;
+        Run((std::to_string(jobs.GetThreadCount()) + " threads").c_str(), &jobs, buildings, props, viewProjection, iterations, visible);
+        // Same results for every thread count, or the parallel paths are broken
+        if (visible != reference)
+            std::cout << "MISMATCH with 1 thread!" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,724 @@
+// Renders synthetic scenarios for a fixed number of frames and reports, for each one, the CPU frame time
+// percentiles, the draw/bind counts of a frame and a hash of the last image, as JSON. Given the JSON of a
+// previous run, flags what got slower than the threshold, draws or binds more, or renders differently.
+// Usage: ./bin/render-bench [--frames N] [--scenario NAME] [--output results.json]
+//                           [--compare baseline.json] [--threshold PERCENT]
+//
+// Like bin/gl-replay, it needs a GL context (a hidden window). The scenes are drawn into an offscreen
+// target of a fixed size, so the hashes don't depend on the window, but they are only comparable
+// between runs on the same driver.
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/Framebuffer.hpp"
+#include "../src/IndexBuffer.hpp"
+#include "../src/Math.hpp"
+#include "../src/Renderer.hpp"
+#include "../src/ResourceRegistry.hpp"
+#include "../src/ShaderVariants.hpp"
+#include "../src/Texture.hpp"
+#include "../src/TextureArray.hpp"
+#include "../src/VertexArray.hpp"
+#include "../src/VertexBuffer.hpp"
+#include "../src/VertexBufferLayout.hpp"
+
+using namespace std::string_literals;
+
+static const int TARGET_WIDTH = 1280, TARGET_HEIGHT = 720;
+static const uint32_t WARM_UP_FRAMES = 20;
+
+// Timings closer than this to the baseline are never reported, whatever the threshold (timer noise on tiny frames)
+static const double MIN_TIME_DIFFERENCE_MS = 0.02;
+
+// RGBA8 pixels of a square pattern, different for each seed
+static std::vector<uint32_t> CreatePattern(int size, uint32_t seed)
+{
+    std::vector<uint32_t> pixels((size_t)size * size);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            uint32_t r = ((uint32_t)(x ^ y) + seed * 37) & 0xFF;
+            uint32_t g = ((uint32_t)x * 3 + seed * 11) & 0xFF;
+            uint32_t b = ((uint32_t)y * 5 + seed) & 0xFF;
+            pixels[(size_t)y * size + x] = r | g << 8 | b << 16 | 0xFF000000;
+        }
+    }
+    return pixels;
+}
+
+static Texture *CreatePatternTexture(int size, uint32_t seed)
+{
+    Texture *texture = new Texture(size, size, GL_RGBA8);
+    texture->SetData(0, 0, size, size, CreatePattern(size, seed).data());
+    return texture;
+}
+
+// Shared by the scenarios: a unit quad, the variants of the quad shader and what is counted outside the Renderer
+struct BenchContext
+{
+    Renderer renderer;
+    VertexArray quadVao;
+    VertexBuffer quadVbo;
+    IndexBuffer quadIbo;
+    ShaderVariants shaders;
+    uint32_t textureBinds = 0;
+
+    BenchContext()
+        : quadVbo(s_QuadVertices, sizeof(s_QuadVertices), GL_STATIC_DRAW), quadIbo(s_QuadIndices, 6, GL_STATIC_DRAW),
+          shaders("res/shaders/bench-quad.vs", "res/shaders/bench-quad.fs")
+    {
+        VertexBufferLayout layout;
+        layout.Push<float>(2);
+        quadVao.AddVBO(quadVbo, layout);
+        quadVao.Unbind();
+    }
+
+    void BindTexture(const Texture &texture)
+    {
+        texture.Bind(0);
+        textureBinds++;
+    }
+
+    // rect is x, y, width, height in clip space
+    void DrawQuad(const Shader &shader, Vec4 rect, Vec4 color)
+    {
+        shader.Bind();
+        shader.SetUniform("u_Rect", rect);
+        shader.SetUniform("u_Color", color);
+        shader.SetUniform("u_Texture", 0);
+        renderer.Draw(quadVao, quadIbo, shader);
+    }
+
+    static float s_QuadVertices[8];
+    static uint32_t s_QuadIndices[6];
+};
+
+float BenchContext::s_QuadVertices[8] = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+uint32_t BenchContext::s_QuadIndices[6] = {0, 1, 2, 2, 3, 0};
+
+// A synthetic workload. Creates its resources in its constructor, only the frames are timed.
+class Scenario
+{
+public:
+    virtual ~Scenario() = default;
+
+    // Draws the frame into the bound target. Must only depend on frameIndex, so the image is the same at every run.
+    virtual void Draw(BenchContext &context, uint32_t frameIndex) = 0;
+};
+
+// Draw call bound: a grid of tiny quads, each one its own draw with its own uniforms
+class SmallQuadsScenario : public Scenario
+{
+public:
+    static constexpr uint32_t COLUMNS = 125, ROWS = 80;
+
+    SmallQuadsScenario() : m_Texture(CreatePatternTexture(64, 1)) {}
+
+    void Draw(BenchContext &context, uint32_t frameIndex) override
+    {
+        const Shader &shader = context.shaders.Get(0);
+        context.BindTexture(*m_Texture);
+
+        float width = 2.0f / COLUMNS, height = 2.0f / ROWS;
+        for (uint32_t y = 0; y < ROWS; y++)
+        {
+            for (uint32_t x = 0; x < COLUMNS; x++)
+            {
+                uint32_t i = y * COLUMNS + x + frameIndex;
+                Vec4 color((i % 7) / 6.0f, (i % 11) / 10.0f, (i % 13) / 12.0f, 1.0f);
+                context.DrawQuad(shader, Vec4(-1.0f + x * width, -1.0f + y * height, width * 0.8f, height * 0.8f), color);
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<Texture> m_Texture;
+};
+
+// Texture bandwidth bound: a few full screen layers, each one minifying a 4096x4096 texture (no mipmaps)
+class HugeTexturesScenario : public Scenario
+{
+public:
+    static constexpr uint32_t LAYERS = 3;
+    static constexpr int TEXTURE_SIZE = 4096;
+
+    HugeTexturesScenario()
+    {
+        for (uint32_t i = 0; i < LAYERS; i++)
+            m_Textures[i].reset(CreatePatternTexture(TEXTURE_SIZE, i + 2));
+    }
+
+    void Draw(BenchContext &context, uint32_t frameIndex) override
+    {
+        const Shader &shader = context.shaders.Get(0);
+
+        // Additive, each layer contributes a third
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        for (uint32_t i = 0; i < LAYERS; i++)
+        {
+            context.BindTexture(*m_Textures[(i + frameIndex) % LAYERS]);
+            context.DrawQuad(shader, Vec4(-1.0f, -1.0f, 2.0f, 2.0f), Vec4(0.33f, 0.33f, 0.33f, 1.0f));
+        }
+        glDisable(GL_BLEND);
+    }
+
+private:
+    std::unique_ptr<Texture> m_Textures[LAYERS];
+};
+
+// Program change bound: a grid of quads cycling through the 8 variants of the quad shader, a switch at every draw
+class ShaderSwitchScenario : public Scenario
+{
+public:
+    static constexpr uint32_t COLUMNS = 50, ROWS = 40;
+
+    ShaderSwitchScenario(BenchContext &context) : m_Texture(CreatePatternTexture(64, 5))
+    {
+        uint64_t keywords[] = {context.shaders.GetKeyword("GRAYSCALE"), context.shaders.GetKeyword("INVERT"),
+                               context.shaders.GetKeyword("STRIPES")};
+
+        // Compiled here, not during the first timed frames
+        for (uint32_t variant = 0; variant < 8; variant++)
+        {
+            uint64_t mask = 0;
+            for (uint32_t bit = 0; bit < 3; bit++)
+                mask |= (variant >> bit & 1) ? keywords[bit] : 0;
+            m_Shaders[variant] = &context.shaders.Get(mask);
+        }
+    }
+
+    void Draw(BenchContext &context, uint32_t frameIndex) override
+    {
+        context.BindTexture(*m_Texture);
+
+        float width = 2.0f / COLUMNS, height = 2.0f / ROWS;
+        for (uint32_t y = 0; y < ROWS; y++)
+        {
+            for (uint32_t x = 0; x < COLUMNS; x++)
+            {
+                uint32_t i = y * COLUMNS + x + frameIndex;
+                context.DrawQuad(*m_Shaders[i % 8], Vec4(-1.0f + x * width, -1.0f + y * height, width * 0.9f, height * 0.9f),
+                                 Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<Texture> m_Texture;
+    const Shader *m_Shaders[8];
+};
+
+// Upload bound: four 1024x1024 textures replaced every frame (16 MiB), then drawn as the four quarters of the screen
+class UploadHeavyScenario : public Scenario
+{
+public:
+    static constexpr uint32_t TEXTURES = 4, PATTERNS = 4;
+    static constexpr int TEXTURE_SIZE = 1024;
+
+    UploadHeavyScenario()
+    {
+        // Generated once, so the frames only time the uploads
+        for (uint32_t i = 0; i < PATTERNS; i++)
+            m_Patterns[i] = CreatePattern(TEXTURE_SIZE, i + 7);
+        for (uint32_t i = 0; i < TEXTURES; i++)
+            m_Textures[i].reset(new Texture(TEXTURE_SIZE, TEXTURE_SIZE, GL_RGBA8));
+    }
+
+    void Draw(BenchContext &context, uint32_t frameIndex) override
+    {
+        const Shader &shader = context.shaders.Get(0);
+        for (uint32_t i = 0; i < TEXTURES; i++)
+        {
+            m_Textures[i]->SetData(0, 0, TEXTURE_SIZE, TEXTURE_SIZE, m_Patterns[(i + frameIndex) % PATTERNS].data());
+            context.BindTexture(*m_Textures[i]);
+            context.DrawQuad(shader, Vec4(-1.0f + (i % 2), -1.0f + (i / 2), 1.0f, 1.0f), Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+        }
+    }
+
+private:
+    std::vector<uint32_t> m_Patterns[PATTERNS];
+    std::unique_ptr<Texture> m_Textures[TEXTURES];
+};
+
+// Texture switch bound: a grid of quads, each one sampling a different texture of 64, a bind and a draw per quad
+class ManyTexturesScenario : public Scenario
+{
+public:
+    static constexpr uint32_t COLUMNS = 50, ROWS = 40, TEXTURES = 64;
+    static constexpr int TEXTURE_SIZE = 64;
+
+    ManyTexturesScenario()
+    {
+        for (uint32_t i = 0; i < TEXTURES; i++)
+            m_Textures[i].reset(CreatePatternTexture(TEXTURE_SIZE, i + 11));
+    }
+
+    void Draw(BenchContext &context, uint32_t frameIndex) override
+    {
+        const Shader &shader = context.shaders.Get(0);
+
+        float width = 2.0f / COLUMNS, height = 2.0f / ROWS;
+        for (uint32_t y = 0; y < ROWS; y++)
+        {
+            for (uint32_t x = 0; x < COLUMNS; x++)
+            {
+                uint32_t i = y * COLUMNS + x + frameIndex;
+                context.BindTexture(*m_Textures[i % TEXTURES]);
+                context.DrawQuad(shader, Vec4(-1.0f + x * width, -1.0f + y * height, width * 0.9f, height * 0.9f),
+                                 Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+            }
+        }
+    }
+
+private:
+    std::unique_ptr<Texture> m_Textures[TEXTURES];
+};
+
+// The many-textures frame batched: the 64 textures are the layers of one array (see TextureArrayManager),
+// and the quads are the instances of a single draw, with their layer as an instance attribute.
+// Renders the same image as many-textures.
+class TextureArrayScenario : public Scenario
+{
+public:
+    static constexpr uint32_t COLUMNS = ManyTexturesScenario::COLUMNS, ROWS = ManyTexturesScenario::ROWS;
+    static constexpr uint32_t TEXTURES = ManyTexturesScenario::TEXTURES;
+    static constexpr int TEXTURE_SIZE = ManyTexturesScenario::TEXTURE_SIZE;
+
+    // Not a Vec4, whose alignment would pad the struct past the 20 bytes of the vertex layout
+    struct Sprite
+    {
+        float rect[4];
+        uint32_t layer;
+    };
+
+    TextureArrayScenario()
+        : m_Shader("res/shaders/bench-sprite.vs", "res/shaders/bench-sprite.fs"), m_Sprites(COLUMNS * ROWS),
+          m_Instances(nullptr, COLUMNS * ROWS * (uint32_t)sizeof(Sprite), GL_STREAM_DRAW)
+    {
+        for (uint32_t i = 0; i < TEXTURES; i++)
+        {
+            m_Layers[i] = m_Textures.Allocate(TEXTURE_SIZE, TEXTURE_SIZE);
+            m_Textures.Upload(m_Layers[i], CreatePattern(TEXTURE_SIZE, i + 11).data());
+        }
+
+        VertexBufferLayout layout;
+        layout.Push<float>(4);           // Rectangle
+        layout.PushInteger<uint32_t>(1); // Layer
+        layout.SetDivisor(1);
+        m_VertexArray.AddVBO(m_Instances, layout);
+        m_VertexArray.Unbind();
+
+        m_Shader.Bind();
+        m_Shader.SetUniform("u_Textures", 0);
+        m_Shader.SetUniform("u_Color", Vec4(1.0f, 1.0f, 1.0f, 1.0f));
+    }
+
+    void Draw(BenchContext &context, uint32_t frameIndex) override
+    {
+        float width = 2.0f / COLUMNS, height = 2.0f / ROWS;
+        for (uint32_t y = 0; y < ROWS; y++)
+        {
+            for (uint32_t x = 0; x < COLUMNS; x++)
+            {
+                uint32_t i = y * COLUMNS + x + frameIndex;
+                Sprite &sprite = m_Sprites[y * COLUMNS + x];
+                sprite.rect[0] = -1.0f + x * width;
+                sprite.rect[1] = -1.0f + y * height;
+                sprite.rect[2] = width * 0.9f;
+                sprite.rect[3] = height * 0.9f;
+                sprite.layer = m_Layers[i % TEXTURES].layer;
+            }
+        }
+        m_Instances.SetData(m_Sprites.data(), (uint32_t)(m_Sprites.size() * sizeof(Sprite)), GL_STREAM_DRAW);
+
+        // All the layers are in the first array: TEXTURES is not more than the layers of an array
+        m_Textures.GetArray(m_Layers[0]).Bind(0);
+        context.textureBinds++;
+        context.renderer.DrawInstanced(m_VertexArray, m_Shader, GL_TRIANGLES, 6, (uint32_t)m_Sprites.size());
+    }
+
+private:
+    TextureArrayManager m_Textures;
+    TextureLayer m_Layers[TEXTURES];
+    Shader m_Shader;
+    std::vector<Sprite> m_Sprites;
+    VertexBuffer m_Instances;
+    VertexArray m_VertexArray;
+};
+
+struct ScenarioInfo
+{
+    const char *name;
+    Scenario *(*create)(BenchContext &context);
+};
+
+static const ScenarioInfo s_Scenarios[] = {
+    {"small-quads", [](BenchContext &) -> Scenario * { return new SmallQuadsScenario(); }},
+    {"huge-textures", [](BenchContext &) -> Scenario * { return new HugeTexturesScenario(); }},
+    {"shader-switch", [](BenchContext &context) -> Scenario * { return new ShaderSwitchScenario(context); }},
+    {"upload-heavy", [](BenchContext &) -> Scenario * { return new UploadHeavyScenario(); }},
+    {"many-textures", [](BenchContext &) -> Scenario * { return new ManyTexturesScenario(); }},
+    {"texture-array", [](BenchContext &) -> Scenario * { return new TextureArrayScenario(); }},
+};
+
+// How a result field is compared with the baseline
+enum class FieldKind
+{
+    Time,  // Regression when slower by more than the threshold
+    Count, // Regression when higher at all
+    Info,  // Reported only (too noisy, or not a cost)
+};
+
+struct ResultField
+{
+    const char *key;
+    double value;
+    FieldKind kind;
+};
+
+struct ScenarioResult
+{
+    std::string name;
+    std::vector<ResultField> fields;
+    uint64_t imageHash;
+};
+
+// Value at percent of the sorted values (nearest rank)
+static double Percentile(const std::vector<double> &sortedValues, uint32_t percent)
+{
+    return sortedValues[(sortedValues.size() - 1) * percent / 100];
+}
+
+// FNV-1a of the pixels of the bound read framebuffer
+static uint64_t HashImage(int width, int height)
+{
+    std::vector<uint8_t> pixels((size_t)width * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    uint64_t hash = 14695981039346656037ull;
+    for (uint8_t byte : pixels)
+        hash = (hash ^ byte) * 1099511628211ull;
+    return hash;
+}
+
+static ScenarioResult RunScenario(const ScenarioInfo &info, BenchContext &context, const Framebuffer &target, uint32_t frames)
+{
+    using Clock = std::chrono::steady_clock;
+
+    std::unique_ptr<Scenario> scenario(info.create(context));
+    glFinish();
+
+    std::vector<double> cpuMs, frameMs;
+    cpuMs.reserve(frames);
+    frameMs.reserve(frames);
+    for (uint32_t frame = 0; frame < WARM_UP_FRAMES + frames; frame++)
+    {
+        context.renderer.ResetStats();
+        context.textureBinds = 0;
+
+        auto start = Clock::now();
+        target.Bind();
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        scenario->Draw(context, frame);
+        auto issued = Clock::now();
+
+        // Frames don't overlap: the GPU time of a frame is part of the next measurements otherwise
+        glFinish();
+        auto finished = Clock::now();
+
+        if (frame >= WARM_UP_FRAMES)
+        {
+            cpuMs.push_back(std::chrono::duration<double, std::milli>(issued - start).count());
+            frameMs.push_back(std::chrono::duration<double, std::milli>(finished - start).count());
+        }
+    }
+
+    ScenarioResult result;
+    result.name = info.name;
+    result.imageHash = HashImage(target.GetWidth(), target.GetHeight());
+    target.Unbind();
+
+    std::sort(cpuMs.begin(), cpuMs.end());
+    std::sort(frameMs.begin(), frameMs.end());
+    const RendererStats &stats = context.renderer.GetStats();
+    result.fields = {
+        {"frames", (double)frames, FieldKind::Info},
+        {"cpuMsP50", Percentile(cpuMs, 50), FieldKind::Time},
+        {"cpuMsP95", Percentile(cpuMs, 95), FieldKind::Time},
+        {"cpuMsP99", Percentile(cpuMs, 99), FieldKind::Info},
+        {"cpuMsMax", cpuMs.back(), FieldKind::Info},
+        {"frameMsP50", Percentile(frameMs, 50), FieldKind::Time},
+        {"frameMsP95", Percentile(frameMs, 95), FieldKind::Time},
+        {"frameMsP99", Percentile(frameMs, 99), FieldKind::Info},
+        {"frameMsMax", frameMs.back(), FieldKind::Info},
+        {"drawCalls", (double)stats.drawCalls, FieldKind::Count},
+        {"vertexArrayBinds", (double)stats.vertexArrayBinds, FieldKind::Count},
+        {"shaderBinds", (double)stats.shaderBinds, FieldKind::Count},
+        {"textureBinds", (double)context.textureBinds, FieldKind::Count},
+    };
+
+    // The textures of the scenario are released, delete them before the next one allocates its own
+    scenario.reset();
+    ResourceRegistry::Get().Flush();
+    return result;
+}
+
+static void WriteResults(const std::string &path, const std::vector<ScenarioResult> &results)
+{
+    FILE *file = fopen(path.c_str(), "w");
+    if (!file)
+        throw std::runtime_error("Can't write "s + path);
+
+    fprintf(file, "{\n  \"scenarios\": [\n");
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const ScenarioResult &result = results[i];
+        fprintf(file, "    {\"name\": \"%s\"", result.name.c_str());
+        for (const ResultField &field : result.fields)
+            fprintf(file, ", \"%s\": %.6g", field.key, field.value);
+        fprintf(file, ", \"imageHash\": \"%016llx\"}%s\n", (unsigned long long)result.imageHash, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+}
+
+using ResultFields = std::map<std::string, std::string>;
+
+// Reads back what WriteResults wrote (flat objects of string and number fields, nothing more general),
+// by scenario name. Throws if the file can't be read.
+static std::map<std::string, ResultFields> ReadResults(const std::string &path)
+{
+    std::ifstream file(path);
+    if (!file)
+        throw std::runtime_error("Can't read "s + path);
+    std::stringstream stream;
+    stream << file.rdbuf();
+    std::string text = stream.str();
+
+    std::map<std::string, ResultFields> results;
+    size_t position = text.find("\"scenarios\"");
+    while (position != std::string::npos && (position = text.find('{', position)) != std::string::npos)
+    {
+        size_t end = text.find('}', position);
+        if (end == std::string::npos)
+            break;
+
+        ResultFields fields;
+        size_t cursor = position + 1;
+        for (;;)
+        {
+            size_t keyStart = text.find('"', cursor);
+            if (keyStart >= end)
+                break;
+            size_t keyEnd = text.find('"', keyStart + 1);
+            size_t valueStart = text.find_first_not_of(" \t\r\n", text.find(':', keyEnd) + 1);
+            if (keyEnd >= end || valueStart >= end)
+                break;
+
+            std::string key = text.substr(keyStart + 1, keyEnd - keyStart - 1);
+            if (text[valueStart] == '"')
+            {
+                size_t valueEnd = text.find('"', valueStart + 1);
+                fields[key] = text.substr(valueStart + 1, valueEnd - valueStart - 1);
+                cursor = valueEnd + 1;
+            }
+            else
+            {
+                size_t valueEnd = text.find_first_of(",}", valueStart);
+                fields[key] = text.substr(valueStart, valueEnd - valueStart);
+                cursor = valueEnd;
+            }
+        }
+
+        results[fields["name"]] = fields;
+        position = end + 1;
+    }
+    return results;
+}
+
+// Prints how the results differ from the baseline, returns the number of regressions
+static uint32_t Compare(const std::vector<ScenarioResult> &results, const std::map<std::string, ResultFields> &baseline,
+                        double thresholdPercent)
+{
+    uint32_t regressions = 0;
+    for (const ScenarioResult &result : results)
+    {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end())
+        {
+            printf("%-14s not in the baseline\n", result.name.c_str());
+            continue;
+        }
+        const ResultFields &fields = it->second;
+
+        for (const ResultField &field : result.fields)
+        {
+            auto baseField = fields.find(field.key);
+            if (field.kind == FieldKind::Info || baseField == fields.end())
+                continue;
+
+            double base = atof(baseField->second.c_str());
+            double change = base > 0.0 ? (field.value - base) / base * 100.0 : 0.0;
+            if (field.kind == FieldKind::Time)
+            {
+                if (fabs(field.value - base) < MIN_TIME_DIFFERENCE_MS || fabs(change) <= thresholdPercent)
+                    continue;
+
+                bool slower = field.value > base;
+                regressions += slower ? 1 : 0;
+                printf("%-14s %-18s %9.3f -> %9.3f ms (%+.1f%%)%s\n", result.name.c_str(), field.key, base, field.value, change,
+                       slower ? "  REGRESSION" : "");
+            }
+            else if (field.value != base)
+            {
+                bool more = field.value > base;
+                regressions += more ? 1 : 0;
+                printf("%-14s %-18s %9.0f -> %9.0f%s\n", result.name.c_str(), field.key, base, field.value, more ? "  REGRESSION" : "");
+            }
+        }
+
+        auto baseHash = fields.find("imageHash");
+        if (baseHash != fields.end() && strtoull(baseHash->second.c_str(), nullptr, 16) != result.imageHash)
+        {
+            regressions++;
+            printf("%-14s %-18s %s -> %016llx  REGRESSION (the image changed)\n", result.name.c_str(), "imageHash",
+                   baseHash->second.c_str(), (unsigned long long)result.imageHash);
+        }
+    }
+    return regressions;
+}
+
+static double GetField(const ScenarioResult &result, const char *key)
+{
+    for (const ResultField &field : result.fields)
+    {
+        if (strcmp(field.key, key) == 0)
+            return field.value;
+    }
+    return 0.0;
+}
+
+static int Run(uint32_t frames, const char *only, const std::string &outputPath, const char *comparePath, double thresholdPercent)
+{
+    BenchContext context;
+
+    Texture targetColor(TARGET_WIDTH, TARGET_HEIGHT, GL_RGBA8);
+    Framebuffer target;
+    target.AttachColor(0, targetColor);
+    target.Validate();
+
+    std::vector<ScenarioResult> results;
+    for (const ScenarioInfo &info : s_Scenarios)
+    {
+        if (only && strcmp(only, info.name) != 0)
+            continue;
+
+        ScenarioResult result = RunScenario(info, context, target, frames);
+        printf("%-14s CPU p50 %7.3f  p95 %7.3f ms | frame p50 %7.3f  p95 %7.3f ms | %5.0f draws, %5.0f shader binds, "
+               "%5.0f texture binds | image %016llx\n",
+               result.name.c_str(), GetField(result, "cpuMsP50"), GetField(result, "cpuMsP95"), GetField(result, "frameMsP50"),
+               GetField(result, "frameMsP95"), GetField(result, "drawCalls"), GetField(result, "shaderBinds"),
+               GetField(result, "textureBinds"), (unsigned long long)result.imageHash);
+        results.push_back(result);
+    }
+    if (results.empty())
+    {
+        std::cerr << "No scenario named " << only << std::endl;
+        return 1;
+    }
+
+    WriteResults(outputPath, results);
+    std::cout << "Results written to " << outputPath << std::endl;
+
+    if (!comparePath)
+        return 0;
+
+    std::cout << "\nCompared with " << comparePath << " (threshold " << thresholdPercent << "%):" << std::endl;
+    uint32_t regressions = Compare(results, ReadResults(comparePath), thresholdPercent);
+    std::cout << regressions << " regression(s)" << std::endl;
+    return regressions != 0 ? 2 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t frames = 200;
+    const char *only = nullptr;
+    std::string outputPath = "bin/render-bench.json";
+    const char *comparePath = nullptr;
+    double thresholdPercent = 10.0;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc)
+            only = argv[++i];
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc)
+            comparePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            thresholdPercent = atof(argv[++i]);
+    }
+    if (frames == 0)
+        frames = 1;
+
+    if (!glfwInit())
+        return 1;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(640, 480, "Render bench", NULL, NULL);
+    if (!window)
+    {
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    int result = 1;
+    if (glewInit() != GLEW_OK)
+        std::cerr << "GLEW failed to initialize" << std::endl;
+    else
+    {
+        try
+        {
+            result = Run(frames, only, outputPath, comparePath, thresholdPercent);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    // The wrappers are gone, delete their GL objects while the context still exists
+    ResourceRegistry::Get().Flush();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}
@@ -0,0 +1,78 @@
+// Measures the CPU cost of building a frame of text with TextBatch: thousands of labels that stay
+// the same (layout cache hits) or change every frame (new layouts), plus rasterizing the glyphs
+// of the atlas the first time. The GL side (one upload and one draw call per atlas page) is not included.
+// Usage: ./bin/text-bench [labels] [frames] [font.ttf]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include "../src/GlyphAtlas.hpp"
+#include "../src/TextBatch.hpp"
+#include "../src/Timing.hpp"
+
+int main(int argc, char **argv)
+{
+    uint32_t labelCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 5000;
+    uint32_t frameCount = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+    const char *fontPath = argc > 3 ? argv[3] : "res/fonts/Lato-Regular.ttf";
+
+    GlyphAtlas atlas(Font::LoadTrueType(fontPath));
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t c = 32; c < 127; c++)
+        atlas.GetGlyphIndex(c);
+    double rasterizeMs = ElapsedMs(start);
+    std::cout << "Rasterized " << atlas.GetGlyphCount() << " glyphs into " << atlas.GetPageCount() << " page(s): "
+              << rasterizeMs / atlas.GetGlyphCount() * 1000.0 << " us per glyph" << std::endl;
+
+    TextBatch batch(atlas);
+
+    // Formatted before the timed part, snprintf would cost about as much as the text itself
+    std::vector<char> texts((size_t)labelCount * 64);
+
+    // Which label changes: none, or all of them, every frame
+    for (int changing = 0; changing < 2; changing++)
+    {
+        double totalMs = 0.0;
+        uint32_t glyphs = 0;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            for (uint32_t i = 0; i < labelCount; i++)
+            {
+                char *text = &texts[(size_t)i * 64];
+                if (changing)
+                    snprintf(text, 64, "Unit %u: %.1f hp %u", i, (double)(frame % 1000) * 0.1, frame);
+                else
+                    snprintf(text, 64, "Unit %u: ready", i);
+            }
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < labelCount; i++)
+            {
+                float x = (float)(i % 50) * 40.0f, y = (float)(i / 50) * 12.0f;
+                batch.AddText(&texts[(size_t)i * 64], x, y, 12.0f, 0xFFFFFFFF);
+            }
+            glyphs = 0;
+            for (uint32_t page = 0; page < batch.GetPageCount(); page++)
+                glyphs += batch.GetQuadCount(page);
+            batch.EndFrame();
+
+            // The first frames fill the cache and grow the buffers
+            if (frame >= 4)
+                totalMs += ElapsedMs(start);
+        }
+
+        const TextBatchStats &stats = batch.GetStats();
+        double frameMs = totalMs / (frameCount - 4);
+        std::cout << (changing ? "Changing" : "Static") << " labels: " << labelCount << " labels, " << glyphs << " glyphs, "
+                  << frameMs << " ms per frame (" << frameMs * 1000000.0 / glyphs << " ns per glyph), "
+                  << stats.cacheHits << " cache hits, " << stats.cacheMisses << " misses, " << stats.cachedRuns << " cached layouts"
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,180 @@
+// Measures the voxel meshing throughput (chunks/s) of the culled and greedy meshers of VoxelMesher,
+// single-threaded and with one job per chunk on the JobSystem, and the triangles each one emits.
+// Usage: ./bin/voxel-bench [chunksX] [chunksY] [chunksZ]
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../src/JobSystem.hpp"
+#include "../src/VoxelMesher.hpp"
+
+static constexpr int S = (int)VoxelChunk::CHUNK_SIZE;
+
+struct World
+{
+    int sizeX, sizeY, sizeZ;
+    std::vector<std::unique_ptr<VoxelChunk>> chunks;
+    std::vector<VoxelNeighbors> neighbors;
+
+    VoxelChunk *Get(int x, int y, int z) const
+    {
+        if (x < 0 || y < 0 || z < 0 || x >= sizeX || y >= sizeY || z >= sizeZ)
+            return nullptr;
+        return chunks[(y * sizeZ + z) * sizeX + x].get();
+    }
+};
+
+// Rolling hills of stone, dirt and grass, with caves and scattered ore so the greedy mesher
+// doesn't only see perfect flat layers
+static World GenerateWorld(int sizeX, int sizeY, int sizeZ)
+{
+    World world{sizeX, sizeY, sizeZ, {}, {}};
+    uint32_t seed = 12345;
+    auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    for (int cy = 0; cy < sizeY; cy++)
+    for (int cz = 0; cz < sizeZ; cz++)
+    for (int cx = 0; cx < sizeX; cx++)
+    {
+        std::unique_ptr<VoxelChunk> chunk(new VoxelChunk());
+        for (int z = 0; z < S; z++)
+        for (int x = 0; x < S; x++)
+        {
+            float wx = (float)(cx * S + x), wz = (float)(cz * S + z);
+            int height = (int)(sizeY * S * 0.5f + 12.0f * sinf(wx * 0.05f) * cosf(wz * 0.04f) + 5.0f * sinf(wx * 0.17f + wz * 0.11f));
+            for (int y = 0; y < S; y++)
+            {
+                int wy = cy * S + y;
+                if (wy > height)
+                    continue;
+
+                float cave = sinf(wx * 0.11f) * sinf(wy * 0.13f) * sinf(wz * 0.09f);
+                if (cave > 0.6f)
+                    continue;
+
+                BlockId block = wy == height ? 3 : (wy > height - 4 ? 2 : 1);
+                if (block == 1 && random() % 100 < 2)
+                    block = 4;
+                chunk->SetBlock(x, y, z, block);
+            }
+        }
+        world.chunks.push_back(std::move(chunk));
+    }
+
+    for (int cy = 0; cy < sizeY; cy++)
+    for (int cz = 0; cz < sizeZ; cz++)
+    for (int cx = 0; cx < sizeX; cx++)
+    {
+        VoxelNeighbors neighbors;
+        neighbors.chunks[FACE_POSITIVE_X] = world.Get(cx + 1, cy, cz);
+        neighbors.chunks[FACE_NEGATIVE_X] = world.Get(cx - 1, cy, cz);
+        neighbors.chunks[FACE_POSITIVE_Y] = world.Get(cx, cy + 1, cz);
+        neighbors.chunks[FACE_NEGATIVE_Y] = world.Get(cx, cy - 1, cz);
+        neighbors.chunks[FACE_POSITIVE_Z] = world.Get(cx, cy, cz + 1);
+        neighbors.chunks[FACE_NEGATIVE_Z] = world.Get(cx, cy, cz - 1);
+        world.neighbors.push_back(neighbors);
+    }
+    return world;
+}
+
+// Number of block faces covered by the quads, which must be the same for both meshers
+static uint64_t CoveredFaces(const std::vector<uint32_t> &vertices)
+{
+    uint64_t area = 0;
+    for (size_t i = 0; i < vertices.size(); i += 4)
+    {
+        uint32_t a = vertices[i], c = vertices[i + 2];
+        uint32_t dx = (uint32_t)abs((int)VoxelVertex::GetX(c) - (int)VoxelVertex::GetX(a));
+        uint32_t dy = (uint32_t)abs((int)VoxelVertex::GetY(c) - (int)VoxelVertex::GetY(a));
+        uint32_t dz = (uint32_t)abs((int)VoxelVertex::GetZ(c) - (int)VoxelVertex::GetZ(a));
+        area += (uint64_t)(dx ? dx : 1) * (dy ? dy : 1) * (dz ? dz : 1);
+    }
+    return area;
+}
+
+template <typename MeshFunction>
+static double MeshWorld(const World &world, JobSystem *jobs, std::vector<std::vector<uint32_t>> &meshes, MeshFunction mesh)
+{
+    uint32_t chunkCount = (uint32_t)world.chunks.size();
+    auto start = std::chrono::steady_clock::now();
+
+    auto meshRange = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            meshes[i].clear();
+            mesh(*world.chunks[i], world.neighbors[i], meshes[i]);
+        }
+    };
+
+    if (jobs)
+        jobs->ParallelFor(chunkCount, 1, meshRange);
+    else
+        meshRange(0, chunkCount);
+
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+    int sizeX = argc > 1 ? atoi(argv[1]) : 8;
+    int sizeY = argc > 2 ? atoi(argv[2]) : 4;
+    int sizeZ = argc > 3 ? atoi(argv[3]) : 8;
+
+    World world = GenerateWorld(sizeX, sizeY, sizeZ);
+    uint32_t chunkCount = (uint32_t)world.chunks.size();
+    std::vector<std::vector<uint32_t>> meshes(chunkCount);
+
+    uint64_t allFaces = 0;
+    for (const std::unique_ptr<VoxelChunk> &chunk : world.chunks)
+        allFaces += VoxelMesher::CountAllFaces(*chunk);
+
+    auto countQuads = [&]() {
+        uint64_t quads = 0, covered = 0;
+        for (const std::vector<uint32_t> &mesh : meshes)
+        {
+            quads += mesh.size() / 4;
+            covered += CoveredFaces(mesh);
+        }
+        return std::make_pair(quads, covered);
+    };
+
+    std::cout << chunkCount << " chunks of " << S << "^3 blocks" << std::endl;
+    std::cout << "all faces: " << allFaces * 2 << " triangles" << std::endl;
+
+    MeshWorld(world, nullptr, meshes, VoxelMesher::MeshCulled); // Warm up
+    double culledSeconds = MeshWorld(world, nullptr, meshes, VoxelMesher::MeshCulled);
+    auto culled = countQuads();
+    std::cout << "culled x1: " << chunkCount / culledSeconds << " chunks/s, " << culled.first * 2 << " triangles" << std::endl;
+
+    double greedySeconds = MeshWorld(world, nullptr, meshes, VoxelMesher::MeshGreedy);
+    auto greedy = countQuads();
+    std::cout << "greedy x1: " << chunkCount / greedySeconds << " chunks/s, " << greedy.first * 2 << " triangles ("
+              << (double)culled.first / greedy.first << "x fewer than culled, "
+              << (double)allFaces / greedy.first << "x fewer than all faces)"
+              << (greedy.second != culled.second ? " (MISMATCH: covers a different area than culled!)" : "") << std::endl;
+
+    uint32_t hardwareThreads = std::thread::hardware_concurrency();
+    for (uint32_t threads = 1; ; threads *= 2)
+    {
+        if (threads > hardwareThreads)
+            threads = hardwareThreads ? hardwareThreads : 1;
+
+        JobSystem jobs(threads);
+        double seconds = MeshWorld(world, &jobs, meshes, VoxelMesher::MeshGreedy);
+        std::cout << "greedy jobs x" << threads << ": " << chunkCount / seconds << " chunks/s, speedup " << greedySeconds / seconds << "x" << std::endl;
+
+        if (threads >= hardwareThreads)
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,24 @@
+#version 330 core
+
+// Each combination is a different program, the shader-switch scenario of bench/RenderBench.cpp cycles through them
+#pragma keywords GRAYSCALE INVERT STRIPES
+
+layout(location=0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform vec4 u_Color;
+uniform sampler2D u_Texture;
+
+void main() {
+    color = texture(u_Texture, v_TexCoord) * u_Color;
+#ifdef GRAYSCALE
+    color.rgb = vec3(dot(color.rgb, vec3(0.299, 0.587, 0.114)));
+#endif
+#ifdef INVERT
+    color.rgb = 1.0 - color.rgb;
+#endif
+#ifdef STRIPES
+    color.rgb *= 0.75 + 0.25 * step(0.5, fract(v_TexCoord.y * 8.0));
+#endif
+}
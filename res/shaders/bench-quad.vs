@@ -0,0 +1,13 @@
+#version 330 core
+
+// Unit quad, placed by u_Rect (x, y, width, height in clip space)
+layout(location=0) in vec2 position;
+
+out vec2 v_TexCoord;
+
+uniform vec4 u_Rect;
+
+void main() {
+    gl_Position = vec4(u_Rect.xy + position * u_Rect.zw, 0.0, 1.0);
+    v_TexCoord = position;
+}
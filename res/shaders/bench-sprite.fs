@@ -0,0 +1,13 @@
+#version 330 core
+
+layout(location=0) out vec4 color;
+
+in vec2 v_TexCoord;
+flat in uint v_Layer;
+
+uniform vec4 u_Color;
+uniform sampler2DArray u_Textures;
+
+void main() {
+    color = texture(u_Textures, vec3(v_TexCoord, float(v_Layer))) * u_Color;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// One quad per instance, the corners come from gl_VertexID and the texture is a layer of u_Textures
+layout(location=0) in vec4 rect;  // x, y, width, height in clip space
+layout(location=1) in uint layer;
+
+out vec2 v_TexCoord;
+flat out uint v_Layer;
+
+// The triangles of the unit quad of bench-quad.vs, so both scenarios rasterize the same pixels
+const vec2 CORNERS[6] = vec2[6](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0));
+
+void main() {
+    vec2 corner = CORNERS[gl_VertexID];
+    gl_Position = vec4(rect.xy + corner * rect.zw, 0.0, 1.0);
+    v_TexCoord = corner;
+    v_Layer = layer;
+}
@@ -1,5 +1,8 @@
 #version 330 core
 
+// TINT: fades the texture to u_Color towards the edges of the quad
+#pragma keywords TINT
+
 layout(location=0)out vec4 color;
 
 in vec4 v_Pos;
@@ -10,5 +13,7 @@ uniform sampler2D u_Texture;
 
 void main(){
     color = texture(u_Texture, v_TexCoord);
+#ifdef TINT
     color = mix(color, u_Color, pow(v_Pos.x*v_Pos.x + v_Pos.y*v_Pos.y, 0.9));
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,11 @@
+// World matrices of every object, 4 texels (columns) per matrix (see TransformBuffer)
+uniform samplerBuffer u_Transforms;
+
+mat4 fetchTransform(int index) {
+    return mat4(
+        texelFetch(u_Transforms, index * 4 + 0),
+        texelFetch(u_Transforms, index * 4 + 1),
+        texelFetch(u_Transforms, index * 4 + 2),
+        texelFetch(u_Transforms, index * 4 + 3)
+    );
+}
@@ -0,0 +1,14 @@
+#version 330 core
+
+layout(location=0) out vec4 color;
+
+in vec3 v_Normal;
+
+uniform vec4 u_Color; // Tint of the level of detail drawn
+
+const vec3 LIGHT_DIRECTION = vec3(0.48, 0.8, 0.36);
+
+void main() {
+    float light = 0.25 + 0.75 * max(dot(normalize(v_Normal), LIGHT_DIRECTION), 0.0);
+    color = vec4(u_Color.rgb * light, u_Color.a);
+}
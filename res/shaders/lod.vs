@@ -0,0 +1,15 @@
+#version 330 core
+
+// Interleaved vertices of a LODMesh, every level of detail indexes the same ones
+layout(location=0) in vec3 position;
+layout(location=1) in vec3 normal;
+
+out vec3 v_Normal;
+
+uniform mat4 u_ViewProjection;
+uniform vec3 u_Offset; // Position of the instance in the world
+
+void main() {
+    gl_Position = u_ViewProjection * vec4(u_Offset + position, 1.0);
+    v_Normal = normal;
+}
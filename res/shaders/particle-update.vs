@@ -0,0 +1,74 @@
+#version 330 core
+
+// One particle per vertex, read from one buffer and written to the other with transform feedback
+// (nothing is rasterized). A particle is dead once its age reaches its lifetime.
+layout(location=0) in vec4 positionAge;
+layout(location=1) in vec4 velocityLifetime;
+
+out vec4 o_PositionAge;
+out vec4 o_VelocityLifetime;
+
+uniform float u_DeltaTime;
+uniform int u_Seed;
+
+// Dead particles of [u_EmitStart, u_EmitStart + u_EmitCount) (wrapping around) are spawned this frame
+uniform int u_EmitStart;
+uniform int u_EmitCount;
+uniform int u_Capacity;
+
+uniform vec3 u_EmitterPosition;
+uniform float u_EmitterRadius;
+uniform vec3 u_InitialVelocity;
+uniform float u_VelocitySpread;
+uniform float u_Lifetime;
+uniform vec3 u_Gravity;
+uniform float u_Drag;
+
+// PCG hash, [0, 1) floats from the particle index and the frame seed
+uint state = 0u;
+
+float Random() {
+    state = state * 747796405u + 2891336453u;
+    uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return float((word >> 22u) ^ word) * (1.0 / 4294967296.0);
+}
+
+vec3 RandomInSphere() {
+    vec3 direction = vec3(Random(), Random(), Random()) * 2.0 - 1.0;
+    return direction * (length(direction) > 1.0 ? 0.5 : 1.0);
+}
+
+void main() {
+    vec3 position = positionAge.xyz;
+    float age = positionAge.w;
+    vec3 velocity = velocityLifetime.xyz;
+    float lifetime = velocityLifetime.w;
+
+    int slot = gl_VertexID - u_EmitStart;
+    if (slot < 0)
+        slot += u_Capacity;
+
+    if (age >= lifetime) {
+        if (slot < u_EmitCount) {
+            state = uint(gl_VertexID) * 1664525u + uint(u_Seed) * 1013904223u;
+            position = u_EmitterPosition + RandomInSphere() * u_EmitterRadius;
+            velocity = u_InitialVelocity + RandomInSphere() * u_VelocitySpread;
+            lifetime = u_Lifetime * (0.5 + 0.5 * Random());
+            age = 0.0;
+        }
+    } else {
+        velocity += u_Gravity * u_DeltaTime;
+        velocity *= max(1.0 - u_Drag * u_DeltaTime, 0.0);
+        position += velocity * u_DeltaTime;
+        age += u_DeltaTime;
+
+        // Bounces on the ground
+        if (position.y < 0.0) {
+            position.y = -position.y;
+            velocity.y = abs(velocity.y) * 0.5;
+        }
+    }
+
+    o_PositionAge = vec4(position, age);
+    o_VelocityLifetime = vec4(velocity, lifetime);
+}
@@ -0,0 +1,35 @@
+#version 330 core
+
+// One particle per instance (see ParticleSystem), a camera facing quad whose 4 corners come from gl_VertexID
+layout(location=0) in vec4 positionAge;
+layout(location=1) in vec4 velocityLifetime;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform mat4 u_ViewProjection;
+uniform vec3 u_CameraRight;
+uniform vec3 u_CameraUp;
+uniform float u_Size;
+uniform vec4 u_StartColor;
+uniform vec4 u_EndColor;
+
+void main() {
+    float life = positionAge.w / velocityLifetime.w;
+    if (!(life < 1.0)) {
+        // Dead: every corner at the same point, the triangles have no area
+        gl_Position = vec4(0.0, 0.0, 2.0, 1.0);
+        v_TexCoord = vec2(0.0);
+        v_Color = vec4(0.0);
+        return;
+    }
+
+    // Triangle strip: bottom-left, top-left, bottom-right, top-right
+    vec2 corner = vec2(gl_VertexID >> 1, gl_VertexID & 1);
+    vec3 offset = (u_CameraRight * (corner.x - 0.5) + u_CameraUp * (corner.y - 0.5)) * u_Size;
+
+    gl_Position = u_ViewProjection * vec4(positionAge.xyz + offset, 1.0);
+    v_TexCoord = corner;
+    v_Color = mix(u_StartColor, u_EndColor, life);
+    v_Color.a *= 1.0 - life;
+}
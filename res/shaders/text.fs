@@ -0,0 +1,17 @@
+#version 330 core
+
+layout(location=0) out vec4 color;
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Page;
+
+void main() {
+    // Signed distance field, 0.5 on the outline. Smoothing over about a pixel keeps the edge
+    // sharp but antialiased at any text size.
+    float distance = texture(u_Page, v_TexCoord).r;
+    float smoothing = max(fwidth(distance) * 0.75, 1e-4);
+    float alpha = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);
+    color = vec4(v_Color.rgb, v_Color.a * alpha);
+}
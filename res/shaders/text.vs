@@ -0,0 +1,22 @@
+#version 330 core
+
+// One glyph per instance (see TextQuad in src/TextBatch.hpp), the 4 corners come from gl_VertexID
+layout(location=0) in vec4 rect;      // x0, y0, x1, y1 in pixels, y down
+layout(location=1) in vec4 atlasRect; // u0, v0, u1, v1 in texels
+layout(location=2) in vec4 color;     // 0-255
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+uniform vec2 u_ScreenSize;
+uniform float u_PageSize;
+
+void main() {
+    // Triangle strip: top-left, bottom-left, top-right, bottom-right
+    vec2 corner = vec2(gl_VertexID >> 1, gl_VertexID & 1);
+    vec2 position = mix(rect.xy, rect.zw, corner);
+
+    gl_Position = vec4(position.x / u_ScreenSize.x * 2.0 - 1.0, 1.0 - position.y / u_ScreenSize.y * 2.0, 0.0, 1.0);
+    v_TexCoord = mix(atlasRect.xy, atlasRect.zw, corner) / u_PageSize;
+    v_Color = color / 255.0;
+}
@@ -0,0 +1,11 @@
+#version 330 core
+
+layout(location=0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Atlas;
+
+void main() {
+    color = texture(u_Atlas, v_TexCoord);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// Tile corner in the map and in the atlas, both in tiles (see TileMap)
+layout(location=0) in vec2 position;
+layout(location=1) in vec2 atlasCorner;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_ViewProjection;
+uniform float u_TileSize;
+uniform vec2 u_AtlasSize; // Columns and rows
+
+void main() {
+    gl_Position = u_ViewProjection * vec4(position * u_TileSize, 0.0, 1.0);
+
+    // Atlas rows count from the top, but the texture is loaded flipped (v = 1 at the top)
+    v_TexCoord = vec2(atlasCorner.x / u_AtlasSize.x, 1.0 - atlasCorner.y / u_AtlasSize.y);
+}
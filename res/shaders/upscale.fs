@@ -0,0 +1,31 @@
+#version 330 core
+
+layout(location=0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Source;
+uniform vec2 u_Scale;
+uniform float u_Sharpness; // 0 for plain bilinear filtering
+
+void main() {
+    // Clamped half a texel inside the drawn part, the rest of the texture holds older frames
+    vec2 texel = 1.0 / vec2(textureSize(u_Source, 0));
+    vec2 maxCoord = u_Scale - 0.5 * texel;
+    vec2 center = min(v_TexCoord, maxCoord);
+    vec3 c = texture(u_Source, center).rgb;
+    if (u_Sharpness <= 0.0) {
+        color = vec4(c, 1.0);
+        return;
+    }
+
+    // Unsharp mask with the 4 neighbors, clamped to their range so edges don't ring
+    vec3 n = texture(u_Source, min(center + vec2(0.0, texel.y), maxCoord)).rgb;
+    vec3 s = texture(u_Source, max(center - vec2(0.0, texel.y), 0.5 * texel)).rgb;
+    vec3 e = texture(u_Source, min(center + vec2(texel.x, 0.0), maxCoord)).rgb;
+    vec3 w = texture(u_Source, max(center - vec2(texel.x, 0.0), 0.5 * texel)).rgb;
+    vec3 sharpened = c + (4.0 * c - n - s - e - w) * (0.25 * u_Sharpness);
+    vec3 lo = min(c, min(min(n, s), min(e, w)));
+    vec3 hi = max(c, max(max(n, s), max(e, w)));
+    color = vec4(clamp(sharpened, lo, hi), 1.0);
+}
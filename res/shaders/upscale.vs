@@ -0,0 +1,12 @@
+#version 330 core
+
+// A triangle covering the screen, from gl_VertexID (no vertex buffer)
+out vec2 v_TexCoord;
+
+uniform vec2 u_Scale; // Part of the source texture the scene was drawn in
+
+void main() {
+    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+    v_TexCoord = corner * u_Scale;
+}
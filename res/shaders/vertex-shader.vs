@@ -6,8 +6,12 @@ layout(location=1) in vec2 texCoord;
 out vec4 v_Pos;
 out vec2 v_TexCoord;
 
+#include "include/transforms.glsl"
+
+uniform int u_TransformIndex;
+
 void main() {
-    gl_Position = position;
+    gl_Position = fetchTransform(u_TransformIndex) * position;
     v_Pos = position;
     v_TexCoord = texCoord;
 }
\ No newline at end of file
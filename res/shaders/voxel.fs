@@ -0,0 +1,18 @@
+#version 330 core
+
+layout(location=0) out vec4 color;
+
+in vec2 v_FacePosition;
+flat in vec2 v_AtlasCorner;
+flat in float v_Shade;
+
+uniform sampler2D u_Atlas;
+uniform vec2 u_AtlasSize;
+
+void main() {
+    // Gradients of the unwrapped coordinates, so mip selection doesn't jump at the block edges
+    vec2 texCoord = (v_AtlasCorner + fract(v_FacePosition)) / u_AtlasSize;
+    vec2 gradient = v_FacePosition / u_AtlasSize;
+    vec4 texel = textureGrad(u_Atlas, texCoord, dFdx(gradient), dFdy(gradient));
+    color = vec4(texel.rgb * v_Shade, texel.a);
+}
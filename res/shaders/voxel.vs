@@ -0,0 +1,35 @@
+#version 330 core
+
+// One 32-bit vertex, see VoxelVertex in src/VoxelMesher.hpp
+layout(location=0) in uint packedVertex;
+
+out vec2 v_FacePosition;
+flat out vec2 v_AtlasCorner;
+flat out float v_Shade;
+
+uniform mat4 u_ViewProjection;
+uniform vec3 u_ChunkOffset; // Corner of the chunk in the world, in blocks
+uniform vec2 u_AtlasSize;   // Columns and rows
+
+// Light per face (+x, -x, +y, -y, +z, -z), so the faces of a cube can be told apart without normals
+const float FACE_SHADE[6] = float[6](0.8, 0.7, 1.0, 0.5, 0.9, 0.6);
+
+void main() {
+    vec3 position = vec3(float(packedVertex & 63u), float((packedVertex >> 6) & 63u), float((packedVertex >> 12) & 63u));
+    int face = int((packedVertex >> 18) & 7u);
+    uint block = (packedVertex >> 21) & 255u;
+
+    gl_Position = u_ViewProjection * vec4(u_ChunkOffset + position, 1.0);
+
+    // Texture coordinates are the position on the face plane (the two axes after the normal one),
+    // the fragment shader wraps them so merged quads repeat the texture once per block
+    int d = face / 2;
+    v_FacePosition = vec2(position[(d + 1) % 3], position[(d + 2) % 3]);
+
+    // Block b uses atlas cell b - 1, rows counting from the top like TileMap
+    float cell = float(block - 1u);
+    float column = mod(cell, u_AtlasSize.x);
+    float row = floor(cell / u_AtlasSize.x);
+    v_AtlasCorner = vec2(column, u_AtlasSize.y - 1.0 - row);
+    v_Shade = FACE_SHADE[face];
+}
@@ -0,0 +1,73 @@
+#include "AllocationCounter.hpp"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+static std::atomic<uint64_t> s_AllocationCount{0};
+static std::atomic<uint64_t> s_FreeCount{0};
+static std::atomic<uint64_t> s_AllocatedBytes{0};
+
+static thread_local uint64_t t_AllocationCount = 0;
+static thread_local uint64_t t_AllocatedBytes = 0;
+
+uint64_t AllocationCounter::GetAllocationCount() { return s_AllocationCount.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::GetFreeCount() { return s_FreeCount.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::GetAllocatedBytes() { return s_AllocatedBytes.load(std::memory_order_relaxed); }
+uint64_t AllocationCounter::GetThreadAllocationCount() { return t_AllocationCount; }
+uint64_t AllocationCounter::GetThreadAllocatedBytes() { return t_AllocatedBytes; }
+
+static inline void CountAllocation(size_t size)
+{
+    s_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+    s_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    t_AllocationCount++;
+    t_AllocatedBytes += size;
+}
+
+static void *CountedAllocate(size_t size, size_t alignment, bool nothrow)
+{
+    CountAllocation(size);
+
+    if (size == 0)
+        size = 1;
+
+    void *pointer = nullptr;
+    if (alignment <= alignof(max_align_t))
+        pointer = malloc(size);
+    else if (posix_memalign(&pointer, alignment, size) != 0)
+        pointer = nullptr;
+
+    if (!pointer && !nothrow)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+static void CountedFree(void *pointer)
+{
+    if (!pointer)
+        return;
+
+    s_FreeCount.fetch_add(1, std::memory_order_relaxed);
+    free(pointer);
+}
+
+// --- Global operator new/delete replacements ---
+
+void *operator new(size_t size) { return CountedAllocate(size, 0, false); }
+void *operator new[](size_t size) { return CountedAllocate(size, 0, false); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, 0, true); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return CountedAllocate(size, 0, true); }
+void *operator new(size_t size, std::align_val_t alignment) { return CountedAllocate(size, (size_t)alignment, false); }
+void *operator new[](size_t size, std::align_val_t alignment) { return CountedAllocate(size, (size_t)alignment, false); }
+
+void operator delete(void *pointer) noexcept { CountedFree(pointer); }
+void operator delete[](void *pointer) noexcept { CountedFree(pointer); }
+void operator delete(void *pointer, size_t) noexcept { CountedFree(pointer); }
+void operator delete[](void *pointer, size_t) noexcept { CountedFree(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { CountedFree(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { CountedFree(pointer); }
+void operator delete(void *pointer, size_t, std::align_val_t) noexcept { CountedFree(pointer); }
+void operator delete[](void *pointer, size_t, std::align_val_t) noexcept { CountedFree(pointer); }
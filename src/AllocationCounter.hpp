@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+// Counts the heap allocations made through operator new (the global operator new/delete are
+// replaced in AllocationCounter.cpp, so linking that file is enough to enable the counters).
+//
+// Heap allocations in the render loop show up as jitter in the frame time, so the goal is to have
+// zero of them in steady-state frames. AllocationScope makes that easy to check:
+//
+//     AllocationScope frameAllocations;
+//     ... render the frame ...
+//     if (frameAllocations.GetAllocationCount() != 0) ...
+class AllocationCounter
+{
+public:
+    // All threads
+    static uint64_t GetAllocationCount();
+    static uint64_t GetFreeCount();
+    static uint64_t GetAllocatedBytes();
+
+    // Only the calling thread (e.g. the render thread)
+    static uint64_t GetThreadAllocationCount();
+    static uint64_t GetThreadAllocatedBytes();
+};
+
+// Allocations made by the current thread since the scope was created (or last reset)
+class AllocationScope
+{
+public:
+    AllocationScope() { Reset(); }
+
+    void Reset()
+    {
+        m_StartCount = AllocationCounter::GetThreadAllocationCount();
+        m_StartBytes = AllocationCounter::GetThreadAllocatedBytes();
+    }
+
+    inline uint64_t GetAllocationCount() const { return AllocationCounter::GetThreadAllocationCount() - m_StartCount; }
+    inline uint64_t GetAllocatedBytes() const { return AllocationCounter::GetThreadAllocatedBytes() - m_StartBytes; }
+
+private:
+    uint64_t m_StartCount;
+    uint64_t m_StartBytes;
+};
@@ -0,0 +1,109 @@
+#include <GL/glew.h>
+
+#include "DynamicResolution.hpp"
+
+#include <stdint.h>
+#include <math.h>
+#include <stdexcept>
+
+// Weight of a new measurement in the average cost, when it doesn't go over the target
+static constexpr double COST_SMOOTHING = 0.1;
+
+DynamicResolution::DynamicResolution(int fullWidth, int fullHeight, const DynamicResolutionSettings &settings)
+    : m_Settings(settings), m_FullWidth(fullWidth), m_FullHeight(fullHeight), m_Scale(settings.maxScale),
+      m_Width(0), m_Height(0), m_CostMs(0.0), m_FrameNumber(0), m_ReadNumber(0)
+{
+    if (settings.targetMs <= 0.0f || settings.minScale <= 0.0f || settings.minScale > settings.maxScale || settings.maxScale > 1.0f)
+        throw std::runtime_error("Dynamic resolution needs a positive target and 0 < minScale <= maxScale <= 1");
+
+    glGenQueries(QUERY_FRAMES * 2, m_Queries);
+    SetScale(settings.maxScale);
+    ResetStats();
+}
+
+DynamicResolution::~DynamicResolution()
+{
+    glDeleteQueries(QUERY_FRAMES * 2, m_Queries);
+}
+
+void DynamicResolution::BeginFrame()
+{
+    // Results come back in order: stop at the first frame the GPU hasn't finished, unless its
+    // queries are needed for this frame
+    while (m_ReadNumber < m_FrameNumber)
+    {
+        uint32_t slot = (uint32_t)(m_ReadNumber % QUERY_FRAMES);
+        GLint available = 0;
+        glGetQueryObjectiv(m_Queries[slot * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+        {
+            if (m_FrameNumber - m_ReadNumber < QUERY_FRAMES)
+                break;
+            m_Stats.stalls++;
+        }
+
+        GLuint64 start = 0, end = 0;
+        glGetQueryObjectui64v(m_Queries[slot * 2], GL_QUERY_RESULT, &start);
+        glGetQueryObjectui64v(m_Queries[slot * 2 + 1], GL_QUERY_RESULT, &end);
+        Update((end - start) / 1e6, m_QueryScales[slot]);
+        m_ReadNumber++;
+    }
+
+    uint32_t slot = (uint32_t)(m_FrameNumber % QUERY_FRAMES);
+    m_QueryScales[slot] = m_Scale;
+    glQueryCounter(m_Queries[slot * 2], GL_TIMESTAMP);
+}
+
+void DynamicResolution::EndFrame()
+{
+    uint32_t slot = (uint32_t)(m_FrameNumber % QUERY_FRAMES);
+    glQueryCounter(m_Queries[slot * 2 + 1], GL_TIMESTAMP);
+    m_FrameNumber++;
+}
+
+void DynamicResolution::Update(double gpuMs, float scale)
+{
+    m_Stats.frameCount++;
+    m_Stats.gpuMs += gpuMs;
+    m_Stats.scale += scale;
+    m_Stats.minScale = scale < m_Stats.minScale ? scale : m_Stats.minScale;
+    m_Stats.maxScale = scale > m_Stats.maxScale ? scale : m_Stats.maxScale;
+
+    // Most of the cost goes with the pixel count. Assuming all of it does overestimates what scaling
+    // down saves, so the next measurements finish the correction, from below the target.
+    double cost = gpuMs / ((double)scale * scale);
+    double budget = m_Settings.targetMs * m_Settings.headroom;
+    if (m_CostMs == 0.0 || gpuMs > m_Settings.targetMs)
+        m_CostMs = cost; // Over the target: react to this frame, not to the average
+    else
+        m_CostMs += (cost - m_CostMs) * COST_SMOOTHING;
+
+    double area = budget / m_CostMs;
+    double maxArea = (double)m_Scale * m_Scale * (1.0 + m_Settings.maxIncrease);
+    SetScale((float)sqrt(area < maxArea ? area : maxArea));
+}
+
+void DynamicResolution::SetScale(float scale)
+{
+    scale = scale < m_Settings.minScale ? m_Settings.minScale : scale > m_Settings.maxScale ? m_Settings.maxScale : scale;
+    m_Scale = scale;
+
+    // At least a pixel, and never over the targets through rounding
+    m_Width = (int)(m_FullWidth * scale + 0.5f);
+    m_Height = (int)(m_FullHeight * scale + 0.5f);
+    m_Width = m_Width < 1 ? 1 : m_Width > m_FullWidth ? m_FullWidth : m_Width;
+    m_Height = m_Height < 1 ? 1 : m_Height > m_FullHeight ? m_FullHeight : m_Height;
+}
+
+void DynamicResolution::SetFullSize(int fullWidth, int fullHeight)
+{
+    m_FullWidth = fullWidth;
+    m_FullHeight = fullHeight;
+    SetScale(m_Scale);
+}
+
+void DynamicResolution::ResetStats()
+{
+    m_Stats = DynamicResolutionStats();
+    m_Stats.minScale = m_Stats.maxScale = m_Scale;
+}
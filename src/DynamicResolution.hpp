@@ -0,0 +1,92 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+
+struct DynamicResolutionSettings
+{
+    float targetMs = 16.0f;  // GPU time to hold, per frame
+    float headroom = 0.9f;   // Fraction of targetMs aimed for, the margin absorbs load changes between two measurements
+    float minScale = 0.5f;   // Of the full resolution, on each axis
+    float maxScale = 1.0f;
+    float maxIncrease = 0.05f; // Largest growth of the pixel count in one frame, going up is never urgent
+};
+
+// Averages over the frames since the last DynamicResolution::ResetStats()
+struct DynamicResolutionStats
+{
+    uint32_t frameCount = 0; // Frames whose GPU time came back
+    double gpuMs = 0.0;      // Of the whole frame
+    double scale = 0.0;      // The frames were drawn at
+    float minScale = 0.0f;
+    float maxScale = 0.0f;
+    uint32_t stalls = 0; // Frames that waited for a query result (more frames in flight than queries)
+};
+
+// Picks the resolution of the scene every frame so the GPU time of a frame stays under a target.
+//
+// The frame is timed with a pair of GL_TIMESTAMP queries, read a few frames later once the GPU got
+// there (no stall). Each result comes with the scale that frame was drawn at, so the controller works
+// with the cost of a pixel: going over the target scales down right away, to where the measured frame
+// would have fit; going up follows the average cost, by at most maxIncrease per frame, so a load
+// that comes and goes doesn't make the resolution oscillate.
+//
+// The scene is drawn into the bottom-left GetWidth() x GetHeight() pixels of full size targets (no
+// reallocation when the scale changes), then stretched to the window by an upscaling pass.
+//
+// Typical use:
+//     resolution.BeginFrame(); // Picks GetWidth() x GetHeight() for this frame
+//     ... draw the scene at that size, upscale ...
+//     resolution.EndFrame();
+class DynamicResolution
+{
+public:
+    // Enough for FramePacer::MAX_FRAMES_IN_FLIGHT, plus the frames the driver queues after the swap
+    static constexpr uint32_t QUERY_FRAMES = 8;
+
+    DynamicResolution(int fullWidth, int fullHeight, const DynamicResolutionSettings &settings = {});
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+    // Reads the queries that are done, updates the scale, and starts timing the frame
+    void BeginFrame();
+    void EndFrame();
+
+    // When the window is resized
+    void SetFullSize(int fullWidth, int fullHeight);
+
+    inline float GetScale() const { return m_Scale; }
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    // The size of the targets the scene is drawn into
+    inline int GetFullWidth() const { return m_FullWidth; }
+    inline int GetFullHeight() const { return m_FullHeight; }
+    inline const DynamicResolutionSettings &GetSettings() const { return m_Settings; }
+
+    inline const DynamicResolutionStats &GetStats() const { return m_Stats; }
+    void ResetStats();
+
+private:
+    // A frame measured at scale took gpuMs
+    void Update(double gpuMs, float scale);
+    void SetScale(float scale);
+
+private:
+    DynamicResolutionSettings m_Settings;
+    int m_FullWidth, m_FullHeight;
+    float m_Scale;
+    int m_Width, m_Height;
+
+    // Milliseconds per full resolution frame, averaged over the last frames (0 until the first result)
+    double m_CostMs;
+
+    uint32_t m_Queries[QUERY_FRAMES * 2]; // Start and end timestamps of each frame
+    float m_QueryScales[QUERY_FRAMES];
+    uint64_t m_FrameNumber; // Frames begun
+    uint64_t m_ReadNumber;  // Frames whose result was read
+
+    DynamicResolutionStats m_Stats;
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "TripleBuffer.hpp"
+
+// Runs a simulation on its own thread at a fixed timestep, decoupled from the frame rate.
+//
+// After every tick the simulation thread publishes an immutable snapshot (the previous and the current
+// state) through a TripleBuffer. The render thread never waits for the simulation: Sample() takes
+// the latest snapshot and interpolates between its two states according to how much time has passed
+// since the tick, so motion stays smooth whether the render loop runs faster or slower than the simulation.
+//
+// State should be a plain value type, since it is copied into every snapshot.
+template <typename State>
+class FixedTimestepSimulation
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using StepFunction = std::function<void(State &state, double dt)>;
+    using InterpolateFunction = std::function<State(const State &previous, const State &current, float alpha)>;
+
+    // Ticks that can run back to back to catch up, before the simulation gives up and drops time
+    static constexpr uint32_t MAX_CATCH_UP_TICKS = 5;
+
+    FixedTimestepSimulation(const State &initial, double timestep, StepFunction step, InterpolateFunction interpolate)
+        : m_Timestep(timestep), m_Step(std::move(step)), m_Interpolate(std::move(interpolate)),
+          m_Snapshots(Snapshot{initial, initial, Clock::now(), 0}), m_Running(false), m_TickCount(0)
+    {
+    }
+
+    ~FixedTimestepSimulation()
+    {
+        Stop();
+    }
+
+    FixedTimestepSimulation(const FixedTimestepSimulation &) = delete;
+    FixedTimestepSimulation &operator=(const FixedTimestepSimulation &) = delete;
+
+    void Start()
+    {
+        if (m_Running.exchange(true))
+            return;
+        m_Thread = std::thread(&FixedTimestepSimulation::Run, this);
+    }
+
+    void Stop()
+    {
+        if (!m_Running.exchange(false))
+            return;
+        m_Thread.join();
+    }
+
+    // Render thread: the simulation state interpolated for the current time
+    State Sample()
+    {
+        m_Snapshots.Update();
+        const Snapshot &snapshot = m_Snapshots.GetReadBuffer();
+
+        // We render one tick behind the simulation: previous is at currentTime - dt, current at currentTime
+        double sinceTick = std::chrono::duration<double>(Clock::now() - snapshot.currentTime).count();
+        float alpha = (float)(sinceTick / m_Timestep);
+        alpha = alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+
+        return m_Interpolate(snapshot.previous, snapshot.current, alpha);
+    }
+
+    inline double GetTimestep() const { return m_Timestep; }
+    inline uint64_t GetTickCount() const { return m_TickCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Snapshot
+    {
+        State previous;
+        State current;
+        Clock::time_point currentTime;
+        uint64_t tick;
+    };
+
+    void Run()
+    {
+        const Clock::duration timestep = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_Timestep));
+
+        // The simulation thread keeps its own copy of the states, snapshots are write-only for it
+        Snapshot state = m_Snapshots.GetReadBuffer();
+        Clock::time_point nextTick = Clock::now() + timestep;
+
+        while (m_Running.load(std::memory_order_relaxed))
+        {
+            std::this_thread::sleep_until(nextTick);
+
+            uint32_t ticks = 0;
+            while (Clock::now() >= nextTick && ticks < MAX_CATCH_UP_TICKS)
+            {
+                state.previous = state.current;
+                m_Step(state.current, m_Timestep);
+                state.currentTime = nextTick;
+                state.tick++;
+
+                nextTick += timestep;
+                ticks++;
+            }
+
+            // Too far behind (e.g. the process was suspended): drop the time instead of spiraling
+            if (Clock::now() >= nextTick)
+                nextTick = Clock::now() + timestep;
+
+            if (ticks > 0)
+            {
+                m_Snapshots.GetWriteBuffer() = state;
+                m_Snapshots.Publish();
+                m_TickCount.store(state.tick, std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    double m_Timestep;
+    StepFunction m_Step;
+    InterpolateFunction m_Interpolate;
+
+    TripleBuffer<Snapshot> m_Snapshots;
+    std::thread m_Thread;
+    std::atomic<bool> m_Running;
+    std::atomic<uint64_t> m_TickCount;
+};
@@ -0,0 +1,224 @@
+#include "Font.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "VirtualFileSystem.hpp"
+#include "vendor/stb_truetype/stb_truetype.h"
+
+// Printable ASCII (32 to 126), 9 rows of 5 pixels each: rows 0-6 are above the baseline, 7-8 are
+// the descenders. Bit 4 is the leftmost pixel.
+static const uint8_t BUILTIN_GLYPHS[95][9] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00}, // '!'
+    {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+    {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A, 0x00, 0x00}, // '#'
+    {0x04, 0x0F, 0x14, 0x0E, 0x05, 0x1E, 0x04, 0x00, 0x00}, // '$'
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00, 0x00}, // '%'
+    {0x0C, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0D, 0x00, 0x00}, // '&'
+    {0x04, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '''
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00}, // '('
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00}, // ')'
+    {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00, 0x00, 0x00}, // '*'
+    {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00, 0x00, 0x00}, // '+'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x04, 0x08, 0x00}, // ','
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00}, // '-'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00}, // '.'
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00, 0x00}, // '/'
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E, 0x00, 0x00}, // '0'
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // '1'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F, 0x00, 0x00}, // '2'
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E, 0x00, 0x00}, // '3'
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02, 0x00, 0x00}, // '4'
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E, 0x00, 0x00}, // '5'
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E, 0x00, 0x00}, // '6'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00}, // '7'
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E, 0x00, 0x00}, // '8'
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C, 0x00, 0x00}, // '9'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00, 0x00, 0x00}, // ':'
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x08, 0x00, 0x00}, // ';'
+    {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00}, // '<'
+    {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00, 0x00, 0x00}, // '='
+    {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00, 0x00}, // '>'
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00, 0x00}, // '?'
+    {0x0E, 0x11, 0x01, 0x0D, 0x15, 0x15, 0x0E, 0x00, 0x00}, // '@'
+    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'A'
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E, 0x00, 0x00}, // 'B'
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E, 0x00, 0x00}, // 'C'
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C, 0x00, 0x00}, // 'D'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F, 0x00, 0x00}, // 'E'
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00}, // 'F'
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F, 0x00, 0x00}, // 'G'
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'H'
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // 'I'
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C, 0x00, 0x00}, // 'J'
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00}, // 'K'
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F, 0x00, 0x00}, // 'L'
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'M'
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00}, // 'N'
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00}, // 'O'
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10, 0x00, 0x00}, // 'P'
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D, 0x00, 0x00}, // 'Q'
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11, 0x00, 0x00}, // 'R'
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E, 0x00, 0x00}, // 'S'
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00}, // 'T'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00}, // 'U'
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00, 0x00}, // 'V'
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A, 0x00, 0x00}, // 'W'
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11, 0x00, 0x00}, // 'X'
+    {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x00, 0x00}, // 'Y'
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F, 0x00, 0x00}, // 'Z'
+    {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E, 0x00, 0x00}, // '['
+    {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00}, // backslash
+    {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E, 0x00, 0x00}, // ']'
+    {0x04, 0x0A, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '^'
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00}, // '_'
+    {0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+    {0x00, 0x00, 0x0E, 0x01, 0x0F, 0x11, 0x0F, 0x00, 0x00}, // 'a'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1E, 0x00, 0x00}, // 'b'
+    {0x00, 0x00, 0x0E, 0x10, 0x10, 0x11, 0x0E, 0x00, 0x00}, // 'c'
+    {0x01, 0x01, 0x0D, 0x13, 0x11, 0x11, 0x0F, 0x00, 0x00}, // 'd'
+    {0x00, 0x00, 0x0E, 0x11, 0x1F, 0x10, 0x0E, 0x00, 0x00}, // 'e'
+    {0x06, 0x09, 0x08, 0x1C, 0x08, 0x08, 0x08, 0x00, 0x00}, // 'f'
+    {0x00, 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x11, 0x0E}, // 'g'
+    {0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'h'
+    {0x04, 0x00, 0x0C, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // 'i'
+    {0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // 'j'
+    {0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00}, // 'k'
+    {0x0C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E, 0x00, 0x00}, // 'l'
+    {0x00, 0x00, 0x1A, 0x15, 0x15, 0x11, 0x11, 0x00, 0x00}, // 'm'
+    {0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00}, // 'n'
+    {0x00, 0x00, 0x0E, 0x11, 0x11, 0x11, 0x0E, 0x00, 0x00}, // 'o'
+    {0x00, 0x00, 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // 'p'
+    {0x00, 0x00, 0x0F, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x01}, // 'q'
+    {0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00}, // 'r'
+    {0x00, 0x00, 0x0F, 0x10, 0x0E, 0x01, 0x1E, 0x00, 0x00}, // 's'
+    {0x08, 0x08, 0x1C, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00}, // 't'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0D, 0x00, 0x00}, // 'u'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0A, 0x04, 0x00, 0x00}, // 'v'
+    {0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0A, 0x00, 0x00}, // 'w'
+    {0x00, 0x00, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x00, 0x00}, // 'x'
+    {0x00, 0x00, 0x11, 0x11, 0x11, 0x0F, 0x01, 0x11, 0x0E}, // 'y'
+    {0x00, 0x00, 0x1F, 0x02, 0x04, 0x08, 0x1F, 0x00, 0x00}, // 'z'
+    {0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00, 0x00}, // '{'
+    {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00}, // '|'
+    {0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00, 0x00}, // '}'
+    {0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00, 0x00}, // '~'
+};
+
+static constexpr int BUILTIN_ROWS = 9;
+static constexpr int BUILTIN_COLUMNS = 5;
+static constexpr int BUILTIN_ASCENT = 7;
+static constexpr int BUILTIN_ADVANCE = 6;
+static constexpr int BUILTIN_LINE_HEIGHT = 11; // Ascent, descent and 2 pixels between lines
+
+static bool RasterizeBuiltin(uint32_t codepoint, GlyphBitmap &bitmap)
+{
+    if (codepoint < 32 || codepoint > 126)
+        return false;
+
+    const uint8_t *rows = BUILTIN_GLYPHS[codepoint - 32];
+    const int scale = Font::BUILTIN_PIXEL_SCALE;
+    bitmap.advance = (float)(BUILTIN_ADVANCE * scale);
+
+    // Only the pixels that are set, the atlas doesn't need to store the empty rows and columns
+    int minX = BUILTIN_COLUMNS, maxX = -1, minY = BUILTIN_ROWS, maxY = -1;
+    for (int y = 0; y < BUILTIN_ROWS; y++)
+    {
+        for (int x = 0; x < BUILTIN_COLUMNS; x++)
+        {
+            if (rows[y] & (0x10 >> x))
+            {
+                minX = x < minX ? x : minX;
+                maxX = x > maxX ? x : maxX;
+                minY = y < minY ? y : minY;
+                maxY = y > maxY ? y : maxY;
+            }
+        }
+    }
+
+    if (maxX < 0)
+    {
+        bitmap.width = bitmap.height = 0;
+        bitmap.coverage.clear();
+        return true;
+    }
+
+    bitmap.width = (maxX - minX + 1) * scale;
+    bitmap.height = (maxY - minY + 1) * scale;
+    bitmap.left = minX * scale;
+    bitmap.top = (BUILTIN_ASCENT - minY) * scale;
+    bitmap.coverage.resize((size_t)bitmap.width * bitmap.height);
+
+    for (int y = 0; y < bitmap.height; y++)
+    {
+        uint8_t row = rows[minY + y / scale];
+        for (int x = 0; x < bitmap.width; x++)
+            bitmap.coverage[(size_t)y * bitmap.width + x] = (row & (0x10 >> (minX + x / scale))) ? 255 : 0;
+    }
+    return true;
+}
+
+Font Font::GetBuiltin()
+{
+    Font font;
+    font.rasterize = RasterizeBuiltin;
+    font.lineHeight = (float)(BUILTIN_LINE_HEIGHT * BUILTIN_PIXEL_SCALE);
+    font.ascent = (float)(BUILTIN_ASCENT * BUILTIN_PIXEL_SCALE) + BUILTIN_PIXEL_SCALE; // Half the line gap above
+    return font;
+}
+
+// The font data must outlive the stbtt_fontinfo pointing into it
+struct TrueTypeData
+{
+    std::vector<uint8_t> data;
+    stbtt_fontinfo info;
+};
+
+Font Font::LoadTrueType(const std::string &path, float pixelHeight)
+{
+    FileData file;
+    if (!VirtualFileSystem::Get().ReadFile(path, file))
+        throw std::runtime_error("Could not read font " + path);
+
+    // Shared by the copies of the font, the atlas keeps one
+    std::shared_ptr<TrueTypeData> trueType = std::make_shared<TrueTypeData>();
+    trueType->data.assign(file.data, file.data + file.size);
+    int offset = stbtt_GetFontOffsetForIndex(trueType->data.data(), 0);
+    if (offset < 0 || !stbtt_InitFont(&trueType->info, trueType->data.data(), offset))
+        throw std::runtime_error("Not a TrueType font: " + path);
+
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(&trueType->info, &ascent, &descent, &lineGap);
+    float scale = stbtt_ScaleForPixelHeight(&trueType->info, pixelHeight);
+
+    Font font;
+    font.rasterize = [trueType, scale](uint32_t codepoint, GlyphBitmap &bitmap) {
+        const stbtt_fontinfo *info = &trueType->info;
+        int glyph = stbtt_FindGlyphIndex(info, (int)codepoint);
+        if (glyph == 0)
+            return false;
+
+        // Straight into the reused bitmap, stbtt_GetCodepointBitmap() would allocate one per glyph
+        int x0, y0, x1, y1;
+        stbtt_GetGlyphBitmapBox(info, glyph, scale, scale, &x0, &y0, &x1, &y1);
+        bitmap.width = x1 - x0;
+        bitmap.height = y1 - y0;
+        bitmap.left = x0;
+        bitmap.top = -y0;
+        bitmap.coverage.resize((size_t)bitmap.width * bitmap.height);
+        if (bitmap.width > 0 && bitmap.height > 0)
+            stbtt_MakeGlyphBitmap(info, bitmap.coverage.data(), bitmap.width, bitmap.height, bitmap.width, scale, scale, glyph);
+
+        int advance, leftSideBearing;
+        stbtt_GetGlyphHMetrics(info, glyph, &advance, &leftSideBearing);
+        bitmap.advance = (float)advance * scale;
+        return true;
+    };
+    font.lineHeight = (float)(ascent - descent + lineGap) * scale;
+    font.ascent = ((float)ascent + (float)lineGap * 0.5f) * scale; // Half the line gap above
+    return font;
+}
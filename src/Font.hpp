@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Coverage of one glyph, before it is turned into a distance field (see GlyphAtlas)
+struct GlyphBitmap
+{
+    int width = 0, height = 0;
+    int left = 0, top = 0;         // Position of the top-left pixel from the pen, top counting up from the baseline
+    float advance = 0.0f;          // Pen movement to the next glyph
+    std::vector<uint8_t> coverage; // width * height, 0-255, rows from the top
+};
+
+// Where the glyphs come from, all sizes in pixels of the rasterized bitmaps.
+//
+// rasterize fills the bitmap of a codepoint and returns false when the font doesn't have it.
+// It is the only thing GlyphAtlas needs from a font, which turns the bitmaps into distance fields.
+struct Font
+{
+    std::function<bool(uint32_t codepoint, GlyphBitmap &bitmap)> rasterize;
+    float lineHeight;
+    float ascent; // From the top of the line to the baseline
+
+    // Glyphs of a TrueType font, rasterized by stb_truetype so that a line is about pixelHeight pixels.
+    // The atlas scales them to any size, pixelHeight only sets how sharp the corners stay.
+    // Read through the VirtualFileSystem, throws std::runtime_error if it can't be read or parsed.
+    static Font LoadTrueType(const std::string &path, float pixelHeight = 40.0f);
+
+    // 5x7 pixel font covering printable ASCII, for when no font file is available.
+    // Each font pixel is rasterized as a BUILTIN_PIXEL_SCALE square, which leaves the distance field
+    // enough room to keep the corners sharp when scaled up.
+    static constexpr int BUILTIN_PIXEL_SCALE = 4;
+    static Font GetBuiltin();
+};
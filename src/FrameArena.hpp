@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Linear (bump) allocator for data that only lives during one frame (command lists, temporary arrays, ...).
+//
+// Allocating is just moving a pointer forward, and everything is freed at once by Reset() at the end
+// of the frame, so per-frame data never touches the general heap.
+// If a frame needs more than the capacity, the extra allocations go to overflow blocks, and the next
+// Reset() grows the main block to the peak usage, so after a few frames the arena stops allocating.
+// Both come from operator new, so they show up in the AllocationCounter like any other heap allocation.
+//
+// Destructors are never called, so only trivially destructible types can be created in the arena.
+class FrameArena
+{
+public:
+    explicit FrameArena(size_t capacity = 1024 * 1024)
+        : m_Buffer(nullptr), m_Capacity(0), m_Offset(0), m_OverflowBytes(0), m_OverflowCount(0), m_PeakUsed(0)
+    {
+        Grow(capacity);
+    }
+
+    ~FrameArena()
+    {
+        FreeOverflow();
+        ::operator delete(m_Buffer, std::align_val_t(alignof(max_align_t)));
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *Allocate(size_t size, size_t alignment = alignof(max_align_t))
+    {
+        size_t offset = (m_Offset + alignment - 1) & ~(alignment - 1);
+        if (offset + size <= m_Capacity)
+        {
+            m_Offset = offset + size;
+            return m_Buffer + offset;
+        }
+        return AllocateOverflow(size, alignment);
+    }
+
+    template <typename T, typename... Args>
+    T *New(Args &&...args)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never calls destructors");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Uninitialized array of count elements
+    template <typename T>
+    T *NewArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "FrameArena never calls destructors");
+        return static_cast<T *>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Frees everything allocated since the last reset. Call it once at the end of every frame.
+    void Reset()
+    {
+        size_t used = GetUsed();
+        if (used > m_PeakUsed)
+            m_PeakUsed = used;
+
+        if (!m_Overflow.empty())
+        {
+            FreeOverflow();
+            Grow(m_PeakUsed + m_PeakUsed / 2);
+        }
+        m_Offset = 0;
+    }
+
+    inline size_t GetUsed() const { return m_Offset + m_OverflowBytes; }
+    inline size_t GetCapacity() const { return m_Capacity; }
+    inline size_t GetPeakUsed() const { return m_PeakUsed; }
+    // Allocations that didn't fit in the main block, since the arena was created
+    inline uint64_t GetOverflowCount() const { return m_OverflowCount; }
+
+private:
+    void Grow(size_t capacity)
+    {
+        ::operator delete(m_Buffer, std::align_val_t(alignof(max_align_t)));
+        m_Buffer = nullptr;
+        m_Buffer = static_cast<uint8_t *>(::operator new(capacity ? capacity : 1, std::align_val_t(alignof(max_align_t))));
+        m_Capacity = capacity;
+    }
+
+    void *AllocateOverflow(size_t size, size_t alignment)
+    {
+        if (alignment < alignof(max_align_t))
+            alignment = alignof(max_align_t);
+        void *pointer = ::operator new(size ? size : 1, std::align_val_t(alignment));
+        m_Overflow.push_back({pointer, alignment});
+        m_OverflowBytes += size;
+        m_OverflowCount++;
+        return pointer;
+    }
+
+    void FreeOverflow()
+    {
+        for (const OverflowBlock &block : m_Overflow)
+            ::operator delete(block.pointer, std::align_val_t(block.alignment));
+        m_Overflow.clear();
+        m_OverflowBytes = 0;
+    }
+
+private:
+    uint8_t *m_Buffer;
+    size_t m_Capacity;
+    size_t m_Offset;
+
+    struct OverflowBlock
+    {
+        void *pointer;
+        size_t alignment;
+    };
+
+    std::vector<OverflowBlock> m_Overflow;
+    size_t m_OverflowBytes;
+    uint64_t m_OverflowCount;
+    size_t m_PeakUsed;
+};
+
+// Lets standard containers use a FrameArena, e.g. std::vector<DrawCommand, ArenaAllocator<DrawCommand>>.
+// Memory is only given back on FrameArena::Reset(), so the container must not outlive the frame.
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    ArenaAllocator(FrameArena &arena) : m_Arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : m_Arena(other.GetArena()) {}
+
+    T *allocate(size_t count) { return static_cast<T *>(m_Arena->Allocate(sizeof(T) * count, alignof(T))); }
+    void deallocate(T *, size_t) {}
+
+    inline FrameArena *GetArena() const { return m_Arena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return m_Arena == other.GetArena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return m_Arena != other.GetArena(); }
+
+private:
+    FrameArena *m_Arena;
+};
@@ -0,0 +1,363 @@
+#include <GL/glew.h>
+
+#include "FrameCapture.hpp"
+#include "Timing.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std::string_literals;
+
+// How long Flush() blocks in a single glClientWaitSync call before checking again (1 ms)
+static constexpr uint64_t FENCE_WAIT_TIMEOUT_NS = 1000000;
+
+// --- PNG encoding ---
+
+// The image data is stored in uncompressed deflate blocks: the files are about as big as the raw pixels,
+// but encoding is little more than a copy, so the writer thread keeps up with continuous capture.
+// Recompress them offline (e.g. optipng) if they are kept.
+
+static uint32_t Crc32(uint32_t crc, const uint8_t *data, size_t size)
+{
+    static const struct CrcTable
+    {
+        uint32_t values[256];
+        CrcTable()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++)
+                    value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+                values[i] = value;
+            }
+        }
+    } table;
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PushBigEndian(std::vector<uint8_t> &out, uint32_t value)
+{
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+// Writes a chunk: length, type, data, CRC of the type and data
+static bool WriteChunk(FILE *file, const char *type, const uint8_t *data, uint32_t size)
+{
+    uint8_t length[4] = {(uint8_t)(size >> 24), (uint8_t)(size >> 16), (uint8_t)(size >> 8), (uint8_t)size};
+    uint32_t crc = Crc32(Crc32(0, (const uint8_t *)type, 4), data, size);
+    uint8_t crcBytes[4] = {(uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc};
+
+    return fwrite(length, 1, 4, file) == 4 && fwrite(type, 1, 4, file) == 4 && (size == 0 || fwrite(data, 1, size, file) == size) &&
+           fwrite(crcBytes, 1, 4, file) == 4;
+}
+
+static uint32_t Adler32(const uint8_t *data, size_t size)
+{
+    // 5552 bytes is the most that can be summed before the 32-bit sums could overflow
+    uint32_t a = 1, b = 0;
+    while (size > 0)
+    {
+        size_t count = size < 5552 ? size : 5552;
+        size -= count;
+        while (count-- > 0)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return b << 16 | a;
+}
+
+// RGB8 pixels, top row first. scratch is reused between calls to hold the scanlines.
+static bool WritePng(const std::string &path, int width, int height, const uint8_t *rgb, std::vector<uint8_t> &scratch)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    static const size_t MAX_STORED_BLOCK = 65535;
+
+    // Every row starts with its filter type (0: none)
+    size_t rowSize = (size_t)width * 3;
+    std::vector<uint8_t> &scanlines = scratch;
+    scanlines.resize((size_t)height * (rowSize + 1));
+    for (int y = 0; y < height; y++)
+    {
+        scanlines[y * (rowSize + 1)] = 0;
+        memcpy(&scanlines[y * (rowSize + 1) + 1], rgb + y * rowSize, rowSize);
+    }
+
+    // zlib stream: header, stored deflate blocks, Adler-32 of the uncompressed data
+    std::vector<uint8_t> zlib;
+    zlib.reserve(scanlines.size() + scanlines.size() / MAX_STORED_BLOCK * 5 + 16);
+    zlib.push_back(0x78);
+    zlib.push_back(0x01);
+    for (size_t offset = 0; offset < scanlines.size(); offset += MAX_STORED_BLOCK)
+    {
+        size_t blockSize = scanlines.size() - offset < MAX_STORED_BLOCK ? scanlines.size() - offset : MAX_STORED_BLOCK;
+        zlib.push_back(offset + blockSize == scanlines.size() ? 1 : 0); // Final block flag, stored
+        zlib.push_back((uint8_t)blockSize);
+        zlib.push_back((uint8_t)(blockSize >> 8));
+        zlib.push_back((uint8_t)~blockSize);
+        zlib.push_back((uint8_t)(~blockSize >> 8));
+        zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + blockSize);
+    }
+    PushBigEndian(zlib, Adler32(scanlines.data(), scanlines.size()));
+
+    std::vector<uint8_t> header;
+    PushBigEndian(header, (uint32_t)width);
+    PushBigEndian(header, (uint32_t)height);
+    header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bits per channel, RGB, deflate, no filter method, not interlaced
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(signature, 1, 8, file) == 8 && WriteChunk(file, "IHDR", header.data(), (uint32_t)header.size()) &&
+                   WriteChunk(file, "IDAT", zlib.data(), (uint32_t)zlib.size()) && WriteChunk(file, "IEND", nullptr, 0);
+    return fclose(file) == 0 && written;
+}
+
+// ---
+
+FrameCapture::FrameCapture(const std::string &path, CaptureFormat format)
+    : m_Path(path), m_Format(format), m_RawFile(nullptr), m_Next(0), m_MapNext(0), m_FreeNext(0), m_StatDropped(0),
+      m_StatFrames(0), m_StatRenderThreadMs(0.0), m_Written(0), m_WriterNext(0), m_Running(true)
+{
+    if (format == CaptureFormat::Raw)
+    {
+        m_RawFile = fopen(path.c_str(), "wb");
+        if (!m_RawFile)
+            throw std::runtime_error("Can't create "s + path);
+    }
+
+    for (Slot &slot : m_Slots)
+    {
+        uint32_t rendererID;
+        glGenBuffers(1, &rendererID);
+        slot.buffer = UniqueResource(ResourceType::Buffer, rendererID);
+    }
+
+    m_Thread = std::thread(&FrameCapture::WriterLoop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+    Flush();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+    }
+    m_WakeUp.notify_one();
+    m_Thread.join();
+
+    if (m_RawFile)
+        fclose(m_RawFile);
+}
+
+bool FrameCapture::Capture(uint32_t framebuffer, int width, int height)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    Slot &slot = m_Slots[m_Next % RING_SIZE];
+    if (slot.state.load(std::memory_order_acquire) != SLOT_FREE)
+    {
+        m_StatDropped++;
+        return false;
+    }
+
+    // Read as RGBA, the format drivers read back fastest, the writer thread drops the alpha
+    uint32_t size = (uint32_t)width * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.GetRendererID());
+    if (slot.bufferSize != size)
+    {
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+        slot.bufferSize = size;
+    }
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.width = width;
+    slot.height = height;
+    slot.frame = m_Next;
+    slot.state.store(SLOT_READING, std::memory_order_relaxed);
+    m_Next++;
+
+    m_StatRenderThreadMs += ElapsedMs(start);
+    return true;
+}
+
+void FrameCapture::Update()
+{
+    auto start = std::chrono::steady_clock::now();
+    Poll();
+    m_StatRenderThreadMs += ElapsedMs(start);
+    m_StatFrames++;
+}
+
+void FrameCapture::Poll()
+{
+    // Unmaps the buffers the writer thread copied the pixels out of
+    while (m_FreeNext != m_MapNext)
+    {
+        Slot &slot = m_Slots[m_FreeNext % RING_SIZE];
+        if (slot.state.load(std::memory_order_acquire) != SLOT_COPIED)
+            break;
+
+        if (slot.pixels)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.GetRendererID());
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot.pixels = nullptr;
+        }
+        slot.state.store(SLOT_FREE, std::memory_order_release);
+        m_FreeNext++;
+    }
+
+    // Maps the readbacks the GPU finished, in capture order, without waiting for the others
+    while (m_MapNext != m_Next)
+    {
+        Slot &slot = m_Slots[m_MapNext % RING_SIZE];
+        GLenum status = glClientWaitSync(slot.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer.GetRendererID());
+        slot.pixels = (const uint8_t *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.bufferSize, GL_MAP_READ_BIT);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            slot.state.store(SLOT_MAPPED, std::memory_order_release);
+        }
+        m_WakeUp.notify_one();
+        m_MapNext++;
+    }
+}
+
+void FrameCapture::Flush()
+{
+    // Waits for the GPU to finish every readback, so they all get mapped
+    while (m_MapNext != m_Next)
+    {
+        glClientWaitSync(m_Slots[m_MapNext % RING_SIZE].fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_TIMEOUT_NS);
+        Poll();
+    }
+
+    // Then for the writer thread, unmapping the buffers as it is done with them
+    for (;;)
+    {
+        Poll();
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        if (m_WriterNext == m_Next)
+            break;
+        m_Idle.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    Poll();
+}
+
+FrameCaptureStats FrameCapture::GetStats() const
+{
+    FrameCaptureStats stats;
+    stats.captured = m_Next;
+    stats.dropped = m_StatDropped;
+    stats.written = m_Written.load(std::memory_order_relaxed);
+    stats.renderThreadMs = m_StatFrames != 0 ? m_StatRenderThreadMs / m_StatFrames : 0.0;
+    return stats;
+}
+
+void FrameCapture::WriterLoop()
+{
+    std::vector<uint8_t> rows, scratch;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;)
+    {
+        Slot &slot = m_Slots[m_WriterNext % RING_SIZE];
+        m_WakeUp.wait(lock, [&]() { return slot.state.load(std::memory_order_acquire) == SLOT_MAPPED || !m_Running; });
+        if (slot.state.load(std::memory_order_acquire) != SLOT_MAPPED)
+            break; // Destroyed, Flush() already handled every capture
+        lock.unlock();
+
+        // The slot is reused once copied, keep what is needed to write the frame
+        int width = slot.width, height = slot.height;
+        uint32_t frame = slot.frame;
+        bool mapped = slot.pixels != nullptr;
+
+        // Bottom row first to top row first, RGBA to RGB
+        if (mapped)
+        {
+            size_t rowSize = (size_t)width * 3;
+            rows.resize(rowSize * height);
+            for (int y = 0; y < height; y++)
+            {
+                const uint8_t *source = slot.pixels + (size_t)(height - 1 - y) * width * 4;
+                uint8_t *destination = rows.data() + y * rowSize;
+                for (int x = 0; x < width; x++)
+                {
+                    destination[x * 3 + 0] = source[x * 4 + 0];
+                    destination[x * 3 + 1] = source[x * 4 + 1];
+                    destination[x * 3 + 2] = source[x * 4 + 2];
+                }
+            }
+        }
+        slot.state.store(SLOT_COPIED, std::memory_order_release);
+
+        if (mapped)
+            WriteFrame(rows, width, height, frame, scratch);
+        else
+            std::cerr << "Frame capture: could not map the pixels of frame " << frame << std::endl;
+
+        lock.lock();
+        m_WriterNext++;
+        m_Idle.notify_all();
+    }
+}
+
+void FrameCapture::WriteFrame(const std::vector<uint8_t> &rows, int width, int height, uint32_t frame, std::vector<uint8_t> &scratch)
+{
+    bool written;
+    std::string path = m_Path;
+    if (m_Format == CaptureFormat::Raw)
+    {
+        written = fwrite(rows.data(), 1, rows.size(), m_RawFile) == rows.size();
+    }
+    else
+    {
+        char number[16];
+        snprintf(number, sizeof(number), "_%06u", frame);
+        size_t extension = path.rfind('.');
+        size_t directory = path.find_last_of("/\\");
+        if (extension == std::string::npos || (directory != std::string::npos && extension < directory))
+            extension = path.size();
+        path.insert(extension, number);
+
+        written = WritePng(path, width, height, rows.data(), scratch);
+    }
+
+    if (written)
+        m_Written.fetch_add(1, std::memory_order_relaxed);
+    else
+        std::cerr << "Frame capture: could not write frame " << frame << " to " << path << std::endl;
+}
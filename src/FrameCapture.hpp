@@ -0,0 +1,120 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ResourceRegistry.hpp"
+
+enum class CaptureFormat
+{
+    PNG, // One file per frame, the frame number inserted before the extension ("shots/frame.png" -> "shots/frame_000042.png")
+    Raw, // Every frame appended to a single file of RGB8 pixels, e.g. for ffmpeg -f rawvideo -pixel_format rgb24
+};
+
+// Totals since the capture started
+struct FrameCaptureStats
+{
+    uint32_t captured = 0;       // Readbacks started
+    uint32_t dropped = 0;        // Frames not captured because every pixel buffer was still busy
+    uint32_t written = 0;        // Frames encoded and written by the writer thread
+    double renderThreadMs = 0.0; // Average time Capture() + Update() took on the render thread, per frame
+};
+
+// Captures frames (screenshots, or every frame for a video) without stalling the render thread.
+//
+// glReadPixels into client memory waits for the GPU to finish the frame. Instead, Capture() reads into
+// the next pixel buffer object of a small ring and puts a fence behind it: the copy happens on the GPU
+// timeline and the call returns right away. A few frames later, Update() sees the fence signaled and
+// maps the buffer, and the writer thread flips the rows out of the mapped memory (GL's first row is the
+// bottom one, the files start with the top one: the convention of stbi_set_flip_vertically_on_load in
+// Texture, so a capture loaded back as a Texture is the right way up). The render thread unmaps the
+// buffer at a later Update(), and encodes nothing itself.
+//
+// When the writer can't keep up and every buffer of the ring is busy, frames are dropped (see
+// FrameCaptureStats) rather than waiting. The GL calls all happen on the render thread: destroy the
+// capture (or Flush() it) while the context still exists.
+class FrameCapture
+{
+public:
+    static constexpr uint32_t RING_SIZE = 4;
+
+    // Throws std::runtime_error if the raw output file can't be created
+    FrameCapture(const std::string &path, CaptureFormat format);
+    ~FrameCapture();
+
+    FrameCapture(const FrameCapture &) = delete;
+    FrameCapture &operator=(const FrameCapture &) = delete;
+
+    // Starts reading back the color buffer of framebuffer (0: the window's back buffer). Call after
+    // drawing the frame, before swapping buffers. Returns false if the frame had to be dropped.
+    bool Capture(uint32_t framebuffer, int width, int height);
+
+    // Hands the finished readbacks to the writer thread and recycles the buffers it is done with,
+    // call once per frame (a frame is typically ready 1 or 2 frames after its Capture())
+    void Update();
+
+    // Waits until every captured frame is written
+    void Flush();
+
+    FrameCaptureStats GetStats() const;
+
+private:
+    // A slot goes Free -> Reading -> Mapped (writer thread) -> Copied -> Free
+    enum SlotState : uint8_t
+    {
+        SLOT_FREE,
+        SLOT_READING, // glReadPixels issued, waiting for the fence
+        SLOT_MAPPED,  // Mapped, the writer thread copies the pixels out
+        SLOT_COPIED,  // The writer thread is done with the mapped memory, waiting to be unmapped
+    };
+
+    struct Slot
+    {
+        UniqueResource buffer;
+        uint32_t bufferSize = 0;
+        GLsync fence = nullptr;
+        int width = 0, height = 0;
+        uint32_t frame = 0;              // Capture number, used in the file names
+        const uint8_t *pixels = nullptr; // Mapped memory, while SLOT_MAPPED
+        std::atomic<uint8_t> state{SLOT_FREE};
+    };
+
+    // Update() without the stats
+    void Poll();
+
+    void WriterLoop();
+    // rows are RGB8, top row first. scratch is reused between frames.
+    void WriteFrame(const std::vector<uint8_t> &rows, int width, int height, uint32_t frame, std::vector<uint8_t> &scratch);
+
+private:
+    std::string m_Path;
+    CaptureFormat m_Format;
+    FILE *m_RawFile;
+
+    // The counters below only grow, their slot is the counter modulo RING_SIZE
+    Slot m_Slots[RING_SIZE];
+    uint32_t m_Next;     // Next Capture(), also the number of frames captured so far
+    uint32_t m_MapNext;  // Oldest capture that may still be reading
+    uint32_t m_FreeNext; // Oldest capture that may be waiting to be unmapped
+
+    uint32_t m_StatDropped;
+    uint32_t m_StatFrames;
+    double m_StatRenderThreadMs;
+    std::atomic<uint32_t> m_Written;
+
+    // The writer thread sleeps on m_WakeUp until a slot is mapped (or the capture is destroyed)
+    std::mutex m_Mutex;
+    std::condition_variable m_WakeUp;
+    std::condition_variable m_Idle; // Notified after every written frame, for Flush()
+    uint32_t m_WriterNext;          // Capture the writer thread handles next
+    bool m_Running;
+    std::thread m_Thread;
+};
@@ -0,0 +1,123 @@
+#include <GL/glew.h>
+
+#include "FramePacer.hpp"
+#include "Timing.hpp"
+
+#include <stdint.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+// How long a single glClientWaitSync call may block before we check again (1 ms)
+static constexpr uint64_t FENCE_WAIT_TIMEOUT_NS = 1000000;
+
+FramePacer::FramePacer(uint32_t framesInFlight, bool lowLatency)
+    : m_FramesInFlight(framesInFlight), m_LowLatency(lowLatency), m_FrameNumber(0), m_CurrentWaitMs(0.0)
+{
+    if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT)
+        throw std::runtime_error("Frames in flight must be between 1 and " + std::to_string(MAX_FRAMES_IN_FLIGHT));
+
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        m_Fences[i] = nullptr;
+
+    ResetStats();
+}
+
+FramePacer::~FramePacer()
+{
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    {
+        if (m_Fences[i])
+            glDeleteSync(m_Fences[i]);
+    }
+}
+
+void FramePacer::BeginFrame()
+{
+    m_FrameStart = Clock::now();
+    m_CurrentWaitMs = 0.0;
+
+    if (m_LowLatency)
+    {
+        // Wait for every frame still in flight, oldest first, so the GPU is idle when input is sampled
+        for (uint32_t i = 0; i < m_FramesInFlight; i++)
+            WaitForSlot((uint32_t)((m_FrameNumber + i) % m_FramesInFlight));
+    }
+    else
+    {
+        // The slot we are about to reuse was last used FramesInFlight frames ago
+        WaitForSlot(GetFrameSlot());
+    }
+
+    // Until MarkInputSampled() is called, input is considered sampled when the frame starts
+    m_InputTimes[GetFrameSlot()] = Clock::now();
+}
+
+void FramePacer::MarkInputSampled()
+{
+    m_InputTimes[GetFrameSlot()] = Clock::now();
+}
+
+void FramePacer::EndFrame()
+{
+    // Signaled once the GPU has executed everything submitted so far, including the swap
+    m_Fences[GetFrameSlot()] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_StatFrames++;
+    m_StatCpuMs += ElapsedMs(m_FrameStart);
+    m_StatWaitMs += m_CurrentWaitMs;
+    m_FrameNumber++;
+}
+
+void FramePacer::WaitForSlot(uint32_t slot)
+{
+    GLsync fence = m_Fences[slot];
+    if (!fence)
+        return;
+
+    Clock::time_point start = Clock::now();
+
+    // The first wait flushes the commands, otherwise the fence might never reach the GPU
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        GLenum result = glClientWaitSync(fence, flags, FENCE_WAIT_TIMEOUT_NS);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED)
+            break;
+        flags = 0;
+    }
+
+    Clock::time_point end = Clock::now();
+    m_CurrentWaitMs += ElapsedMs(start, end);
+
+    // If we had to wait, end is when the GPU finished that frame; otherwise it is an upper bound
+    m_StatLatencyMs += ElapsedMs(m_InputTimes[slot], end);
+    m_StatLatencySamples++;
+
+    glDeleteSync(fence);
+    m_Fences[slot] = nullptr;
+}
+
+FramePacerStats FramePacer::GetStats() const
+{
+    FramePacerStats stats;
+    stats.frameCount = m_StatFrames;
+    if (m_StatFrames > 0)
+    {
+        stats.cpuFrameMs = m_StatCpuMs / m_StatFrames;
+        stats.fenceWaitMs = m_StatWaitMs / m_StatFrames;
+        stats.overlap = m_StatCpuMs > 0.0 ? 1.0 - m_StatWaitMs / m_StatCpuMs : 0.0;
+    }
+    if (m_StatLatencySamples > 0)
+        stats.inputToPresentMs = m_StatLatencyMs / m_StatLatencySamples;
+    return stats;
+}
+
+void FramePacer::ResetStats()
+{
+    m_StatFrames = 0;
+    m_StatLatencySamples = 0;
+    m_StatCpuMs = 0.0;
+    m_StatWaitMs = 0.0;
+    m_StatLatencyMs = 0.0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <chrono>
+
+// Averages over the frames since the last FramePacer::ResetStats()
+struct FramePacerStats
+{
+    uint32_t frameCount = 0;
+    double cpuFrameMs = 0.0;       // BeginFrame to EndFrame
+    double fenceWaitMs = 0.0;      // Time blocked waiting for the GPU inside BeginFrame
+    double inputToPresentMs = 0.0; // Input sampling to the GPU finishing the frame (including the swap)
+    double overlap = 0.0;          // Fraction of the CPU frame not spent waiting for the GPU (1 = fully overlapped)
+};
+
+// Explicit CPU/GPU frame pacing with fences, instead of relying on the driver to throttle us.
+//
+// With N frames in flight, the CPU can be recording frame F while the GPU still executes frames F-1 ... F-N+1.
+// BeginFrame() blocks until frame F-N is done, which guarantees that the per-frame resources of
+// slot GetFrameSlot() (see StreamBuffer) are no longer being read by the GPU and can be overwritten.
+// More frames in flight means more throughput, fewer means less latency.
+//
+// In low latency mode, BeginFrame() waits for the GPU to finish all previous frames, and it should be
+// called right before sampling input (glfwPollEvents), so the input is as fresh as possible when
+// the frame is recorded.
+//
+// Typical loop:
+//     pacer.BeginFrame();
+//     glfwPollEvents();
+//     pacer.MarkInputSampled();
+//     ... update and draw using pacer.GetFrameSlot() ...
+//     glfwSwapBuffers(window);
+//     pacer.EndFrame();
+class FramePacer
+{
+public:
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
+    FramePacer(uint32_t framesInFlight = 2, bool lowLatency = false);
+    ~FramePacer();
+
+    FramePacer(const FramePacer &) = delete;
+    FramePacer &operator=(const FramePacer &) = delete;
+
+    void BeginFrame();
+    void MarkInputSampled();
+    void EndFrame();
+
+    // Index of the per-frame resource set the current frame may write to, in [0, framesInFlight)
+    inline uint32_t GetFrameSlot() const { return (uint32_t)(m_FrameNumber % m_FramesInFlight); }
+    inline uint64_t GetFrameNumber() const { return m_FrameNumber; }
+    inline uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+    inline bool IsLowLatency() const { return m_LowLatency; }
+
+    FramePacerStats GetStats() const;
+    void ResetStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Blocks until the fence of the given slot is signaled, and records that frame's latency
+    void WaitForSlot(uint32_t slot);
+
+private:
+    uint32_t m_FramesInFlight;
+    bool m_LowLatency;
+    uint64_t m_FrameNumber;
+
+    GLsync m_Fences[MAX_FRAMES_IN_FLIGHT];
+    Clock::time_point m_InputTimes[MAX_FRAMES_IN_FLIGHT];
+    Clock::time_point m_FrameStart;
+    double m_CurrentWaitMs;
+
+    // Accumulated stats
+    uint32_t m_StatFrames;
+    uint32_t m_StatLatencySamples;
+    double m_StatCpuMs;
+    double m_StatWaitMs;
+    double m_StatLatencyMs;
+};
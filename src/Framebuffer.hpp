@@ -0,0 +1,186 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+
+#include "ResourceRegistry.hpp"
+#include "Texture.hpp"
+
+// Storage that can be rendered to but not sampled (e.g. a depth buffer only used for depth testing).
+// Cheaper than a texture for that, and the only way to get a multisampled attachment in GL 3.3
+// without multisample textures.
+class Renderbuffer
+{
+public:
+    Renderbuffer(int width, int height, uint32_t internalFormat, int samples = 0)
+        : m_Width(width), m_Height(height), m_InternalFormat(internalFormat), m_Samples(samples)
+    {
+        uint32_t rendererID;
+        glGenRenderbuffers(1, &rendererID);
+        glBindRenderbuffer(GL_RENDERBUFFER, rendererID);
+        if (samples > 0)
+            glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, internalFormat, width, height);
+        else
+            glRenderbufferStorage(GL_RENDERBUFFER, internalFormat, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        m_Resource = UniqueResource(ResourceType::Renderbuffer, rendererID);
+    }
+
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    inline uint32_t GetInternalFormat() const { return m_InternalFormat; }
+    inline int GetSamples() const { return m_Samples; }
+    inline uint32_t GetRendererID() const { return m_Resource.GetRendererID(); }
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
+
+private:
+    UniqueResource m_Resource;
+    int m_Width, m_Height;
+    uint32_t m_InternalFormat;
+    int m_Samples;
+};
+
+// Framebuffer object: a set of textures/renderbuffers drawn into instead of the window.
+//
+// Attach the color and depth targets, then call Validate() once before using it: it also selects
+// the draw buffers, so a framebuffer with several color attachments writes all of them
+// (layout(location = i) in the fragment shader goes to attachment i).
+class Framebuffer
+{
+public:
+    static constexpr uint32_t MAX_COLOR_ATTACHMENTS = 8;
+
+    Framebuffer()
+        : m_ColorCount(0), m_Width(0), m_Height(0)
+    {
+        uint32_t rendererID;
+        glGenFramebuffers(1, &rendererID);
+        m_Resource = UniqueResource(ResourceType::Framebuffer, rendererID);
+    }
+
+    void AttachColor(uint32_t index, const Texture &texture)
+    {
+        AttachColor(index, texture.GetHandle(), texture.GetWidth(), texture.GetHeight());
+    }
+
+    void AttachColor(uint32_t index, ResourceHandle texture, int width, int height)
+    {
+        if (index >= MAX_COLOR_ATTACHMENTS)
+            throw std::runtime_error("Framebuffer color attachment " + std::to_string(index) + " out of range");
+
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Resource.GetRendererID());
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + index, GL_TEXTURE_2D, ResourceRegistry::Get().GetRendererID(texture), 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (index + 1 > m_ColorCount)
+            m_ColorCount = index + 1;
+        SetSize(width, height);
+    }
+
+    void AttachDepth(const Texture &texture)
+    {
+        AttachDepth(texture.GetHandle(), texture.GetWidth(), texture.GetHeight(), PixelFormat::Get(texture.GetInternalFormat()).stencil);
+    }
+
+    void AttachDepth(ResourceHandle texture, int width, int height, bool stencil)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Resource.GetRendererID());
+        glFramebufferTexture2D(GL_FRAMEBUFFER, stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
+                               ResourceRegistry::Get().GetRendererID(texture), 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        SetSize(width, height);
+    }
+
+    // attachment is GL_COLOR_ATTACHMENTi, GL_DEPTH_ATTACHMENT, GL_STENCIL_ATTACHMENT or GL_DEPTH_STENCIL_ATTACHMENT
+    void AttachRenderbuffer(uint32_t attachment, const Renderbuffer &renderbuffer)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Resource.GetRendererID());
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderbuffer.GetRendererID());
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (attachment >= GL_COLOR_ATTACHMENT0 && attachment < GL_COLOR_ATTACHMENT0 + MAX_COLOR_ATTACHMENTS &&
+            attachment - GL_COLOR_ATTACHMENT0 + 1 > m_ColorCount)
+            m_ColorCount = attachment - GL_COLOR_ATTACHMENT0 + 1;
+        SetSize(renderbuffer.GetWidth(), renderbuffer.GetHeight());
+    }
+
+    // Throws with the reason if the attachments can't be rendered to together
+    void Validate() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Resource.GetRendererID());
+
+        // The draw buffers are part of the framebuffer state, they only need to be set once
+        static const GLenum drawBuffers[MAX_COLOR_ATTACHMENTS] = {
+            GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3,
+            GL_COLOR_ATTACHMENT4, GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7};
+        if (m_ColorCount > 0)
+        {
+            glDrawBuffers(m_ColorCount, drawBuffers);
+            glReadBuffer(GL_COLOR_ATTACHMENT0);
+        }
+        else
+        {
+            // Depth only: without this, GL 3.3 reports the framebuffer as incomplete
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+            throw std::runtime_error(std::string("Framebuffer is incomplete: ") + GetStatusName(status));
+    }
+
+    void Bind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Resource.GetRendererID());
+        glViewport(0, 0, m_Width, m_Height);
+    }
+
+    // Back to the window
+    void Unbind() const
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    inline uint32_t GetColorAttachmentCount() const { return m_ColorCount; }
+    inline uint32_t GetRendererID() const { return m_Resource.GetRendererID(); }
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
+
+    static const char *GetStatusName(GLenum status)
+    {
+        switch (status)
+        {
+        case GL_FRAMEBUFFER_COMPLETE: return "complete";
+        case GL_FRAMEBUFFER_UNDEFINED: return "undefined";
+        case GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT: return "incomplete attachment";
+        case GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT: return "missing attachment";
+        case GL_FRAMEBUFFER_INCOMPLETE_DRAW_BUFFER: return "incomplete draw buffer";
+        case GL_FRAMEBUFFER_INCOMPLETE_READ_BUFFER: return "incomplete read buffer";
+        case GL_FRAMEBUFFER_UNSUPPORTED: return "unsupported format combination";
+        case GL_FRAMEBUFFER_INCOMPLETE_MULTISAMPLE: return "attachments have different sample counts";
+        }
+        return "unknown status";
+    }
+
+private:
+    // Attachments of different sizes are allowed, rendering is clipped to the smallest one
+    void SetSize(int width, int height)
+    {
+        if (m_Width == 0 || width < m_Width)
+            m_Width = width;
+        if (m_Height == 0 || height < m_Height)
+            m_Height = height;
+    }
+
+private:
+    UniqueResource m_Resource;
+    uint32_t m_ColorCount;
+    int m_Width, m_Height;
+};
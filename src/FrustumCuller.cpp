@@ -0,0 +1,391 @@
+#include "FrustumCuller.hpp"
+#include "JobSystem.hpp"
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define FRUSTUM_CULLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define FRUSTUM_CULLER_AVX 1
+#include <immintrin.h>
+#endif
+
+// Below this many objects per thread, spawning threads (or jobs) costs more than it saves.
+static constexpr uint32_t MIN_OBJECTS_PER_THREAD = 16 * 1024;
+
+Frustum Frustum::FromViewProjection(const float *m)
+{
+    // m is column-major, so element (row, column) is m[column * 4 + row]
+    auto row = [m](int r, int c) { return m[c * 4 + r]; };
+
+    Frustum frustum;
+    for (int i = 0; i < 3; i++)
+    {
+        // Planes come in pairs: row3 + row_i (left, bottom, near) and row3 - row_i (right, top, far)
+        for (int sign = 0; sign < 2; sign++)
+        {
+            float s = sign == 0 ? 1.0f : -1.0f;
+            FrustumPlane &plane = frustum.planes[i * 2 + sign];
+            plane.a = row(3, 0) + s * row(i, 0);
+            plane.b = row(3, 1) + s * row(i, 1);
+            plane.c = row(3, 2) + s * row(i, 2);
+            plane.d = row(3, 3) + s * row(i, 3);
+
+            float length = sqrtf(plane.a * plane.a + plane.b * plane.b + plane.c * plane.c);
+            if (length > 0.0f)
+            {
+                plane.a /= length;
+                plane.b /= length;
+                plane.c /= length;
+                plane.d /= length;
+            }
+        }
+    }
+    return frustum;
+}
+
+// Writes the indices of the bits set in mask (offset by base) to out, returns how many were written
+static inline uint32_t EmitVisible(uint32_t mask, uint32_t base, uint32_t *out)
+{
+    uint32_t count = 0;
+    while (mask)
+    {
+        out[count++] = base + __builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+static inline uint32_t TailMask(uint32_t begin, uint32_t end, uint32_t width)
+{
+    uint32_t remaining = end - begin;
+    return remaining >= width ? (1u << width) - 1 : (1u << remaining) - 1;
+}
+
+// --- Scalar reference ---
+
+static uint32_t CullSpheresScalar(const Frustum &frustum, const BoundingSpheres &spheres, uint32_t begin, uint32_t end, uint32_t *out)
+{
+    const float *x = spheres.GetCenterX(), *y = spheres.GetCenterY(), *z = spheres.GetCenterZ(), *r = spheres.GetRadius();
+
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+        for (const FrustumPlane &p : frustum.planes)
+        {
+            if (p.a * x[i] + p.b * y[i] + p.c * z[i] + p.d < -r[i])
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+            out[count++] = i;
+    }
+    return count;
+}
+
+static uint32_t CullBoxesScalar(const Frustum &frustum, const BoundingBoxes &boxes, uint32_t begin, uint32_t end, uint32_t *out)
+{
+    const float *x = boxes.GetCenterX(), *y = boxes.GetCenterY(), *z = boxes.GetCenterZ();
+    const float *ex = boxes.GetExtentX(), *ey = boxes.GetExtentY(), *ez = boxes.GetExtentZ();
+
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i++)
+    {
+        bool inside = true;
+        for (const FrustumPlane &p : frustum.planes)
+        {
+            // Projected "radius" of the box onto the plane normal
+            float radius = fabsf(p.a) * ex[i] + fabsf(p.b) * ey[i] + fabsf(p.c) * ez[i];
+            if (p.a * x[i] + p.b * y[i] + p.c * z[i] + p.d < -radius)
+            {
+                inside = false;
+                break;
+            }
+        }
+        if (inside)
+            out[count++] = i;
+    }
+    return count;
+}
+
+// --- SSE: 4 objects per instruction ---
+
+#ifdef FRUSTUM_CULLER_SSE
+static uint32_t CullSpheresSSE(const Frustum &frustum, const BoundingSpheres &spheres, uint32_t begin, uint32_t end, uint32_t *out)
+{
+    const float *x = spheres.GetCenterX(), *y = spheres.GetCenterY(), *z = spheres.GetCenterZ(), *r = spheres.GetRadius();
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(x + i), cy = _mm_loadu_ps(y + i), cz = _mm_loadu_ps(z + i);
+        __m128 negRadius = _mm_sub_ps(zero, _mm_loadu_ps(r + i));
+
+        uint32_t mask = TailMask(i, end, 4);
+        for (const FrustumPlane &p : frustum.planes)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.a), cx), _mm_mul_ps(_mm_set1_ps(p.b), cy)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.c), cz), _mm_set1_ps(p.d)));
+            mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, negRadius));
+            if (!mask)
+                break;
+        }
+        count += EmitVisible(mask, i, out + count);
+    }
+    return count;
+}
+
+static uint32_t CullBoxesSSE(const Frustum &frustum, const BoundingBoxes &boxes, uint32_t begin, uint32_t end, uint32_t *out)
+{
+    const float *x = boxes.GetCenterX(), *y = boxes.GetCenterY(), *z = boxes.GetCenterZ();
+    const float *ex = boxes.GetExtentX(), *ey = boxes.GetExtentY(), *ez = boxes.GetExtentZ();
+    const __m128 zero = _mm_setzero_ps();
+
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 4)
+    {
+        __m128 cx = _mm_loadu_ps(x + i), cy = _mm_loadu_ps(y + i), cz = _mm_loadu_ps(z + i);
+        __m128 hx = _mm_loadu_ps(ex + i), hy = _mm_loadu_ps(ey + i), hz = _mm_loadu_ps(ez + i);
+
+        uint32_t mask = TailMask(i, end, 4);
+        for (const FrustumPlane &p : frustum.planes)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.a), cx), _mm_mul_ps(_mm_set1_ps(p.b), cy)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.c), cz), _mm_set1_ps(p.d)));
+            __m128 radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(fabsf(p.a)), hx), _mm_mul_ps(_mm_set1_ps(fabsf(p.b)), hy)),
+                _mm_mul_ps(_mm_set1_ps(fabsf(p.c)), hz));
+            mask &= _mm_movemask_ps(_mm_cmpge_ps(distance, _mm_sub_ps(zero, radius)));
+            if (!mask)
+                break;
+        }
+        count += EmitVisible(mask, i, out + count);
+    }
+    return count;
+}
+#endif
+
+// --- AVX: 8 objects per instruction ---
+
+#ifdef FRUSTUM_CULLER_AVX
+static uint32_t CullSpheresAVX(const Frustum &frustum, const BoundingSpheres &spheres, uint32_t begin, uint32_t end, uint32_t *out)
+{
+    const float *x = spheres.GetCenterX(), *y = spheres.GetCenterY(), *z = spheres.GetCenterZ(), *r = spheres.GetRadius();
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(x + i), cy = _mm256_loadu_ps(y + i), cz = _mm256_loadu_ps(z + i);
+        __m256 negRadius = _mm256_sub_ps(zero, _mm256_loadu_ps(r + i));
+
+        uint32_t mask = TailMask(i, end, 8);
+        for (const FrustumPlane &p : frustum.planes)
+        {
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.a), cx), _mm256_mul_ps(_mm256_set1_ps(p.b), cy)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.c), cz), _mm256_set1_ps(p.d)));
+            mask &= _mm256_movemask_ps(_mm256_cmp_ps(distance, negRadius, _CMP_GE_OQ));
+            if (!mask)
+                break;
+        }
+        count += EmitVisible(mask, i, out + count);
+    }
+    return count;
+}
+
+static uint32_t CullBoxesAVX(const Frustum &frustum, const BoundingBoxes &boxes, uint32_t begin, uint32_t end, uint32_t *out)
+{
+    const float *x = boxes.GetCenterX(), *y = boxes.GetCenterY(), *z = boxes.GetCenterZ();
+    const float *ex = boxes.GetExtentX(), *ey = boxes.GetExtentY(), *ez = boxes.GetExtentZ();
+    const __m256 zero = _mm256_setzero_ps();
+
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; i += 8)
+    {
+        __m256 cx = _mm256_loadu_ps(x + i), cy = _mm256_loadu_ps(y + i), cz = _mm256_loadu_ps(z + i);
+        __m256 hx = _mm256_loadu_ps(ex + i), hy = _mm256_loadu_ps(ey + i), hz = _mm256_loadu_ps(ez + i);
+
+        uint32_t mask = TailMask(i, end, 8);
+        for (const FrustumPlane &p : frustum.planes)
+        {
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.a), cx), _mm256_mul_ps(_mm256_set1_ps(p.b), cy)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.c), cz), _mm256_set1_ps(p.d)));
+            __m256 radius = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(fabsf(p.a)), hx), _mm256_mul_ps(_mm256_set1_ps(fabsf(p.b)), hy)),
+                _mm256_mul_ps(_mm256_set1_ps(fabsf(p.c)), hz));
+            mask &= _mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_sub_ps(zero, radius), _CMP_GE_OQ));
+            if (!mask)
+                break;
+        }
+        count += EmitVisible(mask, i, out + count);
+    }
+    return count;
+}
+#endif
+
+// Splits [0, count) in one range per thread (aligned to 8 so SIMD blocks never straddle two threads).
+// Each range writes its visible indices at out + begin, then the ranges are packed together,
+// which keeps the output sorted without any synchronization between threads.
+template <typename Bounds, typename CullRange>
+static uint32_t CullParallel(const Frustum &frustum, const Bounds &bounds, uint32_t threadCount, JobSystem *jobSystem, CullRange cullRange, uint32_t *visible)
+{
+    if (jobSystem)
+        threadCount = jobSystem->GetThreadCount();
+
+    uint32_t count = bounds.GetCount();
+    if (count == 0)
+        return 0;
+
+    uint32_t maxThreads = (count + MIN_OBJECTS_PER_THREAD - 1) / MIN_OBJECTS_PER_THREAD;
+    if (threadCount > maxThreads)
+        threadCount = maxThreads;
+
+    if (threadCount <= 1)
+        return cullRange(frustum, bounds, 0, count, visible);
+
+    uint32_t rangeSize = ((count + threadCount - 1) / threadCount + 7) & ~7u;
+    std::vector<uint32_t> rangeCounts(threadCount, 0);
+
+    auto work = [&](uint32_t t) {
+        uint32_t begin = t * rangeSize;
+        uint32_t end = begin + rangeSize < count ? begin + rangeSize : count;
+        if (begin < end)
+            rangeCounts[t] = cullRange(frustum, bounds, begin, end, visible + begin);
+    };
+
+    if (jobSystem)
+    {
+        jobSystem->ParallelFor(threadCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t t = begin; t < end; t++)
+                work(t);
+        });
+    }
+    else
+    {
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+        for (uint32_t t = 1; t < threadCount; t++)
+            workers.emplace_back(work, t);
+        work(0);
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    uint32_t total = rangeCounts[0];
+    for (uint32_t t = 1; t < threadCount; t++)
+    {
+        memmove(visible + total, visible + t * rangeSize, rangeCounts[t] * sizeof(uint32_t));
+        total += rangeCounts[t];
+    }
+    return total;
+}
+
+void FrustumCuller::Cull(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<uint32_t> &visible) const
+{
+    visible.resize(spheres.GetCount());
+    visible.resize(Cull(frustum, spheres, visible.data()));
+}
+
+uint32_t FrustumCuller::Cull(const Frustum &frustum, const BoundingSpheres &spheres, uint32_t *visible) const
+{
+    switch (m_Backend)
+    {
+#ifdef FRUSTUM_CULLER_AVX
+    case CullingBackend::AVX:
+        return CullParallel(frustum, spheres, m_ThreadCount, m_JobSystem, CullSpheresAVX, visible);
+#endif
+#ifdef FRUSTUM_CULLER_SSE
+    case CullingBackend::SSE:
+        return CullParallel(frustum, spheres, m_ThreadCount, m_JobSystem, CullSpheresSSE, visible);
+#endif
+    default:
+        return CullParallel(frustum, spheres, m_ThreadCount, m_JobSystem, CullSpheresScalar, visible);
+    }
+}
+
+void FrustumCuller::Cull(const Frustum &frustum, const BoundingBoxes &boxes, std::vector<uint32_t> &visible) const
+{
+    visible.resize(boxes.GetCount());
+    visible.resize(Cull(frustum, boxes, visible.data()));
+}
+
+uint32_t FrustumCuller::Cull(const Frustum &frustum, const BoundingBoxes &boxes, uint32_t *visible) const
+{
+    switch (m_Backend)
+    {
+#ifdef FRUSTUM_CULLER_AVX
+    case CullingBackend::AVX:
+        return CullParallel(frustum, boxes, m_ThreadCount, m_JobSystem, CullBoxesAVX, visible);
+#endif
+#ifdef FRUSTUM_CULLER_SSE
+    case CullingBackend::SSE:
+        return CullParallel(frustum, boxes, m_ThreadCount, m_JobSystem, CullBoxesSSE, visible);
+#endif
+    default:
+        return CullParallel(frustum, boxes, m_ThreadCount, m_JobSystem, CullBoxesScalar, visible);
+    }
+}
+
+void FrustumCuller::SetBackend(CullingBackend backend)
+{
+    m_Backend = IsBackendAvailable(backend) ? backend : GetBestBackend();
+}
+
+bool FrustumCuller::IsBackendAvailable(CullingBackend backend)
+{
+    switch (backend)
+    {
+    case CullingBackend::Scalar:
+        return true;
+#ifdef FRUSTUM_CULLER_SSE
+    case CullingBackend::SSE:
+        return true;
+#endif
+#ifdef FRUSTUM_CULLER_AVX
+    case CullingBackend::AVX:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+CullingBackend FrustumCuller::GetBestBackend()
+{
+#if defined(FRUSTUM_CULLER_AVX)
+    return CullingBackend::AVX;
+#elif defined(FRUSTUM_CULLER_SSE)
+    return CullingBackend::SSE;
+#else
+    return CullingBackend::Scalar;
+#endif
+}
+
+const char *FrustumCuller::GetBackendName(CullingBackend backend)
+{
+    switch (backend)
+    {
+    case CullingBackend::Scalar:
+        return "scalar";
+    case CullingBackend::SSE:
+        return "sse";
+    case CullingBackend::AVX:
+        return "avx";
+    }
+    return "unknown";
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <vector>
+
+class JobSystem;
+
+// A plane in the form a*x + b*y + c*z + d = 0.
+// The normal (a, b, c) points to the inside of the frustum, so a point p is
+// inside the plane when dot(normal, p) + d >= 0.
+struct FrustumPlane
+{
+    float a, b, c, d;
+};
+
+struct Frustum
+{
+    // Left, right, bottom, top, near and far, in this order.
+    std::array<FrustumPlane, 6> planes;
+
+    // Extracts the six planes from a column-major view-projection matrix
+    // (the same layout OpenGL expects in glUniformMatrix4fv).
+    // Method from Gribb & Hartmann, "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix".
+    static Frustum FromViewProjection(const float *viewProjection);
+};
+
+// Bounding volumes are stored as a structure of arrays (one array per component)
+// instead of an array of structs. This way the culler can load the x of 4 (SSE) or 8 (AVX)
+// objects with a single instruction and test all of them against a plane at once.
+//
+// The arrays are always padded to a multiple of 8 so the SIMD loads never read out of bounds.
+class BoundingSpheres
+{
+public:
+    uint32_t Add(float x, float y, float z, float radius)
+    {
+        uint32_t index = m_Count++;
+        Reserve(m_Count);
+        Set(index, x, y, z, radius);
+        return index;
+    }
+
+    void Set(uint32_t index, float x, float y, float z, float radius)
+    {
+        m_CenterX[index] = x;
+        m_CenterY[index] = y;
+        m_CenterZ[index] = z;
+        m_Radius[index] = radius;
+    }
+
+    void Clear() { m_Count = 0; }
+
+    void Reserve(uint32_t count)
+    {
+        size_t padded = (count + 7) & ~size_t(7);
+        if (padded <= m_CenterX.size())
+            return;
+
+        m_CenterX.resize(padded, 0.0f);
+        m_CenterY.resize(padded, 0.0f);
+        m_CenterZ.resize(padded, 0.0f);
+        m_Radius.resize(padded, 0.0f);
+    }
+
+    inline uint32_t GetCount() const { return m_Count; }
+    inline const float *GetCenterX() const { return m_CenterX.data(); }
+    inline const float *GetCenterY() const { return m_CenterY.data(); }
+    inline const float *GetCenterZ() const { return m_CenterZ.data(); }
+    inline const float *GetRadius() const { return m_Radius.data(); }
+
+private:
+    uint32_t m_Count = 0;
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+    std::vector<float> m_Radius;
+};
+
+// Axis aligned bounding boxes, stored as center + half extents (same SoA layout as BoundingSpheres).
+class BoundingBoxes
+{
+public:
+    uint32_t Add(float x, float y, float z, float extentX, float extentY, float extentZ)
+    {
+        uint32_t index = m_Count++;
+        Reserve(m_Count);
+        Set(index, x, y, z, extentX, extentY, extentZ);
+        return index;
+    }
+
+    void Set(uint32_t index, float x, float y, float z, float extentX, float extentY, float extentZ)
+    {
+        m_CenterX[index] = x;
+        m_CenterY[index] = y;
+        m_CenterZ[index] = z;
+        m_ExtentX[index] = extentX;
+        m_ExtentY[index] = extentY;
+        m_ExtentZ[index] = extentZ;
+    }
+
+    void Clear() { m_Count = 0; }
+
+    void Reserve(uint32_t count)
+    {
+        size_t padded = (count + 7) & ~size_t(7);
+        if (padded <= m_CenterX.size())
+            return;
+
+        m_CenterX.resize(padded, 0.0f);
+        m_CenterY.resize(padded, 0.0f);
+        m_CenterZ.resize(padded, 0.0f);
+        m_ExtentX.resize(padded, 0.0f);
+        m_ExtentY.resize(padded, 0.0f);
+        m_ExtentZ.resize(padded, 0.0f);
+    }
+
+    inline uint32_t GetCount() const { return m_Count; }
+    inline const float *GetCenterX() const { return m_CenterX.data(); }
+    inline const float *GetCenterY() const { return m_CenterY.data(); }
+    inline const float *GetCenterZ() const { return m_CenterZ.data(); }
+    inline const float *GetExtentX() const { return m_ExtentX.data(); }
+    inline const float *GetExtentY() const { return m_ExtentY.data(); }
+    inline const float *GetExtentZ() const { return m_ExtentZ.data(); }
+
+private:
+    uint32_t m_Count = 0;
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ;
+    std::vector<float> m_ExtentX, m_ExtentY, m_ExtentZ;
+};
+
+// Which instruction set is used to test the bounds.
+// SSE tests 4 objects per instruction, AVX tests 8.
+// Only the backends enabled at compile time are available (AVX needs -mavx or -march=native).
+enum class CullingBackend
+{
+    Scalar,
+    SSE,
+    AVX,
+};
+
+// Tests bounding volumes against a frustum and outputs a compact list with the indices
+// of the visible ones, in increasing order, ready to be walked by the renderer.
+class FrustumCuller
+{
+public:
+    FrustumCuller(uint32_t threadCount = 1)
+        : m_Backend(GetBestBackend()), m_ThreadCount(threadCount ? threadCount : 1), m_JobSystem(nullptr)
+    {
+    }
+
+    void Cull(const Frustum &frustum, const BoundingSpheres &spheres, std::vector<uint32_t> &visible) const;
+    void Cull(const Frustum &frustum, const BoundingBoxes &boxes, std::vector<uint32_t> &visible) const;
+
+    // Same, into an array with room for every object (e.g. FrameArena::NewArray<uint32_t>(count)).
+    // Returns the number of visible ones.
+    uint32_t Cull(const Frustum &frustum, const BoundingSpheres &spheres, uint32_t *visible) const;
+    uint32_t Cull(const Frustum &frustum, const BoundingBoxes &boxes, uint32_t *visible) const;
+
+    // If the backend was not compiled in, the best available one is used instead.
+    void SetBackend(CullingBackend backend);
+    inline CullingBackend GetBackend() const { return m_Backend; }
+
+    inline void SetThreadCount(uint32_t threadCount) { m_ThreadCount = threadCount ? threadCount : 1; }
+    inline uint32_t GetThreadCount() const { return m_ThreadCount; }
+
+    // With a job system the ranges are culled by its workers (one range per worker) instead of
+    // threads spawned for every call. nullptr goes back to SetThreadCount() threads.
+    inline void SetJobSystem(JobSystem *jobSystem) { m_JobSystem = jobSystem; }
+    inline JobSystem *GetJobSystem() const { return m_JobSystem; }
+
+    static bool IsBackendAvailable(CullingBackend backend);
+    static CullingBackend GetBestBackend();
+    static const char *GetBackendName(CullingBackend backend);
+
+private:
+    CullingBackend m_Backend;
+    uint32_t m_ThreadCount;
+    JobSystem *m_JobSystem;
+};
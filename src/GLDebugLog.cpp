@@ -0,0 +1,316 @@
+#include <GL/glew.h>
+
+#include "GLDebugLog.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <unordered_map>
+
+#ifdef __WIN32__
+#define DBG_BREAK() __debugbreak()
+#else
+#include <signal.h>
+#define DBG_BREAK() raise(SIGTRAP)
+#endif
+
+// How long the logger thread sleeps when the queue is empty
+static constexpr std::chrono::milliseconds LOGGER_IDLE_SLEEP(10);
+
+// Repeats of a message are counted over windows of this length
+static constexpr std::chrono::seconds REPEAT_WINDOW(1);
+
+static const char *GetSourceName(GLenum source)
+{
+    switch (source)
+    {
+    case GL_DEBUG_SOURCE_API: return "API";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+    case GL_DEBUG_SOURCE_APPLICATION: return "application";
+    default: return "other";
+    }
+}
+
+static const char *GetTypeName(GLenum type)
+{
+    switch (type)
+    {
+    case GL_DEBUG_TYPE_ERROR: return "** GL ERROR **";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+    case GL_DEBUG_TYPE_MARKER: return "marker";
+    default: return "other";
+    }
+}
+
+static const char *GetSeverityName(GLenum severity)
+{
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH: return "high";
+    case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+    case GL_DEBUG_SEVERITY_LOW: return "low";
+    default: return "notification";
+    }
+}
+
+// 3 for high down to 0 for notification
+static int GetSeverityRank(GLenum severity)
+{
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH: return 3;
+    case GL_DEBUG_SEVERITY_MEDIUM: return 2;
+    case GL_DEBUG_SEVERITY_LOW: return 1;
+    default: return 0;
+    }
+}
+
+GLDebugLog::GLDebugLog(FILE *output)
+    : m_Output(output), m_Installed(false), m_BreakOnErrors(false), m_Cells(new Cell[QUEUE_CAPACITY]), m_Head(0), m_Tail(0),
+      m_Frame(0), m_FrameMessages(0), m_FrameErrors(0), m_Dropped(0), m_Suppressed(0), m_Running(true)
+{
+    for (uint32_t i = 0; i < QUEUE_CAPACITY; i++)
+        m_Cells[i].sequence.store(i, std::memory_order_relaxed);
+
+    m_Thread = std::thread(&GLDebugLog::LoggerLoop, this);
+}
+
+GLDebugLog::~GLDebugLog()
+{
+    // The logger thread prints what is left in the queue before exiting
+    m_Running.store(false, std::memory_order_release);
+    m_Thread.join();
+}
+
+bool GLDebugLog::Install(GLenum minSeverity, bool breakOnErrors)
+{
+    if (!glDebugMessageCallback || !glDebugMessageControl)
+        return false;
+
+    m_BreakOnErrors = breakOnErrors;
+    glEnable(GL_DEBUG_OUTPUT);
+    if (breakOnErrors)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+    glDebugMessageCallback(OnMessage, this);
+    SetMinSeverity(minSeverity);
+    m_Installed = true;
+    return true;
+}
+
+void GLDebugLog::Uninstall()
+{
+    if (!m_Installed)
+        return;
+
+    glDebugMessageCallback(nullptr, nullptr);
+    glDisable(GL_DEBUG_OUTPUT);
+    m_Installed = false;
+}
+
+void GLDebugLog::SetMinSeverity(GLenum minSeverity)
+{
+    static const GLenum severities[] = {GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION};
+
+    for (GLenum severity : severities)
+    {
+        GLboolean enabled = GetSeverityRank(severity) >= GetSeverityRank(minSeverity) ? GL_TRUE : GL_FALSE;
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, enabled);
+    }
+}
+
+void GLDebugLog::EndFrame()
+{
+    m_Stats.messages = m_FrameMessages.exchange(0, std::memory_order_relaxed);
+    m_Stats.errors = m_FrameErrors.exchange(0, std::memory_order_relaxed);
+    m_Frame.fetch_add(1, std::memory_order_relaxed);
+}
+
+GLDebugStats GLDebugLog::GetStats() const
+{
+    GLDebugStats stats = m_Stats;
+    stats.dropped = m_Dropped.load(std::memory_order_relaxed);
+    stats.suppressed = m_Suppressed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+GLenum GLDebugLog::ParseSeverity(const char *name)
+{
+    if (strcmp(name, "high") == 0)
+        return GL_DEBUG_SEVERITY_HIGH;
+    if (strcmp(name, "medium") == 0)
+        return GL_DEBUG_SEVERITY_MEDIUM;
+    if (strcmp(name, "low") == 0)
+        return GL_DEBUG_SEVERITY_LOW;
+    if (strcmp(name, "notification") == 0)
+        return GL_DEBUG_SEVERITY_NOTIFICATION;
+    return 0;
+}
+
+void GLAPIENTRY GLDebugLog::OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                      const GLchar *message, const void *userParam)
+{
+    GLDebugLog *log = (GLDebugLog *)userParam;
+
+    log->m_FrameMessages.fetch_add(1, std::memory_order_relaxed);
+    if (type == GL_DEBUG_TYPE_ERROR)
+        log->m_FrameErrors.fetch_add(1, std::memory_order_relaxed);
+
+    if (!log->Push(source, type, id, severity, length, message))
+        log->m_Dropped.fetch_add(1, std::memory_order_relaxed);
+
+    if (log->m_BreakOnErrors && type == GL_DEBUG_TYPE_ERROR)
+        DBG_BREAK();
+}
+
+bool GLDebugLog::Push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message)
+{
+    uint64_t position = m_Head.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;)
+    {
+        cell = &m_Cells[position & (QUEUE_CAPACITY - 1)];
+        uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+        int64_t difference = (int64_t)(sequence - position);
+
+        if (difference == 0)
+        {
+            // The cell is free for this position, claim it
+            if (m_Head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (difference < 0)
+        {
+            // The logger thread has not read the record written a lap ago: full
+            return false;
+        }
+        else
+        {
+            // Another producer claimed it first
+            position = m_Head.load(std::memory_order_relaxed);
+        }
+    }
+
+    Record &record = cell->record;
+    record.source = source;
+    record.type = type;
+    record.severity = severity;
+    record.id = id;
+    record.frame = m_Frame.load(std::memory_order_relaxed);
+
+    // Some drivers pass a negative length for null terminated messages
+    size_t messageLength = length >= 0 ? (size_t)length : strlen(message);
+    record.length = (uint32_t)(messageLength < MESSAGE_SIZE ? messageLength : MESSAGE_SIZE);
+    memcpy(record.message, message, record.length);
+
+    // Release: the logger thread sees the record once it sees the new sequence
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool GLDebugLog::Pop(Record &record)
+{
+    Cell &cell = m_Cells[m_Tail & (QUEUE_CAPACITY - 1)];
+    if (cell.sequence.load(std::memory_order_acquire) != m_Tail + 1)
+        return false;
+
+    record = cell.record;
+
+    // Frees the cell for the producers of the next lap
+    cell.sequence.store(m_Tail + QUEUE_CAPACITY, std::memory_order_release);
+    m_Tail++;
+    return true;
+}
+
+void GLDebugLog::LoggerLoop()
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Repeats
+    {
+        Clock::time_point windowStart;
+        GLuint id;
+        uint32_t count;      // Occurrences in the current window
+        uint64_t suppressed; // Of which not printed
+    };
+
+    // By hash of the message, only touched by this thread
+    std::unordered_map<uint64_t, Repeats> repeats;
+    auto reportSuppressed = [this](const Repeats &entry) {
+        if (entry.suppressed != 0)
+            fprintf(m_Output, "GL CALLBACK: id %u repeated %llu more times\n", entry.id, (unsigned long long)entry.suppressed);
+    };
+    Clock::time_point lastFlush = Clock::now();
+    Record record;
+
+    for (;;)
+    {
+        // Read before draining, so the records pushed before the destructor are all printed
+        bool running = m_Running.load(std::memory_order_acquire);
+        Clock::time_point now = Clock::now();
+
+        while (Pop(record))
+        {
+            // FNV-1a of the message and its identifiers
+            uint64_t hash = 14695981039346656037ull;
+            auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+            mix(record.source);
+            mix(record.type);
+            mix(record.id);
+            for (uint32_t i = 0; i < record.length; i++)
+                mix((uint8_t)record.message[i]);
+
+            Repeats &entry = repeats[hash];
+            if (entry.count == 0 || now - entry.windowStart >= REPEAT_WINDOW)
+            {
+                // The window may have ended since the last flush, its count would be lost otherwise
+                reportSuppressed(entry);
+                entry = {now, record.id, 0, 0};
+            }
+
+            if (++entry.count > REPEAT_LIMIT)
+            {
+                entry.suppressed++;
+                m_Suppressed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            fprintf(m_Output, "GL CALLBACK: %s [%s, %s] frame %llu, id %u: %.*s\n", GetTypeName(record.type),
+                    GetSourceName(record.source), GetSeverityName(record.severity), (unsigned long long)record.frame,
+                    record.id, (int)record.length, record.message);
+            if (entry.count == REPEAT_LIMIT)
+                fprintf(m_Output, "GL CALLBACK: (id %u: further repeats this second are counted, not printed)\n", record.id);
+        }
+
+        // Reports the repeats of the windows that ended
+        if (now - lastFlush >= REPEAT_WINDOW || !running)
+        {
+            for (auto it = repeats.begin(); it != repeats.end();)
+            {
+                if (now - it->second.windowStart < REPEAT_WINDOW && running)
+                {
+                    ++it;
+                    continue;
+                }
+
+                reportSuppressed(it->second);
+                it = repeats.erase(it);
+            }
+            fflush(m_Output);
+            lastFlush = now;
+        }
+
+        if (!running)
+            break;
+
+        std::this_thread::sleep_for(LOGGER_IDLE_SLEEP);
+    }
+}
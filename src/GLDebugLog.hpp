@@ -0,0 +1,109 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// Counts of the last frame ended with GLDebugLog::EndFrame(), plus totals since the log was created
+struct GLDebugStats
+{
+    uint32_t messages = 0;  // Messages the driver reported during the frame (after the severity filter)
+    uint32_t errors = 0;    // Of which GL_DEBUG_TYPE_ERROR
+    uint64_t dropped = 0;   // Messages lost because the queue was full
+    uint64_t suppressed = 0; // Repeats the logger thread did not print
+};
+
+// Logs the messages of the GL debug output (KHR_debug) without slowing down the thread that triggered them.
+//
+// The driver callback only copies a compact record into a bounded lock-free multi-producer queue
+// (Dmitry Vyukov's bounded MPMC queue, used with a single consumer): no lock, no allocation, no I/O.
+// The driver may call it from any of its threads when the output is asynchronous. A logger thread
+// drains the queue and prints the messages, at most REPEAT_LIMIT times per second for the same message,
+// then a single "repeated N times" line.
+//
+// Messages below the minimum severity are disabled in the driver with glDebugMessageControl, so they
+// cost nothing at all. With breakOnErrors, the output is made synchronous (the callback runs inside the
+// failing GL call) and the debugger stops on GL errors, with the faulty call on the stack.
+//
+// Uninstall() before destroying the context: the log must not be destroyed while the callback is installed.
+class GLDebugLog
+{
+public:
+    static constexpr uint32_t QUEUE_CAPACITY = 1024; // Power of two
+    static constexpr uint32_t MESSAGE_SIZE = 232;    // Longer messages are truncated
+    static constexpr uint32_t REPEAT_LIMIT = 3;
+
+    explicit GLDebugLog(FILE *output = stderr);
+    ~GLDebugLog();
+
+    GLDebugLog(const GLDebugLog &) = delete;
+    GLDebugLog &operator=(const GLDebugLog &) = delete;
+
+    // Installs the callback on the current context. Returns false if the context has no debug output.
+    // minSeverity is one of GL_DEBUG_SEVERITY_HIGH, _MEDIUM, _LOW or _NOTIFICATION.
+    bool Install(GLenum minSeverity, bool breakOnErrors = false);
+    void Uninstall();
+
+    // Only enables the messages of minSeverity and above
+    void SetMinSeverity(GLenum minSeverity);
+
+    // Closes the per-frame counts, call once per frame on the render thread
+    void EndFrame();
+
+    GLDebugStats GetStats() const;
+
+    // Parses "high", "medium", "low" or "notification", returns 0 for anything else
+    static GLenum ParseSeverity(const char *name);
+
+private:
+    struct Record
+    {
+        GLenum source;
+        GLenum type;
+        GLenum severity;
+        GLuint id;
+        uint64_t frame;
+        uint32_t length;
+        char message[MESSAGE_SIZE];
+    };
+
+    struct Cell
+    {
+        // Equal to the queue position when the cell is free for it, position + 1 once the record is written
+        std::atomic<uint64_t> sequence;
+        Record record;
+    };
+
+    static void GLAPIENTRY OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                     const GLchar *message, const void *userParam);
+
+    // Any thread, returns false if the queue is full
+    bool Push(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar *message);
+    // Logger thread only
+    bool Pop(Record &record);
+
+    void LoggerLoop();
+
+private:
+    FILE *m_Output;
+    bool m_Installed;
+    bool m_BreakOnErrors;
+
+    std::unique_ptr<Cell[]> m_Cells;
+    alignas(64) std::atomic<uint64_t> m_Head; // Next position to write, shared by the producers
+    alignas(64) uint64_t m_Tail;              // Next position to read, logger thread only
+
+    alignas(64) std::atomic<uint64_t> m_Frame;
+    std::atomic<uint32_t> m_FrameMessages;
+    std::atomic<uint32_t> m_FrameErrors;
+    std::atomic<uint64_t> m_Dropped;
+    std::atomic<uint64_t> m_Suppressed;
+    GLDebugStats m_Stats;
+
+    std::atomic<bool> m_Running;
+    std::thread m_Thread;
+};
@@ -0,0 +1,844 @@
+#include <GL/glew.h>
+
+#include "GLTrace.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+using namespace std::string_literals;
+
+// --- Recording state, shared by the intercepted functions ---
+
+static bool s_Recording = false;
+static std::vector<uint8_t> s_Trace;
+
+// Pixel store state, to know how many bytes the texture uploads read and glReadPixels writes
+struct PixelStore
+{
+    GLint rowLength;
+    GLint alignment;
+};
+static PixelStore s_Unpack = {0, 4};
+
+struct MappedRange
+{
+    void *pointer;
+    GLsizeiptr length;
+    GLbitfield access;
+};
+
+// By target, the contents are recorded by glUnmapBuffer
+static std::unordered_map<GLenum, MappedRange> s_MappedRanges;
+
+// Appends one command to the trace, its size is filled in when it goes out of scope
+class CommandWriter
+{
+public:
+    explicit CommandWriter(GLTraceOp op)
+        : m_Start(s_Trace.size())
+    {
+        GLTraceCommand command{op, 0, 0};
+        Append(&command, sizeof(command));
+    }
+
+    ~CommandWriter()
+    {
+        uint32_t size = (uint32_t)(s_Trace.size() - m_Start - sizeof(GLTraceCommand));
+        memcpy(&s_Trace[m_Start + offsetof(GLTraceCommand, size)], &size, sizeof(size));
+    }
+
+    template <typename T>
+    CommandWriter &operator<<(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value, "Only plain values can be written to a trace");
+        Append(&value, sizeof(T));
+        return *this;
+    }
+
+    // Pointers that GL reads as offsets into a bound buffer (vertex attributes, indices)
+    CommandWriter &Offset(const void *pointer)
+    {
+        return *this << (uint64_t)(uintptr_t)pointer;
+    }
+
+    // Size and pointed-to data, only the size if data is nullptr (e.g. glBufferData that only allocates)
+    CommandWriter &Data(const void *data, uint64_t size)
+    {
+        *this << (uint8_t)(data != nullptr) << size;
+        if (data)
+            Append(data, size);
+        return *this;
+    }
+
+private:
+    static void Append(const void *data, size_t size)
+    {
+        size_t offset = s_Trace.size();
+        s_Trace.resize(offset + size);
+        memcpy(&s_Trace[offset], data, size);
+    }
+
+private:
+    size_t m_Start;
+};
+
+// Bytes of client memory an image of depth layers covers with this pixel store state
+// (GL_UNPACK_IMAGE_HEIGHT is never set, the layers are height rows apart)
+static uint64_t GetPixelDataSize(GLenum format, GLenum type, GLsizei width, GLsizei height, GLsizei depth, const PixelStore &store)
+{
+    uint32_t components;
+    switch (format)
+    {
+    case GL_RG:
+    case GL_RG_INTEGER: components = 2; break;
+    case GL_RGB:
+    case GL_BGR:
+    case GL_RGB_INTEGER: components = 3; break;
+    case GL_RGBA:
+    case GL_BGRA:
+    case GL_RGBA_INTEGER: components = 4; break;
+    default: components = 1; break; // Red, depth, stencil, depth-stencil
+    }
+
+    uint32_t pixelSize;
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE:
+    case GL_BYTE: pixelSize = components; break;
+    case GL_UNSIGNED_SHORT:
+    case GL_SHORT:
+    case GL_HALF_FLOAT: pixelSize = components * 2; break;
+    case GL_UNSIGNED_INT_24_8:
+    case GL_UNSIGNED_INT_8_8_8_8:
+    case GL_UNSIGNED_INT_8_8_8_8_REV:
+    case GL_UNSIGNED_INT_2_10_10_10_REV: pixelSize = 4; break;
+    default: pixelSize = components * 4; break; // Int, unsigned int, float
+    }
+
+    if (width <= 0 || height <= 0 || depth <= 0)
+        return 0;
+
+    uint64_t rowPixels = store.rowLength > 0 ? (uint64_t)store.rowLength : (uint64_t)width;
+    uint64_t rowBytes = (rowPixels * pixelSize + store.alignment - 1) / store.alignment * store.alignment;
+    return rowBytes * (uint64_t)height * (uint64_t)(depth - 1) + rowBytes * (uint64_t)(height - 1) + (uint64_t)width * pixelSize;
+}
+
+// --- Functions loaded by GLEW: the thunks replace the GLEW pointers while recording ---
+
+#define GLTRACE_GLEW_FUNCTIONS(X)                                                                                        \
+    X(ActiveTexture) X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData) X(MapBufferRange)     \
+    X(UnmapBuffer) X(BindBufferRange) X(TexBuffer) X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray)          \
+    X(EnableVertexAttribArray) X(VertexAttribPointer) X(VertexAttribIPointer) X(VertexAttribDivisor) X(CreateShader)    \
+    X(ShaderSource) X(CompileShader) X(DeleteShader) X(CreateProgram) X(AttachShader) X(LinkProgram)                    \
+    X(ValidateProgram) X(UseProgram) X(DeleteProgram) X(GetUniformLocation) X(Uniform1i) X(Uniform1f) X(Uniform2f)      \
+    X(Uniform3f) X(Uniform4f) X(UniformMatrix3fv) X(UniformMatrix4fv) X(GenFramebuffers) X(DeleteFramebuffers)          \
+    X(BindFramebuffer) X(FramebufferTexture2D) X(FramebufferRenderbuffer) X(GenRenderbuffers) X(DeleteRenderbuffers)    \
+    X(BindRenderbuffer) X(RenderbufferStorage) X(RenderbufferStorageMultisample) X(DrawBuffers) X(BlitFramebuffer)      \
+    X(InvalidateFramebuffer) X(ClearBufferfv) X(ClearBufferfi) X(DrawArraysInstanced) X(FenceSync) X(ClientWaitSync)    \
+    X(DeleteSync) X(TexImage3D) X(TexSubImage3D) X(BindBufferBase) X(TransformFeedbackVaryings)                        \
+    X(BeginTransformFeedback) X(EndTransformFeedback) X(GenQueries) X(DeleteQueries) X(QueryCounter)                    \
+    X(GetQueryObjectiv) X(GetQueryObjectui64v)
+
+// The pointers GLEW loaded, called by the thunks
+struct GlewFunctions
+{
+#define GLTRACE_GLEW_POINTER(name) decltype(__glew##name) name;
+    GLTRACE_GLEW_FUNCTIONS(GLTRACE_GLEW_POINTER)
+#undef GLTRACE_GLEW_POINTER
+};
+static GlewFunctions s_Real;
+
+static void GLAPIENTRY TraceActiveTexture(GLenum texture)
+{
+    CommandWriter(GLTraceOp::ActiveTexture) << texture;
+    s_Real.ActiveTexture(texture);
+}
+
+// glGen* and glCreate* are recorded after the call, with the names the driver returned
+static void GLAPIENTRY TraceGenBuffers(GLsizei n, GLuint *buffers)
+{
+    s_Real.GenBuffers(n, buffers);
+    CommandWriter(GLTraceOp::GenBuffers).Data(buffers, n * sizeof(GLuint));
+}
+
+static void GLAPIENTRY TraceDeleteBuffers(GLsizei n, const GLuint *buffers)
+{
+    CommandWriter(GLTraceOp::DeleteBuffers).Data(buffers, n * sizeof(GLuint));
+    s_Real.DeleteBuffers(n, buffers);
+}
+
+static void GLAPIENTRY TraceBindBuffer(GLenum target, GLuint buffer)
+{
+    CommandWriter(GLTraceOp::BindBuffer) << target << buffer;
+    s_Real.BindBuffer(target, buffer);
+}
+
+static void GLAPIENTRY TraceBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    (CommandWriter(GLTraceOp::BufferData) << target << usage).Data(data, size);
+    s_Real.BufferData(target, size, data, usage);
+}
+
+static void GLAPIENTRY TraceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    (CommandWriter(GLTraceOp::BufferSubData) << target << (int64_t)offset).Data(data, size);
+    s_Real.BufferSubData(target, offset, size, data);
+}
+
+static void *GLAPIENTRY TraceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    CommandWriter(GLTraceOp::MapBufferRange) << target << (int64_t)offset << (int64_t)length << access;
+    void *pointer = s_Real.MapBufferRange(target, offset, length, access);
+    s_MappedRanges[target] = {pointer, length, access};
+    return pointer;
+}
+
+// The application wrote the mapped range by now, its contents go with the unmap
+static GLboolean GLAPIENTRY TraceUnmapBuffer(GLenum target)
+{
+    auto it = s_MappedRanges.find(target);
+    bool written = it != s_MappedRanges.end() && it->second.pointer && (it->second.access & GL_MAP_WRITE_BIT);
+    (CommandWriter(GLTraceOp::UnmapBuffer) << target).Data(written ? it->second.pointer : nullptr, written ? it->second.length : 0);
+    if (it != s_MappedRanges.end())
+        s_MappedRanges.erase(it);
+    return s_Real.UnmapBuffer(target);
+}
+
+static void GLAPIENTRY TraceBindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    CommandWriter(GLTraceOp::BindBufferRange) << target << index << buffer << (int64_t)offset << (int64_t)size;
+    s_Real.BindBufferRange(target, index, buffer, offset, size);
+}
+
+static void GLAPIENTRY TraceTexBuffer(GLenum target, GLenum internalFormat, GLuint buffer)
+{
+    CommandWriter(GLTraceOp::TexBuffer) << target << internalFormat << buffer;
+    s_Real.TexBuffer(target, internalFormat, buffer);
+}
+
+static void GLAPIENTRY TraceGenVertexArrays(GLsizei n, GLuint *arrays)
+{
+    s_Real.GenVertexArrays(n, arrays);
+    CommandWriter(GLTraceOp::GenVertexArrays).Data(arrays, n * sizeof(GLuint));
+}
+
+static void GLAPIENTRY TraceDeleteVertexArrays(GLsizei n, const GLuint *arrays)
+{
+    CommandWriter(GLTraceOp::DeleteVertexArrays).Data(arrays, n * sizeof(GLuint));
+    s_Real.DeleteVertexArrays(n, arrays);
+}
+
+static void GLAPIENTRY TraceBindVertexArray(GLuint array)
+{
+    CommandWriter(GLTraceOp::BindVertexArray) << array;
+    s_Real.BindVertexArray(array);
+}
+
+static void GLAPIENTRY TraceEnableVertexAttribArray(GLuint index)
+{
+    CommandWriter(GLTraceOp::EnableVertexAttribArray) << index;
+    s_Real.EnableVertexAttribArray(index);
+}
+
+static void GLAPIENTRY TraceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+    (CommandWriter(GLTraceOp::VertexAttribPointer) << index << size << type << normalized << stride).Offset(pointer);
+    s_Real.VertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+static void GLAPIENTRY TraceVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer)
+{
+    (CommandWriter(GLTraceOp::VertexAttribIPointer) << index << size << type << stride).Offset(pointer);
+    s_Real.VertexAttribIPointer(index, size, type, stride, pointer);
+}
+
+static void GLAPIENTRY TraceVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    CommandWriter(GLTraceOp::VertexAttribDivisor) << index << divisor;
+    s_Real.VertexAttribDivisor(index, divisor);
+}
+
+static GLuint GLAPIENTRY TraceCreateShader(GLenum type)
+{
+    GLuint shader = s_Real.CreateShader(type);
+    CommandWriter(GLTraceOp::CreateShader) << type << shader;
+    return shader;
+}
+
+// Stored as the concatenation of the strings
+static void GLAPIENTRY TraceShaderSource(GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths)
+{
+    std::string source;
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (lengths && lengths[i] >= 0)
+            source.append(strings[i], lengths[i]);
+        else
+            source.append(strings[i]);
+    }
+
+    (CommandWriter(GLTraceOp::ShaderSource) << shader).Data(source.data(), source.size());
+    s_Real.ShaderSource(shader, count, strings, lengths);
+}
+
+static void GLAPIENTRY TraceCompileShader(GLuint shader)
+{
+    CommandWriter(GLTraceOp::CompileShader) << shader;
+    s_Real.CompileShader(shader);
+}
+
+static void GLAPIENTRY TraceDeleteShader(GLuint shader)
+{
+    CommandWriter(GLTraceOp::DeleteShader) << shader;
+    s_Real.DeleteShader(shader);
+}
+
+static GLuint GLAPIENTRY TraceCreateProgram()
+{
+    GLuint program = s_Real.CreateProgram();
+    CommandWriter(GLTraceOp::CreateProgram) << program;
+    return program;
+}
+
+static void GLAPIENTRY TraceAttachShader(GLuint program, GLuint shader)
+{
+    CommandWriter(GLTraceOp::AttachShader) << program << shader;
+    s_Real.AttachShader(program, shader);
+}
+
+static void GLAPIENTRY TraceLinkProgram(GLuint program)
+{
+    CommandWriter(GLTraceOp::LinkProgram) << program;
+    s_Real.LinkProgram(program);
+}
+
+static void GLAPIENTRY TraceValidateProgram(GLuint program)
+{
+    CommandWriter(GLTraceOp::ValidateProgram) << program;
+    s_Real.ValidateProgram(program);
+}
+
+static void GLAPIENTRY TraceUseProgram(GLuint program)
+{
+    CommandWriter(GLTraceOp::UseProgram) << program;
+    s_Real.UseProgram(program);
+}
+
+static void GLAPIENTRY TraceDeleteProgram(GLuint program)
+{
+    CommandWriter(GLTraceOp::DeleteProgram) << program;
+    s_Real.DeleteProgram(program);
+}
+
+// A query, but the replay needs the recorded locations to find its own
+static GLint GLAPIENTRY TraceGetUniformLocation(GLuint program, const GLchar *name)
+{
+    GLint location = s_Real.GetUniformLocation(program, name);
+    (CommandWriter(GLTraceOp::GetUniformLocation) << program << location).Data(name, strlen(name));
+    return location;
+}
+
+static void GLAPIENTRY TraceUniform1i(GLint location, GLint v0)
+{
+    CommandWriter(GLTraceOp::Uniform1i) << location << v0;
+    s_Real.Uniform1i(location, v0);
+}
+
+static void GLAPIENTRY TraceUniform1f(GLint location, GLfloat v0)
+{
+    CommandWriter(GLTraceOp::Uniform1f) << location << v0;
+    s_Real.Uniform1f(location, v0);
+}
+
+static void GLAPIENTRY TraceUniform2f(GLint location, GLfloat v0, GLfloat v1)
+{
+    CommandWriter(GLTraceOp::Uniform2f) << location << v0 << v1;
+    s_Real.Uniform2f(location, v0, v1);
+}
+
+static void GLAPIENTRY TraceUniform3f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+    CommandWriter(GLTraceOp::Uniform3f) << location << v0 << v1 << v2;
+    s_Real.Uniform3f(location, v0, v1, v2);
+}
+
+static void GLAPIENTRY TraceUniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    CommandWriter(GLTraceOp::Uniform4f) << location << v0 << v1 << v2 << v3;
+    s_Real.Uniform4f(location, v0, v1, v2, v3);
+}
+
+static void GLAPIENTRY TraceUniformMatrix3fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    (CommandWriter(GLTraceOp::UniformMatrix3fv) << location << transpose).Data(value, count * 9 * sizeof(GLfloat));
+    s_Real.UniformMatrix3fv(location, count, transpose, value);
+}
+
+static void GLAPIENTRY TraceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    (CommandWriter(GLTraceOp::UniformMatrix4fv) << location << transpose).Data(value, count * 16 * sizeof(GLfloat));
+    s_Real.UniformMatrix4fv(location, count, transpose, value);
+}
+
+static void GLAPIENTRY TraceGenFramebuffers(GLsizei n, GLuint *framebuffers)
+{
+    s_Real.GenFramebuffers(n, framebuffers);
+    CommandWriter(GLTraceOp::GenFramebuffers).Data(framebuffers, n * sizeof(GLuint));
+}
+
+static void GLAPIENTRY TraceDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+    CommandWriter(GLTraceOp::DeleteFramebuffers).Data(framebuffers, n * sizeof(GLuint));
+    s_Real.DeleteFramebuffers(n, framebuffers);
+}
+
+static void GLAPIENTRY TraceBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    CommandWriter(GLTraceOp::BindFramebuffer) << target << framebuffer;
+    s_Real.BindFramebuffer(target, framebuffer);
+}
+
+static void GLAPIENTRY TraceFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level)
+{
+    CommandWriter(GLTraceOp::FramebufferTexture2D) << target << attachment << textureTarget << texture << level;
+    s_Real.FramebufferTexture2D(target, attachment, textureTarget, texture, level);
+}
+
+static void GLAPIENTRY TraceFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer)
+{
+    CommandWriter(GLTraceOp::FramebufferRenderbuffer) << target << attachment << renderbufferTarget << renderbuffer;
+    s_Real.FramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+}
+
+static void GLAPIENTRY TraceGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+{
+    s_Real.GenRenderbuffers(n, renderbuffers);
+    CommandWriter(GLTraceOp::GenRenderbuffers).Data(renderbuffers, n * sizeof(GLuint));
+}
+
+static void GLAPIENTRY TraceDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
+{
+    CommandWriter(GLTraceOp::DeleteRenderbuffers).Data(renderbuffers, n * sizeof(GLuint));
+    s_Real.DeleteRenderbuffers(n, renderbuffers);
+}
+
+static void GLAPIENTRY TraceBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    CommandWriter(GLTraceOp::BindRenderbuffer) << target << renderbuffer;
+    s_Real.BindRenderbuffer(target, renderbuffer);
+}
+
+static void GLAPIENTRY TraceRenderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    CommandWriter(GLTraceOp::RenderbufferStorage) << target << internalFormat << width << height;
+    s_Real.RenderbufferStorage(target, internalFormat, width, height);
+}
+
+static void GLAPIENTRY TraceRenderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    CommandWriter(GLTraceOp::RenderbufferStorageMultisample) << target << samples << internalFormat << width << height;
+    s_Real.RenderbufferStorageMultisample(target, samples, internalFormat, width, height);
+}
+
+static void GLAPIENTRY TraceDrawBuffers(GLsizei n, const GLenum *buffers)
+{
+    CommandWriter(GLTraceOp::DrawBuffers).Data(buffers, n * sizeof(GLenum));
+    s_Real.DrawBuffers(n, buffers);
+}
+
+static void GLAPIENTRY TraceBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1,
+                                            GLint dstY1, GLbitfield mask, GLenum filter)
+{
+    CommandWriter(GLTraceOp::BlitFramebuffer) << srcX0 << srcY0 << srcX1 << srcY1 << dstX0 << dstY0 << dstX1 << dstY1 << mask << filter;
+    s_Real.BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
+}
+
+static void GLAPIENTRY TraceInvalidateFramebuffer(GLenum target, GLsizei n, const GLenum *attachments)
+{
+    (CommandWriter(GLTraceOp::InvalidateFramebuffer) << target).Data(attachments, n * sizeof(GLenum));
+    s_Real.InvalidateFramebuffer(target, n, attachments);
+}
+
+static void GLAPIENTRY TraceClearBufferfv(GLenum buffer, GLint drawBuffer, const GLfloat *value)
+{
+    (CommandWriter(GLTraceOp::ClearBufferfv) << buffer << drawBuffer).Data(value, (buffer == GL_COLOR ? 4 : 1) * sizeof(GLfloat));
+    s_Real.ClearBufferfv(buffer, drawBuffer, value);
+}
+
+static void GLAPIENTRY TraceClearBufferfi(GLenum buffer, GLint drawBuffer, GLfloat depth, GLint stencil)
+{
+    CommandWriter(GLTraceOp::ClearBufferfi) << buffer << drawBuffer << depth << stencil;
+    s_Real.ClearBufferfi(buffer, drawBuffer, depth, stencil);
+}
+
+static void GLAPIENTRY TraceDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instanceCount)
+{
+    CommandWriter(GLTraceOp::DrawArraysInstanced) << mode << first << count << instanceCount;
+    s_Real.DrawArraysInstanced(mode, first, count, instanceCount);
+}
+
+// Syncs are identified by the pointer value the recording driver returned
+static GLsync GLAPIENTRY TraceFenceSync(GLenum condition, GLbitfield flags)
+{
+    GLsync sync = s_Real.FenceSync(condition, flags);
+    CommandWriter(GLTraceOp::FenceSync) << condition << flags << (uint64_t)(uintptr_t)sync;
+    return sync;
+}
+
+static GLenum GLAPIENTRY TraceClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    CommandWriter(GLTraceOp::ClientWaitSync) << (uint64_t)(uintptr_t)sync << flags << (uint64_t)timeout;
+    return s_Real.ClientWaitSync(sync, flags, timeout);
+}
+
+static void GLAPIENTRY TraceDeleteSync(GLsync sync)
+{
+    CommandWriter(GLTraceOp::DeleteSync) << (uint64_t)(uintptr_t)sync;
+    s_Real.DeleteSync(sync);
+}
+
+static void GLAPIENTRY TraceTexImage3D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLsizei depth,
+                                       GLint border, GLenum format, GLenum type, const void *pixels)
+{
+    (CommandWriter(GLTraceOp::TexImage3D) << target << level << internalFormat << width << height << depth << border << format << type)
+        .Data(pixels, GetPixelDataSize(format, type, width, height, depth, s_Unpack));
+    s_Real.TexImage3D(target, level, internalFormat, width, height, depth, border, format, type, pixels);
+}
+
+static void GLAPIENTRY TraceTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                                          GLsizei depth, GLenum format, GLenum type, const void *pixels)
+{
+    (CommandWriter(GLTraceOp::TexSubImage3D) << target << level << x << y << z << width << height << depth << format << type)
+        .Data(pixels, GetPixelDataSize(format, type, width, height, depth, s_Unpack));
+    s_Real.TexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+}
+
+static void GLAPIENTRY TraceBindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    CommandWriter(GLTraceOp::BindBufferBase) << target << index << buffer;
+    s_Real.BindBufferBase(target, index, buffer);
+}
+
+// Stored as the names one after the other, each one with its terminating null
+static void GLAPIENTRY TraceTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar *const *varyings, GLenum bufferMode)
+{
+    std::string names;
+    for (GLsizei i = 0; i < count; i++)
+        names.append(varyings[i], strlen(varyings[i]) + 1);
+
+    (CommandWriter(GLTraceOp::TransformFeedbackVaryings) << program << bufferMode).Data(names.data(), names.size());
+    s_Real.TransformFeedbackVaryings(program, count, varyings, bufferMode);
+}
+
+static void GLAPIENTRY TraceBeginTransformFeedback(GLenum primitiveMode)
+{
+    CommandWriter(GLTraceOp::BeginTransformFeedback) << primitiveMode;
+    s_Real.BeginTransformFeedback(primitiveMode);
+}
+
+static void GLAPIENTRY TraceEndTransformFeedback()
+{
+    CommandWriter(GLTraceOp::EndTransformFeedback);
+    s_Real.EndTransformFeedback();
+}
+
+static void GLAPIENTRY TraceGenQueries(GLsizei n, GLuint *ids)
+{
+    s_Real.GenQueries(n, ids);
+    CommandWriter(GLTraceOp::GenQueries).Data(ids, n * sizeof(GLuint));
+}
+
+static void GLAPIENTRY TraceDeleteQueries(GLsizei n, const GLuint *ids)
+{
+    CommandWriter(GLTraceOp::DeleteQueries).Data(ids, n * sizeof(GLuint));
+    s_Real.DeleteQueries(n, ids);
+}
+
+static void GLAPIENTRY TraceQueryCounter(GLuint id, GLenum target)
+{
+    CommandWriter(GLTraceOp::QueryCounter) << id << target;
+    s_Real.QueryCounter(id, target);
+}
+
+// The results aren't recorded: the replay asks for them again, so it waits for the GPU where the app did
+static void GLAPIENTRY TraceGetQueryObjectiv(GLuint id, GLenum name, GLint *params)
+{
+    CommandWriter(GLTraceOp::GetQueryObjectiv) << id << name;
+    s_Real.GetQueryObjectiv(id, name, params);
+}
+
+static void GLAPIENTRY TraceGetQueryObjectui64v(GLuint id, GLenum name, GLuint64 *params)
+{
+    CommandWriter(GLTraceOp::GetQueryObjectui64v) << id << name;
+    s_Real.GetQueryObjectui64v(id, name, params);
+}
+
+// --- GL 1.1 functions: libGL exports them and GLEW does not load them, so there is no pointer to swap.
+// Defining them here makes the calls of the executable land on these, which forward to the libGL ones
+// (found with RTLD_NEXT) and only record while a recorder is active. Every GL 1.1 call of the app pays
+// for the forwarding, so they are only defined in capture builds (make main-capture). ---
+
+#if defined(__linux__) && defined(GLTRACE_CAPTURE)
+
+static PixelStore s_Pack = {0, 4};
+
+#define GLTRACE_NEXT(name) static auto next = (decltype(&::name))dlsym(RTLD_NEXT, #name)
+
+void GLAPIENTRY glEnable(GLenum cap)
+{
+    GLTRACE_NEXT(glEnable);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::Enable) << cap;
+    next(cap);
+}
+
+void GLAPIENTRY glDisable(GLenum cap)
+{
+    GLTRACE_NEXT(glDisable);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::Disable) << cap;
+    next(cap);
+}
+
+void GLAPIENTRY glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    GLTRACE_NEXT(glBlendFunc);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::BlendFunc) << sfactor << dfactor;
+    next(sfactor, dfactor);
+}
+
+void GLAPIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    GLTRACE_NEXT(glViewport);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::Viewport) << x << y << width << height;
+    next(x, y, width, height);
+}
+
+void GLAPIENTRY glClear(GLbitfield mask)
+{
+    GLTRACE_NEXT(glClear);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::Clear) << mask;
+    next(mask);
+}
+
+void GLAPIENTRY glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+    GLTRACE_NEXT(glClearColor);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::ClearColor) << red << green << blue << alpha;
+    next(red, green, blue, alpha);
+}
+
+void GLAPIENTRY glDrawBuffer(GLenum buffer)
+{
+    GLTRACE_NEXT(glDrawBuffer);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::DrawBuffer) << buffer;
+    next(buffer);
+}
+
+void GLAPIENTRY glReadBuffer(GLenum buffer)
+{
+    GLTRACE_NEXT(glReadBuffer);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::ReadBuffer) << buffer;
+    next(buffer);
+}
+
+void GLAPIENTRY glPixelStorei(GLenum name, GLint param)
+{
+    GLTRACE_NEXT(glPixelStorei);
+    if (name == GL_UNPACK_ROW_LENGTH)
+        s_Unpack.rowLength = param;
+    else if (name == GL_UNPACK_ALIGNMENT)
+        s_Unpack.alignment = param;
+    else if (name == GL_PACK_ROW_LENGTH)
+        s_Pack.rowLength = param;
+    else if (name == GL_PACK_ALIGNMENT)
+        s_Pack.alignment = param;
+
+    if (s_Recording)
+        CommandWriter(GLTraceOp::PixelStorei) << name << param;
+    next(name, param);
+}
+
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint *textures)
+{
+    GLTRACE_NEXT(glGenTextures);
+    next(n, textures);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::GenTextures).Data(textures, n * sizeof(GLuint));
+}
+
+void GLAPIENTRY glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+    GLTRACE_NEXT(glDeleteTextures);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::DeleteTextures).Data(textures, n * sizeof(GLuint));
+    next(n, textures);
+}
+
+void GLAPIENTRY glBindTexture(GLenum target, GLuint texture)
+{
+    GLTRACE_NEXT(glBindTexture);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::BindTexture) << target << texture;
+    next(target, texture);
+}
+
+void GLAPIENTRY glTexParameteri(GLenum target, GLenum name, GLint param)
+{
+    GLTRACE_NEXT(glTexParameteri);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::TexParameteri) << target << name << param;
+    next(target, name, param);
+}
+
+void GLAPIENTRY glTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint border,
+                             GLenum format, GLenum type, const GLvoid *pixels)
+{
+    GLTRACE_NEXT(glTexImage2D);
+    if (s_Recording)
+        (CommandWriter(GLTraceOp::TexImage2D) << target << level << internalFormat << width << height << border << format << type)
+            .Data(pixels, GetPixelDataSize(format, type, width, height, 1, s_Unpack));
+    next(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+void GLAPIENTRY glTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format,
+                                GLenum type, const GLvoid *pixels)
+{
+    GLTRACE_NEXT(glTexSubImage2D);
+    if (s_Recording)
+        (CommandWriter(GLTraceOp::TexSubImage2D) << target << level << x << y << width << height << format << type)
+            .Data(pixels, GetPixelDataSize(format, type, width, height, 1, s_Unpack));
+    next(target, level, x, y, width, height, format, type, pixels);
+}
+
+void GLAPIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    GLTRACE_NEXT(glDrawArrays);
+    if (s_Recording)
+        CommandWriter(GLTraceOp::DrawArrays) << mode << first << count;
+    next(mode, first, count);
+}
+
+void GLAPIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices)
+{
+    GLTRACE_NEXT(glDrawElements);
+    if (s_Recording)
+        (CommandWriter(GLTraceOp::DrawElements) << mode << count << type).Offset(indices);
+    next(mode, count, type, indices);
+}
+
+// Into a pixel pack buffer, pixels is an offset in it. Otherwise the size of the client memory is
+// recorded too, for the replay to read into memory of its own.
+void GLAPIENTRY glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid *pixels)
+{
+    GLTRACE_NEXT(glReadPixels);
+    if (s_Recording)
+    {
+        GLint packBuffer = 0;
+        glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+        uint64_t clientSize = packBuffer ? 0 : GetPixelDataSize(format, type, width, height, 1, s_Pack);
+        (CommandWriter(GLTraceOp::ReadPixels) << x << y << width << height << format << type << clientSize).Offset(pixels);
+    }
+    next(x, y, width, height, format, type, pixels);
+}
+
+#endif
+
+// --- Recorder ---
+
+GLTraceRecorder::GLTraceRecorder(const std::string &path, uint32_t firstFrame, uint32_t frameCount)
+    : m_Path(path), m_FirstFrame(firstFrame), m_FrameCount(frameCount), m_Frame(0), m_Recording(false)
+{
+    if (!IsAvailable())
+        throw std::runtime_error("GL traces can only be recorded by capture builds on Linux (make main-capture)");
+    if (s_Recording)
+        throw std::runtime_error("A GL trace is already being recorded");
+    if (frameCount == 0)
+        throw std::runtime_error("A GL trace needs at least one frame");
+
+    // The default framebuffer size, from the initial viewport
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    m_Header.viewportWidth = viewport[2];
+    m_Header.viewportHeight = viewport[3];
+
+    s_Trace.clear();
+    s_MappedRanges.clear();
+
+#define GLTRACE_PATCH(name) s_Real.name = __glew##name, __glew##name = Trace##name;
+    GLTRACE_GLEW_FUNCTIONS(GLTRACE_PATCH)
+#undef GLTRACE_PATCH
+
+    s_Recording = true;
+    m_Recording = true;
+}
+
+GLTraceRecorder::~GLTraceRecorder()
+{
+    if (m_Recording)
+        Stop();
+}
+
+void GLTraceRecorder::EndFrame()
+{
+    if (!m_Recording)
+        return;
+
+    CommandWriter(GLTraceOp::FrameEnd) << m_Frame;
+    m_Frame++;
+
+    if (m_Frame == m_FirstFrame)
+        m_Header.setupSize = s_Trace.size();
+
+    if (m_Frame == m_FirstFrame + m_FrameCount)
+    {
+        m_Header.frameCount = m_FrameCount;
+        m_Header.framesSize = s_Trace.size() - m_Header.setupSize;
+        Stop();
+        Write();
+    }
+}
+
+void GLTraceRecorder::Stop()
+{
+#define GLTRACE_RESTORE(name) __glew##name = s_Real.name;
+    GLTRACE_GLEW_FUNCTIONS(GLTRACE_RESTORE)
+#undef GLTRACE_RESTORE
+
+    s_Recording = false;
+    m_Recording = false;
+    s_MappedRanges.clear();
+}
+
+void GLTraceRecorder::Write()
+{
+    FILE *file = fopen(m_Path.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("Could not open GL trace file for writing: "s + m_Path);
+
+    bool written = fwrite(&m_Header, sizeof(m_Header), 1, file) == 1 && fwrite(s_Trace.data(), 1, s_Trace.size(), file) == s_Trace.size();
+    fclose(file);
+
+    // The trace can be big, don't keep it around
+    std::vector<uint8_t>().swap(s_Trace);
+
+    if (!written)
+        throw std::runtime_error("Could not write GL trace file: "s + m_Path);
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Binary trace of the GL calls of a few frames, written by GLTraceRecorder and replayed by GLTraceReplay
+// (bench/GLReplay.cpp). Layout:
+//
+//     GLTraceHeader
+//     commands of the setup (everything from the recorder creation to the first captured frame)
+//     commands of the captured frames, each one closed by a FrameEnd command
+//
+// A command is a GLTraceCommand followed by its arguments, in call order, with the pointed-to data
+// inlined (buffer and texture contents, shader sources, uniform arrays, ...). Names and handles are
+// stored as the recording driver returned them, the replay maps them to its own.
+
+// Every traced call (without the gl prefix), in the order of the opcodes
+#define GLTRACE_OPS(X)                                                                                                  \
+    X(FrameEnd)                                                                                                         \
+    /* GL 1.1 */                                                                                                        \
+    X(Enable) X(Disable) X(BlendFunc) X(Viewport) X(Clear) X(ClearColor) X(DrawBuffer) X(ReadBuffer)                   \
+    X(PixelStorei) X(GenTextures) X(DeleteTextures) X(BindTexture) X(TexParameteri) X(TexImage2D) X(TexSubImage2D)      \
+    X(DrawArrays) X(DrawElements) X(ReadPixels)                                                                         \
+    /* Loaded by GLEW */                                                                                                \
+    X(ActiveTexture) X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData) X(MapBufferRange)     \
+    X(UnmapBuffer) X(BindBufferRange) X(TexBuffer) X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray)          \
+    X(EnableVertexAttribArray) X(VertexAttribPointer) X(VertexAttribIPointer) X(VertexAttribDivisor) X(CreateShader)    \
+    X(ShaderSource) X(CompileShader) X(DeleteShader) X(CreateProgram) X(AttachShader) X(LinkProgram)                    \
+    X(ValidateProgram) X(UseProgram) X(DeleteProgram) X(GetUniformLocation) X(Uniform1i) X(Uniform1f) X(Uniform2f)      \
+    X(Uniform3f) X(Uniform4f) X(UniformMatrix3fv) X(UniformMatrix4fv) X(GenFramebuffers) X(DeleteFramebuffers)          \
+    X(BindFramebuffer) X(FramebufferTexture2D) X(FramebufferRenderbuffer) X(GenRenderbuffers) X(DeleteRenderbuffers)    \
+    X(BindRenderbuffer) X(RenderbufferStorage) X(RenderbufferStorageMultisample) X(DrawBuffers) X(BlitFramebuffer)      \
+    X(InvalidateFramebuffer) X(ClearBufferfv) X(ClearBufferfi) X(DrawArraysInstanced) X(FenceSync) X(ClientWaitSync)    \
+    X(DeleteSync) X(TexImage3D) X(TexSubImage3D) X(BindBufferBase) X(TransformFeedbackVaryings)                        \
+    X(BeginTransformFeedback) X(EndTransformFeedback) X(GenQueries) X(DeleteQueries) X(QueryCounter)                    \
+    X(GetQueryObjectiv) X(GetQueryObjectui64v)
+
+enum class GLTraceOp : uint16_t
+{
+#define GLTRACE_OP_ENUM(name) name,
+    GLTRACE_OPS(GLTRACE_OP_ENUM)
+#undef GLTRACE_OP_ENUM
+    Count
+};
+
+inline const char *GetGLTraceOpName(GLTraceOp op)
+{
+    static const char *names[] = {
+#define GLTRACE_OP_NAME(name) #name,
+        GLTRACE_OPS(GLTRACE_OP_NAME)
+#undef GLTRACE_OP_NAME
+    };
+    return op < GLTraceOp::Count ? names[(size_t)op] : "Unknown";
+}
+
+struct GLTraceHeader
+{
+    static constexpr uint32_t MAGIC = 0x52544c47; // "GLTR"
+    static constexpr uint32_t VERSION = 2;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t frameCount = 0;
+    int32_t viewportWidth = 0; // Of the default framebuffer, the replay window gets the same size
+    int32_t viewportHeight = 0;
+    uint32_t reserved = 0;
+    uint64_t setupSize = 0;  // Bytes of commands before the first captured frame
+    uint64_t framesSize = 0; // Bytes of commands of the captured frames
+};
+
+struct GLTraceCommand
+{
+    GLTraceOp op;
+    uint16_t reserved;
+    uint32_t size; // Bytes of arguments following this struct
+};
+
+// Records the GL calls of the current context into a trace file.
+//
+// Recording starts at construction, which must happen before the GL objects used by the captured
+// frames are created (typically right after glewInit): the calls of the frames before firstFrame are
+// kept as the setup of the trace, then frameCount frames are captured, and the file is written at
+// the EndFrame() that completes them.
+//
+// The functions loaded by GLEW are intercepted by swapping their GLEW pointers while recording, the
+// GL 1.1 ones (exported by libGL, not loaded) by defining them in the executable, which takes
+// precedence over libGL on Linux. Those definitions forward every call, recording or not, so they
+// are only compiled with GLTRACE_CAPTURE defined (make main-capture): other builds can't record.
+// Calls outside GLTRACE_OPS are not recorded, mapped buffer ranges are captured when they are
+// unmapped, and query results are asked for again by the replay. Only one recorder may exist at a time.
+class GLTraceRecorder
+{
+public:
+    // Throws std::runtime_error if this build can't record (see IsAvailable)
+    GLTraceRecorder(const std::string &path, uint32_t firstFrame, uint32_t frameCount);
+    ~GLTraceRecorder();
+
+    GLTraceRecorder(const GLTraceRecorder &) = delete;
+    GLTraceRecorder &operator=(const GLTraceRecorder &) = delete;
+
+    // Frame boundary, call right after swapping buffers
+    void EndFrame();
+
+    inline bool IsRecording() const { return m_Recording; }
+
+    static constexpr bool IsAvailable()
+    {
+#if defined(__linux__) && defined(GLTRACE_CAPTURE)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+private:
+    void Stop();
+    void Write();
+
+private:
+    std::string m_Path;
+    uint32_t m_FirstFrame;
+    uint32_t m_FrameCount;
+    uint32_t m_Frame;
+    bool m_Recording;
+
+    GLTraceHeader m_Header;
+};
@@ -0,0 +1,759 @@
+#include <GL/glew.h>
+
+#include "GLTraceReplay.hpp"
+#include "Timing.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+using namespace std::string_literals;
+
+using Clock = std::chrono::steady_clock;
+
+// Reads the arguments of one command, in the order CommandWriter wrote them (see GLTrace.cpp)
+struct GLTraceReplay::Reader
+{
+    const uint8_t *position;
+
+    template <typename T>
+    T Read()
+    {
+        T value;
+        memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    const void *ReadOffset()
+    {
+        return (const void *)(uintptr_t)Read<uint64_t>();
+    }
+
+    // nullptr if the recorded pointer was null, size is set either way
+    const void *ReadData(uint64_t &size)
+    {
+        bool present = Read<uint8_t>() != 0;
+        size = Read<uint64_t>();
+        if (!present)
+            return nullptr;
+
+        const void *data = position;
+        position += size;
+        return data;
+    }
+};
+
+GLTraceReplay::GLTraceReplay(const std::string &path)
+    : m_RecordedProgram(0), m_TimerQuery(0)
+{
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        throw std::runtime_error("Could not open GL trace file: "s + path);
+
+    bool valid = fread(&m_Header, sizeof(m_Header), 1, file) == 1 && m_Header.magic == GLTraceHeader::MAGIC;
+    if (valid && m_Header.version == GLTraceHeader::VERSION)
+    {
+        m_Commands.resize(m_Header.setupSize + m_Header.framesSize);
+        valid = fread(m_Commands.data(), 1, m_Commands.size(), file) == m_Commands.size();
+    }
+    else
+    {
+        valid = false;
+    }
+    fclose(file);
+
+    if (!valid)
+        throw std::runtime_error("Not a GL trace (or an unsupported version / truncated): "s + path);
+
+    glGenQueries(1, &m_TimerQuery);
+}
+
+GLTraceReplay::~GLTraceReplay()
+{
+    glDeleteQueries(1, &m_TimerQuery);
+}
+
+void GLTraceReplay::Setup()
+{
+    Execute(m_Commands.data(), m_Commands.data() + m_Header.setupSize, false);
+    glFinish();
+}
+
+void GLTraceReplay::RunFrames()
+{
+    Execute(m_Commands.data() + m_Header.setupSize, m_Commands.data() + m_Commands.size(), true);
+}
+
+void GLTraceReplay::ResetStats()
+{
+    m_FrameStats.clear();
+    for (GLTraceCallStats &stats : m_CallStats)
+        stats = GLTraceCallStats();
+}
+
+void GLTraceReplay::Execute(const uint8_t *begin, const uint8_t *end, bool timed)
+{
+    bool inFrame = false;
+    Clock::time_point frameStart;
+
+    for (const uint8_t *position = begin; position < end;)
+    {
+        GLTraceCommand command;
+        if ((size_t)(end - position) < sizeof(command))
+            throw std::runtime_error("Truncated GL trace command");
+        memcpy(&command, position, sizeof(command));
+        position += sizeof(command);
+
+        if ((size_t)(end - position) < command.size || command.op >= GLTraceOp::Count)
+            throw std::runtime_error("Corrupted GL trace command");
+
+        Reader reader{position};
+        position += command.size;
+
+        if (!timed)
+        {
+            ExecuteCommand(command.op, reader);
+            continue;
+        }
+
+        if (!inFrame)
+        {
+            inFrame = true;
+            frameStart = Clock::now();
+            glBeginQuery(GL_TIME_ELAPSED, m_TimerQuery);
+        }
+
+        if (command.op == GLTraceOp::FrameEnd)
+        {
+            // The CPU time stops once everything is issued, the total once the GPU is done with it
+            GLTraceFrameStats frame;
+            glEndQuery(GL_TIME_ELAPSED);
+            Clock::time_point issued = Clock::now();
+            glFinish();
+            Clock::time_point finished = Clock::now();
+
+            GLuint64 gpuTime = 0;
+            glGetQueryObjectui64v(m_TimerQuery, GL_QUERY_RESULT, &gpuTime);
+
+            frame.cpuMs = ElapsedMs(frameStart, issued);
+            frame.gpuMs = (double)gpuTime / 1e6;
+            frame.totalMs = ElapsedMs(frameStart, finished);
+            m_FrameStats.push_back(frame);
+            inFrame = false;
+            continue;
+        }
+
+        Clock::time_point callStart = Clock::now();
+        ExecuteCommand(command.op, reader);
+        GLTraceCallStats &stats = m_CallStats[(size_t)command.op];
+        stats.count++;
+        stats.cpuMs += ElapsedMs(callStart);
+    }
+
+    if (inFrame)
+        glEndQuery(GL_TIME_ELAPSED);
+}
+
+GLuint GLTraceReplay::GetName(NameType type, GLuint recorded) const
+{
+    const std::vector<GLuint> &names = m_Names[type];
+    return recorded < names.size() ? names[recorded] : 0;
+}
+
+void GLTraceReplay::SetName(NameType type, GLuint recorded, GLuint name)
+{
+    std::vector<GLuint> &names = m_Names[type];
+    if (recorded >= names.size())
+        names.resize(recorded + 1, 0);
+
+    if (names[recorded] != 0 && names[recorded] != name)
+        DeleteName(type, names[recorded]);
+    names[recorded] = name;
+}
+
+void GLTraceReplay::DeleteName(NameType type, GLuint name)
+{
+    switch (type)
+    {
+    case NAME_BUFFER: glDeleteBuffers(1, &name); break;
+    case NAME_TEXTURE: glDeleteTextures(1, &name); break;
+    case NAME_VERTEX_ARRAY: glDeleteVertexArrays(1, &name); break;
+    case NAME_FRAMEBUFFER: glDeleteFramebuffers(1, &name); break;
+    case NAME_RENDERBUFFER: glDeleteRenderbuffers(1, &name); break;
+    case NAME_QUERY: glDeleteQueries(1, &name); break;
+    default: break; // Shaders and programs are only created by the setup
+    }
+}
+
+GLint GLTraceReplay::GetUniformLocation(GLint recorded) const
+{
+    if (recorded < 0 || m_RecordedProgram >= m_UniformLocations.size())
+        return -1;
+
+    const std::vector<GLint> &locations = m_UniformLocations[m_RecordedProgram];
+    return (size_t)recorded < locations.size() ? locations[recorded] : -1;
+}
+
+void GLTraceReplay::ExecuteCommand(GLTraceOp op, Reader &reader)
+{
+    // glGen* with the recorded names, and glDelete* of the mapped ones
+    auto generate = [&](NameType type, void (*gen)(GLsizei, GLuint *)) {
+        uint64_t size;
+        const GLuint *recorded = (const GLuint *)reader.ReadData(size);
+        for (uint64_t i = 0; i < size / sizeof(GLuint); i++)
+        {
+            GLuint name;
+            gen(1, &name);
+            SetName(type, recorded[i], name);
+        }
+    };
+    auto remove = [&](NameType type) {
+        uint64_t size;
+        const GLuint *recorded = (const GLuint *)reader.ReadData(size);
+        for (uint64_t i = 0; i < size / sizeof(GLuint); i++)
+        {
+            GLuint name = GetName(type, recorded[i]);
+            if (name != 0)
+                DeleteName(type, name);
+            if (recorded[i] < m_Names[type].size())
+                m_Names[type][recorded[i]] = 0;
+        }
+    };
+
+    uint64_t size;
+    switch (op)
+    {
+    case GLTraceOp::FrameEnd:
+        break;
+
+    // --- GL 1.1 ---
+
+    case GLTraceOp::Enable:
+        glEnable(reader.Read<GLenum>());
+        break;
+    case GLTraceOp::Disable:
+        glDisable(reader.Read<GLenum>());
+        break;
+    case GLTraceOp::BlendFunc:
+    {
+        GLenum sfactor = reader.Read<GLenum>();
+        glBlendFunc(sfactor, reader.Read<GLenum>());
+        break;
+    }
+    case GLTraceOp::Viewport:
+    {
+        GLint x = reader.Read<GLint>(), y = reader.Read<GLint>();
+        GLsizei width = reader.Read<GLsizei>();
+        glViewport(x, y, width, reader.Read<GLsizei>());
+        break;
+    }
+    case GLTraceOp::Clear:
+        glClear(reader.Read<GLbitfield>());
+        break;
+    case GLTraceOp::ClearColor:
+    {
+        GLfloat r = reader.Read<GLfloat>(), g = reader.Read<GLfloat>(), b = reader.Read<GLfloat>();
+        glClearColor(r, g, b, reader.Read<GLfloat>());
+        break;
+    }
+    case GLTraceOp::DrawBuffer:
+        glDrawBuffer(reader.Read<GLenum>());
+        break;
+    case GLTraceOp::ReadBuffer:
+        glReadBuffer(reader.Read<GLenum>());
+        break;
+    case GLTraceOp::PixelStorei:
+    {
+        GLenum name = reader.Read<GLenum>();
+        glPixelStorei(name, reader.Read<GLint>());
+        break;
+    }
+    case GLTraceOp::GenTextures:
+        generate(NAME_TEXTURE, [](GLsizei n, GLuint *names) { glGenTextures(n, names); });
+        break;
+    case GLTraceOp::DeleteTextures:
+        remove(NAME_TEXTURE);
+        break;
+    case GLTraceOp::BindTexture:
+    {
+        GLenum target = reader.Read<GLenum>();
+        glBindTexture(target, GetName(NAME_TEXTURE, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::TexParameteri:
+    {
+        GLenum target = reader.Read<GLenum>(), name = reader.Read<GLenum>();
+        glTexParameteri(target, name, reader.Read<GLint>());
+        break;
+    }
+    case GLTraceOp::TexImage2D:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLint level = reader.Read<GLint>(), internalFormat = reader.Read<GLint>();
+        GLsizei width = reader.Read<GLsizei>(), height = reader.Read<GLsizei>();
+        GLint border = reader.Read<GLint>();
+        GLenum format = reader.Read<GLenum>(), type = reader.Read<GLenum>();
+        glTexImage2D(target, level, internalFormat, width, height, border, format, type, reader.ReadData(size));
+        break;
+    }
+    case GLTraceOp::TexSubImage2D:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLint level = reader.Read<GLint>(), x = reader.Read<GLint>(), y = reader.Read<GLint>();
+        GLsizei width = reader.Read<GLsizei>(), height = reader.Read<GLsizei>();
+        GLenum format = reader.Read<GLenum>(), type = reader.Read<GLenum>();
+        glTexSubImage2D(target, level, x, y, width, height, format, type, reader.ReadData(size));
+        break;
+    }
+    case GLTraceOp::DrawArrays:
+    {
+        GLenum mode = reader.Read<GLenum>();
+        GLint first = reader.Read<GLint>();
+        glDrawArrays(mode, first, reader.Read<GLsizei>());
+        break;
+    }
+    case GLTraceOp::DrawElements:
+    {
+        GLenum mode = reader.Read<GLenum>();
+        GLsizei count = reader.Read<GLsizei>();
+        GLenum type = reader.Read<GLenum>();
+        glDrawElements(mode, count, type, reader.ReadOffset());
+        break;
+    }
+    case GLTraceOp::ReadPixels:
+    {
+        GLint x = reader.Read<GLint>(), y = reader.Read<GLint>();
+        GLsizei width = reader.Read<GLsizei>(), height = reader.Read<GLsizei>();
+        GLenum format = reader.Read<GLenum>(), type = reader.Read<GLenum>();
+        uint64_t clientSize = reader.Read<uint64_t>();
+        void *pixels = (void *)reader.ReadOffset();
+        if (clientSize != 0)
+        {
+            m_ReadPixels.resize(clientSize);
+            pixels = m_ReadPixels.data();
+        }
+        glReadPixels(x, y, width, height, format, type, pixels);
+        break;
+    }
+
+    // --- Loaded by GLEW ---
+
+    case GLTraceOp::ActiveTexture:
+        glActiveTexture(reader.Read<GLenum>());
+        break;
+    case GLTraceOp::GenBuffers:
+        generate(NAME_BUFFER, [](GLsizei n, GLuint *names) { glGenBuffers(n, names); });
+        break;
+    case GLTraceOp::DeleteBuffers:
+        remove(NAME_BUFFER);
+        break;
+    case GLTraceOp::BindBuffer:
+    {
+        GLenum target = reader.Read<GLenum>();
+        glBindBuffer(target, GetName(NAME_BUFFER, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::BufferData:
+    {
+        GLenum target = reader.Read<GLenum>(), usage = reader.Read<GLenum>();
+        const void *data = reader.ReadData(size);
+        glBufferData(target, (GLsizeiptr)size, data, usage);
+        break;
+    }
+    case GLTraceOp::BufferSubData:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLintptr offset = (GLintptr)reader.Read<int64_t>();
+        const void *data = reader.ReadData(size);
+        glBufferSubData(target, offset, (GLsizeiptr)size, data);
+        break;
+    }
+    case GLTraceOp::MapBufferRange:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLintptr offset = (GLintptr)reader.Read<int64_t>();
+        GLsizeiptr length = (GLsizeiptr)reader.Read<int64_t>();
+        m_MappedPointers[target] = glMapBufferRange(target, offset, length, reader.Read<GLbitfield>());
+        break;
+    }
+    case GLTraceOp::UnmapBuffer:
+    {
+        // Writes what the application wrote into the range before unmapping it
+        GLenum target = reader.Read<GLenum>();
+        const void *data = reader.ReadData(size);
+        void *pointer = m_MappedPointers[target];
+        if (data && pointer)
+            memcpy(pointer, data, size);
+        m_MappedPointers[target] = nullptr;
+        glUnmapBuffer(target);
+        break;
+    }
+    case GLTraceOp::BindBufferRange:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLuint index = reader.Read<GLuint>();
+        GLuint buffer = GetName(NAME_BUFFER, reader.Read<GLuint>());
+        GLintptr offset = (GLintptr)reader.Read<int64_t>();
+        glBindBufferRange(target, index, buffer, offset, (GLsizeiptr)reader.Read<int64_t>());
+        break;
+    }
+    case GLTraceOp::TexBuffer:
+    {
+        GLenum target = reader.Read<GLenum>(), internalFormat = reader.Read<GLenum>();
+        glTexBuffer(target, internalFormat, GetName(NAME_BUFFER, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::GenVertexArrays:
+        generate(NAME_VERTEX_ARRAY, [](GLsizei n, GLuint *names) { glGenVertexArrays(n, names); });
+        break;
+    case GLTraceOp::DeleteVertexArrays:
+        remove(NAME_VERTEX_ARRAY);
+        break;
+    case GLTraceOp::BindVertexArray:
+        glBindVertexArray(GetName(NAME_VERTEX_ARRAY, reader.Read<GLuint>()));
+        break;
+    case GLTraceOp::EnableVertexAttribArray:
+        glEnableVertexAttribArray(reader.Read<GLuint>());
+        break;
+    case GLTraceOp::VertexAttribPointer:
+    {
+        GLuint index = reader.Read<GLuint>();
+        GLint components = reader.Read<GLint>();
+        GLenum type = reader.Read<GLenum>();
+        GLboolean normalized = reader.Read<GLboolean>();
+        GLsizei stride = reader.Read<GLsizei>();
+        glVertexAttribPointer(index, components, type, normalized, stride, reader.ReadOffset());
+        break;
+    }
+    case GLTraceOp::VertexAttribIPointer:
+    {
+        GLuint index = reader.Read<GLuint>();
+        GLint components = reader.Read<GLint>();
+        GLenum type = reader.Read<GLenum>();
+        GLsizei stride = reader.Read<GLsizei>();
+        glVertexAttribIPointer(index, components, type, stride, reader.ReadOffset());
+        break;
+    }
+    case GLTraceOp::VertexAttribDivisor:
+    {
+        GLuint index = reader.Read<GLuint>();
+        glVertexAttribDivisor(index, reader.Read<GLuint>());
+        break;
+    }
+    case GLTraceOp::CreateShader:
+    {
+        GLenum type = reader.Read<GLenum>();
+        SetName(NAME_SHADER_OBJECT, reader.Read<GLuint>(), glCreateShader(type));
+        break;
+    }
+    case GLTraceOp::ShaderSource:
+    {
+        GLuint shader = GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>());
+        const GLchar *source = (const GLchar *)reader.ReadData(size);
+        GLint length = (GLint)size;
+        glShaderSource(shader, 1, &source, &length);
+        break;
+    }
+    case GLTraceOp::CompileShader:
+        glCompileShader(GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>()));
+        break;
+    case GLTraceOp::DeleteShader:
+        glDeleteShader(GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>()));
+        break;
+    case GLTraceOp::CreateProgram:
+        SetName(NAME_SHADER_OBJECT, reader.Read<GLuint>(), glCreateProgram());
+        break;
+    case GLTraceOp::AttachShader:
+    {
+        GLuint program = GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>());
+        glAttachShader(program, GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::LinkProgram:
+        glLinkProgram(GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>()));
+        break;
+    case GLTraceOp::ValidateProgram:
+        glValidateProgram(GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>()));
+        break;
+    case GLTraceOp::UseProgram:
+        m_RecordedProgram = reader.Read<GLuint>();
+        glUseProgram(GetName(NAME_SHADER_OBJECT, m_RecordedProgram));
+        break;
+    case GLTraceOp::DeleteProgram:
+        glDeleteProgram(GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>()));
+        break;
+    case GLTraceOp::GetUniformLocation:
+    {
+        GLuint program = reader.Read<GLuint>();
+        GLint recorded = reader.Read<GLint>();
+        const char *name = (const char *)reader.ReadData(size);
+        if (recorded < 0)
+            break;
+
+        if (program >= m_UniformLocations.size())
+            m_UniformLocations.resize(program + 1);
+        std::vector<GLint> &locations = m_UniformLocations[program];
+        if ((size_t)recorded >= locations.size())
+            locations.resize(recorded + 1, -1);
+        locations[recorded] = glGetUniformLocation(GetName(NAME_SHADER_OBJECT, program), std::string(name, size).c_str());
+        break;
+    }
+    case GLTraceOp::Uniform1i:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        glUniform1i(location, reader.Read<GLint>());
+        break;
+    }
+    case GLTraceOp::Uniform1f:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        glUniform1f(location, reader.Read<GLfloat>());
+        break;
+    }
+    case GLTraceOp::Uniform2f:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        GLfloat x = reader.Read<GLfloat>();
+        glUniform2f(location, x, reader.Read<GLfloat>());
+        break;
+    }
+    case GLTraceOp::Uniform3f:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        GLfloat x = reader.Read<GLfloat>(), y = reader.Read<GLfloat>();
+        glUniform3f(location, x, y, reader.Read<GLfloat>());
+        break;
+    }
+    case GLTraceOp::Uniform4f:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        GLfloat x = reader.Read<GLfloat>(), y = reader.Read<GLfloat>(), z = reader.Read<GLfloat>();
+        glUniform4f(location, x, y, z, reader.Read<GLfloat>());
+        break;
+    }
+    case GLTraceOp::UniformMatrix3fv:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        GLboolean transpose = reader.Read<GLboolean>();
+        const GLfloat *values = (const GLfloat *)reader.ReadData(size);
+        glUniformMatrix3fv(location, (GLsizei)(size / (9 * sizeof(GLfloat))), transpose, values);
+        break;
+    }
+    case GLTraceOp::UniformMatrix4fv:
+    {
+        GLint location = GetUniformLocation(reader.Read<GLint>());
+        GLboolean transpose = reader.Read<GLboolean>();
+        const GLfloat *values = (const GLfloat *)reader.ReadData(size);
+        glUniformMatrix4fv(location, (GLsizei)(size / (16 * sizeof(GLfloat))), transpose, values);
+        break;
+    }
+    case GLTraceOp::GenFramebuffers:
+        generate(NAME_FRAMEBUFFER, [](GLsizei n, GLuint *names) { glGenFramebuffers(n, names); });
+        break;
+    case GLTraceOp::DeleteFramebuffers:
+        remove(NAME_FRAMEBUFFER);
+        break;
+    case GLTraceOp::BindFramebuffer:
+    {
+        GLenum target = reader.Read<GLenum>();
+        glBindFramebuffer(target, GetName(NAME_FRAMEBUFFER, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::FramebufferTexture2D:
+    {
+        GLenum target = reader.Read<GLenum>(), attachment = reader.Read<GLenum>(), textureTarget = reader.Read<GLenum>();
+        GLuint texture = GetName(NAME_TEXTURE, reader.Read<GLuint>());
+        glFramebufferTexture2D(target, attachment, textureTarget, texture, reader.Read<GLint>());
+        break;
+    }
+    case GLTraceOp::FramebufferRenderbuffer:
+    {
+        GLenum target = reader.Read<GLenum>(), attachment = reader.Read<GLenum>(), renderbufferTarget = reader.Read<GLenum>();
+        glFramebufferRenderbuffer(target, attachment, renderbufferTarget, GetName(NAME_RENDERBUFFER, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::GenRenderbuffers:
+        generate(NAME_RENDERBUFFER, [](GLsizei n, GLuint *names) { glGenRenderbuffers(n, names); });
+        break;
+    case GLTraceOp::DeleteRenderbuffers:
+        remove(NAME_RENDERBUFFER);
+        break;
+    case GLTraceOp::BindRenderbuffer:
+    {
+        GLenum target = reader.Read<GLenum>();
+        glBindRenderbuffer(target, GetName(NAME_RENDERBUFFER, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::RenderbufferStorage:
+    {
+        GLenum target = reader.Read<GLenum>(), internalFormat = reader.Read<GLenum>();
+        GLsizei width = reader.Read<GLsizei>();
+        glRenderbufferStorage(target, internalFormat, width, reader.Read<GLsizei>());
+        break;
+    }
+    case GLTraceOp::RenderbufferStorageMultisample:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLsizei samples = reader.Read<GLsizei>();
+        GLenum internalFormat = reader.Read<GLenum>();
+        GLsizei width = reader.Read<GLsizei>();
+        glRenderbufferStorageMultisample(target, samples, internalFormat, width, reader.Read<GLsizei>());
+        break;
+    }
+    case GLTraceOp::DrawBuffers:
+    {
+        const GLenum *buffers = (const GLenum *)reader.ReadData(size);
+        glDrawBuffers((GLsizei)(size / sizeof(GLenum)), buffers);
+        break;
+    }
+    case GLTraceOp::BlitFramebuffer:
+    {
+        GLint coordinates[8];
+        for (GLint &coordinate : coordinates)
+            coordinate = reader.Read<GLint>();
+        GLbitfield mask = reader.Read<GLbitfield>();
+        glBlitFramebuffer(coordinates[0], coordinates[1], coordinates[2], coordinates[3], coordinates[4], coordinates[5],
+                          coordinates[6], coordinates[7], mask, reader.Read<GLenum>());
+        break;
+    }
+    case GLTraceOp::InvalidateFramebuffer:
+    {
+        GLenum target = reader.Read<GLenum>();
+        const GLenum *attachments = (const GLenum *)reader.ReadData(size);
+        glInvalidateFramebuffer(target, (GLsizei)(size / sizeof(GLenum)), attachments);
+        break;
+    }
+    case GLTraceOp::ClearBufferfv:
+    {
+        GLenum buffer = reader.Read<GLenum>();
+        GLint drawBuffer = reader.Read<GLint>();
+        glClearBufferfv(buffer, drawBuffer, (const GLfloat *)reader.ReadData(size));
+        break;
+    }
+    case GLTraceOp::ClearBufferfi:
+    {
+        GLenum buffer = reader.Read<GLenum>();
+        GLint drawBuffer = reader.Read<GLint>();
+        GLfloat depth = reader.Read<GLfloat>();
+        glClearBufferfi(buffer, drawBuffer, depth, reader.Read<GLint>());
+        break;
+    }
+    case GLTraceOp::DrawArraysInstanced:
+    {
+        GLenum mode = reader.Read<GLenum>();
+        GLint first = reader.Read<GLint>();
+        GLsizei count = reader.Read<GLsizei>();
+        glDrawArraysInstanced(mode, first, count, reader.Read<GLsizei>());
+        break;
+    }
+    case GLTraceOp::FenceSync:
+    {
+        GLenum condition = reader.Read<GLenum>();
+        GLbitfield flags = reader.Read<GLbitfield>();
+        GLsync &sync = m_Syncs[reader.Read<uint64_t>()];
+        if (sync)
+            glDeleteSync(sync);
+        sync = glFenceSync(condition, flags);
+        break;
+    }
+    case GLTraceOp::ClientWaitSync:
+    {
+        // A sync created before the captured frames and deleted by them is gone from the second run on,
+        // but each replayed frame ends with glFinish anyway
+        auto it = m_Syncs.find(reader.Read<uint64_t>());
+        GLbitfield flags = reader.Read<GLbitfield>();
+        GLuint64 timeout = reader.Read<uint64_t>();
+        if (it != m_Syncs.end())
+            glClientWaitSync(it->second, flags, timeout);
+        break;
+    }
+    case GLTraceOp::DeleteSync:
+    {
+        auto it = m_Syncs.find(reader.Read<uint64_t>());
+        if (it != m_Syncs.end())
+        {
+            glDeleteSync(it->second);
+            m_Syncs.erase(it);
+        }
+        break;
+    }
+
+    case GLTraceOp::TexImage3D:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLint level = reader.Read<GLint>(), internalFormat = reader.Read<GLint>();
+        GLsizei width = reader.Read<GLsizei>(), height = reader.Read<GLsizei>(), depth = reader.Read<GLsizei>();
+        GLint border = reader.Read<GLint>();
+        GLenum format = reader.Read<GLenum>(), type = reader.Read<GLenum>();
+        glTexImage3D(target, level, internalFormat, width, height, depth, border, format, type, reader.ReadData(size));
+        break;
+    }
+    case GLTraceOp::TexSubImage3D:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLint level = reader.Read<GLint>(), x = reader.Read<GLint>(), y = reader.Read<GLint>(), z = reader.Read<GLint>();
+        GLsizei width = reader.Read<GLsizei>(), height = reader.Read<GLsizei>(), depth = reader.Read<GLsizei>();
+        GLenum format = reader.Read<GLenum>(), type = reader.Read<GLenum>();
+        glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, reader.ReadData(size));
+        break;
+    }
+    case GLTraceOp::BindBufferBase:
+    {
+        GLenum target = reader.Read<GLenum>();
+        GLuint index = reader.Read<GLuint>();
+        glBindBufferBase(target, index, GetName(NAME_BUFFER, reader.Read<GLuint>()));
+        break;
+    }
+    case GLTraceOp::TransformFeedbackVaryings:
+    {
+        GLuint program = GetName(NAME_SHADER_OBJECT, reader.Read<GLuint>());
+        GLenum bufferMode = reader.Read<GLenum>();
+        const GLchar *names = (const GLchar *)reader.ReadData(size);
+        std::vector<const GLchar *> varyings;
+        for (uint64_t i = 0; i < size; i += strlen(names + i) + 1)
+            varyings.push_back(names + i);
+        glTransformFeedbackVaryings(program, (GLsizei)varyings.size(), varyings.data(), bufferMode);
+        break;
+    }
+    case GLTraceOp::BeginTransformFeedback:
+        glBeginTransformFeedback(reader.Read<GLenum>());
+        break;
+    case GLTraceOp::EndTransformFeedback:
+        glEndTransformFeedback();
+        break;
+    case GLTraceOp::GenQueries:
+        generate(NAME_QUERY, [](GLsizei n, GLuint *names) { glGenQueries(n, names); });
+        break;
+    case GLTraceOp::DeleteQueries:
+        remove(NAME_QUERY);
+        break;
+    case GLTraceOp::QueryCounter:
+    {
+        GLuint query = GetName(NAME_QUERY, reader.Read<GLuint>());
+        glQueryCounter(query, reader.Read<GLenum>());
+        break;
+    }
+    // Asked again so the replay waits for the results where the app did, the values are dropped
+    case GLTraceOp::GetQueryObjectiv:
+    {
+        GLuint query = GetName(NAME_QUERY, reader.Read<GLuint>());
+        GLint result;
+        glGetQueryObjectiv(query, reader.Read<GLenum>(), &result);
+        break;
+    }
+    case GLTraceOp::GetQueryObjectui64v:
+    {
+        GLuint query = GetName(NAME_QUERY, reader.Read<GLuint>());
+        GLuint64 result;
+        glGetQueryObjectui64v(query, reader.Read<GLenum>(), &result);
+        break;
+    }
+
+    default:
+        throw std::runtime_error("Unsupported command in GL trace: "s + GetGLTraceOpName(op));
+    }
+}
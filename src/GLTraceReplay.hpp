@@ -0,0 +1,96 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GLTrace.hpp"
+
+struct GLTraceFrameStats
+{
+    double cpuMs = 0.0;   // Issuing the calls of the frame
+    double gpuMs = 0.0;   // GL_TIME_ELAPSED of the frame
+    double totalMs = 0.0; // Issuing the calls and waiting for the GPU to finish them (glFinish)
+};
+
+// Totals over every replayed frame
+struct GLTraceCallStats
+{
+    uint64_t count = 0;
+    double cpuMs = 0.0;
+};
+
+// Replays a trace recorded by GLTraceRecorder on the current context (see bench/GLReplay.cpp).
+//
+// The setup is executed once, then RunFrames() executes the captured frames again every time it is
+// called, so the same workload can be timed as many times as needed. Object names, sync objects and
+// uniform locations are translated to the ones of this context. Objects the captured frames create
+// are recreated at every run, the previous copy is deleted when its recorded name comes back.
+class GLTraceReplay
+{
+public:
+    // Loads the whole file, throws std::runtime_error if it can't be read or is not a trace
+    explicit GLTraceReplay(const std::string &path);
+    ~GLTraceReplay();
+
+    GLTraceReplay(const GLTraceReplay &) = delete;
+    GLTraceReplay &operator=(const GLTraceReplay &) = delete;
+
+    inline const GLTraceHeader &GetHeader() const { return m_Header; }
+
+    void Setup();
+    void RunFrames();
+
+    // One entry per frame run since the last ResetStats()
+    inline const std::vector<GLTraceFrameStats> &GetFrameStats() const { return m_FrameStats; }
+    inline const GLTraceCallStats &GetCallStats(GLTraceOp op) const { return m_CallStats[(size_t)op]; }
+    void ResetStats();
+
+private:
+    // Kinds of GL names, each one is mapped separately
+    enum NameType
+    {
+        NAME_BUFFER,
+        NAME_TEXTURE,
+        NAME_VERTEX_ARRAY,
+        NAME_FRAMEBUFFER,
+        NAME_RENDERBUFFER,
+        NAME_QUERY,
+        NAME_SHADER_OBJECT, // Shaders and programs share their names
+        NAME_TYPE_COUNT,
+    };
+
+    struct Reader;
+
+    // Executes the commands of [begin, end), timing the frames and the calls if timed
+    void Execute(const uint8_t *begin, const uint8_t *end, bool timed);
+    void ExecuteCommand(GLTraceOp op, Reader &reader);
+
+    GLuint GetName(NameType type, GLuint recorded) const;
+    // Replaces the name a recorded one maps to, deleting the previous object (see the class comment)
+    void SetName(NameType type, GLuint recorded, GLuint name);
+    void DeleteName(NameType type, GLuint name);
+
+    // Location in the program bound by the last UseProgram command
+    GLint GetUniformLocation(GLint recorded) const;
+
+private:
+    GLTraceHeader m_Header;
+    std::vector<uint8_t> m_Commands;
+
+    std::vector<GLuint> m_Names[NAME_TYPE_COUNT];
+    std::unordered_map<uint64_t, GLsync> m_Syncs;
+    std::unordered_map<GLenum, void *> m_MappedPointers;
+    std::vector<uint8_t> m_ReadPixels; // Client memory of glReadPixels, the pixels themselves aren't used
+
+    // Locations of this context, by recorded program then recorded location
+    std::vector<std::vector<GLint>> m_UniformLocations;
+    GLuint m_RecordedProgram;
+
+    GLuint m_TimerQuery;
+    std::vector<GLTraceFrameStats> m_FrameStats;
+    GLTraceCallStats m_CallStats[(size_t)GLTraceOp::Count];
+};
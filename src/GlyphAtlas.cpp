@@ -0,0 +1,256 @@
+#include "GlyphAtlas.hpp"
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static constexpr float DISTANCE_INFINITY = 1e20f;
+
+GlyphAtlas::GlyphAtlas(const Font &font)
+    : m_Font(font)
+{
+    for (uint32_t &glyph : m_AsciiGlyphs)
+        glyph = NO_GLYPH;
+}
+
+uint32_t GlyphAtlas::AddGlyph(uint32_t codepoint)
+{
+    if (codepoint >= 128)
+    {
+        auto it = m_OtherGlyphs.find(codepoint);
+        if (it != m_OtherGlyphs.end())
+            return it->second;
+    }
+
+    uint32_t index;
+    if (!m_Font.rasterize(codepoint, m_Bitmap))
+    {
+        // Shares the glyph of '?', or an empty one if the font doesn't even have that
+        if (codepoint != '?')
+            index = GetGlyphIndex('?');
+        else
+        {
+            index = (uint32_t)m_Glyphs.size();
+            m_Glyphs.push_back({0, 0, 0, 0, 0, 0.0f, 0.0f, 0.0f, 0.0f, 0.5f});
+        }
+    }
+    else
+    {
+        float scale = 1.0f / m_Font.lineHeight;
+        Glyph glyph = {0, 0, 0, 0, 0, 0.0f, 0.0f, 0.0f, 0.0f, m_Bitmap.advance * scale};
+
+        if (m_Bitmap.width > 0 && m_Bitmap.height > 0)
+        {
+            int width = m_Bitmap.width + 2 * SPREAD, height = m_Bitmap.height + 2 * SPREAD;
+            if (width > PAGE_SIZE || height > PAGE_SIZE)
+                throw std::runtime_error("Glyph " + std::to_string(codepoint) + " doesn't fit in an atlas page");
+
+            uint32_t page;
+            int x, y;
+            Allocate(width, height, page, x, y);
+
+            Page &target = m_Pages[page];
+            GenerateDistanceField(m_Bitmap.coverage.data(), m_Bitmap.width, m_Bitmap.height, SPREAD,
+                                  &target.pixels[(size_t)y * PAGE_SIZE + x], PAGE_SIZE);
+
+            target.dirtyMinX = x < target.dirtyMinX ? x : target.dirtyMinX;
+            target.dirtyMinY = y < target.dirtyMinY ? y : target.dirtyMinY;
+            target.dirtyMaxX = x + width > target.dirtyMaxX ? x + width : target.dirtyMaxX;
+            target.dirtyMaxY = y + height > target.dirtyMaxY ? y + height : target.dirtyMaxY;
+
+            // The quad covers the padding too, the field fades out over it
+            glyph.page = (uint16_t)page;
+            glyph.u0 = (uint16_t)x;
+            glyph.v0 = (uint16_t)y;
+            glyph.u1 = (uint16_t)(x + width);
+            glyph.v1 = (uint16_t)(y + height);
+            glyph.x0 = (float)(m_Bitmap.left - SPREAD) * scale;
+            glyph.y0 = (float)(-m_Bitmap.top - SPREAD) * scale;
+            glyph.x1 = glyph.x0 + (float)width * scale;
+            glyph.y1 = glyph.y0 + (float)height * scale;
+        }
+
+        index = (uint32_t)m_Glyphs.size();
+        m_Glyphs.push_back(glyph);
+    }
+
+    if (codepoint < 128)
+        m_AsciiGlyphs[codepoint] = index;
+    else
+        m_OtherGlyphs[codepoint] = index;
+    return index;
+}
+
+void GlyphAtlas::Allocate(int width, int height, uint32_t &page, int &x, int &y)
+{
+    // Shelf packing: glyphs are placed left to right in rows as tall as their tallest glyph,
+    // which wastes little space since the glyphs of a font have similar heights
+    if (m_Pages.empty())
+        AddPage();
+
+    Page *current = &m_Pages.back();
+    if (current->shelfX + width > PAGE_SIZE)
+    {
+        current->shelfY += current->shelfHeight;
+        current->shelfX = 0;
+        current->shelfHeight = 0;
+    }
+    if (current->shelfY + height > PAGE_SIZE)
+    {
+        AddPage();
+        current = &m_Pages.back();
+    }
+
+    page = (uint32_t)m_Pages.size() - 1;
+    x = current->shelfX;
+    y = current->shelfY;
+    current->shelfX += width;
+    current->shelfHeight = height > current->shelfHeight ? height : current->shelfHeight;
+}
+
+void GlyphAtlas::AddPage()
+{
+    if (m_Pages.size() >= UINT16_MAX)
+        throw std::runtime_error("Glyph atlas is full");
+
+    m_Pages.emplace_back();
+    Page &page = m_Pages.back();
+    page.pixels.resize((size_t)PAGE_SIZE * PAGE_SIZE, 0);
+    page.dirtyMinX = page.dirtyMinY = PAGE_SIZE;
+    page.dirtyMaxX = page.dirtyMaxY = 0;
+}
+
+bool GlyphAtlas::GetDirtyRect(uint32_t page, int &x, int &y, int &width, int &height) const
+{
+    const Page &source = m_Pages[page];
+    if (source.dirtyMaxX <= source.dirtyMinX)
+        return false;
+
+    x = source.dirtyMinX;
+    y = source.dirtyMinY;
+    width = source.dirtyMaxX - source.dirtyMinX;
+    height = source.dirtyMaxY - source.dirtyMinY;
+    return true;
+}
+
+void GlyphAtlas::ClearDirty(uint32_t page)
+{
+    Page &target = m_Pages[page];
+    target.dirtyMinX = target.dirtyMinY = PAGE_SIZE;
+    target.dirtyMaxX = target.dirtyMaxY = 0;
+}
+
+// Squared distance from each sample to the nearest zero of f, along one row or column.
+// Lower envelope of the parabolas rooted at each sample (v: their positions, z: the ranges where they are lowest).
+static void DistanceTransform1D(const float *f, int n, float *d, int *v, float *z)
+{
+    int k = 0;
+    v[0] = 0;
+    z[0] = -DISTANCE_INFINITY;
+    z[1] = DISTANCE_INFINITY;
+
+    for (int q = 1; q < n; q++)
+    {
+        float s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+        while (s <= z[k])
+        {
+            k--;
+            s = ((f[q] + (float)(q * q)) - (f[v[k]] + (float)(v[k] * v[k]))) / (float)(2 * q - 2 * v[k]);
+        }
+        k++;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = DISTANCE_INFINITY;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; q++)
+    {
+        while (z[k + 1] < (float)q)
+            k++;
+        float offset = (float)(q - v[k]);
+        d[q] = offset * offset + f[v[k]];
+    }
+}
+
+// Squared distance to the nearest zero of grid, in place
+static void DistanceTransform2D(std::vector<float> &grid, int width, int height)
+{
+    int size = width > height ? width : height;
+    std::vector<float> f(size), d(size), z(size + 1);
+    std::vector<int> v(size);
+
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+            f[y] = grid[(size_t)y * width + x];
+        DistanceTransform1D(f.data(), height, d.data(), v.data(), z.data());
+        for (int y = 0; y < height; y++)
+            grid[(size_t)y * width + x] = d[y];
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        float *row = &grid[(size_t)y * width];
+        memcpy(f.data(), row, width * sizeof(float));
+        DistanceTransform1D(f.data(), width, row, v.data(), z.data());
+    }
+}
+
+void GlyphAtlas::GenerateDistanceField(const uint8_t *coverage, int width, int height, int spread, uint8_t *out, int outStride)
+{
+    int fieldWidth = width + 2 * spread, fieldHeight = height + 2 * spread;
+    size_t fieldSize = (size_t)fieldWidth * fieldHeight;
+
+    auto getCoverage = [&](int x, int y) {
+        x -= spread;
+        y -= spread;
+        return x >= 0 && y >= 0 && x < width && y < height ? coverage[(size_t)y * width + x] : 0;
+    };
+
+    // Squared distance of every pixel to the inside, and to the outside. Edge pixels start at their
+    // distance to the outline, on the side their coverage puts them (as in Mapbox's TinySDF).
+    std::vector<float> toInside(fieldSize), toOutside(fieldSize);
+    for (int y = 0; y < fieldHeight; y++)
+    {
+        for (int x = 0; x < fieldWidth; x++)
+        {
+            size_t i = (size_t)y * fieldWidth + x;
+            uint8_t value = getCoverage(x, y);
+            if (value == 255)
+            {
+                toInside[i] = 0.0f;
+                toOutside[i] = DISTANCE_INFINITY;
+            }
+            else if (value == 0)
+            {
+                toInside[i] = DISTANCE_INFINITY;
+                toOutside[i] = 0.0f;
+            }
+            else
+            {
+                float edge = 0.5f - (float)value / 255.0f; // Positive when the pixel center is outside
+                toInside[i] = edge > 0.0f ? edge * edge : 0.0f;
+                toOutside[i] = edge < 0.0f ? edge * edge : 0.0f;
+            }
+        }
+    }
+    DistanceTransform2D(toInside, fieldWidth, fieldHeight);
+    DistanceTransform2D(toOutside, fieldWidth, fieldHeight);
+
+    // 128 on the outline, 0 and 255 spread pixels away from it
+    float scale = 127.0f / (float)spread;
+    for (int y = 0; y < fieldHeight; y++)
+    {
+        for (int x = 0; x < fieldWidth; x++)
+        {
+            size_t i = (size_t)y * fieldWidth + x;
+            float distance = sqrtf(toInside[i]) - sqrtf(toOutside[i]);
+            float value = 128.0f - distance * scale;
+            out[(size_t)y * outStride + x] = (uint8_t)(value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value + 0.5f));
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "Font.hpp"
+
+// Where a glyph is in the atlas and how to place its quad
+struct Glyph
+{
+    uint16_t page;
+    uint16_t u0, v0, u1, v1; // Texels in the page, v0 is the top row
+    float x0, y0, x1, y1;    // Quad from the pen position on the baseline, in line heights, y down
+    float advance;           // In line heights
+
+    inline bool IsEmpty() const { return u0 == u1; }
+};
+
+// Single-channel signed distance fields of glyphs, packed into PAGE_SIZE x PAGE_SIZE pages.
+//
+// Glyphs are rasterized the first time they are asked for, so only the characters actually
+// displayed take space. Each one is stored as a distance field (128 on the outline, higher inside),
+// which the text shader turns back into a sharp edge at any scale with a single texture read.
+// The atlas only works on CPU memory: the renderer uploads the rectangle of each page that changed
+// (see GetDirtyRect), so glyphs can be added while building a frame.
+class GlyphAtlas
+{
+public:
+    static constexpr int PAGE_SIZE = 512;
+    static constexpr int SPREAD = 4; // Texels on each side of the outline covered by the distance field
+
+    GlyphAtlas(const Font &font = Font::GetBuiltin());
+
+    GlyphAtlas(const GlyphAtlas &) = delete;
+    GlyphAtlas &operator=(const GlyphAtlas &) = delete;
+
+    // Rasterizes the glyph on first use. Codepoints missing from the font get the glyph of '?'.
+    inline uint32_t GetGlyphIndex(uint32_t codepoint)
+    {
+        if (codepoint < 128 && m_AsciiGlyphs[codepoint] != NO_GLYPH)
+            return m_AsciiGlyphs[codepoint];
+        return AddGlyph(codepoint);
+    }
+
+    inline const Glyph &GetGlyph(uint32_t index) const { return m_Glyphs[index]; }
+    inline uint32_t GetGlyphCount() const { return (uint32_t)m_Glyphs.size(); }
+
+    // From the top of a line to its baseline, in line heights
+    inline float GetAscent() const { return m_Font.ascent / m_Font.lineHeight; }
+
+    inline uint32_t GetPageCount() const { return (uint32_t)m_Pages.size(); }
+    inline const uint8_t *GetPagePixels(uint32_t page) const { return m_Pages[page].pixels.data(); }
+
+    // Part of the page changed since the last ClearDirty(), false if nothing did
+    bool GetDirtyRect(uint32_t page, int &x, int &y, int &width, int &height) const;
+    void ClearDirty(uint32_t page);
+
+    // Signed distance field of a coverage bitmap, using exact euclidean distance transforms of the inside
+    // and the outside (Felzenszwalb and Huttenlocher). Partly covered pixels put the outline inside the
+    // pixel, 0.5 - coverage pixels from its center, so anti-aliased edges keep their sub-pixel position.
+    // Writes (width + 2 * spread) x (height + 2 * spread) bytes to out, outStride bytes apart.
+    static void GenerateDistanceField(const uint8_t *coverage, int width, int height, int spread, uint8_t *out, int outStride);
+
+private:
+    static constexpr uint32_t NO_GLYPH = UINT32_MAX;
+
+    struct Page
+    {
+        std::vector<uint8_t> pixels;
+        int shelfX = 0, shelfY = 0, shelfHeight = 0; // Row of glyphs being filled
+        int dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+    };
+
+    uint32_t AddGlyph(uint32_t codepoint);
+    void Allocate(int width, int height, uint32_t &page, int &x, int &y);
+    void AddPage();
+
+private:
+    Font m_Font;
+    std::vector<Glyph> m_Glyphs;
+    uint32_t m_AsciiGlyphs[128];
+    std::unordered_map<uint32_t, uint32_t> m_OtherGlyphs;
+    std::vector<Page> m_Pages;
+    GlyphBitmap m_Bitmap; // Reused by every glyph
+};
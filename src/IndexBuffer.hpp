@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include <GL/glew.h>
 
+#include "ResourceRegistry.hpp"
+
 // Index buffer is a set of indices that are used
 // to avoid the need of duplicating the vertices.
 // In this example, we draw a square, so we need 4 vertices.
@@ -15,19 +17,16 @@ public:
     IndexBuffer(uint32_t *data, uint32_t count, uint32_t usage)
         : m_Count(count)
     {
-        glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+        uint32_t rendererID;
+        glGenBuffers(1, &rendererID);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererID);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(uint32_t), data, usage);
-    }
-
-    ~IndexBuffer(void)
-    {
-        glDeleteBuffers(1, &m_RendererID);
+        m_Resource = UniqueResource(ResourceType::Buffer, rendererID);
     }
 
     void Bind(void) const
     {
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_Resource.GetRendererID());
     }
 
     void Unbind(void) const
@@ -36,8 +35,9 @@ public:
     }
 
     inline uint32_t GetCount(void) const { return m_Count; }
+    inline ResourceHandle GetHandle(void) const { return m_Resource.GetHandle(); }
 
 private:
-    uint32_t m_RendererID;
+    UniqueResource m_Resource;
     uint32_t m_Count;
 };
\ No newline at end of file
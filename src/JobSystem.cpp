@@ -0,0 +1,248 @@
+#include "JobSystem.hpp"
+
+#include <stdint.h>
+#include <thread>
+
+// Failed attempts to find a job before an idle worker goes to sleep
+static constexpr uint32_t IDLE_SPINS = 64;
+
+// The JobSystem the calling thread belongs to, and its index in it
+static thread_local JobSystem *t_System = nullptr;
+static thread_local int32_t t_WorkerIndex = -1;
+
+JobSystem::JobSystem(uint32_t threadCount)
+    : m_NextExternalJob(0), m_Running(true), m_PendingJobs(0), m_SleepingWorkers(0)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    m_ExternalJobs.reset(new Job[JOBS_PER_WORKER]);
+
+    m_Workers.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        m_Workers.emplace_back(new Worker());
+        m_Workers.back()->jobs.reset(new Job[JOBS_PER_WORKER]);
+    }
+
+    // The creating thread is worker 0, it runs jobs when it waits
+    t_System = this;
+    t_WorkerIndex = 0;
+
+    for (uint32_t i = 1; i < threadCount; i++)
+        m_Workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Running.store(false);
+    }
+    m_WakeUp.notify_all();
+
+    for (size_t i = 1; i < m_Workers.size(); i++)
+        m_Workers[i]->thread.join();
+
+    if (t_System == this)
+    {
+        t_System = nullptr;
+        t_WorkerIndex = -1;
+    }
+}
+
+int32_t JobSystem::GetCurrentWorkerIndex() const
+{
+    return t_System == this ? t_WorkerIndex : -1;
+}
+
+void JobSystem::Wait(JobCounter &counter)
+{
+    int32_t index = GetCurrentWorkerIndex();
+    while (!counter.IsDone())
+    {
+        if (Job *job = FindJob(index))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+
+    // The count reached zero while the last job held the lock, once we get it the job is done with the counter
+    std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+bool JobSystem::TryRunJob()
+{
+    Job *job = FindJob(GetCurrentWorkerIndex());
+    if (!job)
+        return false;
+
+    Execute(job);
+    return true;
+}
+
+void JobSystem::WorkerLoop(uint32_t index)
+{
+    t_System = this;
+    t_WorkerIndex = (int32_t)index;
+
+    uint32_t idle = 0;
+    while (m_Running.load(std::memory_order_relaxed))
+    {
+        if (Job *job = FindJob((int32_t)index))
+        {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < IDLE_SPINS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Schedule() bumps m_PendingJobs before it looks at m_SleepingWorkers, and we do the opposite,
+        // so either it sees us sleeping and wakes us up, or we see its job and don't sleep
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_SleepingWorkers.fetch_add(1);
+        m_WakeUp.wait(lock, [this]() { return m_PendingJobs.load() > 0 || !m_Running.load(); });
+        m_SleepingWorkers.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+Job *JobSystem::AllocateJob()
+{
+    int32_t index = GetCurrentWorkerIndex();
+    if (index >= 0)
+    {
+        // Only this thread allocates from its ring, so no locking. If the oldest slot is still
+        // in use there are JOBS_PER_WORKER jobs in flight: help with them until it is free.
+        Worker &worker = *m_Workers[index];
+        Job *job = &worker.jobs[worker.nextJob % JOBS_PER_WORKER];
+        while (!job->finished.load(std::memory_order_acquire))
+        {
+            if (Job *other = FindJob(index))
+                Execute(other);
+            else
+                std::this_thread::yield();
+        }
+        worker.nextJob++;
+        job->finished.store(false, std::memory_order_relaxed);
+        return job;
+    }
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_ExternalMutex);
+            Job *job = &m_ExternalJobs[m_NextExternalJob % JOBS_PER_WORKER];
+            if (job->finished.load(std::memory_order_acquire))
+            {
+                m_NextExternalJob++;
+                job->finished.store(false, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        if (Job *other = FindJob(-1))
+            Execute(other);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::Schedule(Job *job)
+{
+    int32_t index = GetCurrentWorkerIndex();
+    if (index >= 0)
+    {
+        // Full deque: running the job right away is the simplest form of back-pressure
+        if (!m_Workers[index]->deque.Push(job))
+        {
+            Execute(job);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_ExternalMutex);
+        m_ExternalQueue.push_back(job);
+    }
+
+    m_PendingJobs.fetch_add(1);
+    if (m_SleepingWorkers.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_WakeUp.notify_one();
+    }
+}
+
+Job *JobSystem::FindJob(int32_t workerIndex)
+{
+    Job *job = nullptr;
+
+    // Our own jobs first, newest first: their data is most likely still in cache
+    if (workerIndex >= 0)
+        job = m_Workers[workerIndex]->deque.Pop();
+
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(m_ExternalMutex);
+        if (!m_ExternalQueue.empty())
+        {
+            job = m_ExternalQueue.front();
+            m_ExternalQueue.pop_front();
+        }
+    }
+
+    // Then steal the oldest jobs of the other workers, starting with our neighbour so thieves spread out
+    uint32_t workerCount = (uint32_t)m_Workers.size();
+    uint32_t start = workerIndex >= 0 ? (uint32_t)workerIndex + 1 : 0;
+    for (uint32_t i = 0; !job && i < workerCount; i++)
+    {
+        uint32_t victim = (start + i) % workerCount;
+        if ((int32_t)victim != workerIndex)
+            job = m_Workers[victim]->deque.Steal();
+    }
+
+    if (job)
+        m_PendingJobs.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+}
+
+void JobSystem::Execute(Job *job)
+{
+    job->run(*job);
+
+    if (job->counter)
+        FinishJob(*job->counter);
+
+    // From here on the slot can be reused by its owner
+    job->finished.store(true, std::memory_order_release);
+}
+
+void JobSystem::FinishJob(JobCounter &counter)
+{
+    uint32_t count = counter.m_Count.load(std::memory_order_relaxed);
+    while (count > 1)
+    {
+        if (counter.m_Count.compare_exchange_weak(count, count - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+    }
+
+    // Probably the last job: drop the count to zero under the lock, so Wait() and Submit() with a dependency
+    // never see a zero count while we still use the counter
+    std::vector<Job *> dependents;
+    {
+        std::lock_guard<std::mutex> lock(counter.m_Mutex);
+        if (counter.m_Count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            dependents.swap(counter.m_Dependents);
+    }
+
+    for (Job *dependent : dependents)
+        Schedule(dependent);
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+// A unit of work. The callable is stored inline (no heap allocation per job),
+// so its captures must fit in DATA_SIZE bytes.
+struct alignas(64) Job
+{
+    static constexpr size_t DATA_SIZE = 48;
+
+    void (*run)(Job &job);
+    class JobCounter *counter;
+    std::atomic<bool> finished{true};
+    alignas(16) unsigned char data[DATA_SIZE];
+};
+
+// Counts unfinished jobs. Submitting with a counter increments it, finishing the job decrements it.
+// JobSystem::Wait(counter) waits until it reaches zero, and jobs submitted with the counter as a
+// dependency only start once it does, which is how jobs are chained.
+//
+// A counter must outlive its jobs: only destroy it after JobSystem::Wait() returned (IsDone() alone
+// is not enough, the last job may still be releasing it).
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+
+    inline bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+    inline uint32_t GetCount() const { return m_Count.load(std::memory_order_acquire); }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<uint32_t> m_Count{0};
+
+    // Jobs waiting for this counter to reach zero. The count only drops to zero while this is locked.
+    std::mutex m_Mutex;
+    std::vector<Job *> m_Dependents;
+};
+
+// Chase-Lev work-stealing deque ("Correct and Efficient Work-Stealing for Weak Memory Models", Lê et al. 2013).
+// The owner thread pushes and pops at the bottom (LIFO, cache friendly), other threads steal from the top (FIFO).
+class WorkStealingDeque
+{
+public:
+    static constexpr int64_t CAPACITY = 4096;
+
+    // Owner only. Returns false if the deque is full.
+    bool Push(Job *job)
+    {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        if (bottom - top >= CAPACITY)
+            return false;
+
+        m_Jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+        // Release: a thief that sees the new bottom also sees the job and its data
+        m_Bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner only
+    Job *Pop()
+    {
+        int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = m_Top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            // Empty
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job = m_Jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // Last job: race against the thieves for it
+            if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    // Any thread
+    Job *Steal()
+    {
+        int64_t top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+        if (top >= bottom)
+            return nullptr;
+
+        Job *job = m_Jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+        if (!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> m_Top{0};
+    alignas(64) std::atomic<int64_t> m_Bottom{0};
+    alignas(64) std::atomic<Job *> m_Jobs[CAPACITY];
+};
+
+// Work-stealing job scheduler.
+//
+// Every worker thread (and the thread that created the JobSystem, which helps while it waits)
+// has its own deque: jobs are pushed to the deque of the submitting thread, and idle workers
+// steal from the others, so there is no global queue to fight over.
+// Threads that are not part of the system (e.g. the simulation thread) can submit too, through
+// a small shared queue.
+//
+// Typical use:
+//     JobCounter counter;
+//     jobs.Submit([&]() { image = TextureImage::Decode(path); }, &counter);
+//     jobs.Submit([&]() { BuildMesh(...); }, &counter);
+//     jobs.Wait(counter); // Runs jobs on this thread too, instead of just blocking
+class JobSystem
+{
+public:
+    // threadCount counts the calling thread, so JobSystem(1) runs everything on the calling thread.
+    // 0 means one thread per hardware core.
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    // Runs function() on some worker. If counter is given it is incremented now and decremented when the job is done.
+    // If dependency is given, the job only starts once that counter reaches zero.
+    template <typename Function>
+    void Submit(Function &&function, JobCounter *counter = nullptr, JobCounter *dependency = nullptr)
+    {
+        using Callable = typename std::decay<Function>::type;
+        static_assert(sizeof(Callable) <= Job::DATA_SIZE, "Job captures are too big, capture a pointer to the data instead");
+        static_assert(alignof(Callable) <= 16, "Job captures are over-aligned");
+
+        Job *job = AllocateJob();
+        new (job->data) Callable(std::forward<Function>(function));
+        job->run = [](Job &self) {
+            Callable *callable = reinterpret_cast<Callable *>(self.data);
+            (*callable)();
+            callable->~Callable();
+        };
+        job->counter = counter;
+
+        if (counter)
+            counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+
+        if (dependency)
+        {
+            std::lock_guard<std::mutex> lock(dependency->m_Mutex);
+            if (!dependency->IsDone())
+            {
+                dependency->m_Dependents.push_back(job);
+                return;
+            }
+        }
+
+        Schedule(job);
+    }
+
+    // Calls function(begin, end) over [0, count) split in chunks of grainSize, and waits for all of them.
+    template <typename Function>
+    void ParallelFor(uint32_t count, uint32_t grainSize, const Function &function)
+    {
+        if (grainSize == 0)
+            grainSize = 1;
+
+        JobCounter counter;
+        for (uint32_t begin = 0; begin < count; begin += grainSize)
+        {
+            uint32_t end = count - begin > grainSize ? begin + grainSize : count;
+            const Function *f = &function;
+            Submit([f, begin, end]() { (*f)(begin, end); }, &counter);
+        }
+        Wait(counter);
+    }
+
+    // Runs other jobs on the calling thread until the counter reaches zero
+    void Wait(JobCounter &counter);
+
+    // Runs one waiting job on the calling thread, returns false if there was none. For code that polls
+    // its jobs instead of waiting for them (e.g. once per frame): the jobs of the thread that created
+    // the system only run when it helps, so without this they never run on a single core machine.
+    bool TryRunJob();
+
+    inline uint32_t GetThreadCount() const { return (uint32_t)m_Workers.size(); }
+
+    // Index of the calling thread in the system, or -1 if it is not part of it
+    int32_t GetCurrentWorkerIndex() const;
+
+private:
+    struct Worker
+    {
+        WorkStealingDeque deque;
+        std::unique_ptr<Job[]> jobs; // Ring of jobs submitted by this worker
+        uint32_t nextJob = 0;
+        std::thread thread;
+    };
+
+    static constexpr uint32_t JOBS_PER_WORKER = 4096;
+
+    void WorkerLoop(uint32_t index);
+    Job *AllocateJob();
+    void Schedule(Job *job);
+    Job *FindJob(int32_t workerIndex);
+    void Execute(Job *job);
+    void FinishJob(JobCounter &counter);
+
+private:
+    std::vector<std::unique_ptr<Worker>> m_Workers;
+
+    // For threads that are not workers
+    std::mutex m_ExternalMutex;
+    std::deque<Job *> m_ExternalQueue;
+    std::unique_ptr<Job[]> m_ExternalJobs;
+    uint32_t m_NextExternalJob;
+
+    std::atomic<bool> m_Running;
+    std::atomic<int32_t> m_PendingJobs; // Scheduled and not yet picked up by anybody
+    std::atomic<uint32_t> m_SleepingWorkers;
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WakeUp;
+};
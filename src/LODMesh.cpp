@@ -0,0 +1,95 @@
+#include "LODMesh.hpp"
+#include "MeshSimplifier.hpp"
+#include "Timing.hpp"
+
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+LODMesh::LODMesh(const void *vertices, uint32_t vertexCount, const VertexBufferLayout &layout,
+                 const uint32_t *indices, uint32_t indexCount, const LODSettings &settings)
+    : m_VertexBuffer(const_cast<void *>(vertices), vertexCount * layout.GetStride(), GL_STATIC_DRAW),
+      m_Radius(0.0f), m_Hysteresis(settings.hysteresis), m_BuildMs(0.0)
+{
+    if (layout.GetElementCount() == 0 || layout.GetElement(0).type != GL_FLOAT || layout.GetElement(0).count < 3)
+        throw std::runtime_error("LODMesh needs the positions (3 floats) as the first vertex attribute");
+
+    m_VertexArray.AddVBO(m_VertexBuffer, layout);
+
+    // Bounding sphere around the center of the bounding box
+    uint32_t stride = layout.GetStride();
+    auto position = [vertices, stride](uint32_t i) {
+        const float *p = (const float *)((const uint8_t *)vertices + (size_t)i * stride);
+        return Vec3{p[0], p[1], p[2]};
+    };
+    if (vertexCount > 0)
+    {
+        Vec3 min = position(0), max = min;
+        for (uint32_t i = 1; i < vertexCount; i++)
+        {
+            Vec3 p = position(i);
+            for (int c = 0; c < 3; c++)
+            {
+                min[c] = p[c] < min[c] ? p[c] : min[c];
+                max[c] = p[c] > max[c] ? p[c] : max[c];
+            }
+        }
+        m_Center = (min + max) * 0.5f;
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            float distance = Length(position(i) - m_Center);
+            m_Radius = distance > m_Radius ? distance : m_Radius;
+        }
+    }
+
+    std::vector<uint32_t> levelIndices(indices, indices + indexCount);
+    m_Levels.push_back(LODLevel{std::unique_ptr<IndexBuffer>(new IndexBuffer(levelIndices.data(), indexCount, GL_STATIC_DRAW)), indexCount / 3, 0.0f});
+
+    auto start = std::chrono::steady_clock::now();
+    MeshSimplifier simplifier((const float *)vertices, vertexCount, stride, indices, indexCount);
+    while (m_Levels.size() < settings.maxLevels)
+    {
+        uint32_t previous = m_Levels.back().triangleCount;
+        uint32_t target = (uint32_t)(previous * settings.reduction);
+        if (target < settings.minTriangles)
+            break;
+
+        // Stuck on locked vertices or maxError: another level would look the same
+        uint32_t reached = simplifier.Simplify(target, settings.maxError);
+        if (reached > previous - previous / 8)
+            break;
+
+        simplifier.GetIndices(levelIndices);
+        m_Levels.push_back(LODLevel{std::unique_ptr<IndexBuffer>(new IndexBuffer(levelIndices.data(), (uint32_t)levelIndices.size(), GL_STATIC_DRAW)),
+                                    reached, simplifier.GetError()});
+    }
+    m_BuildMs = ElapsedMs(start);
+    m_VertexArray.Unbind();
+}
+
+float LODMesh::GetProjectionScale(float fovYRadians, float viewportHeight)
+{
+    return viewportHeight / (2.0f * tanf(fovYRadians * 0.5f));
+}
+
+uint32_t LODMesh::SelectLevel(float distance, float projectionScale, float thresholdPixels, uint32_t current) const
+{
+    // The errors only grow from one level to the next
+    float pixelsPerUnit = projectionScale / (distance > 1e-4f ? distance : 1e-4f);
+    uint32_t level = current < m_Levels.size() ? current : (uint32_t)m_Levels.size() - 1;
+
+    while (level > 0 && m_Levels[level].error * pixelsPerUnit > thresholdPixels * (1.0f + m_Hysteresis))
+        level--;
+    while (level + 1 < m_Levels.size() && m_Levels[level + 1].error * pixelsPerUnit <= thresholdPixels * (1.0f - m_Hysteresis))
+        level++;
+    return level;
+}
+
+uint32_t LODMesh::Draw(const Renderer &renderer, const Shader &shader, uint32_t level) const
+{
+    const LODLevel &lod = m_Levels[level];
+    renderer.Draw(m_VertexArray, *lod.indices, shader);
+    return lod.triangleCount;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <float.h>
+#include <memory>
+#include <vector>
+
+#include "IndexBuffer.hpp"
+#include "Math.hpp"
+#include "Renderer.hpp"
+#include "Shader.hpp"
+#include "VertexArray.hpp"
+#include "VertexBuffer.hpp"
+#include "VertexBufferLayout.hpp"
+
+struct LODSettings
+{
+    uint32_t maxLevels = 6;     // Including the full mesh
+    float reduction = 0.5f;     // Triangles of each level, relative to the previous one
+    uint32_t minTriangles = 64; // No level below this
+    float maxError = FLT_MAX;   // No level with a larger error, in the units of the positions
+    float hysteresis = 0.25f;   // See LODMesh::SelectLevel()
+};
+
+struct LODLevel
+{
+    std::unique_ptr<IndexBuffer> indices;
+    uint32_t triangleCount;
+    float error; // See MeshSimplifier::GetError(), 0 for the full mesh
+};
+
+// A mesh and its levels of detail: one vertex buffer, and one index buffer per level, built at load
+// time by MeshSimplifier (by default each level has half the triangles of the previous one).
+//
+// Levels are picked by projected error: the error of a level in pixels, at the distance of the
+// instance. An instance uses the coarsest level whose projected error is under a threshold (around a
+// pixel, the simplification is then invisible), so distant instances cost a few hundred triangles.
+class LODMesh
+{
+public:
+    // The positions must be the first attribute of layout, 3 floats (throws std::runtime_error otherwise).
+    // indices are triangles.
+    LODMesh(const void *vertices, uint32_t vertexCount, const VertexBufferLayout &layout,
+            const uint32_t *indices, uint32_t indexCount, const LODSettings &settings = {});
+
+    LODMesh(const LODMesh &) = delete;
+    LODMesh &operator=(const LODMesh &) = delete;
+
+    // Pixels covered by one world unit at distance 1, for SelectLevel()
+    static float GetProjectionScale(float fovYRadians, float viewportHeight);
+
+    // Level to draw for an instance at distance from the camera (to its bounding sphere), that was
+    // drawn with current last frame. A level only changes when the projected error of the current
+    // one goes hysteresis (a fraction of the threshold) over the threshold, or the error of the next
+    // coarser one goes as much under it: an instance moving around a switch distance doesn't pop
+    // back and forth every frame.
+    uint32_t SelectLevel(float distance, float projectionScale, float thresholdPixels, uint32_t current) const;
+
+    // The shader must be bound, with its uniforms set. Returns the number of triangles drawn.
+    uint32_t Draw(const Renderer &renderer, const Shader &shader, uint32_t level) const;
+
+    inline uint32_t GetLevelCount() const { return (uint32_t)m_Levels.size(); }
+    inline const LODLevel &GetLevel(uint32_t level) const { return m_Levels[level]; }
+
+    // Bounding sphere of the positions
+    inline const Vec3 &GetCenter() const { return m_Center; }
+    inline float GetRadius() const { return m_Radius; }
+
+    // Time spent simplifying, in the constructor
+    inline double GetBuildMs() const { return m_BuildMs; }
+
+private:
+    VertexBuffer m_VertexBuffer;
+    VertexArray m_VertexArray;
+    std::vector<LODLevel> m_Levels;
+
+    Vec3 m_Center;
+    float m_Radius;
+    float m_Hysteresis;
+    double m_BuildMs;
+};
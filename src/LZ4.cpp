@@ -0,0 +1,207 @@
+#include "LZ4.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static constexpr size_t MIN_MATCH = 4;
+static constexpr size_t LAST_LITERALS = 5;  // The block always ends with at least 5 literals
+static constexpr size_t MATCH_FIND_LIMIT = 12; // And its last match starts at least 12 bytes before the end
+static constexpr size_t MAX_OFFSET = 65535;
+static constexpr uint32_t HASH_BITS = 12;
+
+static inline uint32_t Read32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Copies in chunks of 16 bytes, rounding length up: the buffers need WILD_COPY bytes of margin
+static constexpr size_t WILD_COPY = 16;
+
+static inline void WildCopy(uint8_t *destination, const uint8_t *source, size_t length)
+{
+    uint8_t *end = destination + length;
+    do
+    {
+        memcpy(destination, source, 16);
+        destination += 16;
+        source += 16;
+    } while (destination < end);
+}
+
+static inline uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Lengths over 15 continue in bytes of 255 and a last byte under 255
+static inline uint8_t *WriteLength(uint8_t *out, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        *out++ = 255;
+    *out++ = (uint8_t)length;
+    return out;
+}
+
+static inline bool ReadLength(const uint8_t *&in, const uint8_t *end, size_t &length)
+{
+    uint8_t byte;
+    do
+    {
+        if (in == end)
+            return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+size_t LZ4Compress(const void *source, size_t size, void *destination, size_t capacity)
+{
+    const uint8_t *input = (const uint8_t *)source;
+    const uint8_t *inputEnd = input + size;
+    uint8_t *out = (uint8_t *)destination;
+    uint8_t *outEnd = out + capacity;
+
+    // A sequence: its literals, and a match of matchLength (0 for the last sequence, which has none)
+    auto emit = [&](const uint8_t *literals, size_t literalLength, size_t offset, size_t matchLength) {
+        size_t worst = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+        if ((size_t)(outEnd - out) < worst)
+            return false;
+
+        uint8_t *token = out++;
+        *token = (uint8_t)((literalLength < 15 ? literalLength : 15) << 4);
+        if (literalLength >= 15)
+            out = WriteLength(out, literalLength - 15);
+        memcpy(out, literals, literalLength);
+        out += literalLength;
+
+        if (matchLength > 0)
+        {
+            *out++ = (uint8_t)offset;
+            *out++ = (uint8_t)(offset >> 8);
+            size_t length = matchLength - MIN_MATCH;
+            *token |= (uint8_t)(length < 15 ? length : 15);
+            if (length >= 15)
+                out = WriteLength(out, length - 15);
+        }
+        return true;
+    };
+
+    const uint8_t *anchor = input; // First byte not encoded yet
+    if (size > MATCH_FIND_LIMIT)
+    {
+        // Positions of the last sequences seen, by hash. Stale or colliding ones are caught by comparing the bytes.
+        uint32_t table[1 << HASH_BITS] = {};
+        const uint8_t *matchLimit = inputEnd - LAST_LITERALS;
+        const uint8_t *findLimit = inputEnd - MATCH_FIND_LIMIT;
+
+        const uint8_t *p = input;
+        while (p < findLimit)
+        {
+            uint32_t sequence = Read32(p);
+            uint32_t hash = Hash(sequence);
+            const uint8_t *candidate = input + table[hash];
+            table[hash] = (uint32_t)(p - input);
+
+            if (candidate >= p || (size_t)(p - candidate) > MAX_OFFSET || Read32(candidate) != sequence)
+            {
+                // Skips faster through data that doesn't compress
+                p += 1 + ((p - anchor) >> 6);
+                continue;
+            }
+
+            // Extends the match backwards into the pending literals, then forwards
+            while (p > anchor && candidate > input && p[-1] == candidate[-1])
+            {
+                p--;
+                candidate--;
+            }
+            const uint8_t *end = p + MIN_MATCH;
+            const uint8_t *from = candidate + MIN_MATCH;
+            while (end < matchLimit && *end == *from)
+            {
+                end++;
+                from++;
+            }
+
+            if (!emit(anchor, (size_t)(p - anchor), (size_t)(p - candidate), (size_t)(end - p)))
+                return 0;
+            anchor = p = end;
+
+            // The sequence just before the next position is likely to repeat too
+            if (p - 2 > input && p < findLimit)
+                table[Hash(Read32(p - 2))] = (uint32_t)(p - 2 - input);
+        }
+    }
+
+    if (!emit(anchor, (size_t)(inputEnd - anchor), 0, 0))
+        return 0;
+    return (size_t)(out - (uint8_t *)destination);
+}
+
+bool LZ4Decompress(const void *source, size_t compressedSize, void *destination, size_t size)
+{
+    const uint8_t *in = (const uint8_t *)source;
+    const uint8_t *inEnd = in + compressedSize;
+    uint8_t *outStart = (uint8_t *)destination;
+    uint8_t *out = outStart;
+    uint8_t *outEnd = out + size;
+
+    while (in < inEnd)
+    {
+        uint8_t token = *in++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(in, inEnd, literalLength))
+            return false;
+        if (literalLength > (size_t)(inEnd - in) || literalLength > (size_t)(outEnd - out))
+            return false;
+        if ((size_t)(inEnd - in) >= literalLength + WILD_COPY && (size_t)(outEnd - out) >= literalLength + WILD_COPY)
+            WildCopy(out, in, literalLength); // Copies up to 16 bytes too many, overwritten by what comes next
+        else
+            memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        // The last sequence has no match
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+        size_t offset = in[0] | (size_t)in[1] << 8;
+        in += 2;
+        if (offset == 0 || offset > (size_t)(out - outStart))
+            return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(in, inEnd, matchLength))
+            return false;
+        matchLength += MIN_MATCH;
+        if (matchLength > (size_t)(outEnd - out))
+            return false;
+
+        // A match may overlap what it writes (e.g. offset 1 repeats a byte), then it goes byte by byte
+        const uint8_t *from = out - offset;
+        if (offset >= 16 && (size_t)(outEnd - out) >= matchLength + WILD_COPY)
+        {
+            // 16 bytes behind or more, each chunk only reads bytes written before it
+            WildCopy(out, from, matchLength);
+            out += matchLength;
+        }
+        else if (offset >= matchLength)
+        {
+            memcpy(out, from, matchLength);
+            out += matchLength;
+        }
+        else
+        {
+            for (size_t i = 0; i < matchLength; i++)
+                *out++ = from[i];
+        }
+    }
+    return out == outEnd;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Compression in the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md):
+// literals and back-references within 64 KB, byte aligned, so decoding is mostly memcpy
+// (over 1 GB/s on one core). Blocks written here can be read by the reference library and the other way round.
+//
+// The compressor is the simple greedy one (a single hash table of 4-byte sequences): the ratio is
+// that of LZ4's fast mode, which is what resources loaded at startup want.
+
+// Largest output of LZ4Compress() for size bytes of input
+inline size_t LZ4CompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+// Largest size a block of compressedSize bytes can decode to: besides the literals, each byte of a
+// block adds at most 255 bytes to a match length
+inline uint64_t LZ4DecompressBound(uint64_t compressedSize)
+{
+    return compressedSize * 255 + 16;
+}
+
+// Returns the compressed size, or 0 if it doesn't fit in capacity bytes (LZ4CompressBound() always fits)
+size_t LZ4Compress(const void *source, size_t size, void *destination, size_t capacity);
+
+// Decodes a whole block into exactly size bytes. Returns false if the data is corrupt or doesn't
+// decode to size bytes; nothing is read or written out of the two buffers either way.
+bool LZ4Decompress(const void *source, size_t compressedSize, void *destination, size_t size);
@@ -0,0 +1,327 @@
+#include "Math.hpp"
+
+#include <stddef.h>
+#include <math.h>
+
+Mat3 Mat3::Transposed() const
+{
+    Mat3 result;
+    for (int c = 0; c < 3; c++)
+        for (int r = 0; r < 3; r++)
+            result[c][r] = columns[r][c];
+    return result;
+}
+
+Mat4 Mat4::Translate(const Vec3 &translation)
+{
+    Mat4 result;
+    result[3] = Vec4(translation, 1.0f);
+    return result;
+}
+
+Mat4 Mat4::Scale(const Vec3 &scale)
+{
+    Mat4 result;
+    result[0].x = scale.x;
+    result[1].y = scale.y;
+    result[2].z = scale.z;
+    return result;
+}
+
+Mat4 Mat4::Rotate(float angleRadians, const Vec3 &axis)
+{
+    return Quat::FromAxisAngle(axis, angleRadians).ToMat4();
+}
+
+Mat4 Mat4::Perspective(float fovYRadians, float aspect, float zNear, float zFar)
+{
+    // Same as gluPerspective: right handed, looking down -z, depth mapped to [-1, 1]
+    float f = 1.0f / tanf(fovYRadians * 0.5f);
+
+    Mat4 result(0.0f);
+    result[0].x = f / aspect;
+    result[1].y = f;
+    result[2].z = (zFar + zNear) / (zNear - zFar);
+    result[2].w = -1.0f;
+    result[3].z = (2.0f * zFar * zNear) / (zNear - zFar);
+    return result;
+}
+
+Mat4 Mat4::Ortho(float left, float right, float bottom, float top, float zNear, float zFar)
+{
+    Mat4 result;
+    result[0].x = 2.0f / (right - left);
+    result[1].y = 2.0f / (top - bottom);
+    result[2].z = -2.0f / (zFar - zNear);
+    result[3] = Vec4(-(right + left) / (right - left), -(top + bottom) / (top - bottom), -(zFar + zNear) / (zFar - zNear), 1.0f);
+    return result;
+}
+
+Mat4 Mat4::LookAt(const Vec3 &eye, const Vec3 &target, const Vec3 &up)
+{
+    Vec3 forward = Normalize(target - eye);
+    Vec3 side = Normalize(Cross(forward, up));
+    Vec3 newUp = Cross(side, forward);
+
+    Mat4 result;
+    result[0] = Vec4(side.x, newUp.x, -forward.x, 0.0f);
+    result[1] = Vec4(side.y, newUp.y, -forward.y, 0.0f);
+    result[2] = Vec4(side.z, newUp.z, -forward.z, 0.0f);
+    result[3] = Vec4(-Dot(side, eye), -Dot(newUp, eye), Dot(forward, eye), 1.0f);
+    return result;
+}
+
+Mat4 Mat4::Transposed() const
+{
+    Mat4 result;
+    for (int c = 0; c < 4; c++)
+        for (int r = 0; r < 4; r++)
+            result[c][r] = columns[r][c];
+    return result;
+}
+
+Mat4 Mat4::Inverse() const
+{
+    // Cofactor expansion, with the 2x2 sub-determinants shared between cofactors
+    const float *m = Data();
+
+    float s0 = m[0] * m[5] - m[4] * m[1];
+    float s1 = m[0] * m[9] - m[8] * m[1];
+    float s2 = m[0] * m[13] - m[12] * m[1];
+    float s3 = m[4] * m[9] - m[8] * m[5];
+    float s4 = m[4] * m[13] - m[12] * m[5];
+    float s5 = m[8] * m[13] - m[12] * m[9];
+
+    float c5 = m[10] * m[15] - m[14] * m[11];
+    float c4 = m[6] * m[15] - m[14] * m[7];
+    float c3 = m[6] * m[11] - m[10] * m[7];
+    float c2 = m[2] * m[15] - m[14] * m[3];
+    float c1 = m[2] * m[11] - m[10] * m[3];
+    float c0 = m[2] * m[7] - m[6] * m[3];
+
+    float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (determinant == 0.0f)
+        return Mat4(0.0f);
+
+    float inv = 1.0f / determinant;
+
+    Mat4 result;
+    float *r = result.Data();
+    r[0] = (m[5] * c5 - m[9] * c4 + m[13] * c3) * inv;
+    r[1] = (-m[1] * c5 + m[9] * c2 - m[13] * c1) * inv;
+    r[2] = (m[1] * c4 - m[5] * c2 + m[13] * c0) * inv;
+    r[3] = (-m[1] * c3 + m[5] * c1 - m[9] * c0) * inv;
+
+    r[4] = (-m[4] * c5 + m[8] * c4 - m[12] * c3) * inv;
+    r[5] = (m[0] * c5 - m[8] * c2 + m[12] * c1) * inv;
+    r[6] = (-m[0] * c4 + m[4] * c2 - m[12] * c0) * inv;
+    r[7] = (m[0] * c3 - m[4] * c1 + m[8] * c0) * inv;
+
+    r[8] = (m[7] * s5 - m[11] * s4 + m[15] * s3) * inv;
+    r[9] = (-m[3] * s5 + m[11] * s2 - m[15] * s1) * inv;
+    r[10] = (m[3] * s4 - m[7] * s2 + m[15] * s0) * inv;
+    r[11] = (-m[3] * s3 + m[7] * s1 - m[11] * s0) * inv;
+
+    r[12] = (-m[6] * s5 + m[10] * s4 - m[14] * s3) * inv;
+    r[13] = (m[2] * s5 - m[10] * s2 + m[14] * s1) * inv;
+    r[14] = (-m[2] * s4 + m[6] * s2 - m[14] * s0) * inv;
+    r[15] = (m[2] * s3 - m[6] * s1 + m[10] * s0) * inv;
+    return result;
+}
+
+Mat3 Mat4::NormalMatrix() const
+{
+    Mat4 inverse = Inverse();
+
+    Mat3 result;
+    for (int c = 0; c < 3; c++)
+        for (int r = 0; r < 3; r++)
+            result[c][r] = inverse[r][c];
+    return result;
+}
+
+Quat Quat::FromAxisAngle(const Vec3 &axis, float angleRadians)
+{
+    Vec3 n = Normalize(axis);
+    float s = sinf(angleRadians * 0.5f);
+    return Quat(n.x * s, n.y * s, n.z * s, cosf(angleRadians * 0.5f));
+}
+
+Quat Quat::Normalized() const
+{
+    float length = sqrtf(x * x + y * y + z * z + w * w);
+    if (length == 0.0f)
+        return Quat();
+    float inv = 1.0f / length;
+    return Quat(x * inv, y * inv, z * inv, w * inv);
+}
+
+Mat3 Quat::ToMat3() const
+{
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+
+    Mat3 result;
+    result[0] = Vec3(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy));
+    result[1] = Vec3(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx));
+    result[2] = Vec3(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy));
+    return result;
+}
+
+Quat Slerp(const Quat &a, const Quat &b, float t)
+{
+    float cosTheta = Dot(a, b);
+    Quat end = b;
+    if (cosTheta < 0.0f)
+    {
+        // q and -q are the same rotation, take the one closer to a
+        cosTheta = -cosTheta;
+        end = Quat(-b.x, -b.y, -b.z, -b.w);
+    }
+
+    float wa, wb;
+    if (cosTheta > 0.9995f)
+    {
+        // Almost the same rotation: lerp (and normalize) to avoid dividing by sin(~0)
+        wa = 1.0f - t;
+        wb = t;
+    }
+    else
+    {
+        float theta = acosf(cosTheta);
+        float sinTheta = sinf(theta);
+        wa = sinf((1.0f - t) * theta) / sinTheta;
+        wb = sinf(t * theta) / sinTheta;
+    }
+
+    return Quat(a.x * wa + end.x * wb, a.y * wa + end.y * wb, a.z * wa + end.z * wb, a.w * wa + end.w * wb).Normalized();
+}
+
+Mat4 ComposeTransform(const Vec3 &translation, const Quat &rotation, const Vec3 &scale)
+{
+    Mat3 r = rotation.ToMat3();
+
+    Mat4 result;
+    result[0] = Vec4(r[0] * scale.x, 0.0f);
+    result[1] = Vec4(r[1] * scale.y, 0.0f);
+    result[2] = Vec4(r[2] * scale.z, 0.0f);
+    result[3] = Vec4(translation, 1.0f);
+    return result;
+}
+
+// --- Batch operations ---
+
+void TransformPoints(const Mat4 &m, const Vec3 *points, Vec3 *out, size_t count)
+{
+#if defined(MATH_SIMD_SSE)
+    // The matrix stays in 4 registers for the whole loop
+    __m128 c0 = _mm_load_ps(&m[0].x), c1 = _mm_load_ps(&m[1].x), c2 = _mm_load_ps(&m[2].x), c3 = _mm_load_ps(&m[3].x);
+    for (size_t i = 0; i < count; i++)
+    {
+        __m128 r = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(points[i].x)), _mm_mul_ps(c1, _mm_set1_ps(points[i].y))),
+            _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(points[i].z)), c3));
+
+        alignas(16) float result[4];
+        _mm_store_ps(result, r);
+        out[i] = Vec3(result[0], result[1], result[2]);
+    }
+#elif defined(MATH_SIMD_NEON)
+    float32x4_t c0 = vld1q_f32(&m[0].x), c1 = vld1q_f32(&m[1].x), c2 = vld1q_f32(&m[2].x), c3 = vld1q_f32(&m[3].x);
+    for (size_t i = 0; i < count; i++)
+    {
+        float32x4_t r = vmlaq_n_f32(c3, c0, points[i].x);
+        r = vmlaq_n_f32(r, c1, points[i].y);
+        r = vmlaq_n_f32(r, c2, points[i].z);
+        out[i] = Vec3(vgetq_lane_f32(r, 0), vgetq_lane_f32(r, 1), vgetq_lane_f32(r, 2));
+    }
+#else
+    TransformPointsScalar(m, points, out, count);
+#endif
+}
+
+void TransformPointsScalar(const Mat4 &m, const Vec3 *points, Vec3 *out, size_t count)
+{
+    const float *e = m.Data();
+    for (size_t i = 0; i < count; i++)
+    {
+        Vec3 p = points[i];
+        out[i] = Vec3(
+            e[0] * p.x + e[4] * p.y + e[8] * p.z + e[12],
+            e[1] * p.x + e[5] * p.y + e[9] * p.z + e[13],
+            e[2] * p.x + e[6] * p.y + e[10] * p.z + e[14]);
+    }
+}
+
+void TransformVectors(const Mat4 &m, const Vec4 *vectors, Vec4 *out, size_t count)
+{
+#if defined(MATH_SIMD_SSE)
+    __m128 c0 = _mm_load_ps(&m[0].x), c1 = _mm_load_ps(&m[1].x), c2 = _mm_load_ps(&m[2].x), c3 = _mm_load_ps(&m[3].x);
+    for (size_t i = 0; i < count; i++)
+    {
+        // Broadcast each component of the vector with a shuffle instead of going through memory
+        __m128 v = _mm_load_ps(&vectors[i].x);
+        __m128 r = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(c0, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0))), _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)))),
+            _mm_add_ps(_mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))), _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)))));
+        _mm_store_ps(&out[i].x, r);
+    }
+#elif defined(MATH_SIMD_NEON)
+    float32x4_t c0 = vld1q_f32(&m[0].x), c1 = vld1q_f32(&m[1].x), c2 = vld1q_f32(&m[2].x), c3 = vld1q_f32(&m[3].x);
+    for (size_t i = 0; i < count; i++)
+    {
+        const Vec4 &v = vectors[i];
+        float32x4_t r = vmulq_n_f32(c0, v.x);
+        r = vmlaq_n_f32(r, c1, v.y);
+        r = vmlaq_n_f32(r, c2, v.z);
+        r = vmlaq_n_f32(r, c3, v.w);
+        vst1q_f32(&out[i].x, r);
+    }
+#else
+    TransformVectorsScalar(m, vectors, out, count);
+#endif
+}
+
+void TransformVectorsScalar(const Mat4 &m, const Vec4 *vectors, Vec4 *out, size_t count)
+{
+    const float *e = m.Data();
+    for (size_t i = 0; i < count; i++)
+    {
+        Vec4 v = vectors[i];
+        out[i] = Vec4(
+            e[0] * v.x + e[4] * v.y + e[8] * v.z + e[12] * v.w,
+            e[1] * v.x + e[5] * v.y + e[9] * v.z + e[13] * v.w,
+            e[2] * v.x + e[6] * v.y + e[10] * v.z + e[14] * v.w,
+            e[3] * v.x + e[7] * v.y + e[11] * v.z + e[15] * v.w);
+    }
+}
+
+void MultiplyMatrices(const Mat4 *a, const Mat4 *b, Mat4 *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        TransformVectors(a[i], b[i].columns, out[i].columns, 4);
+}
+
+void MultiplyMatricesScalar(const Mat4 *a, const Mat4 *b, Mat4 *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        TransformVectorsScalar(a[i], b[i].columns, out[i].columns, 4);
+}
+
+void MultiplyMatrices(const Mat4 &a, const Mat4 *b, Mat4 *out, size_t count)
+{
+    if (count == 0)
+        return;
+
+    // Every column of every matrix is transformed by the same a
+    TransformVectors(a, b[0].columns, out[0].columns, count * 4);
+}
+
+void MultiplyMatricesScalar(const Mat4 &a, const Mat4 *b, Mat4 *out, size_t count)
+{
+    if (count == 0)
+        return;
+
+    TransformVectorsScalar(a, b[0].columns, out[0].columns, count * 4);
+}
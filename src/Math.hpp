@@ -0,0 +1,273 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+// Small math library for transforms.
+//
+// All matrices are column-major (columns are stored one after the other), which is the layout
+// OpenGL expects, so a Mat4 can be passed straight to glUniformMatrix4fv (see Shader::SetUniform)
+// or copied into a buffer without transposing.
+//
+// Vec4, Quat and Mat4 are 16-byte aligned so a Vec4 (or a matrix column) fits in one SSE/NEON register.
+// The hot operations (Mat4 * Vec4, Mat4 * Mat4 and the batch versions below) use SSE on x86 and NEON on ARM,
+// and fall back to plain scalar code elsewhere (or when MATH_FORCE_SCALAR is defined).
+
+#if defined(MATH_FORCE_SCALAR)
+#define MATH_SIMD_NAME "scalar"
+#elif defined(__SSE__) || defined(_M_X64)
+#define MATH_SIMD_SSE 1
+#define MATH_SIMD_NAME "sse"
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MATH_SIMD_NEON 1
+#define MATH_SIMD_NAME "neon"
+#include <arm_neon.h>
+#else
+#define MATH_SIMD_NAME "scalar"
+#endif
+
+struct Vec2
+{
+    float x, y;
+
+    Vec2() : x(0.0f), y(0.0f) {}
+    Vec2(float x, float y) : x(x), y(y) {}
+
+    inline float &operator[](int i) { return (&x)[i]; }
+    inline float operator[](int i) const { return (&x)[i]; }
+};
+
+struct Vec3
+{
+    float x, y, z;
+
+    Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+    Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+
+    inline float &operator[](int i) { return (&x)[i]; }
+    inline float operator[](int i) const { return (&x)[i]; }
+};
+
+struct alignas(16) Vec4
+{
+    float x, y, z, w;
+
+    Vec4() : x(0.0f), y(0.0f), z(0.0f), w(0.0f) {}
+    Vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+    Vec4(const Vec3 &v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+
+    inline float &operator[](int i) { return (&x)[i]; }
+    inline float operator[](int i) const { return (&x)[i]; }
+    inline Vec3 XYZ() const { return Vec3(x, y, z); }
+};
+
+// --- Vector operations ---
+
+inline Vec2 operator+(const Vec2 &a, const Vec2 &b) { return Vec2(a.x + b.x, a.y + b.y); }
+inline Vec2 operator-(const Vec2 &a, const Vec2 &b) { return Vec2(a.x - b.x, a.y - b.y); }
+inline Vec2 operator*(const Vec2 &a, float s) { return Vec2(a.x * s, a.y * s); }
+inline float Dot(const Vec2 &a, const Vec2 &b) { return a.x * b.x + a.y * b.y; }
+
+inline Vec3 operator+(const Vec3 &a, const Vec3 &b) { return Vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline Vec3 operator-(const Vec3 &a, const Vec3 &b) { return Vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline Vec3 operator-(const Vec3 &a) { return Vec3(-a.x, -a.y, -a.z); }
+inline Vec3 operator*(const Vec3 &a, float s) { return Vec3(a.x * s, a.y * s, a.z * s); }
+inline Vec3 operator*(const Vec3 &a, const Vec3 &b) { return Vec3(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline float Dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 Cross(const Vec3 &a, const Vec3 &b) { return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+
+inline Vec4 operator+(const Vec4 &a, const Vec4 &b) { return Vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline Vec4 operator-(const Vec4 &a, const Vec4 &b) { return Vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline Vec4 operator*(const Vec4 &a, float s) { return Vec4(a.x * s, a.y * s, a.z * s, a.w * s); }
+inline float Dot(const Vec4 &a, const Vec4 &b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+template <typename V>
+inline float Length(const V &v) { return sqrtf(Dot(v, v)); }
+
+template <typename V>
+inline V Normalize(const V &v)
+{
+    float length = Length(v);
+    return length > 0.0f ? v * (1.0f / length) : v;
+}
+
+// --- Matrices ---
+
+struct Mat3
+{
+    Vec3 columns[3];
+
+    Mat3() : Mat3(1.0f) {}
+    explicit Mat3(float diagonal)
+    {
+        columns[0] = Vec3(diagonal, 0.0f, 0.0f);
+        columns[1] = Vec3(0.0f, diagonal, 0.0f);
+        columns[2] = Vec3(0.0f, 0.0f, diagonal);
+    }
+
+    inline Vec3 &operator[](int column) { return columns[column]; }
+    inline const Vec3 &operator[](int column) const { return columns[column]; }
+    inline const float *Data() const { return &columns[0].x; }
+
+    static Mat3 Identity() { return Mat3(1.0f); }
+    Mat3 Transposed() const;
+};
+
+struct alignas(16) Mat4
+{
+    Vec4 columns[4];
+
+    Mat4() : Mat4(1.0f) {}
+    explicit Mat4(float diagonal)
+    {
+        columns[0] = Vec4(diagonal, 0.0f, 0.0f, 0.0f);
+        columns[1] = Vec4(0.0f, diagonal, 0.0f, 0.0f);
+        columns[2] = Vec4(0.0f, 0.0f, diagonal, 0.0f);
+        columns[3] = Vec4(0.0f, 0.0f, 0.0f, diagonal);
+    }
+    explicit Mat4(const Mat3 &m)
+        : Mat4(1.0f)
+    {
+        for (int c = 0; c < 3; c++)
+            columns[c] = Vec4(m[c], 0.0f);
+    }
+
+    inline Vec4 &operator[](int column) { return columns[column]; }
+    inline const Vec4 &operator[](int column) const { return columns[column]; }
+    inline float *Data() { return &columns[0].x; }
+    inline const float *Data() const { return &columns[0].x; }
+
+    static Mat4 Identity() { return Mat4(1.0f); }
+    static Mat4 Translate(const Vec3 &translation);
+    static Mat4 Scale(const Vec3 &scale);
+    static Mat4 Rotate(float angleRadians, const Vec3 &axis);
+    static Mat4 Perspective(float fovYRadians, float aspect, float zNear, float zFar);
+    static Mat4 Ortho(float left, float right, float bottom, float top, float zNear, float zFar);
+    static Mat4 LookAt(const Vec3 &eye, const Vec3 &target, const Vec3 &up);
+
+    Mat4 Transposed() const;
+    Mat4 Inverse() const;
+    // Upper 3x3 part, inverted and transposed (to transform normals)
+    Mat3 NormalMatrix() const;
+};
+
+inline Vec3 operator*(const Mat3 &m, const Vec3 &v)
+{
+    return m[0] * v.x + m[1] * v.y + m[2] * v.z;
+}
+
+inline Mat3 operator*(const Mat3 &a, const Mat3 &b)
+{
+    Mat3 result;
+    for (int c = 0; c < 3; c++)
+        result[c] = a * b[c];
+    return result;
+}
+
+inline Vec4 operator*(const Mat4 &m, const Vec4 &v)
+{
+    // Linear combination of the columns: m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w
+    Vec4 result;
+#if defined(MATH_SIMD_SSE)
+    __m128 r = _mm_mul_ps(_mm_load_ps(&m[0].x), _mm_set1_ps(v.x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m[1].x), _mm_set1_ps(v.y)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m[2].x), _mm_set1_ps(v.z)));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_load_ps(&m[3].x), _mm_set1_ps(v.w)));
+    _mm_store_ps(&result.x, r);
+#elif defined(MATH_SIMD_NEON)
+    float32x4_t r = vmulq_n_f32(vld1q_f32(&m[0].x), v.x);
+    r = vmlaq_n_f32(r, vld1q_f32(&m[1].x), v.y);
+    r = vmlaq_n_f32(r, vld1q_f32(&m[2].x), v.z);
+    r = vmlaq_n_f32(r, vld1q_f32(&m[3].x), v.w);
+    vst1q_f32(&result.x, r);
+#else
+    result = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w;
+#endif
+    return result;
+}
+
+inline Mat4 operator*(const Mat4 &a, const Mat4 &b)
+{
+    // Each column of the result is a transformed by the matching column of b
+    Mat4 result;
+    for (int c = 0; c < 4; c++)
+        result[c] = a * b[c];
+    return result;
+}
+
+inline Vec3 TransformPoint(const Mat4 &m, const Vec3 &p)
+{
+    return (m * Vec4(p, 1.0f)).XYZ();
+}
+
+inline Vec3 TransformDirection(const Mat4 &m, const Vec3 &d)
+{
+    return (m * Vec4(d, 0.0f)).XYZ();
+}
+
+// --- Quaternions ---
+
+// Unit quaternion representing a rotation: (x, y, z) = axis * sin(angle / 2), w = cos(angle / 2)
+struct alignas(16) Quat
+{
+    float x, y, z, w;
+
+    Quat() : x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+    Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+
+    static Quat Identity() { return Quat(); }
+    static Quat FromAxisAngle(const Vec3 &axis, float angleRadians);
+
+    Quat Normalized() const;
+    Quat Conjugate() const { return Quat(-x, -y, -z, w); }
+    Mat3 ToMat3() const;
+    Mat4 ToMat4() const { return Mat4(ToMat3()); }
+};
+
+inline float Dot(const Quat &a, const Quat &b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+// Rotation by b followed by rotation by a
+inline Quat operator*(const Quat &a, const Quat &b)
+{
+    return Quat(
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+inline Vec3 operator*(const Quat &q, const Vec3 &v)
+{
+    // v' = v + 2w (u x v) + 2 u x (u x v), with u = (x, y, z)
+    Vec3 u(q.x, q.y, q.z);
+    Vec3 t = Cross(u, v) * 2.0f;
+    return v + t * q.w + Cross(u, t);
+}
+
+// Spherical interpolation, always along the shortest path
+Quat Slerp(const Quat &a, const Quat &b, float t);
+
+// Model matrix from translation, rotation and scale (applied in this order: scale, rotate, translate)
+Mat4 ComposeTransform(const Vec3 &translation, const Quat &rotation, const Vec3 &scale);
+
+// --- Batch operations ---
+// Same results as calling the operators above in a loop, but with the matrix kept in registers
+// and no temporaries. The *Scalar versions are the plain C++ reference (used by bench/MathBench.cpp).
+
+// out[i] = m * (points[i], 1). out may alias points
+void TransformPoints(const Mat4 &m, const Vec3 *points, Vec3 *out, size_t count);
+void TransformPointsScalar(const Mat4 &m, const Vec3 *points, Vec3 *out, size_t count);
+
+// out[i] = m * vectors[i]. out may alias vectors
+void TransformVectors(const Mat4 &m, const Vec4 *vectors, Vec4 *out, size_t count);
+void TransformVectorsScalar(const Mat4 &m, const Vec4 *vectors, Vec4 *out, size_t count);
+
+// out[i] = a[i] * b[i]. out may alias b, but not a
+void MultiplyMatrices(const Mat4 *a, const Mat4 *b, Mat4 *out, size_t count);
+void MultiplyMatricesScalar(const Mat4 *a, const Mat4 *b, Mat4 *out, size_t count);
+
+// out[i] = a * b[i]. out may alias b
+void MultiplyMatrices(const Mat4 &a, const Mat4 *b, Mat4 *out, size_t count);
+void MultiplyMatricesScalar(const Mat4 &a, const Mat4 *b, Mat4 *out, size_t count);
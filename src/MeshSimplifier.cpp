@@ -0,0 +1,304 @@
+#include "MeshSimplifier.hpp"
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+void MeshSimplifier::Quadric::AddPlane(double a, double b, double c, double d, double area)
+{
+    a2 += area * a * a;
+    ab += area * a * b;
+    ac += area * a * c;
+    ad += area * a * d;
+    b2 += area * b * b;
+    bc += area * b * c;
+    bd += area * b * d;
+    c2 += area * c * c;
+    cd += area * c * d;
+    d2 += area * d * d;
+    weight += area;
+}
+
+void MeshSimplifier::Quadric::Add(const Quadric &o)
+{
+    a2 += o.a2;
+    ab += o.ab;
+    ac += o.ac;
+    ad += o.ad;
+    b2 += o.b2;
+    bc += o.bc;
+    bd += o.bd;
+    c2 += o.c2;
+    cd += o.cd;
+    d2 += o.d2;
+    weight += o.weight;
+}
+
+double MeshSimplifier::Quadric::Evaluate(const Vec3 &p) const
+{
+    // (x y z 1) Q (x y z 1)^T
+    double x = p.x, y = p.y, z = p.z;
+    return a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x +
+           b2 * y * y + 2 * bc * y * z + 2 * bd * y +
+           c2 * z * z + 2 * cd * z + d2;
+}
+
+MeshSimplifier::MeshSimplifier(const float *positions, uint32_t vertexCount, size_t stride, const uint32_t *indices, uint32_t indexCount)
+    : m_Indices(indices, indices + indexCount / 3 * 3), m_TriangleRemoved(indexCount / 3, 0), m_TriangleCount(0),
+      m_Quadrics(vertexCount), m_VertexTriangles(vertexCount), m_Locked(vertexCount, 0), m_VertexRemoved(vertexCount, 0),
+      m_Versions(vertexCount, 0), m_Error(0.0f)
+{
+    m_Positions.resize(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        const float *p = (const float *)((const uint8_t *)positions + i * stride);
+        m_Positions[i] = Vec3{p[0], p[1], p[2]};
+    }
+
+    // Seams: vertices at the same position, found next to each other once sorted
+    std::vector<uint32_t> order(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        const Vec3 &pa = m_Positions[a], &pb = m_Positions[b];
+        return pa.x != pb.x ? pa.x < pb.x : pa.y != pb.y ? pa.y < pb.y : pa.z < pb.z;
+    });
+    for (uint32_t i = 1; i < vertexCount; i++)
+    {
+        const Vec3 &a = m_Positions[order[i - 1]], &b = m_Positions[order[i]];
+        if (a.x == b.x && a.y == b.y && a.z == b.z)
+            m_Locked[order[i - 1]] = m_Locked[order[i]] = 1;
+    }
+
+    // Borders: edges used by a single triangle (in either direction)
+    std::vector<uint64_t> edges;
+    edges.reserve(m_Indices.size());
+    uint32_t triangleCount = (uint32_t)m_Indices.size() / 3;
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        uint32_t *v = &m_Indices[t * 3];
+        if (v[0] == v[1] || v[1] == v[2] || v[2] == v[0])
+        {
+            m_TriangleRemoved[t] = 1;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            uint32_t a = v[i], b = v[(i + 1) % 3];
+            edges.push_back(a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a);
+            m_VertexTriangles[a].push_back(t);
+        }
+
+        Vec3 normal = Cross(m_Positions[v[1]] - m_Positions[v[0]], m_Positions[v[2]] - m_Positions[v[0]]);
+        float length = Length(normal);
+        if (length > 0.0f)
+        {
+            normal = normal * (1.0f / length);
+            double d = -Dot(normal, m_Positions[v[0]]);
+            for (uint32_t i = 0; i < 3; i++)
+                m_Quadrics[v[i]].AddPlane(normal.x, normal.y, normal.z, d, length * 0.5);
+        }
+        m_TriangleCount++;
+    }
+
+    std::sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size();)
+    {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i])
+            j++;
+        if (j - i == 1)
+            m_Locked[edges[i] >> 32] = m_Locked[(uint32_t)edges[i]] = 1;
+        i = j;
+    }
+
+    // In a closed mesh every edge is a -> b in one triangle and b -> a in the other: one push each
+    for (uint32_t t = 0; t < triangleCount; t++)
+    {
+        if (m_TriangleRemoved[t])
+            continue;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            uint32_t a = m_Indices[t * 3 + i], b = m_Indices[t * 3 + (i + 1) % 3];
+            if (a < b)
+            {
+                PushCollapse(a, b);
+                PushCollapse(b, a);
+            }
+        }
+    }
+}
+
+void MeshSimplifier::PushCollapse(uint32_t from, uint32_t to)
+{
+    if (m_Locked[from])
+        return;
+
+    Quadric quadric = m_Quadrics[from];
+    quadric.Add(m_Quadrics[to]);
+    double cost = quadric.weight > 0.0 ? quadric.Evaluate(m_Positions[to]) / quadric.weight : 0.0;
+    m_Queue.push(Collapse{(float)(cost > 0.0 ? cost : 0.0), from, to, m_Versions[from], m_Versions[to]});
+}
+
+uint32_t MeshSimplifier::Simplify(uint32_t targetTriangles, float maxError)
+{
+    float maxCost = maxError < sqrtf(FLT_MAX) ? maxError * maxError : FLT_MAX;
+
+    while (m_TriangleCount > targetTriangles && !m_Queue.empty())
+    {
+        Collapse collapse = m_Queue.top();
+        if (m_VertexRemoved[collapse.from] || m_VertexRemoved[collapse.to] ||
+            collapse.fromVersion != m_Versions[collapse.from] || collapse.toVersion != m_Versions[collapse.to])
+        {
+            m_Queue.pop();
+            continue;
+        }
+
+        // Left in the queue, a later call with a larger maxError starts from it
+        if (collapse.cost > maxCost)
+            break;
+
+        m_Queue.pop();
+        if (!IsValid(collapse.from, collapse.to))
+            continue; // Pushed again if the neighborhood changes
+
+        Apply(collapse.from, collapse.to);
+        float error = sqrtf(collapse.cost);
+        m_Error = error > m_Error ? error : m_Error;
+    }
+    return m_TriangleCount;
+}
+
+bool MeshSimplifier::IsValid(uint32_t from, uint32_t to)
+{
+    // Link condition: the vertices adjacent to both ends must be the opposite corners of the triangles
+    // sharing the edge, otherwise the collapse pinches the surface (e.g. flattens a tetrahedron)
+    m_FromNeighbors.clear();
+    m_ToNeighbors.clear();
+    uint32_t sharedTriangles = 0;
+    for (uint32_t t : m_VertexTriangles[from])
+    {
+        if (m_TriangleRemoved[t])
+            continue;
+
+        const uint32_t *v = &m_Indices[t * 3];
+        bool hasTo = v[0] == to || v[1] == to || v[2] == to;
+        sharedTriangles += hasTo;
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            if (v[i] != from)
+                m_FromNeighbors.push_back(v[i]);
+        }
+
+        if (hasTo)
+            continue;
+
+        // Triangles that stay must not flip when from moves to the position of to
+        uint32_t corner = v[0] == from ? 0 : v[1] == from ? 1 : 2;
+        const Vec3 &p1 = m_Positions[v[(corner + 1) % 3]], &p2 = m_Positions[v[(corner + 2) % 3]];
+        Vec3 before = Cross(p1 - m_Positions[from], p2 - m_Positions[from]);
+        Vec3 after = Cross(p1 - m_Positions[to], p2 - m_Positions[to]);
+        if (Dot(before, after) <= 0.0f)
+            return false;
+    }
+
+    for (uint32_t t : m_VertexTriangles[to])
+    {
+        if (m_TriangleRemoved[t])
+            continue;
+        const uint32_t *v = &m_Indices[t * 3];
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            if (v[i] != to)
+                m_ToNeighbors.push_back(v[i]);
+        }
+    }
+
+    std::sort(m_FromNeighbors.begin(), m_FromNeighbors.end());
+    m_FromNeighbors.erase(std::unique(m_FromNeighbors.begin(), m_FromNeighbors.end()), m_FromNeighbors.end());
+    std::sort(m_ToNeighbors.begin(), m_ToNeighbors.end());
+    m_ToNeighbors.erase(std::unique(m_ToNeighbors.begin(), m_ToNeighbors.end()), m_ToNeighbors.end());
+
+    uint32_t common = 0;
+    for (size_t i = 0, j = 0; i < m_FromNeighbors.size() && j < m_ToNeighbors.size();)
+    {
+        if (m_FromNeighbors[i] < m_ToNeighbors[j])
+            i++;
+        else if (m_FromNeighbors[i] > m_ToNeighbors[j])
+            j++;
+        else
+        {
+            common++;
+            i++;
+            j++;
+        }
+    }
+    return common == sharedTriangles;
+}
+
+void MeshSimplifier::Apply(uint32_t from, uint32_t to)
+{
+    std::vector<uint32_t> &toTriangles = m_VertexTriangles[to];
+    toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [this](uint32_t t) { return m_TriangleRemoved[t] != 0; }),
+                      toTriangles.end());
+
+    for (uint32_t t : m_VertexTriangles[from])
+    {
+        if (m_TriangleRemoved[t])
+            continue;
+
+        uint32_t *v = &m_Indices[t * 3];
+        if (v[0] == to || v[1] == to || v[2] == to)
+        {
+            // The triangles along the edge collapse to nothing
+            m_TriangleRemoved[t] = 1;
+            m_TriangleCount--;
+            continue;
+        }
+
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            if (v[i] == from)
+                v[i] = to;
+        }
+        toTriangles.push_back(t);
+    }
+    toTriangles.erase(std::remove_if(toTriangles.begin(), toTriangles.end(), [this](uint32_t t) { return m_TriangleRemoved[t] != 0; }),
+                      toTriangles.end());
+
+    m_VertexTriangles[from].clear();
+    m_VertexTriangles[from].shrink_to_fit();
+    m_VertexRemoved[from] = 1;
+    m_Quadrics[to].Add(m_Quadrics[from]);
+
+    // Every collapse into or out of to has a new cost
+    m_Versions[to]++;
+    for (uint32_t t : toTriangles)
+    {
+        const uint32_t *v = &m_Indices[t * 3];
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            if (v[i] == to)
+            {
+                // Each neighbor comes up in two triangles, pushed from one of them
+                uint32_t next = v[(i + 1) % 3];
+                PushCollapse(next, to);
+                PushCollapse(to, next);
+            }
+        }
+    }
+}
+
+void MeshSimplifier::GetIndices(std::vector<uint32_t> &indices) const
+{
+    indices.clear();
+    indices.reserve(m_TriangleCount * 3);
+    for (size_t t = 0; t < m_TriangleRemoved.size(); t++)
+    {
+        if (!m_TriangleRemoved[t])
+            indices.insert(indices.end(), m_Indices.begin() + t * 3, m_Indices.begin() + t * 3 + 3);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <float.h>
+#include <queue>
+#include <vector>
+
+#include "Math.hpp"
+
+// Simplifies triangle meshes with quadric error metrics (Garland & Heckbert, "Surface Simplification
+// Using Quadric Error Metrics", 1997), restricted to half-edge collapses: a vertex is merged into one
+// of its neighbors instead of moving to a new optimal position. The simplified index lists still point
+// into the original vertices, so every level of detail of a mesh shares its vertex buffer (see LODMesh).
+//
+// Each vertex accumulates the planes of its triangles, weighted by their area, in a quadric that
+// gives the squared distance to those planes. Edges are collapsed cheapest first; a collapse is skipped
+// when it would flip a triangle or pinch the surface. Vertices on an open border, and vertices sharing
+// their position with another one (an attribute seam, e.g. texture coordinates wrapping around), never
+// move, so no holes or cracks open.
+//
+// Simplify() can be called again with smaller targets: a chain of levels is built in one pass.
+class MeshSimplifier
+{
+public:
+    // positions: the x, y, z floats of each vertex, stride bytes apart (e.g. the start of an interleaved vertex)
+    MeshSimplifier(const float *positions, uint32_t vertexCount, size_t stride, const uint32_t *indices, uint32_t indexCount);
+
+    MeshSimplifier(const MeshSimplifier &) = delete;
+    MeshSimplifier &operator=(const MeshSimplifier &) = delete;
+
+    // Collapses edges until at most targetTriangles are left, or until the next collapse would have
+    // an error over maxError. Returns the triangle count reached.
+    uint32_t Simplify(uint32_t targetTriangles, float maxError = FLT_MAX);
+
+    // The triangles left, as indices into the original vertices
+    void GetIndices(std::vector<uint32_t> &indices) const;
+
+    inline uint32_t GetTriangleCount() const { return m_TriangleCount; }
+    // Largest error of the collapses so far: roughly how far the surface moved, in the units of the positions
+    inline float GetError() const { return m_Error; }
+
+private:
+    // Sum of squared plane distances, as the symmetric 4x4 matrix of Garland & Heckbert.
+    // Doubles: the terms of thousands of planes are summed, and the costs are small differences of them.
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+        double weight = 0; // Total area of the planes
+
+        void AddPlane(double a, double b, double c, double d, double area);
+        void Add(const Quadric &other);
+        double Evaluate(const Vec3 &p) const;
+    };
+
+    struct Collapse
+    {
+        float cost; // Squared error
+        uint32_t from, to;
+        uint32_t fromVersion, toVersion; // Stale once either vertex changed
+
+        bool operator>(const Collapse &other) const { return cost > other.cost; }
+    };
+
+    void PushCollapse(uint32_t from, uint32_t to);
+    bool IsValid(uint32_t from, uint32_t to);
+    void Apply(uint32_t from, uint32_t to);
+
+private:
+    std::vector<Vec3> m_Positions;
+    std::vector<uint32_t> m_Indices;
+    std::vector<uint8_t> m_TriangleRemoved;
+    uint32_t m_TriangleCount;
+
+    std::vector<Quadric> m_Quadrics;
+    std::vector<std::vector<uint32_t>> m_VertexTriangles;
+    std::vector<uint8_t> m_Locked;
+    std::vector<uint8_t> m_VertexRemoved;
+    std::vector<uint32_t> m_Versions;
+
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_Queue;
+    float m_Error;
+
+    // Reused by IsValid()
+    std::vector<uint32_t> m_FromNeighbors, m_ToNeighbors;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Pool of objects of a single type that are created and destroyed at runtime (e.g. the mesh build
+// work areas of TileMap).
+//
+// Objects live in chunks of ChunkSize slots, and freed slots go to a free list, so creating
+// and destroying objects at runtime reuses memory instead of going to the heap every time.
+// Since objects are constructed in place, non-copyable and non-movable types work too.
+// Pointers returned by Create() stay valid until Destroy() (chunks never move).
+template <typename T, size_t ChunkSize = 64>
+class ObjectPool
+{
+public:
+    ObjectPool()
+        : m_FreeList(nullptr), m_LiveCount(0)
+    {
+    }
+
+    ~ObjectPool()
+    {
+        // We can't tell which slots are alive, so objects that were not destroyed are leaked
+        if (m_LiveCount != 0)
+            std::cerr << "ObjectPool destroyed with " << m_LiveCount << " live objects" << std::endl;
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    ObjectPool &operator=(const ObjectPool &) = delete;
+
+    template <typename... Args>
+    T *Create(Args &&...args)
+    {
+        if (!m_FreeList)
+            AddChunk();
+
+        Slot *slot = m_FreeList;
+        m_FreeList = slot->next;
+
+        T *object;
+        try
+        {
+            object = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...)
+        {
+            slot->next = m_FreeList;
+            m_FreeList = slot;
+            throw;
+        }
+
+        m_LiveCount++;
+        return object;
+    }
+
+    void Destroy(T *object)
+    {
+        if (!object)
+            return;
+
+        object->~T();
+
+        Slot *slot = reinterpret_cast<Slot *>(object);
+        slot->next = m_FreeList;
+        m_FreeList = slot;
+        m_LiveCount--;
+    }
+
+    // Allocates enough chunks upfront so that count objects can be alive without further allocations
+    void Reserve(size_t count)
+    {
+        while (GetCapacity() < count)
+            AddChunk();
+    }
+
+    inline size_t GetLiveCount() const { return m_LiveCount; }
+    inline size_t GetCapacity() const { return m_Chunks.size() * ChunkSize; }
+
+private:
+    union Slot
+    {
+        Slot *next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    void AddChunk()
+    {
+        std::unique_ptr<Slot[]> chunk(new Slot[ChunkSize]);
+
+        // Thread the new slots into the free list, keeping them in memory order
+        for (size_t i = 0; i < ChunkSize - 1; i++)
+            chunk[i].next = &chunk[i + 1];
+        chunk[ChunkSize - 1].next = m_FreeList;
+        m_FreeList = &chunk[0];
+
+        m_Chunks.push_back(std::move(chunk));
+    }
+
+private:
+    std::vector<std::unique_ptr<Slot[]>> m_Chunks;
+    Slot *m_FreeList;
+    size_t m_LiveCount;
+};
@@ -0,0 +1,466 @@
+#include "OcclusionCuller.hpp"
+#include "JobSystem.hpp"
+#include "Timing.hpp"
+
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define OCCLUSION_CULLER_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Boxes tested per job, smaller batches are tested on the calling thread
+static constexpr uint32_t BOXES_PER_JOB = 4096;
+
+// Clip space planes, one bit each in OutCode()
+static constexpr uint32_t OUTSIDE_NEAR = 16;
+
+// Plain comparisons: fminf and fmaxf handle NaNs, and are library calls without -ffast-math
+static inline float Min(float a, float b) { return a < b ? a : b; }
+static inline float Max(float a, float b) { return a > b ? a : b; }
+static inline float Min3(float a, float b, float c) { return Min(a, Min(b, c)); }
+static inline float Max3(float a, float b, float c) { return Max(a, Max(b, c)); }
+
+static inline int32_t ClampToInt(float value, int32_t min, int32_t max)
+{
+    // Clamped as a float first: clipped triangles can project very far out of the buffer
+    return value <= (float)min ? min : value >= (float)max ? max : (int32_t)value;
+}
+
+static inline uint32_t OutCode(const Vec4 &v)
+{
+    return (v.x < -v.w ? 1 : 0) | (v.x > v.w ? 2 : 0) | (v.y < -v.w ? 4 : 0) | (v.y > v.w ? 8 : 0) |
+           (v.z < -v.w ? OUTSIDE_NEAR : 0) | (v.z > v.w ? 32 : 0);
+}
+
+// Clips a clip space triangle to the near plane (z >= -w), returns the vertex count of the polygon left (0, 3 or 4)
+static uint32_t ClipNear(const Vec4 *in, Vec4 *out)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        const Vec4 &a = in[i], &b = in[(i + 1) % 3];
+        float distanceA = a.z + a.w, distanceB = b.z + b.w;
+        if (distanceA >= 0.0f)
+            out[count++] = a;
+        if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+            out[count++] = a + (b - a) * (distanceA / (distanceA - distanceB));
+    }
+    return count;
+}
+
+OcclusionCuller::OcclusionCuller(uint32_t width, uint32_t height, JobSystem *jobSystem)
+    : m_JobSystem(jobSystem)
+{
+    m_TilesX = width ? (width + TILE_WIDTH - 1) / TILE_WIDTH : 1;
+    m_TilesY = height ? (height + TILE_HEIGHT - 1) / TILE_HEIGHT : 1;
+    m_Width = m_TilesX * TILE_WIDTH;
+    m_Height = m_TilesY * TILE_HEIGHT;
+    m_TileBins.resize(m_TilesX * m_TilesY);
+
+    // Halved (rounded up) down to 1x1, so texel t of level l always covers the pixels [t << l, (t + 1) << l)
+    size_t offset = 0;
+    uint32_t levelWidth = m_Width, levelHeight = m_Height;
+    while (true)
+    {
+        m_Levels.push_back(Level{levelWidth, levelHeight, offset});
+        offset += (size_t)levelWidth * levelHeight;
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+    m_Depth.resize(offset, 1.0f);
+}
+
+uint32_t OcclusionCuller::AddMesh(const Vec3 *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount)
+{
+    Mesh mesh;
+    mesh.vertices.reserve(vertexCount);
+    for (uint32_t i = 0; i < vertexCount; i++)
+        mesh.vertices.push_back(Vec4(vertices[i], 1.0f));
+    mesh.indices.assign(indices, indices + indexCount);
+
+    m_Meshes.push_back(std::move(mesh));
+    return (uint32_t)m_Meshes.size() - 1;
+}
+
+uint32_t OcclusionCuller::AddOccluder(uint32_t mesh, const Mat4 &model)
+{
+    m_Occluders.push_back(Occluder{mesh, model});
+    return (uint32_t)m_Occluders.size() - 1;
+}
+
+void OcclusionCuller::SetOccluderTransform(uint32_t occluder, const Mat4 &model)
+{
+    m_Occluders[occluder].model = model;
+}
+
+void OcclusionCuller::RenderOccluders(const Mat4 &viewProjection)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    m_ViewProjection = viewProjection;
+    m_Triangles.clear();
+    for (std::vector<uint32_t> &bin : m_TileBins)
+        bin.clear();
+    m_Stats.occluderTriangles = 0;
+
+    for (const Occluder &occluder : m_Occluders)
+    {
+        const Mesh &mesh = m_Meshes[occluder.mesh];
+        m_ClipVertices.resize(mesh.vertices.size());
+        TransformVectors(viewProjection * occluder.model, mesh.vertices.data(), m_ClipVertices.data(), mesh.vertices.size());
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        {
+            const Vec4 triangle[3] = {m_ClipVertices[mesh.indices[i]], m_ClipVertices[mesh.indices[i + 1]], m_ClipVertices[mesh.indices[i + 2]]};
+            m_Stats.occluderTriangles++;
+
+            uint32_t a = OutCode(triangle[0]), b = OutCode(triangle[1]), c = OutCode(triangle[2]);
+            if (a & b & c)
+                continue; // Entirely outside of one of the planes
+
+            // Only the near plane needs real clipping (w must stay positive), the others are handled
+            // by clamping the bounding boxes to the buffer
+            if ((a | b | c) & OUTSIDE_NEAR)
+            {
+                Vec4 polygon[4];
+                uint32_t count = ClipNear(triangle, polygon);
+                for (uint32_t k = 1; k + 1 < count; k++)
+                    SetupTriangle(polygon[0], polygon[k], polygon[k + 1]);
+            }
+            else
+            {
+                SetupTriangle(triangle[0], triangle[1], triangle[2]);
+            }
+        }
+    }
+    m_Stats.rasterizedTriangles = (uint32_t)m_Triangles.size();
+
+    uint32_t tileCount = m_TilesX * m_TilesY;
+    if (m_JobSystem)
+    {
+        m_JobSystem->ParallelFor(tileCount, 1, [this](uint32_t begin, uint32_t end) {
+            for (uint32_t tile = begin; tile < end; tile++)
+                RasterizeTile(tile);
+        });
+    }
+    else
+    {
+        for (uint32_t tile = 0; tile < tileCount; tile++)
+            RasterizeTile(tile);
+    }
+
+    auto rasterized = std::chrono::steady_clock::now();
+    BuildPyramid();
+
+    m_Stats.rasterMs = ElapsedMs(start, rasterized);
+    m_Stats.pyramidMs = ElapsedMs(rasterized);
+}
+
+void OcclusionCuller::SetupTriangle(const Vec4 &v0, const Vec4 &v1, const Vec4 &v2)
+{
+    const Vec4 *vertices[3] = {&v0, &v1, &v2};
+    float x[3], y[3], z[3];
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        float inverseW = 1.0f / vertices[i]->w;
+        x[i] = (vertices[i]->x * inverseW * 0.5f + 0.5f) * (float)m_Width;
+        y[i] = (vertices[i]->y * inverseW * 0.5f + 0.5f) * (float)m_Height;
+        z[i] = vertices[i]->z * inverseW * 0.5f + 0.5f;
+    }
+
+    // Counter-clockwise (positive area) is front facing
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+    if (!(area > 0.0f))
+        return;
+
+    ScreenTriangle triangle;
+    triangle.minX = ClampToInt(ceilf(Min3(x[0], x[1], x[2]) - 0.5f), 0, (int32_t)m_Width);
+    triangle.maxX = ClampToInt(floorf(Max3(x[0], x[1], x[2]) - 0.5f), -1, (int32_t)m_Width - 1);
+    triangle.minY = ClampToInt(ceilf(Min3(y[0], y[1], y[2]) - 0.5f), 0, (int32_t)m_Height);
+    triangle.maxY = ClampToInt(floorf(Max3(y[0], y[1], y[2]) - 0.5f), -1, (int32_t)m_Height - 1);
+    if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+        return; // Covers no pixel center
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        uint32_t j = (i + 1) % 3;
+        triangle.edgeA[i] = y[i] - y[j];
+        triangle.edgeB[i] = x[j] - x[i];
+        triangle.edgeC[i] = -(triangle.edgeA[i] * x[i] + triangle.edgeB[i] * y[i]);
+    }
+
+    // Depth is linear in screen space after the perspective divide. Evaluated at the pixel centers, plus
+    // what it can grow by within half a pixel: the farthest depth of the pixel, so the buffer never
+    // claims an occluder nearer than it is.
+    triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+    triangle.depthB = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / area;
+    triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0] +
+                      0.5f * (fabsf(triangle.depthA) + fabsf(triangle.depthB));
+
+    uint32_t index = (uint32_t)m_Triangles.size();
+    m_Triangles.push_back(triangle);
+
+    for (int32_t tileY = triangle.minY / (int32_t)TILE_HEIGHT; tileY <= triangle.maxY / (int32_t)TILE_HEIGHT; tileY++)
+    {
+        for (int32_t tileX = triangle.minX / (int32_t)TILE_WIDTH; tileX <= triangle.maxX / (int32_t)TILE_WIDTH; tileX++)
+            m_TileBins[tileY * m_TilesX + tileX].push_back(index);
+    }
+}
+
+void OcclusionCuller::RasterizeTile(uint32_t tile)
+{
+    int32_t tileMinX = (int32_t)((tile % m_TilesX) * TILE_WIDTH), tileMaxX = tileMinX + (int32_t)TILE_WIDTH - 1;
+    int32_t tileMinY = (int32_t)((tile / m_TilesX) * TILE_HEIGHT), tileMaxY = tileMinY + (int32_t)TILE_HEIGHT - 1;
+
+    float *depth = m_Depth.data();
+    for (int32_t y = tileMinY; y <= tileMaxY; y++)
+    {
+        for (int32_t x = tileMinX; x <= tileMaxX; x++)
+            depth[y * m_Width + x] = 1.0f;
+    }
+
+    for (uint32_t index : m_TileBins[tile])
+    {
+        const ScreenTriangle &t = m_Triangles[index];
+        int32_t minX = t.minX > tileMinX ? t.minX : tileMinX, maxX = t.maxX < tileMaxX ? t.maxX : tileMaxX;
+        int32_t minY = t.minY > tileMinY ? t.minY : tileMinY, maxY = t.maxY < tileMaxY ? t.maxY : tileMaxY;
+
+#ifdef OCCLUSION_CULLER_SSE
+        // Whole groups of 4 pixels: the extra ones on the sides are outside of the triangle anyway,
+        // and the tiles are a multiple of 4 pixels wide
+        minX &= ~3;
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 lanes = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f); // Pixel centers
+        const __m128 edgeA0 = _mm_set1_ps(t.edgeA[0]), edgeA1 = _mm_set1_ps(t.edgeA[1]), edgeA2 = _mm_set1_ps(t.edgeA[2]);
+        const __m128 depthA = _mm_set1_ps(t.depthA);
+
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            float centerY = (float)y + 0.5f;
+            __m128 row0 = _mm_set1_ps(t.edgeB[0] * centerY + t.edgeC[0]);
+            __m128 row1 = _mm_set1_ps(t.edgeB[1] * centerY + t.edgeC[1]);
+            __m128 row2 = _mm_set1_ps(t.edgeB[2] * centerY + t.edgeC[2]);
+            __m128 rowDepth = _mm_set1_ps(t.depthB * centerY + t.depthC);
+            float *row = depth + y * m_Width;
+
+            for (int32_t x = minX; x <= maxX; x += 4)
+            {
+                __m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+                __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA0, centerX), row0), zero),
+                                                      _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA1, centerX), row1), zero)),
+                                           _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(edgeA2, centerX), row2), zero));
+                if (!_mm_movemask_ps(inside))
+                    continue;
+
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 nearer = _mm_min_ps(old, _mm_add_ps(_mm_mul_ps(depthA, centerX), rowDepth));
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, old)));
+            }
+        }
+#else
+        for (int32_t y = minY; y <= maxY; y++)
+        {
+            float centerY = (float)y + 0.5f;
+            float *row = depth + y * m_Width;
+            for (int32_t x = minX; x <= maxX; x++)
+            {
+                float centerX = (float)x + 0.5f;
+                if (t.edgeA[0] * centerX + t.edgeB[0] * centerY + t.edgeC[0] < 0.0f ||
+                    t.edgeA[1] * centerX + t.edgeB[1] * centerY + t.edgeC[1] < 0.0f ||
+                    t.edgeA[2] * centerX + t.edgeB[2] * centerY + t.edgeC[2] < 0.0f)
+                    continue;
+
+                float z = t.depthA * centerX + t.depthB * centerY + t.depthC;
+                if (z < row[x])
+                    row[x] = z;
+            }
+        }
+#endif
+    }
+}
+
+void OcclusionCuller::BuildPyramid()
+{
+    for (size_t l = 1; l < m_Levels.size(); l++)
+    {
+        const Level &source = m_Levels[l - 1], &level = m_Levels[l];
+        const float *src = m_Depth.data() + source.offset;
+        float *dst = m_Depth.data() + level.offset;
+
+        for (uint32_t y = 0; y < level.height; y++)
+        {
+            // An odd size has no second row (or column) for the last texel, the first one is used twice
+            const float *row0 = src + (size_t)(2 * y) * source.width;
+            const float *row1 = 2 * y + 1 < source.height ? row0 + source.width : row0;
+            for (uint32_t x = 0; x < level.width; x++)
+            {
+                uint32_t x0 = 2 * x, x1 = 2 * x + 1 < source.width ? 2 * x + 1 : 2 * x;
+                dst[y * level.width + x] = Max(Max(row0[x0], row0[x1]), Max(row1[x0], row1[x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::IsVisible(const Vec3 &center, const Vec3 &extent) const
+{
+    // The corners are the projected center plus or minus the projected half extents
+    const Mat4 &m = m_ViewProjection;
+    Vec4 projectedCenter = m * Vec4(center, 1.0f);
+    Vec4 axisX = m[0] * extent.x, axisY = m[1] * extent.y, axisZ = m[2] * extent.z;
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        Vec4 corner = projectedCenter + axisX * (i & 1 ? 1.0f : -1.0f) + axisY * (i & 2 ? 1.0f : -1.0f) + axisZ * (i & 4 ? 1.0f : -1.0f);
+
+        // Crosses the near plane: the camera may be inside, and the projection is meaningless
+        if (corner.z < -corner.w)
+            return true;
+
+        float inverseW = 1.0f / corner.w;
+        float x = corner.x * inverseW, y = corner.y * inverseW, z = corner.z * inverseW;
+        minX = Min(minX, x);
+        maxX = Max(maxX, x);
+        minY = Min(minY, y);
+        maxY = Max(maxY, y);
+        minZ = Min(minZ, z);
+    }
+    return IsRectVisible(minX, minY, maxX, maxY, minZ);
+}
+
+bool OcclusionCuller::IsRectVisible(float minX, float minY, float maxX, float maxY, float minZ) const
+{
+    if (maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f)
+        return false; // Off screen, the frustum culler should have caught it
+
+    // Pixels touched by the screen rectangle (truncating is flooring here, negative values clamp to 0 anyway)
+    int32_t x0 = ClampToInt((minX * 0.5f + 0.5f) * (float)m_Width, 0, (int32_t)m_Width - 1);
+    int32_t x1 = ClampToInt((maxX * 0.5f + 0.5f) * (float)m_Width, 0, (int32_t)m_Width - 1);
+    int32_t y0 = ClampToInt((minY * 0.5f + 0.5f) * (float)m_Height, 0, (int32_t)m_Height - 1);
+    int32_t y1 = ClampToInt((maxY * 0.5f + 0.5f) * (float)m_Height, 0, (int32_t)m_Height - 1);
+
+    // First level where the rectangle spans at most 2x2 texels
+    uint32_t l = 0;
+    while (l + 1 < m_Levels.size() && ((x1 >> l) - (x0 >> l) > 1 || (y1 >> l) - (y0 >> l) > 1))
+        l++;
+
+    // The same texel is read twice when the rectangle spans only one of them, cheaper than branching
+    const Level &level = m_Levels[l];
+    const float *row0 = m_Depth.data() + level.offset + (y0 >> l) * level.width;
+    const float *row1 = m_Depth.data() + level.offset + (y1 >> l) * level.width;
+    float farthest = Max(Max(row0[x0 >> l], row0[x1 >> l]), Max(row1[x0 >> l], row1[x1 >> l]));
+
+    return minZ * 0.5f + 0.5f <= farthest;
+}
+
+#ifdef OCCLUSION_CULLER_SSE
+void OcclusionCuller::TestBoxes4(const BoundingBoxes &boxes, const uint32_t *indices, uint8_t *results) const
+{
+    // Same as IsVisible(), with one box per lane up to the screen rectangles
+    const float *x = boxes.GetCenterX(), *y = boxes.GetCenterY(), *z = boxes.GetCenterZ();
+    const float *ex = boxes.GetExtentX(), *ey = boxes.GetExtentY(), *ez = boxes.GetExtentZ();
+    uint32_t a = indices[0], b = indices[1], c = indices[2], d = indices[3];
+    __m128 centerX = _mm_setr_ps(x[a], x[b], x[c], x[d]), extentX = _mm_setr_ps(ex[a], ex[b], ex[c], ex[d]);
+    __m128 centerY = _mm_setr_ps(y[a], y[b], y[c], y[d]), extentY = _mm_setr_ps(ey[a], ey[b], ey[c], ey[d]);
+    __m128 centerZ = _mm_setr_ps(z[a], z[b], z[c], z[d]), extentZ = _mm_setr_ps(ez[a], ez[b], ez[c], ez[d]);
+
+    // Component r (x, y, z, w) of the projected center and half extents
+    const float *m = m_ViewProjection.Data();
+    __m128 projected[4], axisX[4], axisY[4], axisZ[4];
+    for (uint32_t r = 0; r < 4; r++)
+    {
+        projected[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[r]), centerX), _mm_mul_ps(_mm_set1_ps(m[4 + r]), centerY)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(m[8 + r]), centerZ), _mm_set1_ps(m[12 + r])));
+        axisX[r] = _mm_mul_ps(_mm_set1_ps(m[r]), extentX);
+        axisY[r] = _mm_mul_ps(_mm_set1_ps(m[4 + r]), extentY);
+        axisZ[r] = _mm_mul_ps(_mm_set1_ps(m[8 + r]), extentZ);
+    }
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 minX = _mm_set1_ps(FLT_MAX), minY = minX, minZ = minX;
+    __m128 maxX = _mm_set1_ps(-FLT_MAX), maxY = maxX;
+    __m128 crossesNear = _mm_setzero_ps();
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        __m128 corner[4];
+        for (uint32_t r = 0; r < 4; r++)
+        {
+            __m128 v = i & 1 ? _mm_add_ps(projected[r], axisX[r]) : _mm_sub_ps(projected[r], axisX[r]);
+            v = i & 2 ? _mm_add_ps(v, axisY[r]) : _mm_sub_ps(v, axisY[r]);
+            corner[r] = i & 4 ? _mm_add_ps(v, axisZ[r]) : _mm_sub_ps(v, axisZ[r]);
+        }
+
+        // The lanes crossing the near plane are visible whatever the (meaningless) rest gives
+        crossesNear = _mm_or_ps(crossesNear, _mm_cmplt_ps(_mm_add_ps(corner[2], corner[3]), _mm_setzero_ps()));
+
+        __m128 inverseW = _mm_div_ps(one, corner[3]);
+        __m128 px = _mm_mul_ps(corner[0], inverseW), py = _mm_mul_ps(corner[1], inverseW);
+        minX = _mm_min_ps(minX, px);
+        maxX = _mm_max_ps(maxX, px);
+        minY = _mm_min_ps(minY, py);
+        maxY = _mm_max_ps(maxY, py);
+        minZ = _mm_min_ps(minZ, _mm_mul_ps(corner[2], inverseW));
+    }
+
+    alignas(16) float rect[5][4];
+    _mm_store_ps(rect[0], minX);
+    _mm_store_ps(rect[1], minY);
+    _mm_store_ps(rect[2], maxX);
+    _mm_store_ps(rect[3], maxY);
+    _mm_store_ps(rect[4], minZ);
+    int near = _mm_movemask_ps(crossesNear);
+    for (uint32_t lane = 0; lane < 4; lane++)
+        results[lane] = ((near >> lane) & 1) || IsRectVisible(rect[0][lane], rect[1][lane], rect[2][lane], rect[3][lane], rect[4][lane]);
+}
+#endif
+
+void OcclusionCuller::Cull(const BoundingBoxes &boxes, std::vector<uint32_t> &visible)
+{
+    visible.resize(Cull(boxes, visible.data(), (uint32_t)visible.size()));
+}
+
+uint32_t OcclusionCuller::Cull(const BoundingBoxes &boxes, uint32_t *visible, uint32_t count)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    const float *x = boxes.GetCenterX(), *y = boxes.GetCenterY(), *z = boxes.GetCenterZ();
+    const float *ex = boxes.GetExtentX(), *ey = boxes.GetExtentY(), *ez = boxes.GetExtentZ();
+    m_Results.resize(count);
+
+    auto test = [&](uint32_t begin, uint32_t end) {
+        uint32_t i = begin;
+#ifdef OCCLUSION_CULLER_SSE
+        for (; i + 4 <= end; i += 4)
+            TestBoxes4(boxes, visible + i, m_Results.data() + i);
+#endif
+        for (; i < end; i++)
+        {
+            uint32_t box = visible[i];
+            m_Results[i] = IsVisible(Vec3{x[box], y[box], z[box]}, Vec3{ex[box], ey[box], ez[box]});
+        }
+    };
+
+    if (m_JobSystem && count > BOXES_PER_JOB)
+        m_JobSystem->ParallelFor(count, BOXES_PER_JOB, test);
+    else
+        test(0, count);
+
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (m_Results[i])
+            visible[kept++] = visible[i];
+    }
+
+    m_Stats.tested = count;
+    m_Stats.culled = count - kept;
+    m_Stats.testMs = ElapsedMs(start);
+    return kept;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "FrustumCuller.hpp"
+#include "Math.hpp"
+
+class JobSystem;
+
+struct OcclusionCullerStats
+{
+    uint32_t occluderTriangles = 0;   // Triangles of the occluders, in the last RenderOccluders()
+    uint32_t rasterizedTriangles = 0; // Of which left after clipping and back face culling
+    uint32_t tested = 0;              // Boxes tested by the last Cull()
+    uint32_t culled = 0;              // Of which hidden by the occluders
+    double rasterMs = 0.0;            // Transforming, binning and rasterizing the occluders
+    double pyramidMs = 0.0;           // Building the hierarchical-Z pyramid
+    double testMs = 0.0;              // The last Cull()
+};
+
+// Hides objects behind a few large occluders (buildings, walls, terrain...) before they are drawn.
+//
+// Designated occluder meshes (low poly, and never bigger than what they stand for) are rasterized on
+// the CPU into a small depth buffer, then reduced into a hierarchical-Z pyramid where each texel keeps
+// the farthest depth of the 2x2 texels below it. A box is hidden when its nearest point is farther
+// than the pyramid, over the (at most 2x2) texels of the level where its screen rectangle fits. Boxes
+// crossing the near plane stay visible, and so does everything behind pixels the occluders don't
+// cover. Coverage is sampled at the pixel centers though: a gap between occluders thinner than a
+// pixel of the buffer may be closed, hiding what is seen through it.
+//
+// The depth buffer is split in TILE_WIDTH x TILE_HEIGHT tiles. The triangles are set up and binned to
+// the tiles they overlap, then each tile is rasterized by one job (4 pixels at a time with SSE), so no
+// two threads ever write the same pixel.
+//
+// Typical use, once per frame:
+//     occlusion.RenderOccluders(viewProjection);
+//     frustumCuller.Cull(frustum, boxes, visible);
+//     occlusion.Cull(boxes, visible); // Removes the hidden ones, the others are drawn
+class OcclusionCuller
+{
+public:
+    static constexpr uint32_t TILE_WIDTH = 32;
+    static constexpr uint32_t TILE_HEIGHT = 16;
+
+    // The size is rounded up to whole tiles. jobSystem may be nullptr, everything then runs on the calling thread.
+    OcclusionCuller(uint32_t width = 256, uint32_t height = 128, JobSystem *jobSystem = nullptr);
+
+    OcclusionCuller(const OcclusionCuller &) = delete;
+    OcclusionCuller &operator=(const OcclusionCuller &) = delete;
+
+    // Local space triangles, counter-clockwise seen from the outside (the GL default front faces).
+    // Returns the index of the mesh, for AddOccluder().
+    uint32_t AddMesh(const Vec3 *vertices, uint32_t vertexCount, const uint32_t *indices, uint32_t indexCount);
+
+    // Places an instance of a mesh, returns its index for SetOccluderTransform()
+    uint32_t AddOccluder(uint32_t mesh, const Mat4 &model);
+    void SetOccluderTransform(uint32_t occluder, const Mat4 &model);
+    void ClearOccluders() { m_Occluders.clear(); }
+
+    // Once per frame, before Cull(): fills the depth buffer and the pyramid with the occluders
+    void RenderOccluders(const Mat4 &viewProjection);
+
+    // Removes from visible the indices of the boxes hidden by the occluders, keeping the order of the others.
+    // Meant for the output of FrustumCuller::Cull().
+    void Cull(const BoundingBoxes &boxes, std::vector<uint32_t> &visible);
+    // Same on the count first indices of an array (e.g. from FrameArena), returns how many are left
+    uint32_t Cull(const BoundingBoxes &boxes, uint32_t *visible, uint32_t count);
+
+    // Single world space box, against the last RenderOccluders()
+    bool IsVisible(const Vec3 &center, const Vec3 &extent) const;
+
+    inline uint32_t GetWidth() const { return m_Width; }
+    inline uint32_t GetHeight() const { return m_Height; }
+    // Rows from the bottom, depth from 0 (near plane) to 1 (far plane, and where no occluder was drawn)
+    inline const float *GetDepthBuffer() const { return m_Depth.data(); }
+
+    inline const OcclusionCullerStats &GetStats() const { return m_Stats; }
+
+private:
+    struct Mesh
+    {
+        std::vector<Vec4> vertices; // w = 1, ready for TransformVectors()
+        std::vector<uint32_t> indices;
+    };
+
+    struct Occluder
+    {
+        uint32_t mesh;
+        Mat4 model;
+    };
+
+    // In pixels, with the rows from the bottom
+    struct ScreenTriangle
+    {
+        float edgeA[3], edgeB[3], edgeC[3]; // Inside when edgeA * x + edgeB * y + edgeC >= 0 for the 3 edges
+        float depthA, depthB, depthC;       // depthA * x + depthB * y + depthC, the farthest depth of the pixel
+        int32_t minX, minY, maxX, maxY;     // Pixels whose center may be inside, clamped to the buffer
+    };
+
+    struct Level
+    {
+        uint32_t width, height;
+        size_t offset; // In m_Depth
+    };
+
+    void SetupTriangle(const Vec4 &v0, const Vec4 &v1, const Vec4 &v2);
+    void RasterizeTile(uint32_t tile);
+    void BuildPyramid();
+
+    // Screen rectangle in normalized device coordinates, against the pyramid
+    bool IsRectVisible(float minX, float minY, float maxX, float maxY, float minZ) const;
+    // IsVisible() of the boxes indices[0..3] at once, with SSE
+    void TestBoxes4(const BoundingBoxes &boxes, const uint32_t *indices, uint8_t *results) const;
+
+private:
+    uint32_t m_Width, m_Height;
+    uint32_t m_TilesX, m_TilesY;
+    JobSystem *m_JobSystem;
+
+    std::vector<Mesh> m_Meshes;
+    std::vector<Occluder> m_Occluders;
+    Mat4 m_ViewProjection;
+
+    // Reused every frame
+    std::vector<Vec4> m_ClipVertices;
+    std::vector<ScreenTriangle> m_Triangles;
+    std::vector<std::vector<uint32_t>> m_TileBins; // Triangles overlapping each tile
+    std::vector<uint8_t> m_Results;                // Per box being tested by Cull()
+
+    // Every level of the pyramid, the full resolution depth buffer first
+    std::vector<float> m_Depth;
+    std::vector<Level> m_Levels;
+
+    OcclusionCullerStats m_Stats;
+};
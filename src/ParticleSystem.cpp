@@ -0,0 +1,102 @@
+#include <GL/glew.h>
+
+#include "ParticleSystem.hpp"
+
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Timing.hpp"
+#include "VertexBufferLayout.hpp"
+
+// Longest step simulated at once, longer frames are slowed down instead
+static constexpr float MAX_DELTA_TIME = 0.1f;
+
+ParticleSystem::ParticleSystem(uint32_t capacity, const ParticleSettings &settings)
+    : m_Capacity(capacity), m_Settings(settings),
+      m_UpdateShader("res/shaders/particle-update.vs", std::vector<std::string>{"o_PositionAge", "o_VelocityLifetime"}),
+      m_DrawShader("res/shaders/particle.vs", "res/shaders/particle.fs"),
+      m_Current(0), m_EmitStart(0), m_EmitRemainder(0.0f), m_Seed(0), m_UpdateMs(0.0)
+{
+    // Zero is dead (age >= lifetime), only the first buffer needs it: the other one is written before being read
+    std::vector<float> state((size_t)capacity * 8, 0.0f);
+    m_Buffers[0].reset(new VertexBuffer(state.data(), capacity * 8 * sizeof(float), GL_DYNAMIC_COPY));
+    m_Buffers[1].reset(new VertexBuffer(nullptr, capacity * 8 * sizeof(float), GL_DYNAMIC_COPY));
+
+    VertexBufferLayout updateLayout;
+    updateLayout.Push<float>(4); // Position, age
+    updateLayout.Push<float>(4); // Velocity, lifetime
+
+    VertexBufferLayout drawLayout = updateLayout;
+    drawLayout.SetDivisor(1); // One quad per particle, the corners come from gl_VertexID
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        m_UpdateArrays[i].AddVBO(*m_Buffers[i], updateLayout);
+        m_DrawArrays[i].AddVBO(*m_Buffers[i], drawLayout);
+    }
+    m_DrawArrays[1].Unbind();
+
+    m_DrawShader.Bind();
+    m_DrawShader.SetUniform("u_Texture", 0);
+
+    m_Stats.capacity = capacity;
+}
+
+void ParticleSystem::Update(const Renderer &renderer, float deltaTime)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    deltaTime = deltaTime < MAX_DELTA_TIME ? deltaTime : MAX_DELTA_TIME;
+    float toEmit = m_Settings.emitRate * deltaTime + m_EmitRemainder;
+    uint32_t emitCount = toEmit < (float)m_Capacity ? (uint32_t)toEmit : m_Capacity;
+    m_EmitRemainder = toEmit < (float)m_Capacity ? toEmit - (float)emitCount : 0.0f;
+
+    m_UpdateShader.Bind();
+    m_UpdateShader.SetUniform("u_DeltaTime", deltaTime);
+    m_UpdateShader.SetUniform("u_Seed", (int)m_Seed);
+    m_UpdateShader.SetUniform("u_EmitStart", (int)m_EmitStart);
+    m_UpdateShader.SetUniform("u_EmitCount", (int)emitCount);
+    m_UpdateShader.SetUniform("u_Capacity", (int)m_Capacity);
+    m_UpdateShader.SetUniform("u_EmitterPosition", m_Settings.emitterPosition);
+    m_UpdateShader.SetUniform("u_EmitterRadius", m_Settings.emitterRadius);
+    m_UpdateShader.SetUniform("u_InitialVelocity", m_Settings.initialVelocity);
+    m_UpdateShader.SetUniform("u_VelocitySpread", m_Settings.velocitySpread);
+    m_UpdateShader.SetUniform("u_Lifetime", m_Settings.lifetime);
+    m_UpdateShader.SetUniform("u_Gravity", m_Settings.gravity);
+    m_UpdateShader.SetUniform("u_Drag", m_Settings.drag);
+
+    // Each particle is a point, read from the current buffer and written to the other one
+    uint32_t next = 1 - m_Current;
+    renderer.DrawTransformFeedback(m_UpdateArrays[m_Current], m_UpdateShader, m_Capacity, *m_Buffers[next]);
+
+    m_Current = next;
+    m_EmitStart = (uint32_t)(((uint64_t)m_EmitStart + emitCount) % m_Capacity);
+    m_Seed++;
+
+    m_Stats.emitted = emitCount;
+    m_UpdateMs = ElapsedMs(start);
+}
+
+void ParticleSystem::Draw(const Renderer &renderer, const Texture &texture, const Mat4 &viewProjection, Vec3 cameraRight, Vec3 cameraUp)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    texture.Bind(0);
+    m_DrawShader.Bind();
+    m_DrawShader.SetUniform("u_ViewProjection", viewProjection);
+    m_DrawShader.SetUniform("u_CameraRight", cameraRight);
+    m_DrawShader.SetUniform("u_CameraUp", cameraUp);
+    m_DrawShader.SetUniform("u_Size", m_Settings.size);
+    m_DrawShader.SetUniform("u_StartColor", m_Settings.startColor);
+    m_DrawShader.SetUniform("u_EndColor", m_Settings.endColor);
+
+    // Additive: no sorting needed, the order of the particles doesn't matter
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE);
+    renderer.DrawInstanced(m_DrawArrays[m_Current], m_DrawShader, GL_TRIANGLE_STRIP, 4, m_Capacity);
+    glDisable(GL_BLEND);
+
+    m_Stats.cpuMs = m_UpdateMs + ElapsedMs(start);
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+
+#include "Math.hpp"
+#include "Renderer.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+#include "VertexArray.hpp"
+#include "VertexBuffer.hpp"
+
+// Everything can be changed between frames, it is passed to the shaders as uniforms
+struct ParticleSettings
+{
+    Vec3 emitterPosition{0.0f, 0.0f, 0.0f};
+    float emitterRadius = 0.5f;  // Particles spawn in this sphere around the emitter
+    Vec3 initialVelocity{0.0f, 12.0f, 0.0f};
+    float velocitySpread = 4.0f; // Random velocity added to initialVelocity, up to this length
+    float emitRate = 100000.0f;  // Particles per second
+    float lifetime = 4.0f;       // Seconds, each particle lives between half and all of it
+
+    Vec3 gravity{0.0f, -9.81f, 0.0f};
+    float drag = 0.2f; // Fraction of the velocity lost per second
+
+    float size = 0.1f; // World units
+    Vec4 startColor{1.0f, 0.8f, 0.3f, 1.0f};
+    Vec4 endColor{1.0f, 0.2f, 0.05f, 1.0f};
+};
+
+struct ParticleStats
+{
+    uint32_t capacity = 0;
+    uint32_t emitted = 0; // Spawn slots handed to the GPU by the last Update() (dead particles in them respawn)
+    double cpuMs = 0.0;   // Time the last Update() and Draw() took on the CPU
+};
+
+// Particles simulated and drawn entirely on the GPU: the CPU never touches their data after creation.
+//
+// The state of the particles (position, age, velocity, lifetime: 32 bytes each) lives in two vertex
+// buffers. Update() runs a vertex shader over the current one with rasterization disabled, and
+// transform feedback writes the new state into the other, then they swap. Drawing reads the current
+// buffer as per-instance attributes: one camera facing quad per particle, additively blended.
+//
+// Emitting needs no readback either. Every frame, the update shader respawns the dead particles of a
+// window of emitRate * deltaTime slots, which moves around the buffer like a ring. A particle still
+// alive when the window comes back to it is left alone, so the rate is capped to what the capacity
+// can hold (capacity / average lifetime). Dead particles are still processed and collapsed to nothing
+// when drawn: the cost is proportional to the capacity, not to the number of live particles.
+class ParticleSystem
+{
+public:
+    explicit ParticleSystem(uint32_t capacity, const ParticleSettings &settings = {});
+
+    ParticleSystem(const ParticleSystem &) = delete;
+    ParticleSystem &operator=(const ParticleSystem &) = delete;
+
+    // Advances the simulation by deltaTime seconds (clamped, so a hitch doesn't emit a burst)
+    void Update(const Renderer &renderer, float deltaTime);
+
+    // Additively blended on the current framebuffer, texture modulated by the color of each particle.
+    // cameraRight and cameraUp are world space unit vectors, the quads are built from them.
+    void Draw(const Renderer &renderer, const Texture &texture, const Mat4 &viewProjection, Vec3 cameraRight, Vec3 cameraUp);
+
+    inline ParticleSettings &GetSettings() { return m_Settings; }
+    inline const ParticleStats &GetStats() const { return m_Stats; }
+
+private:
+    uint32_t m_Capacity;
+    ParticleSettings m_Settings;
+
+    Shader m_UpdateShader;
+    Shader m_DrawShader;
+
+    // The state is read from m_Buffers[m_Current], m_UpdateArrays[i] and m_DrawArrays[i] read m_Buffers[i]
+    std::unique_ptr<VertexBuffer> m_Buffers[2];
+    VertexArray m_UpdateArrays[2];
+    VertexArray m_DrawArrays[2];
+    uint32_t m_Current;
+
+    uint32_t m_EmitStart;
+    float m_EmitRemainder; // Fraction of a particle left to emit by the next frames
+    uint32_t m_Seed;
+
+    ParticleStats m_Stats;
+    double m_UpdateMs;
+};
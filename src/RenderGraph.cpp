@@ -0,0 +1,583 @@
+#include <GL/glew.h>
+
+#include "RenderGraph.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// --- RenderPassBuilder ---
+
+void RenderPassBuilder::Read(RenderResource resource)
+{
+    if (!resource.IsValid() || resource.index >= m_Graph.m_Resources.size())
+        throw std::runtime_error("Pass '" + m_Graph.m_Passes[m_Pass].name + "' reads an invalid resource");
+    if (m_Graph.m_Resources[resource.index].kind == RenderGraph::ResourceKind::Backbuffer)
+        throw std::runtime_error("Pass '" + m_Graph.m_Passes[m_Pass].name + "' can't sample the backbuffer");
+
+    m_Graph.m_Passes[m_Pass].reads.push_back(resource);
+}
+
+RenderResource RenderPassBuilder::Write(RenderResource resource, LoadOp load)
+{
+    RenderGraph::PassNode &pass = m_Graph.m_Passes[m_Pass];
+    if (pass.colors.size() >= Framebuffer::MAX_COLOR_ATTACHMENTS)
+        throw std::runtime_error("Pass '" + pass.name + "' writes too many color attachments");
+
+    RenderResource written = m_Graph.WriteResource(m_Pass, resource, load);
+    if (PixelFormat::Get(m_Graph.m_Resources[resource.index].desc.format).depth)
+        throw std::runtime_error("Pass '" + pass.name + "' writes depth texture '" + m_Graph.m_Resources[resource.index].name + "' as a color attachment");
+
+    pass.colors.push_back({written, load});
+    return written;
+}
+
+RenderResource RenderPassBuilder::WriteDepth(RenderResource resource, LoadOp load)
+{
+    RenderGraph::PassNode &pass = m_Graph.m_Passes[m_Pass];
+    if (pass.depth.resource.IsValid())
+        throw std::runtime_error("Pass '" + pass.name + "' writes two depth attachments");
+
+    RenderResource written = m_Graph.WriteResource(m_Pass, resource, load);
+    if (!PixelFormat::Get(m_Graph.m_Resources[resource.index].desc.format).depth)
+        throw std::runtime_error("Pass '" + pass.name + "' writes color texture '" + m_Graph.m_Resources[resource.index].name + "' as depth");
+
+    pass.depth = {written, load};
+    return written;
+}
+
+void RenderPassBuilder::SetClearColor(float r, float g, float b, float a)
+{
+    float *color = m_Graph.m_Passes[m_Pass].clearColor;
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+    color[3] = a;
+}
+
+void RenderPassBuilder::SetClearDepth(float depth)
+{
+    m_Graph.m_Passes[m_Pass].clearDepth = depth;
+}
+
+void RenderPassBuilder::SetSideEffect()
+{
+    m_Graph.m_Passes[m_Pass].sideEffect = true;
+}
+
+// --- RenderPassContext ---
+
+uint32_t RenderPassContext::GetTexture(RenderResource resource) const
+{
+    const std::vector<RenderResource> &reads = m_Graph.m_Passes[m_Pass].reads;
+    for (const RenderResource &read : reads)
+    {
+        if (read.index == resource.index)
+            return m_Graph.GetTextureID(resource);
+    }
+    throw std::runtime_error("Pass '" + m_Graph.m_Passes[m_Pass].name + "' did not declare a read of '" + m_Graph.m_Resources[resource.index].name + "'");
+}
+
+void RenderPassContext::BindTexture(RenderResource resource, uint32_t slot) const
+{
+    uint32_t texture = GetTexture(resource);
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+// --- RenderGraph ---
+
+RenderResource RenderGraph::AddResource(const std::string &name, const RenderTargetDesc &desc, ResourceKind kind, ResourceHandle texture)
+{
+    m_Compiled = false;
+
+    ResourceNode node;
+    node.name = name;
+    node.desc = desc;
+    node.kind = kind;
+    node.texture = texture;
+    node.producers.push_back(NO_PASS);
+    node.firstUse = UINT32_MAX;
+    node.lastUse = 0;
+    m_Resources.push_back(std::move(node));
+
+    RenderResource resource;
+    resource.index = (uint32_t)m_Resources.size() - 1;
+    return resource;
+}
+
+RenderResource RenderGraph::CreateTexture(const std::string &name, const RenderTargetDesc &desc)
+{
+    PixelFormat::Get(desc.format); // Throws on unsupported formats now rather than in Compile()
+    return AddResource(name, desc, ResourceKind::Transient, ResourceHandle());
+}
+
+RenderResource RenderGraph::ImportTexture(const std::string &name, const Texture &texture)
+{
+    return AddResource(name, {texture.GetWidth(), texture.GetHeight(), texture.GetInternalFormat()}, ResourceKind::Imported, texture.GetHandle());
+}
+
+RenderResource RenderGraph::ImportBackbuffer(const std::string &name, int width, int height)
+{
+    return AddResource(name, {width, height, GL_RGBA8}, ResourceKind::Backbuffer, ResourceHandle());
+}
+
+uint32_t RenderGraph::AddPass(const std::string &name, const SetupFunction &setup, ExecuteFunction execute)
+{
+    m_Compiled = false;
+
+    PassNode node;
+    node.name = name;
+    node.depth = {RenderResource(), LoadOp::DontCare};
+    node.clearColor[0] = node.clearColor[1] = node.clearColor[2] = 0.0f;
+    node.clearColor[3] = 1.0f;
+    node.clearDepth = 1.0f;
+    node.sideEffect = false;
+    node.blit = false;
+    node.blitFilter = GL_NEAREST;
+    node.execute = std::move(execute);
+    node.needed = false;
+    node.framebuffer = NO_PASS;
+    node.readFramebuffer = NO_PASS;
+    m_Passes.push_back(std::move(node));
+
+    uint32_t pass = (uint32_t)m_Passes.size() - 1;
+    RenderPassBuilder builder(*this, pass);
+    setup(builder);
+
+    const PassNode &added = m_Passes[pass];
+    bool toBackbuffer = false, toTexture = added.depth.resource.IsValid();
+    for (const Attachment &color : added.colors)
+        (m_Resources[color.resource.index].kind == ResourceKind::Backbuffer ? toBackbuffer : toTexture) = true;
+    if (toBackbuffer && (toTexture || added.colors.size() > 1))
+        throw std::runtime_error("Pass '" + name + "' writes the backbuffer together with other attachments");
+
+    return pass;
+}
+
+RenderResource RenderGraph::AddBlitPass(const std::string &name, RenderResource source, RenderResource destination, uint32_t filter)
+{
+    RenderResource written;
+    uint32_t pass = AddPass(name, [&](RenderPassBuilder &builder) {
+        builder.Read(source);
+        if (PixelFormat::Get(m_Resources[destination.index].desc.format).depth)
+            written = builder.WriteDepth(destination, LoadOp::DontCare);
+        else
+            written = builder.Write(destination, LoadOp::DontCare);
+    }, nullptr);
+
+    m_Passes[pass].blit = true;
+    m_Passes[pass].blitFilter = filter;
+    return written;
+}
+
+RenderResource RenderGraph::WriteResource(uint32_t pass, RenderResource resource, LoadOp load)
+{
+    if (!resource.IsValid() || resource.index >= m_Resources.size())
+        throw std::runtime_error("Pass '" + m_Passes[pass].name + "' writes an invalid resource");
+
+    ResourceNode &node = m_Resources[resource.index];
+    if (resource.version + 1 != node.producers.size())
+        throw std::runtime_error("Pass '" + m_Passes[pass].name + "' writes an old version of '" + node.name + "'");
+    if (load == LoadOp::Load && node.kind == ResourceKind::Transient && resource.version == 0)
+        throw std::runtime_error("Pass '" + m_Passes[pass].name + "' loads '" + node.name + "' before anything was written to it");
+
+    node.producers.push_back(pass);
+
+    RenderResource written;
+    written.index = resource.index;
+    written.version = resource.version + 1;
+    return written;
+}
+
+void RenderGraph::GetDependencies(uint32_t pass, bool includeWriteAfterRead, std::vector<uint32_t> &dependencies) const
+{
+    dependencies.clear();
+    const PassNode &node = m_Passes[pass];
+
+    for (const RenderResource &read : node.reads)
+    {
+        uint32_t producer = m_Resources[read.index].producers[read.version];
+        if (producer != NO_PASS)
+            dependencies.push_back(producer);
+    }
+
+    auto addAttachment = [&](const Attachment &attachment) {
+        if (!attachment.resource.IsValid())
+            return;
+
+        // The previous version: its contents are needed with Load, and in every case it must be done first
+        const ResourceNode &resource = m_Resources[attachment.resource.index];
+        uint32_t previousVersion = attachment.resource.version - 1;
+        uint32_t previous = resource.producers[previousVersion];
+        if (previous != NO_PASS && (attachment.load == LoadOp::Load || includeWriteAfterRead))
+            dependencies.push_back(previous);
+
+        // Passes reading the previous version must run before it is overwritten
+        if (includeWriteAfterRead)
+        {
+            for (uint32_t other = 0; other < m_Passes.size(); other++)
+            {
+                if (other == pass || !m_Passes[other].needed)
+                    continue;
+                for (const RenderResource &read : m_Passes[other].reads)
+                {
+                    if (read.index == attachment.resource.index && read.version == previousVersion)
+                        dependencies.push_back(other);
+                }
+            }
+        }
+    };
+
+    for (const Attachment &color : node.colors)
+        addAttachment(color);
+    addAttachment(node.depth);
+}
+
+// Depth-first, dependencies first: every pass lands right after what it needs
+void RenderGraph::Visit(uint32_t pass, std::vector<uint8_t> &state)
+{
+    if (state[pass] == 2)
+        return;
+    if (state[pass] == 1)
+        throw std::runtime_error("Render graph has a cycle through pass '" + m_Passes[pass].name + "'");
+
+    state[pass] = 1;
+    std::vector<uint32_t> dependencies;
+    GetDependencies(pass, true, dependencies);
+    for (uint32_t dependency : dependencies)
+        Visit(dependency, state);
+
+    state[pass] = 2;
+    m_Order.push_back(pass);
+}
+
+void RenderGraph::Compile()
+{
+    m_Order.clear();
+    m_Stats = RenderGraphStats();
+    m_Stats.passCount = (uint32_t)m_Passes.size();
+
+    // --- Culling: keep what contributes to a root ---
+
+    std::vector<uint32_t> roots;
+    for (uint32_t pass = 0; pass < m_Passes.size(); pass++)
+    {
+        PassNode &node = m_Passes[pass];
+        node.needed = false;
+        node.discards.clear();
+
+        bool root = node.sideEffect;
+        for (const Attachment &color : node.colors)
+            root |= m_Resources[color.resource.index].kind != ResourceKind::Transient;
+        if (node.depth.resource.IsValid())
+            root |= m_Resources[node.depth.resource.index].kind != ResourceKind::Transient;
+        if (root)
+            roots.push_back(pass);
+    }
+
+    std::vector<uint32_t> pending = roots, dependencies;
+    while (!pending.empty())
+    {
+        uint32_t pass = pending.back();
+        pending.pop_back();
+        if (m_Passes[pass].needed)
+            continue;
+
+        m_Passes[pass].needed = true;
+        GetDependencies(pass, false, dependencies);
+        pending.insert(pending.end(), dependencies.begin(), dependencies.end());
+    }
+
+    // --- Ordering ---
+
+    std::vector<uint8_t> state(m_Passes.size(), 0);
+    for (uint32_t root : roots)
+        Visit(root, state);
+
+    m_Stats.culledPassCount = m_Stats.passCount - (uint32_t)m_Order.size();
+
+    // --- Lifetimes ---
+
+    for (ResourceNode &resource : m_Resources)
+    {
+        resource.firstUse = UINT32_MAX;
+        resource.lastUse = 0;
+    }
+
+    auto use = [this](RenderResource resource, uint32_t position) {
+        ResourceNode &node = m_Resources[resource.index];
+        node.firstUse = std::min(node.firstUse, position);
+        node.lastUse = std::max(node.lastUse, position);
+    };
+
+    for (uint32_t position = 0; position < m_Order.size(); position++)
+    {
+        const PassNode &pass = m_Passes[m_Order[position]];
+        for (const RenderResource &read : pass.reads)
+            use(read, position);
+        for (const Attachment &color : pass.colors)
+            use(color.resource, position);
+        if (pass.depth.resource.IsValid())
+            use(pass.depth.resource, position);
+    }
+
+    AllocateTextures();
+
+    // --- Framebuffers ---
+
+    std::vector<std::vector<uint32_t>> keys(m_Passes.size()), readKeys(m_Passes.size());
+    for (uint32_t pass : m_Order)
+    {
+        const PassNode &node = m_Passes[pass];
+        if (node.colors.empty() && !node.depth.resource.IsValid())
+            continue; // Compute-like pass, nothing to bind
+        if (!node.colors.empty() && m_Resources[node.colors[0].resource.index].kind == ResourceKind::Backbuffer)
+            continue;
+
+        for (const Attachment &color : node.colors)
+            keys[pass].push_back(m_Resources[color.resource.index].texture.value);
+        keys[pass].push_back(node.depth.resource.IsValid() ? m_Resources[node.depth.resource.index].texture.value : 0);
+
+        if (node.blit)
+        {
+            const ResourceNode &source = m_Resources[node.reads[0].index];
+            bool depth = PixelFormat::Get(source.desc.format).depth;
+            readKeys[pass].push_back(depth ? 0 : source.texture.value);
+            readKeys[pass].push_back(depth ? source.texture.value : 0);
+        }
+    }
+
+    // Framebuffers that no pass uses anymore may point to textures that were just released
+    for (CachedFramebuffer &cached : m_Framebuffers)
+    {
+        cached.used = false;
+        for (uint32_t pass : m_Order)
+            cached.used |= cached.key == keys[pass] || cached.key == readKeys[pass];
+    }
+    m_Framebuffers.erase(std::remove_if(m_Framebuffers.begin(), m_Framebuffers.end(),
+                                        [](const CachedFramebuffer &cached) { return !cached.used; }),
+                         m_Framebuffers.end());
+
+    for (uint32_t pass : m_Order)
+    {
+        PassNode &node = m_Passes[pass];
+        node.framebuffer = NO_PASS;
+        node.readFramebuffer = NO_PASS;
+
+        if (!keys[pass].empty())
+        {
+            std::vector<uint32_t> colors(keys[pass].begin(), keys[pass].end() - 1);
+            node.framebuffer = GetFramebuffer(keys[pass], colors, keys[pass].back());
+        }
+        if (!readKeys[pass].empty() && (readKeys[pass][0] || readKeys[pass][1]))
+        {
+            std::vector<uint32_t> colors;
+            if (readKeys[pass][0])
+                colors.push_back(readKeys[pass][0]);
+            node.readFramebuffer = GetFramebuffer(readKeys[pass], colors, readKeys[pass][1]);
+        }
+    }
+
+    // --- Discards: transient attachments nobody reads after this pass ---
+
+    for (uint32_t position = 0; position < m_Order.size(); position++)
+    {
+        PassNode &node = m_Passes[m_Order[position]];
+        for (uint32_t i = 0; i < node.colors.size(); i++)
+        {
+            const ResourceNode &resource = m_Resources[node.colors[i].resource.index];
+            if (resource.kind == ResourceKind::Transient && resource.lastUse == position)
+                node.discards.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+        if (node.depth.resource.IsValid())
+        {
+            const ResourceNode &resource = m_Resources[node.depth.resource.index];
+            if (resource.kind == ResourceKind::Transient && resource.lastUse == position)
+                node.discards.push_back(PixelFormat::Get(resource.desc.format).stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT);
+        }
+    }
+
+    m_Compiled = true;
+}
+
+void RenderGraph::AllocateTextures()
+{
+    struct Slot
+    {
+        RenderTargetDesc desc;
+        uint32_t lastUse;
+        int32_t pooled;
+    };
+
+    // Transient resources used by the remaining passes, by first use
+    std::vector<uint32_t> transients;
+    for (uint32_t i = 0; i < m_Resources.size(); i++)
+    {
+        if (m_Resources[i].kind == ResourceKind::Transient && m_Resources[i].firstUse != UINT32_MAX)
+            transients.push_back(i);
+    }
+    std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b) {
+        return m_Resources[a].firstUse < m_Resources[b].firstUse;
+    });
+
+    // Greedy interval assignment: reuse a texture of the same kind whose last user already ran
+    std::vector<Slot> slots;
+    std::vector<uint32_t> slotOf(m_Resources.size(), UINT32_MAX);
+    for (uint32_t index : transients)
+    {
+        const ResourceNode &resource = m_Resources[index];
+        m_Stats.transientBytes += (uint64_t)resource.desc.width * resource.desc.height * PixelFormat::Get(resource.desc.format).bytesPerPixel;
+
+        uint32_t slot = 0;
+        while (slot < slots.size() && !(slots[slot].desc == resource.desc && slots[slot].lastUse < resource.firstUse))
+            slot++;
+        if (slot == slots.size())
+            slots.push_back({resource.desc, 0, -1});
+
+        slots[slot].lastUse = resource.lastUse;
+        slotOf[index] = slot;
+    }
+    m_Stats.transientCount = (uint32_t)transients.size();
+    m_Stats.textureCount = (uint32_t)slots.size();
+
+    // Back the slots with textures from the pool, create the missing ones and free the leftovers
+    for (PooledTexture &pooled : m_TexturePool)
+        pooled.used = false;
+
+    for (Slot &slot : slots)
+    {
+        for (uint32_t i = 0; i < m_TexturePool.size() && slot.pooled < 0; i++)
+        {
+            if (!m_TexturePool[i].used && m_TexturePool[i].desc == slot.desc)
+                slot.pooled = (int32_t)i;
+        }
+        if (slot.pooled < 0)
+        {
+            m_TexturePool.push_back({slot.desc, std::unique_ptr<Texture>(new Texture(slot.desc.width, slot.desc.height, slot.desc.format)), false});
+            slot.pooled = (int32_t)m_TexturePool.size() - 1;
+        }
+        m_TexturePool[slot.pooled].used = true;
+        m_Stats.textureBytes += (uint64_t)slot.desc.width * slot.desc.height * PixelFormat::Get(slot.desc.format).bytesPerPixel;
+    }
+
+    for (uint32_t index : transients)
+        m_Resources[index].texture = m_TexturePool[slots[slotOf[index]].pooled].texture->GetHandle();
+
+    // Erasing shifts the pool, so this must happen after the handles were taken
+    m_TexturePool.erase(std::remove_if(m_TexturePool.begin(), m_TexturePool.end(),
+                                       [](const PooledTexture &pooled) { return !pooled.used; }),
+                        m_TexturePool.end());
+}
+
+uint32_t RenderGraph::GetFramebuffer(const std::vector<uint32_t> &key, const std::vector<uint32_t> &colors, uint32_t depth)
+{
+    for (uint32_t i = 0; i < m_Framebuffers.size(); i++)
+    {
+        if (m_Framebuffers[i].key == key)
+            return i;
+    }
+
+    auto findDesc = [this](uint32_t handle) -> const RenderTargetDesc & {
+        for (const ResourceNode &resource : m_Resources)
+        {
+            if (resource.texture.value == handle)
+                return resource.desc;
+        }
+        throw std::runtime_error("Render graph texture without a resource");
+    };
+
+    std::unique_ptr<Framebuffer> framebuffer(new Framebuffer());
+    for (uint32_t i = 0; i < colors.size(); i++)
+    {
+        const RenderTargetDesc &desc = findDesc(colors[i]);
+        framebuffer->AttachColor(i, ResourceHandle{colors[i]}, desc.width, desc.height);
+    }
+    if (depth)
+    {
+        const RenderTargetDesc &desc = findDesc(depth);
+        framebuffer->AttachDepth(ResourceHandle{depth}, desc.width, desc.height, PixelFormat::Get(desc.format).stencil);
+    }
+    framebuffer->Validate();
+
+    m_Framebuffers.push_back({key, std::move(framebuffer), true});
+    return (uint32_t)m_Framebuffers.size() - 1;
+}
+
+uint32_t RenderGraph::GetTextureID(RenderResource resource) const
+{
+    return ResourceRegistry::Get().GetRendererID(m_Resources[resource.index].texture);
+}
+
+void RenderGraph::Execute() const
+{
+    if (!m_Compiled)
+        throw std::runtime_error("RenderGraph::Execute() called without Compile()");
+
+    for (uint32_t pass : m_Order)
+    {
+        const PassNode &node = m_Passes[pass];
+        int width = 0, height = 0;
+
+        if (node.framebuffer != NO_PASS)
+        {
+            const Framebuffer &framebuffer = *m_Framebuffers[node.framebuffer].framebuffer;
+            framebuffer.Bind();
+            width = framebuffer.GetWidth();
+            height = framebuffer.GetHeight();
+        }
+        else if (!node.colors.empty())
+        {
+            // Backbuffer
+            const RenderTargetDesc &desc = m_Resources[node.colors[0].resource.index].desc;
+            width = desc.width;
+            height = desc.height;
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, width, height);
+        }
+
+        if (node.blit)
+        {
+            const ResourceNode &source = m_Resources[node.reads[0].index];
+            bool depth = PixelFormat::Get(source.desc.format).depth;
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, node.readFramebuffer == NO_PASS ? 0 : m_Framebuffers[node.readFramebuffer].framebuffer->GetRendererID());
+            glBlitFramebuffer(0, 0, source.desc.width, source.desc.height, 0, 0, width, height,
+                              depth ? GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT, depth ? GL_NEAREST : node.blitFilter);
+        }
+        else
+        {
+            // glClearBuffer* only touches the attachments asked for, unlike glClear.
+            // Note that they respect the write masks (glColorMask, glDepthMask).
+            for (uint32_t i = 0; i < node.colors.size(); i++)
+            {
+                if (node.colors[i].load == LoadOp::Clear)
+                    glClearBufferfv(GL_COLOR, i, node.clearColor);
+            }
+            if (node.depth.resource.IsValid() && node.depth.load == LoadOp::Clear)
+            {
+                if (PixelFormat::Get(m_Resources[node.depth.resource.index].desc.format).stencil)
+                    glClearBufferfi(GL_DEPTH_STENCIL, 0, node.clearDepth, 0);
+                else
+                    glClearBufferfv(GL_DEPTH, 0, &node.clearDepth);
+            }
+
+            if (node.execute)
+                node.execute(RenderPassContext(*this, pass, width, height));
+        }
+
+        if (!node.discards.empty() && GLEW_ARB_invalidate_subdata)
+            glInvalidateFramebuffer(GL_FRAMEBUFFER, (GLsizei)node.discards.size(), node.discards.data());
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void RenderGraph::Reset()
+{
+    m_Resources.clear();
+    m_Passes.clear();
+    m_Order.clear();
+    m_Compiled = false;
+    m_Stats = RenderGraphStats();
+}
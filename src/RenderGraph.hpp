@@ -0,0 +1,240 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Framebuffer.hpp"
+#include "ResourceRegistry.hpp"
+#include "Texture.hpp"
+
+// A texture of the graph, at a given version. Every write makes a new version, so a handle
+// always refers to well defined contents and passes can only be ordered one way.
+struct RenderResource
+{
+    uint32_t index = UINT32_MAX;
+    uint32_t version = 0;
+
+    inline bool IsValid() const { return index != UINT32_MAX; }
+};
+
+struct RenderTargetDesc
+{
+    int width;
+    int height;
+    uint32_t format; // Sized internal format (GL_RGBA8, GL_RGBA16F, GL_DEPTH24_STENCIL8, ...)
+
+    inline bool operator==(const RenderTargetDesc &other) const
+    {
+        return width == other.width && height == other.height && format == other.format;
+    }
+};
+
+// What happens to the previous contents of an attachment when a pass starts writing it
+enum class LoadOp
+{
+    Load,     // Keep them (the pass draws on top of the previous version)
+    Clear,    // Clear to the pass clear color/depth
+    DontCare, // The pass overwrites every pixel: no clear, and no dependency on the previous version
+};
+
+class RenderGraph;
+
+// Passed to the setup function of a pass to declare what it reads and writes.
+// Write/WriteDepth return the new version of the resource, to be read by later passes.
+class RenderPassBuilder
+{
+public:
+    // The texture is sampled by the pass (see RenderPassContext::BindTexture)
+    void Read(RenderResource resource);
+
+    // Color attachment, in order (the first call is attachment 0)
+    RenderResource Write(RenderResource resource, LoadOp load = LoadOp::Load);
+    RenderResource WriteDepth(RenderResource resource, LoadOp load = LoadOp::Load);
+
+    void SetClearColor(float r, float g, float b, float a);
+    void SetClearDepth(float depth);
+
+    // The pass has effects the graph can't see (e.g. it writes a buffer), so it is never culled
+    void SetSideEffect();
+
+private:
+    friend class RenderGraph;
+    RenderPassBuilder(RenderGraph &graph, uint32_t pass)
+        : m_Graph(graph), m_Pass(pass)
+    {
+    }
+
+    RenderGraph &m_Graph;
+    uint32_t m_Pass;
+};
+
+// Given to the execute function of a pass, with its framebuffer already bound and cleared
+class RenderPassContext
+{
+public:
+    // OpenGL texture of a resource the pass declared with Read()
+    uint32_t GetTexture(RenderResource resource) const;
+    void BindTexture(RenderResource resource, uint32_t slot) const;
+
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+
+private:
+    friend class RenderGraph;
+    RenderPassContext(const RenderGraph &graph, uint32_t pass, int width, int height)
+        : m_Graph(graph), m_Pass(pass), m_Width(width), m_Height(height)
+    {
+    }
+
+    const RenderGraph &m_Graph;
+    uint32_t m_Pass;
+    int m_Width, m_Height;
+};
+
+struct RenderGraphStats
+{
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+    uint32_t transientCount = 0; // Transient textures used by the remaining passes
+    uint32_t textureCount = 0;   // Actual textures behind them
+    uint64_t transientBytes = 0; // What the transient textures would take without aliasing
+    uint64_t textureBytes = 0;   // What they take
+};
+
+// Describes a frame as passes that read and write textures, instead of a fixed sequence of draws.
+//
+// Compile() works out from the declarations:
+// - which passes are needed: only those contributing to an imported texture, the backbuffer or
+//   a pass with side effects. The others are culled and never run.
+// - the order: each pass runs right before the first pass that needs its output, which keeps
+//   the lifetimes of the transient textures short.
+// - the textures: transient textures (CreateTexture) whose lifetimes don't overlap share the
+//   same GL texture when their size and format match, e.g. the ping-pong targets of a blur chain.
+//   Attachments whose contents are not read afterwards (typically depth) are invalidated at
+//   the end of the pass, so the driver doesn't have to store them.
+//
+// The graph is compiled once and executed every frame. Textures and framebuffers are kept
+// across Reset() so rebuilding the graph (e.g. when the window is resized) reuses what still fits.
+class RenderGraph
+{
+public:
+    using SetupFunction = std::function<void(RenderPassBuilder &builder)>;
+    using ExecuteFunction = std::function<void(const RenderPassContext &context)>;
+
+    RenderGraph() = default;
+    RenderGraph(const RenderGraph &) = delete;
+    RenderGraph &operator=(const RenderGraph &) = delete;
+
+    // Texture owned by the graph, only valid during the frame
+    RenderResource CreateTexture(const std::string &name, const RenderTargetDesc &desc);
+
+    // Texture owned by someone else, its contents are kept after the frame
+    RenderResource ImportTexture(const std::string &name, const Texture &texture);
+
+    // The default framebuffer (the window)
+    RenderResource ImportBackbuffer(const std::string &name, int width, int height);
+
+    // The setup function runs right away, execute runs in Execute() if the pass is not culled
+    uint32_t AddPass(const std::string &name, const SetupFunction &setup, ExecuteFunction execute);
+
+    // Copies source into destination (scaled to its size) with glBlitFramebuffer
+    RenderResource AddBlitPass(const std::string &name, RenderResource source, RenderResource destination, uint32_t filter = GL_NEAREST);
+
+    void Compile();
+    void Execute() const;
+
+    // Removes every pass and resource, keeps the textures and framebuffers for the next Compile()
+    void Reset();
+
+    inline const RenderGraphStats &GetStats() const { return m_Stats; }
+    inline const std::vector<uint32_t> &GetExecutionOrder() const { return m_Order; }
+    inline const std::string &GetPassName(uint32_t pass) const { return m_Passes[pass].name; }
+    inline bool IsPassCulled(uint32_t pass) const { return !m_Passes[pass].needed; }
+
+private:
+    friend class RenderPassBuilder;
+    friend class RenderPassContext;
+
+    static constexpr uint32_t NO_PASS = UINT32_MAX;
+
+    enum class ResourceKind
+    {
+        Transient,
+        Imported,
+        Backbuffer,
+    };
+
+    struct ResourceNode
+    {
+        std::string name;
+        RenderTargetDesc desc;
+        ResourceKind kind;
+        ResourceHandle texture;             // Imported texture, or after Compile() the pooled one
+        std::vector<uint32_t> producers;    // Pass that wrote each version (NO_PASS for version 0)
+        uint32_t firstUse, lastUse;         // In execution order
+    };
+
+    struct Attachment
+    {
+        RenderResource resource; // The version written by the pass
+        LoadOp load;
+    };
+
+    struct PassNode
+    {
+        std::string name;
+        std::vector<RenderResource> reads;
+        std::vector<Attachment> colors;
+        Attachment depth;
+        float clearColor[4];
+        float clearDepth;
+        bool sideEffect;
+        bool blit;
+        uint32_t blitFilter;
+        ExecuteFunction execute;
+
+        // Filled by Compile()
+        bool needed;
+        uint32_t framebuffer;     // Index in m_Framebuffers, NO_PASS for the backbuffer
+        uint32_t readFramebuffer; // Blit source
+        std::vector<uint32_t> discards;
+    };
+
+    struct PooledTexture
+    {
+        RenderTargetDesc desc;
+        std::unique_ptr<Texture> texture;
+        bool used;
+    };
+
+    struct CachedFramebuffer
+    {
+        std::vector<uint32_t> key; // Texture handles (depth last), so the same attachments reuse the same FBO
+        std::unique_ptr<Framebuffer> framebuffer;
+        bool used;
+    };
+
+    RenderResource AddResource(const std::string &name, const RenderTargetDesc &desc, ResourceKind kind, ResourceHandle texture);
+    RenderResource WriteResource(uint32_t pass, RenderResource resource, LoadOp load);
+    void GetDependencies(uint32_t pass, bool includeWriteAfterRead, std::vector<uint32_t> &dependencies) const;
+    void Visit(uint32_t pass, std::vector<uint8_t> &state);
+    void AllocateTextures();
+    uint32_t GetFramebuffer(const std::vector<uint32_t> &key, const std::vector<uint32_t> &colors, uint32_t depth);
+    uint32_t GetTextureID(RenderResource resource) const;
+
+private:
+    std::vector<ResourceNode> m_Resources;
+    std::vector<PassNode> m_Passes;
+    std::vector<uint32_t> m_Order;
+    bool m_Compiled = false;
+    RenderGraphStats m_Stats;
+
+    // Kept across Reset()
+    std::vector<PooledTexture> m_TexturePool;
+    std::vector<CachedFramebuffer> m_Framebuffers;
+};
@@ -5,21 +5,96 @@
 #include "VertexArray.hpp"
 #include "IndexBuffer.hpp"
 #include "Shader.hpp"
+#include "ResourceRegistry.hpp"
+
+// Everything needed for one draw call, as 32-bit resource handles instead of references
+// (16 bytes, so lists of them are cheap to build, copy and sort).
+struct DrawCommand
+{
+    ResourceHandle vertexArray;
+    ResourceHandle indexBuffer;
+    ResourceHandle shader;
+    uint32_t indexCount;
+
+    static DrawCommand Create(const VertexArray &vao, const IndexBuffer &ibo, const Shader &shader)
+    {
+        return {vao.GetHandle(), ibo.GetHandle(), shader.GetHandle(), ibo.GetCount()};
+    }
+};
+
+// Work submitted through a Renderer since its last ResetStats()
+struct RendererStats
+{
+    uint32_t drawCalls = 0;
+    uint32_t vertexArrayBinds = 0; // Including the index buffer that goes with the vertex array
+    uint32_t shaderBinds = 0;
+};
 
 class Renderer
 {
 public:
     void Draw(const VertexArray& vao, const IndexBuffer& ibo, const Shader& shader) const 
     {
+        m_Stats.drawCalls++;
+        m_Stats.vertexArrayBinds++;
+        m_Stats.shaderBinds++;
         vao.Bind();
         ibo.Bind();
         shader.Bind();
         glDrawElements(GL_TRIANGLES, ibo.GetCount(), GL_UNSIGNED_INT, 0);
     }
 
+    void Draw(const DrawCommand& command) const
+    {
+        m_Stats.drawCalls++;
+        m_Stats.vertexArrayBinds++;
+        m_Stats.shaderBinds++;
+        const ResourceRegistry& registry = ResourceRegistry::Get();
+        glBindVertexArray(registry.GetRendererID(command.vertexArray));
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, registry.GetRendererID(command.indexBuffer));
+        glUseProgram(registry.GetRendererID(command.shader));
+        glDrawElements(GL_TRIANGLES, command.indexCount, GL_UNSIGNED_INT, 0);
+    }
+
+    // Draws instanceCount copies of the first vertexCount vertices (e.g. a quad per glyph, see TextRenderer)
+    void DrawInstanced(const VertexArray& vao, const Shader& shader, uint32_t mode, uint32_t vertexCount, uint32_t instanceCount) const
+    {
+        m_Stats.drawCalls++;
+        m_Stats.vertexArrayBinds++;
+        m_Stats.shaderBinds++;
+        vao.Bind();
+        shader.Bind();
+        glDrawArraysInstanced(mode, 0, vertexCount, instanceCount);
+    }
+
+    // Runs the vertex shader of a transform feedback program (see Shader) over vertexCount points, and
+    // writes its outputs to destination instead of rasterizing anything
+    void DrawTransformFeedback(const VertexArray& vao, const Shader& shader, uint32_t vertexCount, const VertexBuffer& destination) const
+    {
+        m_Stats.drawCalls++;
+        m_Stats.vertexArrayBinds++;
+        m_Stats.shaderBinds++;
+        vao.Bind();
+        shader.Bind(); // Can't change while transform feedback is active
+
+        glEnable(GL_RASTERIZER_DISCARD);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, ResourceRegistry::Get().GetRendererID(destination.GetHandle()));
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArrays(GL_POINTS, 0, vertexCount);
+        glEndTransformFeedback();
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glDisable(GL_RASTERIZER_DISCARD);
+    }
+
     void Clear() const 
     {
         glClear(GL_COLOR_BUFFER_BIT);
     }
+
+    inline const RendererStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = RendererStats(); }
+
 private:
+    // Counting doesn't change what is drawn, so the const drawing functions may update it
+    mutable RendererStats m_Stats;
 };
\ No newline at end of file
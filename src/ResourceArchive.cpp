@@ -0,0 +1,224 @@
+#include "ResourceArchive.hpp"
+#include "LZ4.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ARCHIVE_MMAP 1
+#endif
+
+using namespace std::string_literals;
+
+static int ComparePaths(const char *a, size_t aLength, const char *b, size_t bLength)
+{
+    int result = memcmp(a, b, aLength < bLength ? aLength : bLength);
+    return result != 0 ? result : aLength < bLength ? -1 : aLength > bLength ? 1 : 0;
+}
+
+// --- ResourceArchive ---
+
+ResourceArchive::ResourceArchive(const std::string &path)
+    : m_Path(path), m_Data(nullptr), m_Size(0), m_Mapped(false), m_Entries(nullptr), m_Names(nullptr)
+{
+#ifdef ARCHIVE_MMAP
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+        throw std::runtime_error("Could not open archive: "s + path);
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        void *mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping != MAP_FAILED)
+        {
+            m_Data = (const uint8_t *)mapping;
+            m_Size = (size_t)status.st_size;
+            m_Mapped = true;
+        }
+    }
+    close(file); // The mapping stays valid
+#else
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file)
+        throw std::runtime_error("Could not open archive: "s + path);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size > 0)
+    {
+        m_Contents.resize((size_t)size);
+        if (fread(m_Contents.data(), 1, m_Contents.size(), file) == m_Contents.size())
+        {
+            m_Data = m_Contents.data();
+            m_Size = m_Contents.size();
+        }
+    }
+    fclose(file);
+#endif
+
+    // Everything the lookups rely on is checked once here
+    bool valid = m_Data && m_Size >= sizeof(ArchiveHeader);
+    if (valid)
+    {
+        memcpy(&m_Header, m_Data, sizeof(m_Header));
+        valid = m_Header.magic == ArchiveHeader::MAGIC && m_Header.version == ArchiveHeader::VERSION &&
+                sizeof(ArchiveHeader) + (uint64_t)m_Header.entryCount * sizeof(ArchiveEntry) <= m_Size &&
+                m_Header.namesOffset <= m_Size && m_Header.namesSize <= m_Size - m_Header.namesOffset;
+    }
+    if (valid)
+    {
+        m_Entries = (const ArchiveEntry *)(m_Data + sizeof(ArchiveHeader));
+        m_Names = (const char *)m_Data + m_Header.namesOffset;
+        for (uint32_t i = 0; i < m_Header.entryCount && valid; i++)
+        {
+            const ArchiveEntry &entry = m_Entries[i];
+            // The size is what Read() allocates, it must be one the stored data can decode to
+            bool sizeValid = (entry.compression == ArchiveCompression::None && entry.storedSize == entry.size) ||
+                             (entry.compression == ArchiveCompression::LZ4 && entry.size <= LZ4DecompressBound(entry.storedSize));
+            valid = entry.offset <= m_Size && entry.storedSize <= m_Size - entry.offset &&
+                    (uint64_t)entry.nameOffset + entry.nameLength <= m_Header.namesSize && sizeValid;
+            if (valid && i > 0)
+            {
+                const ArchiveEntry &previous = m_Entries[i - 1];
+                valid = ComparePaths(m_Names + previous.nameOffset, previous.nameLength, m_Names + entry.nameOffset, entry.nameLength) < 0;
+            }
+        }
+    }
+
+    if (!valid)
+    {
+#ifdef ARCHIVE_MMAP
+        if (m_Mapped)
+            munmap((void *)m_Data, m_Size);
+#endif
+        throw std::runtime_error("Not a resource archive (or an unsupported version / corrupt): "s + path);
+    }
+}
+
+ResourceArchive::~ResourceArchive()
+{
+#ifdef ARCHIVE_MMAP
+    if (m_Mapped)
+        munmap((void *)m_Data, m_Size);
+#endif
+}
+
+const ArchiveEntry *ResourceArchive::Find(const std::string &path) const
+{
+    const ArchiveEntry *begin = m_Entries, *end = m_Entries + m_Header.entryCount;
+    const ArchiveEntry *found = std::lower_bound(begin, end, path, [this](const ArchiveEntry &entry, const std::string &path) {
+        return ComparePaths(m_Names + entry.nameOffset, entry.nameLength, path.data(), path.size()) < 0;
+    });
+    if (found == end || ComparePaths(m_Names + found->nameOffset, found->nameLength, path.data(), path.size()) != 0)
+        return nullptr;
+    return found;
+}
+
+void ResourceArchive::Read(const ArchiveEntry &entry, std::vector<uint8_t> &contents) const
+{
+    contents.resize(entry.size);
+    const uint8_t *stored = GetStoredData(entry);
+    if (entry.compression == ArchiveCompression::None)
+        memcpy(contents.data(), stored, entry.size);
+    else if (!LZ4Decompress(stored, entry.storedSize, contents.data(), entry.size))
+        throw std::runtime_error("Corrupt entry " + GetEntryPath(entry) + " in archive " + m_Path);
+}
+
+// --- ResourceArchiveWriter ---
+
+void ResourceArchiveWriter::Add(const std::string &path, const void *data, size_t size, bool compress)
+{
+    if (path.size() > UINT16_MAX)
+        throw std::runtime_error("Path too long for an archive: " + path);
+
+    PendingEntry entry;
+    entry.path = path;
+    entry.size = size;
+    entry.compression = ArchiveCompression::None;
+
+    if (compress && size > 0)
+    {
+        entry.data.resize(LZ4CompressBound(size));
+        size_t compressedSize = LZ4Compress(data, size, entry.data.data(), entry.data.size());
+        if (compressedSize > 0 && compressedSize <= size - size / 8)
+        {
+            entry.data.resize(compressedSize);
+            entry.compression = ArchiveCompression::LZ4;
+        }
+    }
+    if (entry.compression == ArchiveCompression::None)
+        entry.data.assign((const uint8_t *)data, (const uint8_t *)data + size);
+
+    m_Entries.push_back(std::move(entry));
+}
+
+void ResourceArchiveWriter::Write(const std::string &path, uint32_t alignment)
+{
+    if (alignment == 0 || alignment > 4096 || (alignment & (alignment - 1)) != 0)
+        throw std::runtime_error("The alignment of an archive must be a power of 2, up to 4096");
+
+    std::sort(m_Entries.begin(), m_Entries.end(), [](const PendingEntry &a, const PendingEntry &b) { return a.path < b.path; });
+    for (size_t i = 1; i < m_Entries.size(); i++)
+    {
+        if (m_Entries[i].path == m_Entries[i - 1].path)
+            throw std::runtime_error("Two archive entries have the path " + m_Entries[i].path);
+    }
+
+    ArchiveHeader header;
+    header.entryCount = (uint32_t)m_Entries.size();
+    header.alignment = alignment;
+    header.namesOffset = sizeof(ArchiveHeader) + m_Entries.size() * sizeof(ArchiveEntry);
+
+    std::string names;
+    std::vector<ArchiveEntry> entries(m_Entries.size());
+    for (size_t i = 0; i < m_Entries.size(); i++)
+    {
+        entries[i].nameOffset = (uint32_t)names.size();
+        entries[i].nameLength = (uint16_t)m_Entries[i].path.size();
+        names += m_Entries[i].path;
+    }
+    header.namesSize = names.size();
+
+    auto align = [alignment](uint64_t offset) { return (offset + alignment - 1) & ~(uint64_t)(alignment - 1); };
+    uint64_t offset = align(header.namesOffset + header.namesSize);
+    for (size_t i = 0; i < m_Entries.size(); i++)
+    {
+        entries[i].offset = offset;
+        entries[i].size = m_Entries[i].size;
+        entries[i].storedSize = m_Entries[i].data.size();
+        entries[i].compression = m_Entries[i].compression;
+        entries[i].reserved = 0;
+        offset = align(offset + entries[i].storedSize);
+    }
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file)
+        throw std::runtime_error("Could not create archive: "s + path);
+
+    static const uint8_t padding[4096] = {};
+    uint64_t written = 0;
+    auto write = [&](const void *data, size_t size) {
+        written += size;
+        return fwrite(data, 1, size, file) == size;
+    };
+    auto pad = [&]() { return write(padding, (size_t)(align(written) - written)); };
+
+    bool ok = write(&header, sizeof(header)) && write(entries.data(), entries.size() * sizeof(ArchiveEntry)) && write(names.data(), names.size());
+    for (size_t i = 0; i < m_Entries.size() && ok; i++)
+        ok = pad() && write(m_Entries[i].data.data(), m_Entries[i].data.size());
+    ok = fclose(file) == 0 && ok;
+
+    if (!ok)
+        throw std::runtime_error("Could not write archive: "s + path);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Layout of an archive: the header, the table of contents (entryCount ArchiveEntry, sorted by path),
+// the paths, then the data of each entry at a multiple of the alignment. Little endian.
+struct ArchiveHeader
+{
+    static constexpr uint32_t MAGIC = 0x4b415052; // "RPAK"
+    static constexpr uint32_t VERSION = 1;
+
+    uint32_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t entryCount = 0;
+    uint32_t alignment = 0;   // Of the data of every entry
+    uint64_t namesOffset = 0; // The paths, one after the other (no terminating zeros)
+    uint64_t namesSize = 0;
+};
+
+enum class ArchiveCompression : uint8_t
+{
+    None,
+    LZ4, // One LZ4 block (see LZ4.hpp)
+};
+
+struct ArchiveEntry
+{
+    uint64_t offset;     // Of the data, from the start of the archive
+    uint64_t size;       // Of the file
+    uint64_t storedSize; // In the archive (size when not compressed)
+    uint32_t nameOffset; // In the paths
+    uint16_t nameLength;
+    ArchiveCompression compression;
+    uint8_t reserved;
+};
+
+// Read-only access to an archive of resource files (see bin/pack-archive), usually through the
+// VirtualFileSystem.
+//
+// The archive is mapped in memory rather than read: opening it is one open() and one mmap(), and
+// the pages of an entry are only read from disk when it is used. Uncompressed entries are used in
+// place (GetStoredData()), compressed ones are decompressed straight from the mapping. A path is
+// found with a binary search of the table of contents.
+class ResourceArchive
+{
+public:
+    // Throws std::runtime_error if the file can't be opened or isn't a valid archive
+    explicit ResourceArchive(const std::string &path);
+    ~ResourceArchive();
+
+    ResourceArchive(const ResourceArchive &) = delete;
+    ResourceArchive &operator=(const ResourceArchive &) = delete;
+
+    // nullptr if the archive has no such path. Paths are compared as is (see VirtualFileSystem::NormalizePath()).
+    const ArchiveEntry *Find(const std::string &path) const;
+
+    // The bytes of the entry in the archive, compressed if the entry is
+    inline const uint8_t *GetStoredData(const ArchiveEntry &entry) const { return m_Data + entry.offset; }
+
+    // The contents of the entry, decompressed if needed. Throws std::runtime_error if they are corrupt.
+    void Read(const ArchiveEntry &entry, std::vector<uint8_t> &contents) const;
+
+    inline uint32_t GetEntryCount() const { return m_Header.entryCount; }
+    inline const ArchiveEntry &GetEntry(uint32_t index) const { return m_Entries[index]; }
+    inline std::string GetEntryPath(const ArchiveEntry &entry) const { return std::string(m_Names + entry.nameOffset, entry.nameLength); }
+
+    inline const std::string &GetPath() const { return m_Path; }
+    inline size_t GetSize() const { return m_Size; }
+
+private:
+    std::string m_Path;
+    const uint8_t *m_Data;
+    size_t m_Size;
+    bool m_Mapped;
+    std::vector<uint8_t> m_Contents; // The whole archive, where it can't be mapped
+
+    ArchiveHeader m_Header;
+    const ArchiveEntry *m_Entries;
+    const char *m_Names;
+};
+
+// Builds an archive: add the files, then write it
+class ResourceArchiveWriter
+{
+public:
+    static constexpr uint32_t DEFAULT_ALIGNMENT = 64; // A cache line, enough for any SIMD load
+
+    // Entries are only stored compressed when it saves at least an eighth of their size
+    // (already compressed files, e.g. PNGs, are stored as is)
+    void Add(const std::string &path, const void *data, size_t size, bool compress = true);
+
+    // Throws std::runtime_error if the file can't be written, or two entries have the same path
+    void Write(const std::string &path, uint32_t alignment = DEFAULT_ALIGNMENT);
+
+    inline size_t GetEntryCount() const { return m_Entries.size(); }
+
+private:
+    struct PendingEntry
+    {
+        std::string path;
+        std::vector<uint8_t> data; // As stored
+        uint64_t size;
+        ArchiveCompression compression;
+    };
+
+    std::vector<PendingEntry> m_Entries;
+};
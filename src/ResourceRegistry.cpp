@@ -0,0 +1,153 @@
+#include <GL/glew.h>
+
+#include "ResourceRegistry.hpp"
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+ResourceRegistry &ResourceRegistry::Get()
+{
+    static ResourceRegistry registry;
+    return registry;
+}
+
+ResourceHandle ResourceRegistry::Register(ResourceType type, uint32_t rendererID)
+{
+    uint32_t index;
+    if (m_FreeSlot != UINT32_MAX)
+    {
+        index = m_FreeSlot;
+        m_FreeSlot = m_Slots[index].denseIndex;
+    }
+    else
+    {
+        if (m_Slots.size() > ResourceHandle::INDEX_MASK)
+            throw std::runtime_error("Too many GPU resources");
+
+        index = (uint32_t)m_Slots.size();
+        m_Slots.push_back({1, 0});
+    }
+
+    Slot &slot = m_Slots[index];
+    slot.denseIndex = (uint32_t)m_RendererIDs.size();
+    m_RendererIDs.push_back(rendererID);
+    m_Types.push_back(type);
+    m_SlotOf.push_back(index);
+
+    ResourceHandle handle;
+    handle.value = (slot.generation << ResourceHandle::INDEX_BITS) | index;
+    return handle;
+}
+
+void ResourceRegistry::Release(ResourceHandle handle)
+{
+    if (!IsValid(handle))
+        return;
+
+    uint32_t index = handle.GetIndex();
+    Slot &slot = m_Slots[index];
+    uint32_t dense = slot.denseIndex;
+
+    m_PendingDeletes[m_FrameSlot].push_back({m_Types[dense], m_RendererIDs[dense]});
+
+    // Keep the dense arrays packed by moving the last object into the hole
+    uint32_t last = (uint32_t)m_RendererIDs.size() - 1;
+    if (dense != last)
+    {
+        m_RendererIDs[dense] = m_RendererIDs[last];
+        m_Types[dense] = m_Types[last];
+        m_SlotOf[dense] = m_SlotOf[last];
+        m_Slots[m_SlotOf[dense]].denseIndex = dense;
+    }
+    m_RendererIDs.pop_back();
+    m_Types.pop_back();
+    m_SlotOf.pop_back();
+
+    // Bumping the generation invalidates every copy of the handle.
+    // Generation 0 is skipped, so a handle value of 0 is never valid.
+    slot.generation = slot.generation == ResourceHandle::MAX_GENERATION ? 1 : slot.generation + 1;
+    slot.denseIndex = m_FreeSlot;
+    m_FreeSlot = index;
+}
+
+bool ResourceRegistry::IsValid(ResourceHandle handle) const
+{
+    uint32_t index = handle.GetIndex();
+    return !handle.IsNull() && index < m_Slots.size() && m_Slots[index].generation == handle.GetGeneration();
+}
+
+ResourceType ResourceRegistry::GetType(ResourceHandle handle) const
+{
+    if (!IsValid(handle))
+        throw std::runtime_error("Stale resource handle");
+    return m_Types[m_Slots[handle.GetIndex()].denseIndex];
+}
+
+void ResourceRegistry::BeginFrame(uint32_t frameSlot)
+{
+    if (frameSlot >= m_FramesInFlight)
+        throw std::runtime_error("Frame slot " + std::to_string(frameSlot) + " out of range");
+
+    // The fence of the frame that filled this queue has been waited on by the pacer
+    m_FrameSlot = frameSlot;
+    DeleteQueue(m_PendingDeletes[m_FrameSlot]);
+}
+
+void ResourceRegistry::Flush()
+{
+    for (std::vector<PendingDelete> &queue : m_PendingDeletes)
+        DeleteQueue(queue);
+}
+
+void ResourceRegistry::SetFramesInFlight(uint32_t framesInFlight)
+{
+    if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT)
+        throw std::runtime_error("Frames in flight must be between 1 and " + std::to_string(MAX_FRAMES_IN_FLIGHT));
+
+    // Pending objects are from the old frame numbering, just delete them
+    Flush();
+    m_FramesInFlight = framesInFlight;
+    m_FrameSlot = 0;
+}
+
+uint32_t ResourceRegistry::GetPendingDeleteCount() const
+{
+    uint32_t count = 0;
+    for (const std::vector<PendingDelete> &queue : m_PendingDeletes)
+        count += (uint32_t)queue.size();
+    return count;
+}
+
+void ResourceRegistry::DeleteQueue(std::vector<PendingDelete> &queue)
+{
+    for (const PendingDelete &object : queue)
+        DeleteObject(object);
+    queue.clear();
+}
+
+void ResourceRegistry::DeleteObject(const PendingDelete &object)
+{
+    switch (object.type)
+    {
+    case ResourceType::Buffer:
+        glDeleteBuffers(1, &object.rendererID);
+        break;
+    case ResourceType::VertexArray:
+        glDeleteVertexArrays(1, &object.rendererID);
+        break;
+    case ResourceType::Program:
+        glDeleteProgram(object.rendererID);
+        break;
+    case ResourceType::Texture:
+        glDeleteTextures(1, &object.rendererID);
+        break;
+    case ResourceType::Framebuffer:
+        glDeleteFramebuffers(1, &object.rendererID);
+        break;
+    case ResourceType::Renderbuffer:
+        glDeleteRenderbuffers(1, &object.rendererID);
+        break;
+    }
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+#include "FramePacer.hpp"
+
+// Kind of OpenGL object behind a handle (decides which glDelete* is called)
+enum class ResourceType : uint8_t
+{
+    Buffer,
+    VertexArray,
+    Program,
+    Texture,
+    Framebuffer,
+    Renderbuffer,
+};
+
+// 32-bit generational handle to an OpenGL object.
+//
+// The low bits index a slot in the registry, the high bits hold the generation of that slot.
+// When an object is released its slot's generation is bumped, so stale handles are detected
+// instead of silently pointing to whatever object reuses the slot later.
+// Handles are plain values: cheap to copy and small enough to fill draw command structs with.
+struct ResourceHandle
+{
+    static constexpr uint32_t INDEX_BITS = 20;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+    static constexpr uint32_t MAX_GENERATION = (1u << (32 - INDEX_BITS)) - 1;
+
+    uint32_t value = 0; // 0 is never a valid handle (generations start at 1)
+
+    inline uint32_t GetIndex() const { return value & INDEX_MASK; }
+    inline uint32_t GetGeneration() const { return value >> INDEX_BITS; }
+    inline bool IsNull() const { return value == 0; }
+
+    inline bool operator==(const ResourceHandle &other) const { return value == other.value; }
+    inline bool operator!=(const ResourceHandle &other) const { return value != other.value; }
+};
+
+// Owns every OpenGL object created by the wrappers (VertexBuffer, IndexBuffer, VertexArray, Shader, Texture, Framebuffer, ...).
+//
+// - Slots (indexed by the handle) point into dense arrays with the live objects, so a lookup is
+//   two array accesses and iterating over all objects touches contiguous memory.
+// - Released objects are not deleted right away: they are queued with the frame slot being recorded
+//   (FramePacer::GetFrameSlot()) and deleted when that slot comes back, after FramePacer::BeginFrame()
+//   has waited for the GPU to finish the frame that released them (see BeginFrame).
+//
+// Like the GL context itself, the registry must only be used from the thread that owns the context.
+class ResourceRegistry
+{
+public:
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = FramePacer::MAX_FRAMES_IN_FLIGHT;
+
+    static ResourceRegistry &Get();
+
+    ResourceHandle Register(ResourceType type, uint32_t rendererID);
+
+    // Invalidates the handle now, deletes the GL object a few frames later
+    void Release(ResourceHandle handle);
+
+    bool IsValid(ResourceHandle handle) const;
+
+    // OpenGL name of the object, or 0 if the handle is stale
+    inline uint32_t GetRendererID(ResourceHandle handle) const
+    {
+        uint32_t index = handle.GetIndex();
+        if (index >= m_Slots.size() || m_Slots[index].generation != handle.GetGeneration())
+            return 0;
+        return m_RendererIDs[m_Slots[index].denseIndex];
+    }
+
+    ResourceType GetType(ResourceHandle handle) const;
+
+    // Call right after FramePacer::BeginFrame(), with its GetFrameSlot(): deletes the objects released
+    // the last time this slot was recorded, which the GPU is done with, then queues the new releases to it
+    void BeginFrame(uint32_t frameSlot);
+
+    // Deletes every pending object right away (e.g. before destroying the GL context)
+    void Flush();
+
+    void SetFramesInFlight(uint32_t framesInFlight);
+    inline uint32_t GetFramesInFlight() const { return m_FramesInFlight; }
+
+    inline uint32_t GetLiveCount() const { return (uint32_t)m_RendererIDs.size(); }
+    uint32_t GetPendingDeleteCount() const;
+
+private:
+    ResourceRegistry() = default;
+
+    struct Slot
+    {
+        uint32_t generation;
+        uint32_t denseIndex; // Next free slot, while the slot is free
+    };
+
+    struct PendingDelete
+    {
+        ResourceType type;
+        uint32_t rendererID;
+    };
+
+    static void DeleteObject(const PendingDelete &object);
+    void DeleteQueue(std::vector<PendingDelete> &queue);
+
+private:
+    std::vector<Slot> m_Slots;
+    uint32_t m_FreeSlot = UINT32_MAX;
+
+    // Dense arrays, one entry per live object
+    std::vector<uint32_t> m_RendererIDs;
+    std::vector<ResourceType> m_Types;
+    std::vector<uint32_t> m_SlotOf;
+
+    // One destruction queue per frame slot
+    std::array<std::vector<PendingDelete>, MAX_FRAMES_IN_FLIGHT> m_PendingDeletes;
+    uint32_t m_FramesInFlight = 2;
+    uint32_t m_FrameSlot = 0;
+};
+
+// Move-only owner of a registered GL object: releases it when destroyed, can't be copied
+// (so there is no double delete), and moving just transfers the handle.
+// The GL wrappers hold one of these instead of a raw GL name.
+class UniqueResource
+{
+public:
+    UniqueResource() = default;
+
+    UniqueResource(ResourceType type, uint32_t rendererID)
+        : m_Handle(ResourceRegistry::Get().Register(type, rendererID))
+    {
+    }
+
+    ~UniqueResource()
+    {
+        Reset();
+    }
+
+    UniqueResource(const UniqueResource &) = delete;
+    UniqueResource &operator=(const UniqueResource &) = delete;
+
+    UniqueResource(UniqueResource &&other) noexcept
+        : m_Handle(other.m_Handle)
+    {
+        other.m_Handle = ResourceHandle();
+    }
+
+    UniqueResource &operator=(UniqueResource &&other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_Handle = other.m_Handle;
+            other.m_Handle = ResourceHandle();
+        }
+        return *this;
+    }
+
+    void Reset()
+    {
+        if (!m_Handle.IsNull())
+            ResourceRegistry::Get().Release(m_Handle);
+        m_Handle = ResourceHandle();
+    }
+
+    inline ResourceHandle GetHandle() const { return m_Handle; }
+    inline uint32_t GetRendererID() const { return ResourceRegistry::Get().GetRendererID(m_Handle); }
+
+private:
+    ResourceHandle m_Handle;
+};
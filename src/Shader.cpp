@@ -4,20 +4,11 @@
 
 #include <stdint.h>
 #include <string>
-#include <fstream>
-#include <sstream>
+#include <vector>
 
-uint32_t Shader::CompileShader(uint32_t type, const std::string &path)
+uint32_t Shader::CompileShader(uint32_t type, const ShaderSource &sourceFiles, const ShaderDefines &defines)
 {
-    std::ifstream shaderSourceFile;
-    shaderSourceFile.open(path);
-    if (!shaderSourceFile)
-        throw std::runtime_error("Could not open "s + (type == GL_VERTEX_SHADER ? "vertex" : "fragment") + " shader file: "s + path);
-
-    std::stringstream ss;
-    while (ss << shaderSourceFile.rdbuf())
-        ;
-    std::string shaderSource = ss.str();
+    std::string shaderSource = sourceFiles.Assemble(defines);
 
     uint32_t shaderId = glCreateShader(type);
     const char *source = shaderSource.c_str();
@@ -33,7 +24,8 @@ uint32_t Shader::CompileShader(uint32_t type, const std::string &path)
         char *message = (char *)alloca((len + 1) * sizeof(char));
         glGetShaderInfoLog(shaderId, len, &len, message);
 
-        throw std::runtime_error("Could not compile "s + (type == GL_VERTEX_SHADER ? "vertex" : "fragment") + " shader: "s + path + ":\n"s + message);
+        throw std::runtime_error("Could not compile "s + (type == GL_VERTEX_SHADER ? "vertex" : "fragment") + " shader: "s + sourceFiles.path +
+                                 " (files " + sourceFiles.DescribeFiles() + "):\n"s + message);
 
         glDeleteShader(shaderId);
     }
@@ -41,6 +33,34 @@ uint32_t Shader::CompileShader(uint32_t type, const std::string &path)
     return shaderId;
 }
 
+Shader::Shader(const std::string &vertexFilePath, const std::vector<std::string> &feedbackVaryings, const ShaderDefines &defines)
+{
+    uint32_t vertexShaderID = CompileShader(GL_VERTEX_SHADER, ShaderPreprocessor::Load(vertexFilePath), defines);
+
+    uint32_t rendererID = glCreateProgram();
+    glAttachShader(rendererID, vertexShaderID);
+
+    // Must be set before linking, the linker lays out the outputs accordingly
+    std::vector<const char *> varyings;
+    for (const std::string &varying : feedbackVaryings)
+        varyings.push_back(varying.c_str());
+    glTransformFeedbackVaryings(rendererID, (GLsizei)varyings.size(), varyings.data(), GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(rendererID);
+
+    int linked;
+    glGetProgramiv(rendererID, GL_LINK_STATUS, &linked);
+    glDeleteShader(vertexShaderID);
+    if (linked == GL_FALSE)
+    {
+        char message[1024];
+        glGetProgramInfoLog(rendererID, sizeof(message), nullptr, message);
+        glDeleteProgram(rendererID);
+        throw std::runtime_error("Could not link transform feedback program "s + vertexFilePath + ":\n"s + message);
+    }
+
+    m_Resource = UniqueResource(ResourceType::Program, rendererID);
+}
+
 template <>
 void Shader::SetUniform<float, float, float, float>(int32_t location, float v0, float v1, float v2, float v3) const
 {
@@ -57,4 +77,34 @@ template<>
 void Shader::SetUniform<float>(int32_t location, float v) const
 {
     glUniform1f(location, v);
+}
+
+template <>
+void Shader::SetUniform<Vec2>(int32_t location, Vec2 v) const
+{
+    glUniform2f(location, v.x, v.y);
+}
+
+template <>
+void Shader::SetUniform<Vec3>(int32_t location, Vec3 v) const
+{
+    glUniform3f(location, v.x, v.y, v.z);
+}
+
+template <>
+void Shader::SetUniform<Vec4>(int32_t location, Vec4 v) const
+{
+    glUniform4f(location, v.x, v.y, v.z, v.w);
+}
+
+template <>
+void Shader::SetUniform<Mat3>(int32_t location, Mat3 m) const
+{
+    glUniformMatrix3fv(location, 1, GL_FALSE, m.Data());
+}
+
+template <>
+void Shader::SetUniform<Mat4>(int32_t location, Mat4 m) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, m.Data());
 }
\ No newline at end of file
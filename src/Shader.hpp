@@ -5,43 +5,67 @@
 #include <string>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
+
+#include "Math.hpp"
+#include "ResourceRegistry.hpp"
+#include "ShaderPreprocessor.hpp"
 
 using namespace std::string_literals;
 
 class Shader
 {
 public:
-    Shader(const std::string &vertexFilePath, const std::string &fragmentFilePath)
+    // The files go through ShaderPreprocessor (#include, #pragma keywords), the defines are
+    // added right after their #version line
+    Shader(const std::string &vertexFilePath, const std::string &fragmentFilePath, const ShaderDefines &defines = {})
+        : Shader(ShaderPreprocessor::Load(vertexFilePath), ShaderPreprocessor::Load(fragmentFilePath), defines)
     {
-        uint32_t vertexShaderID = CompileShader(GL_VERTEX_SHADER, vertexFilePath);
-        uint32_t fragmentShaderID = CompileShader(GL_FRAGMENT_SHADER, fragmentFilePath);
+    }
 
-        m_RendererID = glCreateProgram();
-        glAttachShader(m_RendererID, vertexShaderID);
-        glAttachShader(m_RendererID, fragmentShaderID);
-        glLinkProgram(m_RendererID);
+    // From sources loaded beforehand, e.g. to compile several variants of the same files (see ShaderVariants)
+    Shader(const ShaderSource &vertexSource, const ShaderSource &fragmentSource, const ShaderDefines &defines = {})
+    {
+        uint32_t vertexShaderID = CompileShader(GL_VERTEX_SHADER, vertexSource, defines);
+        uint32_t fragmentShaderID = CompileShader(GL_FRAGMENT_SHADER, fragmentSource, defines);
 
-        glValidateProgram(m_RendererID);
+        uint32_t rendererID = glCreateProgram();
+        glAttachShader(rendererID, vertexShaderID);
+        glAttachShader(rendererID, fragmentShaderID);
+        glLinkProgram(rendererID);
+
+        glValidateProgram(rendererID);
 
         glDeleteShader(vertexShaderID);
         glDeleteShader(fragmentShaderID);
-    }
 
-    ~Shader()
-    {
-        glDeleteProgram(m_RendererID);
+        m_Resource = UniqueResource(ResourceType::Program, rendererID);
     }
 
-    void Bind() const { glUseProgram(m_RendererID); }
+    // Vertex shader only program whose outputs are captured with transform feedback instead of being
+    // rasterized (see ParticleSystem). The varyings are written interleaved, in this order, to the
+    // buffer bound at index 0 of GL_TRANSFORM_FEEDBACK_BUFFER.
+    Shader(const std::string &vertexFilePath, const std::vector<std::string> &feedbackVaryings, const ShaderDefines &defines = {});
+
+    void Bind() const { glUseProgram(m_Resource.GetRendererID()); }
     void Unbind() const { glUseProgram(0); }
 
     int32_t GetUniformLocation(const std::string &uniformName) const
     {
-        auto it = m_UniformLocationCache.find(uniformName);
+        return GetUniformLocation(uniformName.c_str());
+    }
+
+    // Taking a const char * lets SetUniform("u_Name", ...) look up the cache without creating
+    // a std::string temporary (which allocates for names longer than the small string buffer).
+    int32_t GetUniformLocation(const char *uniformName) const
+    {
+        // assign() reuses the capacity of the key, so it only allocates for the longest name seen so far
+        m_UniformLookupKey.assign(uniformName);
+        auto it = m_UniformLocationCache.find(m_UniformLookupKey);
         if (it != m_UniformLocationCache.end())
             return it->second;
 
-        int32_t location = glGetUniformLocation(m_RendererID, uniformName.c_str());
+        int32_t location = glGetUniformLocation(m_Resource.GetRendererID(), uniformName);
         if (location == -1)
         {
             std::cout << "Uniform \"" << uniformName << "\" not found in shader" << std::endl;
@@ -62,10 +86,38 @@ public:
         SetUniform(GetUniformLocation(uniformName), values...);
     }
 
+    template <typename... T>
+    void SetUniform(const char *uniformName, T... values) const
+    {
+        SetUniform(GetUniformLocation(uniformName), values...);
+    }
+
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
+
 private:
-    uint32_t CompileShader(uint32_t type, const std::string &path);
+    uint32_t CompileShader(uint32_t type, const ShaderSource &source, const ShaderDefines &defines);
 
 private:
-    uint32_t m_RendererID;
+    UniqueResource m_Resource;
     mutable std::unordered_map<std::string, int32_t> m_UniformLocationCache;
+    mutable std::string m_UniformLookupKey;
 };
+
+// Supported uniform types (defined in Shader.cpp).
+// Matrices are column-major, so they are uploaded as they are (transpose = GL_FALSE).
+template <>
+void Shader::SetUniform<float, float, float, float>(int32_t location, float v0, float v1, float v2, float v3) const;
+template <>
+void Shader::SetUniform<int>(int32_t location, int v) const;
+template <>
+void Shader::SetUniform<float>(int32_t location, float v) const;
+template <>
+void Shader::SetUniform<Vec2>(int32_t location, Vec2 v) const;
+template <>
+void Shader::SetUniform<Vec3>(int32_t location, Vec3 v) const;
+template <>
+void Shader::SetUniform<Vec4>(int32_t location, Vec4 v) const;
+template <>
+void Shader::SetUniform<Mat3>(int32_t location, Mat3 m) const;
+template <>
+void Shader::SetUniform<Mat4>(int32_t location, Mat4 m) const;
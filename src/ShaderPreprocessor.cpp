@@ -0,0 +1,186 @@
+#include "ShaderPreprocessor.hpp"
+#include "VirtualFileSystem.hpp"
+
+#include <stdint.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+
+static std::string GetDirectory(const std::string &path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+static inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// If line is a directive, returns its name ("include", "pragma", ...) and sets arguments to what follows
+static std::string ParseDirective(const std::string &line, std::string &arguments)
+{
+    size_t i = 0;
+    while (i < line.size() && IsSpace(line[i]))
+        i++;
+    if (i == line.size() || line[i] != '#')
+        return std::string();
+    i++;
+    while (i < line.size() && IsSpace(line[i]))
+        i++;
+
+    size_t nameStart = i;
+    while (i < line.size() && !IsSpace(line[i]))
+        i++;
+    std::string name = line.substr(nameStart, i - nameStart);
+
+    while (i < line.size() && IsSpace(line[i]))
+        i++;
+    size_t end = line.size();
+    while (end > i && IsSpace(line[end - 1]))
+        end--;
+    arguments = line.substr(i, end - i);
+    return name;
+}
+
+static std::vector<std::string> SplitWords(const std::string &text)
+{
+    std::vector<std::string> words;
+    std::istringstream stream(text);
+    std::string word;
+    while (stream >> word)
+        words.push_back(word);
+    return words;
+}
+
+ShaderSource ShaderPreprocessor::Load(const std::string &path)
+{
+    ShaderSource source;
+    source.path = path;
+
+    std::vector<std::string> stack;
+    Expand(path, true, source, stack, source.body);
+    return source;
+}
+
+void ShaderPreprocessor::Expand(const std::string &path, bool root, ShaderSource &source, std::vector<std::string> &stack, std::string &out)
+{
+    FileData file;
+    if (!VirtualFileSystem::Get().ReadFile(path, file))
+    {
+        if (root)
+            throw std::runtime_error("Could not open shader file: "s + path);
+        throw std::runtime_error("Could not open shader include: "s + path + " (included from " + stack.back() + ")");
+    }
+
+    uint32_t fileNumber = (uint32_t)source.files.size();
+    source.files.push_back(path);
+    stack.push_back(path);
+
+    if (!root)
+        out += "#line 1 " + std::to_string(fileNumber) + "\n";
+
+    std::istringstream lines(file.ToString());
+    std::string line, arguments;
+    uint32_t lineNumber = 0;
+    bool sawCode = false;
+
+    while (std::getline(lines, line))
+    {
+        lineNumber++;
+        std::string directive = ParseDirective(line, arguments);
+
+        if (directive == "version")
+        {
+            // Must come first in GLSL, Assemble() puts it back in front of the defines.
+            // Included files may have one too (so they can be checked on their own), it's dropped.
+            if (root && !sawCode)
+                source.version = line;
+            out += '\n';
+            continue;
+        }
+
+        if (directive == "include")
+        {
+            if (arguments.size() < 2 || (arguments.front() != '"' && arguments.front() != '<') || (arguments.back() != '"' && arguments.back() != '>'))
+                throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected #include \"file\"");
+
+            std::string includePath = GetDirectory(path) + arguments.substr(1, arguments.size() - 2);
+
+            // Files already pasted are skipped, which also makes include cycles harmless
+            bool included = false;
+            for (const std::string &file : source.files)
+                included = included || file == includePath;
+
+            if (!included)
+            {
+                Expand(includePath, false, source, stack, out);
+                // Back to this file, on the line after the #include
+                out += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileNumber) + "\n";
+            }
+            else
+            {
+                out += '\n';
+            }
+            continue;
+        }
+
+        if (directive == "pragma")
+        {
+            std::vector<std::string> words = SplitWords(arguments);
+            if (!words.empty() && words[0] == "once")
+            {
+                // Every file is only included once anyway
+                out += '\n';
+                continue;
+            }
+            if (!words.empty() && words[0] == "keywords")
+            {
+                for (size_t i = 1; i < words.size(); i++)
+                {
+                    bool known = false;
+                    for (const std::string &keyword : source.keywords)
+                        known = known || keyword == words[i];
+                    if (!known)
+                        source.keywords.push_back(words[i]);
+                }
+                out += '\n';
+                continue;
+            }
+        }
+
+        if (!directive.empty() || line.find_first_not_of(" \t\r") != std::string::npos)
+            sawCode = true;
+        out += line;
+        out += '\n';
+    }
+
+    stack.pop_back();
+}
+
+std::string ShaderSource::Assemble(const ShaderDefines &defines) const
+{
+    std::string text;
+    text.reserve(version.size() + body.size() + defines.size() * 32 + 32);
+
+    if (!version.empty())
+        text += version + "\n";
+    for (const ShaderDefine &define : defines)
+        text += "#define " + define.name + (define.value.empty() ? "" : " " + define.value) + "\n";
+
+    // The body keeps an empty line where #version was, so it starts on line 1 of file 0
+    text += "#line 1 0\n";
+    text += body;
+    return text;
+}
+
+std::string ShaderSource::DescribeFiles() const
+{
+    std::string description;
+    for (size_t i = 0; i < files.size(); i++)
+        description += (i ? ", " : "") + std::to_string(i) + ": " + files[i];
+    return description;
+}
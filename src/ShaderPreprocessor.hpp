@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// #define injected in front of a shader, value is empty for a plain "#define NAME"
+struct ShaderDefine
+{
+    std::string name;
+    std::string value;
+};
+
+using ShaderDefines = std::vector<ShaderDefine>;
+
+// A shader file with its #includes expanded, ready to be compiled with different defines
+struct ShaderSource
+{
+    std::string path;
+    std::string version;               // The #version line of the file, empty if it has none
+    std::string body;                  // Everything after it
+    std::vector<std::string> files;    // The file of each GLSL source string number used by #line (files[0] is path)
+    std::vector<std::string> keywords; // Declared with #pragma keywords, see ShaderVariants
+
+    // Text to give to glShaderSource: #version, then the defines, then the body
+    std::string Assemble(const ShaderDefines &defines) const;
+
+    // "0: a.fs, 1: common.glsl", to make sense of the "1(12)" locations of compile errors
+    std::string DescribeFiles() const;
+};
+
+// Resolves the directives GLSL doesn't have, before the source is handed to the driver:
+//
+//   #include "file"        Pastes the file (relative to the including one). Each file is only included
+//                          once, and a #line directive after it keeps error locations pointing at
+//                          the right file and line.
+//   #pragma keywords A B   Declares keywords the shader can be specialized on (#ifdef A ... #endif),
+//                          one variant being compiled per combination actually used (see ShaderVariants).
+//
+// Includes are pasted whatever the #ifdefs around them, the driver's preprocessor handles those.
+class ShaderPreprocessor
+{
+public:
+    // The files are read through the VirtualFileSystem. Throws std::runtime_error if one can't be read.
+    static ShaderSource Load(const std::string &path);
+
+private:
+    static void Expand(const std::string &path, bool root, ShaderSource &source, std::vector<std::string> &stack, std::string &out);
+};
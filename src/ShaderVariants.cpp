@@ -0,0 +1,51 @@
+#include "ShaderVariants.hpp"
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+
+ShaderVariants::ShaderVariants(const std::string &vertexFilePath, const std::string &fragmentFilePath, const ShaderDefines &defines)
+    : m_Vertex(ShaderPreprocessor::Load(vertexFilePath)), m_Fragment(ShaderPreprocessor::Load(fragmentFilePath)), m_Defines(defines)
+{
+    // Both stages see the same defines, so a keyword declared by either one applies to both
+    m_Keywords = m_Vertex.keywords;
+    for (const std::string &keyword : m_Fragment.keywords)
+    {
+        bool known = false;
+        for (const std::string &existing : m_Keywords)
+            known = known || existing == keyword;
+        if (!known)
+            m_Keywords.push_back(keyword);
+    }
+
+    if (m_Keywords.size() > MAX_KEYWORDS)
+        throw std::runtime_error("Shaders " + vertexFilePath + " and " + fragmentFilePath + " declare more than 64 keywords");
+}
+
+uint64_t ShaderVariants::GetKeyword(const std::string &keyword) const
+{
+    for (size_t i = 0; i < m_Keywords.size(); i++)
+    {
+        if (m_Keywords[i] == keyword)
+            return 1ull << i;
+    }
+    throw std::runtime_error("Shaders " + m_Vertex.path + " and " + m_Fragment.path + " have no keyword " + keyword);
+}
+
+const Shader &ShaderVariants::Get(uint64_t keywords)
+{
+    auto it = m_Variants.find(keywords);
+    if (it != m_Variants.end())
+        return *it->second;
+
+    m_VariantDefines = m_Defines;
+    for (size_t i = 0; i < m_Keywords.size(); i++)
+    {
+        if (keywords & (1ull << i))
+            m_VariantDefines.push_back({m_Keywords[i], ""});
+    }
+
+    // Compiled before it goes in the map, so a variant that fails to compile isn't cached
+    std::unique_ptr<Shader> variant(new Shader(m_Vertex, m_Fragment, m_VariantDefines));
+    return *(m_Variants[keywords] = std::move(variant));
+}
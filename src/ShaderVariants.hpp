@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.hpp"
+#include "ShaderPreprocessor.hpp"
+
+// The specialized programs of a vertex/fragment shader pair.
+//
+// The shaders declare what they can be specialized on with "#pragma keywords A B ..." and test them
+// with #ifdef, so a variant only contains the work it needs instead of branching on uniforms at
+// every pixel. A variant is the set of keywords it defines, as a bit mask (see GetKeyword), and is
+// compiled the first time it is asked for: only the combinations actually used are ever built.
+// The files are read and their includes expanded once, when the ShaderVariants is created.
+class ShaderVariants
+{
+public:
+    static constexpr uint32_t MAX_KEYWORDS = 64;
+
+    // defines are added to every variant (e.g. constants like MAX_LIGHTS 4)
+    ShaderVariants(const std::string &vertexFilePath, const std::string &fragmentFilePath, const ShaderDefines &defines = {});
+
+    ShaderVariants(const ShaderVariants &) = delete;
+    ShaderVariants &operator=(const ShaderVariants &) = delete;
+
+    // Bit of a keyword declared by one of the stages, throws if there is no such keyword
+    uint64_t GetKeyword(const std::string &keyword) const;
+
+    // The variant with exactly these keywords defined
+    const Shader &Get(uint64_t keywords = 0);
+
+    inline const std::vector<std::string> &GetKeywords() const { return m_Keywords; }
+    inline uint32_t GetCompiledCount() const { return (uint32_t)m_Variants.size(); }
+
+private:
+    ShaderSource m_Vertex;
+    ShaderSource m_Fragment;
+    ShaderDefines m_Defines;
+    std::vector<std::string> m_Keywords; // Bit i is m_Keywords[i]
+
+    std::unordered_map<uint64_t, std::unique_ptr<Shader>> m_Variants;
+    ShaderDefines m_VariantDefines; // Reused to build the defines of a new variant
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <stdexcept>
+#include <string>
+
+#include "ResourceRegistry.hpp"
+
+// Buffer for data that is rewritten every frame (uniforms, dynamic vertices, ...).
+//
+// The buffer is split in one region per frame in flight, and each frame only writes to the region
+// of its FramePacer slot. Since the pacer guarantees the GPU is done with that region, writes can
+// map it with GL_MAP_UNSYNCHRONIZED_BIT, so the driver never stalls or makes a copy (orphaning).
+class StreamBuffer
+{
+public:
+    StreamBuffer(uint32_t target, uint32_t regionSize, uint32_t framesInFlight)
+        : m_Target(target), m_RegionSize(regionSize), m_FramesInFlight(framesInFlight), m_Slot(0), m_Cursor(0)
+    {
+        uint32_t rendererID;
+        glGenBuffers(1, &rendererID);
+        glBindBuffer(target, rendererID);
+        glBufferData(target, (GLsizeiptr)regionSize * framesInFlight, nullptr, GL_STREAM_DRAW);
+        glBindBuffer(target, 0);
+        m_Resource = UniqueResource(ResourceType::Buffer, rendererID);
+    }
+
+    // Starts writing at the beginning of the region of the given frame slot (FramePacer::GetFrameSlot())
+    void BeginFrame(uint32_t frameSlot)
+    {
+        m_Slot = frameSlot % m_FramesInFlight;
+        m_Cursor = 0;
+    }
+
+    // Copies data into the current region and returns its offset in the whole buffer
+    // (to use with glBindBufferRange or as a vertex attribute offset)
+    uint32_t Write(const void *data, uint32_t size, uint32_t alignment = 16)
+    {
+        uint32_t offset = (m_Cursor + alignment - 1) / alignment * alignment;
+        if (offset + size > m_RegionSize)
+            throw std::runtime_error("StreamBuffer region overflow (" + std::to_string(offset + size) + " > " + std::to_string(m_RegionSize) + " bytes)");
+
+        uint32_t bufferOffset = m_Slot * m_RegionSize + offset;
+        glBindBuffer(m_Target, m_Resource.GetRendererID());
+        void *destination = glMapBufferRange(m_Target, bufferOffset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if (destination)
+        {
+            memcpy(destination, data, size);
+            glUnmapBuffer(m_Target);
+        }
+        else
+        {
+            // The map can fail (out of memory, lost context...): a plain copy is still correct, the
+            // driver just may have to synchronize
+            glBufferSubData(m_Target, bufferOffset, size, data);
+        }
+
+        m_Cursor = offset + size;
+        return bufferOffset;
+    }
+
+    void Bind() const
+    {
+        glBindBuffer(m_Target, m_Resource.GetRendererID());
+    }
+
+    void Unbind() const
+    {
+        glBindBuffer(m_Target, 0);
+    }
+
+    // For uniform buffers: binds a range written by Write() to a binding point
+    void BindRange(uint32_t bindingPoint, uint32_t offset, uint32_t size) const
+    {
+        glBindBufferRange(m_Target, bindingPoint, m_Resource.GetRendererID(), offset, size);
+    }
+
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
+    inline uint32_t GetRegionSize() const { return m_RegionSize; }
+    inline uint32_t GetUsed() const { return m_Cursor; }
+
+private:
+    UniqueResource m_Resource;
+    uint32_t m_Target;
+    uint32_t m_RegionSize;
+    uint32_t m_FramesInFlight;
+    uint32_t m_Slot;
+    uint32_t m_Cursor;
+};
@@ -0,0 +1,318 @@
+#include "TextBatch.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// 8 bytes per multiply instead of FNV-1a's one, every label is hashed every frame
+static inline uint32_t HashText(const char *text, size_t length)
+{
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t hash = length * multiplier;
+
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, text + i, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    if (i < length)
+    {
+        uint64_t word = 0;
+        memcpy(&word, text + i, length - i);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    return (uint32_t)(hash >> 32);
+}
+
+// Next codepoint of UTF-8 text, malformed sequences decode as U+FFFD one byte at a time
+static inline uint32_t DecodeUtf8(const char *text, size_t length, size_t &i)
+{
+    uint8_t first = (uint8_t)text[i++];
+    if (first < 0x80)
+        return first;
+
+    int extra = first >= 0xF0 ? 3 : (first >= 0xE0 ? 2 : (first >= 0xC0 ? 1 : -1));
+    if (extra < 0 || first > 0xF4 || i + extra > length)
+        return 0xFFFD;
+
+    uint32_t codepoint = first & (0x3F >> extra);
+    for (int k = 0; k < extra; k++)
+    {
+        uint8_t next = (uint8_t)text[i + k];
+        if ((next & 0xC0) != 0x80)
+            return 0xFFFD;
+        codepoint = (codepoint << 6) | (next & 0x3F);
+    }
+    i += extra;
+    return codepoint;
+}
+
+TextBatch::TextBatch(GlyphAtlas &atlas)
+    : m_Atlas(atlas)
+{
+    m_Slots.resize(1024, {0, EMPTY_SLOT});
+    m_SeenThisFrame.resize(SEEN_BITS / 64, 0);
+    m_SeenLastFrame.resize(SEEN_BITS / 64, 0);
+}
+
+void TextBatch::AddText(const char *text, float x, float y, float size, uint32_t color)
+{
+    AddText(text, strlen(text), x, y, size, color);
+}
+
+void TextBatch::AddText(const char *text, size_t length, float x, float y, float size, uint32_t color)
+{
+    m_FrameStats.labels++;
+    const TextRun *cached = GetRun(text, length);
+    if (!cached)
+    {
+        AddUncachedText(text, length, x, y, size, color);
+        return;
+    }
+
+    const TextRun &run = *cached;
+    m_FrameStats.glyphs += (uint32_t)run.glyphs.size();
+
+    if (m_Pages.size() < m_Atlas.GetPageCount())
+        m_Pages.resize(m_Atlas.GetPageCount());
+
+    for (const ShapedGlyph &glyph : run.glyphs)
+    {
+        PageQuads &page = m_Pages[glyph.page];
+        if (page.count == page.quads.size())
+            page.quads.resize(page.quads.empty() ? 1024 : page.quads.size() * 2);
+
+        page.quads[page.count++] = {x + glyph.x0 * size, y + glyph.y0 * size, x + glyph.x1 * size, y + glyph.y1 * size,
+                                    glyph.u0, glyph.v0, glyph.u1, glyph.v1, color};
+    }
+}
+
+// Shape() and the quad writes of AddText() in one pass, for a text that won't be drawn again
+void TextBatch::AddUncachedText(const char *text, size_t length, float x, float y, float size, uint32_t color)
+{
+    // The page being written and its count are kept in locals until a glyph is on another page:
+    // the compiler can't keep them in registers otherwise, a quad store might change them
+    uint32_t pageIndex = UINT32_MAX;
+    TextQuad *quads = nullptr;
+    uint32_t count = 0, glyphCount = 0;
+
+    float penX = 0.0f, penY = m_Atlas.GetAscent();
+    for (size_t i = 0; i < length;)
+    {
+        uint32_t codepoint = DecodeUtf8(text, length, i);
+        if (codepoint == '\n')
+        {
+            penX = 0.0f;
+            penY += 1.0f;
+            continue;
+        }
+
+        const Glyph &glyph = m_Atlas.GetGlyph(m_Atlas.GetGlyphIndex(codepoint));
+        if (!glyph.IsEmpty())
+        {
+            if (glyph.page != pageIndex)
+            {
+                if (pageIndex != UINT32_MAX)
+                    m_Pages[pageIndex].count = count;
+                // The glyph may have just been added on a new atlas page
+                if (glyph.page >= m_Pages.size())
+                    m_Pages.resize(m_Atlas.GetPageCount());
+
+                // Room for the rest of the text, it has at most a glyph per byte
+                PageQuads &page = m_Pages[glyph.page];
+                size_t needed = page.count + (length - i + 1);
+                if (page.quads.size() < needed)
+                    page.quads.resize(needed > page.quads.size() * 2 ? (needed > 1024 ? needed : 1024) : page.quads.size() * 2);
+
+                pageIndex = glyph.page;
+                quads = page.quads.data();
+                count = page.count;
+            }
+
+            quads[count++] = {x + (penX + glyph.x0) * size, y + (penY + glyph.y0) * size,
+                              x + (penX + glyph.x1) * size, y + (penY + glyph.y1) * size,
+                              glyph.u0, glyph.v0, glyph.u1, glyph.v1, color};
+            glyphCount++;
+        }
+        penX += glyph.advance;
+    }
+
+    if (pageIndex != UINT32_MAX)
+        m_Pages[pageIndex].count = count;
+    m_FrameStats.glyphs += glyphCount;
+}
+
+float TextBatch::GetTextWidth(const char *text, float size)
+{
+    size_t length = strlen(text);
+    const TextRun *run = GetRun(text, length);
+    if (!run)
+    {
+        Shape(text, length, m_UncachedRun);
+        run = &m_UncachedRun;
+    }
+    return run->width * size;
+}
+
+// The cached layout of the text, or null when it shouldn't be cached and is laid out by the caller
+const TextBatch::TextRun *TextBatch::GetRun(const char *text, size_t length)
+{
+    uint32_t hash = HashText(text, length);
+    uint32_t mask = (uint32_t)m_Slots.size() - 1;
+
+    for (uint32_t slot = hash & mask; m_Slots[slot].run != EMPTY_SLOT; slot = (slot + 1) & mask)
+    {
+        if (m_Slots[slot].hash != hash)
+            continue;
+
+        TextRun &run = m_Runs[m_Slots[slot].run];
+        if (run.text.size() != length || memcmp(run.text.data(), text, length) != 0)
+        {
+            // Another text with the same hash owns the entry, lay this one out without caching it
+            m_FrameStats.cacheMisses++;
+            return nullptr;
+        }
+
+        m_FrameStats.cacheHits++;
+        run.lastUsedFrame = m_Frame;
+        return &run;
+    }
+
+    m_FrameStats.cacheMisses++;
+
+    // Only cache texts seen in the previous frame or earlier in this one. One that is new (a counter
+    // that changes every frame) is laid out without being copied or stored, it won't be seen again.
+    uint32_t seenBit = (hash >> 14) % SEEN_BITS;
+    uint64_t seenMask = 1ull << (seenBit % 64);
+    if (((m_SeenThisFrame[seenBit / 64] | m_SeenLastFrame[seenBit / 64]) & seenMask) == 0)
+    {
+        m_SeenThisFrame[seenBit / 64] |= seenMask;
+        return nullptr;
+    }
+
+    // Reuses an evicted run when there is one, its string and vector keep their capacity
+    uint32_t runIndex;
+    if (!m_FreeRuns.empty())
+    {
+        runIndex = m_FreeRuns.back();
+        m_FreeRuns.pop_back();
+    }
+    else
+    {
+        runIndex = (uint32_t)m_Runs.size();
+        m_Runs.emplace_back();
+    }
+
+    TextRun &run = m_Runs[runIndex];
+    run.text.assign(text, length);
+    run.hash = hash;
+    run.lastUsedFrame = m_Frame;
+    run.live = true;
+    Shape(text, length, run);
+
+    // Keeps the table at most half full
+    if ((m_LiveRuns + 1) * 2 > m_Slots.size())
+        GrowSlots();
+    InsertSlot(runIndex);
+    m_LiveRuns++;
+    return &run;
+}
+
+void TextBatch::Shape(const char *text, size_t length, TextRun &run)
+{
+    run.glyphs.clear();
+    run.width = 0.0f;
+
+    // Pen position on the baseline, in line heights from the top-left corner of the text
+    float x = 0.0f, y = m_Atlas.GetAscent();
+
+    for (size_t i = 0; i < length;)
+    {
+        uint32_t codepoint = DecodeUtf8(text, length, i);
+        if (codepoint == '\n')
+        {
+            x = 0.0f;
+            y += 1.0f;
+            continue;
+        }
+
+        const Glyph &glyph = m_Atlas.GetGlyph(m_Atlas.GetGlyphIndex(codepoint));
+        if (!glyph.IsEmpty())
+            run.glyphs.push_back({x + glyph.x0, y + glyph.y0, x + glyph.x1, y + glyph.y1, glyph.u0, glyph.v0, glyph.u1, glyph.v1, glyph.page});
+
+        x += glyph.advance;
+        run.width = x > run.width ? x : run.width;
+    }
+}
+
+void TextBatch::InsertSlot(uint32_t runIndex)
+{
+    uint32_t mask = (uint32_t)m_Slots.size() - 1;
+    uint32_t hash = m_Runs[runIndex].hash;
+    uint32_t slot = hash & mask;
+    while (m_Slots[slot].run != EMPTY_SLOT)
+        slot = (slot + 1) & mask;
+    m_Slots[slot] = {hash, runIndex};
+}
+
+void TextBatch::RemoveSlot(uint32_t runIndex)
+{
+    uint32_t mask = (uint32_t)m_Slots.size() - 1;
+    uint32_t slot = m_Runs[runIndex].hash & mask;
+    while (m_Slots[slot].run != runIndex)
+        slot = (slot + 1) & mask;
+
+    // Backward shift: moves the following entries of the cluster up when the hole is between
+    // them and their home slot, so lookups never need tombstones
+    uint32_t hole = slot;
+    for (uint32_t next = (hole + 1) & mask; m_Slots[next].run != EMPTY_SLOT; next = (next + 1) & mask)
+    {
+        uint32_t home = m_Slots[next].hash & mask;
+        if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+            m_Slots[hole] = m_Slots[next];
+            hole = next;
+        }
+    }
+    m_Slots[hole].run = EMPTY_SLOT;
+}
+
+void TextBatch::GrowSlots()
+{
+    m_Slots.assign(m_Slots.size() * 2, {0, EMPTY_SLOT});
+    for (uint32_t i = 0; i < m_Runs.size(); i++)
+    {
+        if (m_Runs[i].live)
+            InsertSlot(i);
+    }
+}
+
+void TextBatch::EndFrame()
+{
+    for (PageQuads &page : m_Pages)
+        page.count = 0;
+
+    for (uint32_t i = 0; i < m_Runs.size(); i++)
+    {
+        TextRun &run = m_Runs[i];
+        if (run.live && m_Frame - run.lastUsedFrame >= RUN_LIFETIME)
+        {
+            RemoveSlot(i);
+            run.live = false;
+            m_FreeRuns.push_back(i);
+            m_LiveRuns--;
+        }
+    }
+
+    m_SeenLastFrame.swap(m_SeenThisFrame);
+    memset(m_SeenThisFrame.data(), 0, m_SeenThisFrame.size() * sizeof(uint64_t));
+
+    m_Frame++;
+    m_Stats = m_FrameStats;
+    m_Stats.cachedRuns = m_LiveRuns;
+    m_FrameStats = TextBatchStats();
+}
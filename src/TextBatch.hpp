@@ -0,0 +1,125 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "GlyphAtlas.hpp"
+
+// One glyph on screen, drawn as an instanced quad (28 bytes instead of 4 vertices), see res/shaders/text.vs
+struct TextQuad
+{
+    float x0, y0, x1, y1;    // Pixels, y down
+    uint16_t u0, v0, u1, v1; // Texels in the atlas page
+    uint32_t color;          // RGBA8, red in the lowest byte
+};
+
+struct TextBatchStats
+{
+    uint32_t labels = 0;      // AddText() calls
+    uint32_t glyphs = 0;      // Quads queued
+    uint32_t cacheHits = 0;   // Labels whose layout was already cached
+    uint32_t cacheMisses = 0; // Labels laid out this frame (and cached, unless seen for the first time)
+    uint32_t cachedRuns = 0;  // Layouts in the cache at the end of the frame
+};
+
+// Collects the text of a frame as quads, grouped by atlas page so each page is one draw call.
+//
+// The layout of a string (its glyphs and their positions, in line heights) is computed once and
+// cached, so the same label drawn every frame, at any position, size or color, only costs a hash
+// lookup and the quad writes. A string is only cached the second time it is seen in two frames,
+// so labels that change every frame (timers, counters) are laid out straight into the quads instead
+// of filling the cache, and layouts not used for RUN_LIFETIME frames are dropped. After a few frames of
+// warm-up, building a frame doesn't allocate.
+class TextBatch
+{
+public:
+    static constexpr uint32_t RUN_LIFETIME = 2;
+
+    TextBatch(GlyphAtlas &atlas);
+
+    TextBatch(const TextBatch &) = delete;
+    TextBatch &operator=(const TextBatch &) = delete;
+
+    // UTF-8 text, '\n' starts a new line. (x, y) is the top-left corner of the text in pixels,
+    // y down, and size is the line height in pixels.
+    void AddText(const char *text, size_t length, float x, float y, float size, uint32_t color);
+    void AddText(const char *text, float x, float y, float size, uint32_t color);
+
+    // Width of the longest line, in pixels
+    float GetTextWidth(const char *text, float size);
+
+    // Quads queued since the last EndFrame(), by atlas page
+    inline uint32_t GetPageCount() const { return (uint32_t)m_Pages.size(); }
+    inline const TextQuad *GetQuads(uint32_t page) const { return m_Pages[page].quads.data(); }
+    inline uint32_t GetQuadCount(uint32_t page) const { return m_Pages[page].count; }
+
+    // Clears the queued quads and evicts the layouts that are no longer used
+    void EndFrame();
+
+    // Of the last frame ended by EndFrame()
+    inline const TextBatchStats &GetStats() const { return m_Stats; }
+    inline GlyphAtlas &GetAtlas() { return m_Atlas; }
+
+private:
+    static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+    static constexpr uint32_t SEEN_BITS = 1 << 18; // 32 KB, about 4% false positives with 5000 new texts a frame
+
+    // The hash is kept next to the run index, so probing doesn't touch the runs themselves
+    struct Slot
+    {
+        uint32_t hash;
+        uint32_t run;
+    };
+
+    // Quad of a glyph in the run, ready to be scaled and moved to where the text goes
+    struct ShapedGlyph
+    {
+        float x0, y0, x1, y1; // From the top-left corner of the text, in line heights
+        uint16_t u0, v0, u1, v1;
+        uint32_t page;
+    };
+
+    // Quads of a page. The vector only grows, count says how much of it is used this frame.
+    struct PageQuads
+    {
+        std::vector<TextQuad> quads;
+        uint32_t count = 0;
+    };
+
+    struct TextRun
+    {
+        std::string text;
+        uint32_t hash;
+        std::vector<ShapedGlyph> glyphs; // Empty glyphs (spaces) are left out
+        float width;
+        uint32_t lastUsedFrame;
+        bool live;
+    };
+
+    const TextRun *GetRun(const char *text, size_t length);
+    void Shape(const char *text, size_t length, TextRun &run);
+    void AddUncachedText(const char *text, size_t length, float x, float y, float size, uint32_t color);
+    void InsertSlot(uint32_t runIndex);
+    void RemoveSlot(uint32_t runIndex);
+    void GrowSlots();
+
+private:
+    GlyphAtlas &m_Atlas;
+    std::vector<PageQuads> m_Pages;
+
+    // Open addressing (linear probing) on the hash of the text
+    std::vector<TextRun> m_Runs;
+    std::vector<uint32_t> m_FreeRuns;
+    std::vector<Slot> m_Slots;
+    uint32_t m_LiveRuns = 0;
+    TextRun m_UncachedRun; // For GetTextWidth() of a text that isn't cached
+
+    // Hashes of the texts seen this frame and in the last one (with false positives), see GetRun()
+    std::vector<uint64_t> m_SeenThisFrame, m_SeenLastFrame;
+
+    uint32_t m_Frame = 0;
+    TextBatchStats m_FrameStats;
+    TextBatchStats m_Stats;
+};
@@ -0,0 +1,88 @@
+#include <GL/glew.h>
+
+#include "TextRenderer.hpp"
+
+#include <stdint.h>
+
+TextRenderer::TextRenderer(uint32_t framesInFlight, uint32_t maxGlyphsPerFrame, const Font &font)
+    : m_Atlas(font), m_Batch(m_Atlas),
+      m_Shader("res/shaders/text.vs", "res/shaders/text.fs"),
+      m_Quads(GL_ARRAY_BUFFER, maxGlyphsPerFrame * (uint32_t)sizeof(TextQuad), framesInFlight),
+      m_MaxGlyphs(maxGlyphsPerFrame)
+{
+    m_Layout.Push<float>(4);    // Rectangle, in pixels
+    m_Layout.Push<uint16_t>(4); // Rectangle in the atlas page, in texels
+    m_Layout.Push<uint8_t>(4);  // Color
+    m_Layout.SetDivisor(1);     // One quad per instance, the corners come from gl_VertexID
+
+    m_Shader.Bind();
+    m_Shader.SetUniform("u_Page", 0);
+    m_Shader.SetUniform("u_PageSize", (float)GlyphAtlas::PAGE_SIZE);
+}
+
+void TextRenderer::UploadAtlas()
+{
+    for (uint32_t page = 0; page < m_Atlas.GetPageCount(); page++)
+    {
+        if (page == m_Pages.size())
+            m_Pages.emplace_back(new Texture(GlyphAtlas::PAGE_SIZE, GlyphAtlas::PAGE_SIZE, GL_R8));
+
+        // Only the rectangle the new glyphs went into
+        int x, y, width, height;
+        if (!m_Atlas.GetDirtyRect(page, x, y, width, height))
+            continue;
+
+        const uint8_t *pixels = m_Atlas.GetPagePixels(page) + (size_t)y * GlyphAtlas::PAGE_SIZE + x;
+        m_Pages[page]->SetData(x, y, width, height, pixels, GlyphAtlas::PAGE_SIZE);
+        m_Atlas.ClearDirty(page);
+    }
+}
+
+uint32_t TextRenderer::Draw(const Renderer &renderer, int width, int height, uint32_t frameSlot)
+{
+    m_Stats.drawCalls = 0;
+    m_Stats.glyphs = 0;
+    m_Stats.droppedGlyphs = 0;
+
+    UploadAtlas();
+    m_Stats.atlasPages = m_Atlas.GetPageCount();
+
+    m_Quads.BeginFrame(frameSlot);
+
+    m_Shader.Bind();
+    m_Shader.SetUniform("u_ScreenSize", Vec2{(float)width, (float)height});
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    for (uint32_t page = 0; page < m_Batch.GetPageCount(); page++)
+    {
+        uint32_t count = m_Batch.GetQuadCount(page);
+        uint32_t room = m_MaxGlyphs - m_Stats.glyphs;
+        if (count > room)
+        {
+            m_Stats.droppedGlyphs += count - room;
+            count = room;
+        }
+        if (count == 0)
+            continue;
+
+        // The instance attributes can't start at an offset in GL 3.3 (no base instance),
+        // so they are pointed at this page's quads before each draw
+        uint32_t offset = m_Quads.Write(m_Batch.GetQuads(page), count * (uint32_t)sizeof(TextQuad), 4);
+        m_VertexArray.AddVBO(m_Quads, m_Layout, offset);
+
+        m_Pages[page]->Bind(0);
+        renderer.DrawInstanced(m_VertexArray, m_Shader, GL_TRIANGLE_STRIP, 4, count);
+
+        m_Stats.drawCalls++;
+        m_Stats.glyphs += count;
+    }
+
+    glDisable(GL_BLEND);
+    m_VertexArray.Unbind();
+    m_Quads.Unbind();
+
+    m_Batch.EndFrame();
+    return m_Stats.drawCalls;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "GlyphAtlas.hpp"
+#include "Renderer.hpp"
+#include "Shader.hpp"
+#include "StreamBuffer.hpp"
+#include "TextBatch.hpp"
+#include "Texture.hpp"
+#include "VertexArray.hpp"
+
+struct TextRendererStats
+{
+    uint32_t drawCalls = 0;     // In the last Draw(), one per atlas page with text
+    uint32_t glyphs = 0;        // Drawn in the last Draw()
+    uint32_t droppedGlyphs = 0; // Over maxGlyphsPerFrame in the last Draw()
+    uint32_t atlasPages = 0;
+};
+
+// Screen-space text on top of the current framebuffer.
+//
+// Text is queued with AddText() during the frame (see TextBatch), then Draw() uploads the glyphs
+// added to the atlas since the last frame, writes the quads into a StreamBuffer region of the
+// current frame slot and issues one instanced draw call per atlas page.
+class TextRenderer
+{
+public:
+    TextRenderer(uint32_t framesInFlight, uint32_t maxGlyphsPerFrame = 65536, const Font &font = Font::GetBuiltin());
+
+    TextRenderer(const TextRenderer &) = delete;
+    TextRenderer &operator=(const TextRenderer &) = delete;
+
+    // See TextBatch::AddText. color is RGBA8 with red in the lowest byte (0xAABBGGRR).
+    inline void AddText(const char *text, float x, float y, float size, uint32_t color = 0xFFFFFFFF)
+    {
+        m_Batch.AddText(text, x, y, size, color);
+    }
+
+    // Draws and clears everything queued since the last call, on a width x height pixels framebuffer.
+    // frameSlot is FramePacer::GetFrameSlot(). Returns the number of draw calls.
+    uint32_t Draw(const Renderer &renderer, int width, int height, uint32_t frameSlot);
+
+    inline TextBatch &GetBatch() { return m_Batch; }
+    inline GlyphAtlas &GetAtlas() { return m_Atlas; }
+    inline const TextRendererStats &GetStats() const { return m_Stats; }
+
+private:
+    void UploadAtlas();
+
+private:
+    GlyphAtlas m_Atlas;
+    TextBatch m_Batch;
+    std::vector<std::unique_ptr<Texture>> m_Pages;
+
+    Shader m_Shader;
+    StreamBuffer m_Quads;
+    VertexArray m_VertexArray;
+    VertexBufferLayout m_Layout;
+    uint32_t m_MaxGlyphs;
+
+    TextRendererStats m_Stats;
+};
@@ -3,52 +3,154 @@
 #include <GL/glew.h>
 
 #include <stdint.h>
+#include <stdexcept>
 #include <string>
 
 #include "vendor/stb_image/stb_image.h"
+#include "ResourceRegistry.hpp"
+#include "VirtualFileSystem.hpp"
+
+// Pixels decoded on the CPU, not uploaded yet. Decoding doesn't touch OpenGL, so it can run
+// on a job (see JobSystem) while only the upload happens on the GL thread.
+struct TextureImage
+{
+    std::string filepath;
+    uint8_t *pixels = nullptr; // RGBA8, owned: release with Free()
+    int width = 0, height = 0, bpp = 0;
+
+    static TextureImage Decode(const std::string &filepath)
+    {
+        TextureImage image;
+        image.filepath = filepath;
+
+        // From an archive when one has it (see VirtualFileSystem), pixels stays null if the file can't be read
+        FileData file;
+        if (!VirtualFileSystem::Get().ReadFile(filepath, file))
+            return image;
+
+        // The thread-local flag, the global one is not safe to set from several jobs at once
+        stbi_set_flip_vertically_on_load_thread(true);
+        image.pixels = stbi_load_from_memory(file.data, (int)file.size, &image.width, &image.height, &image.bpp, 4);
+        return image;
+    }
+
+    void Free()
+    {
+        if (pixels) {
+            stbi_image_free(pixels);
+            pixels = nullptr;
+        }
+    }
+};
+
+// How the pixels of a sized internal format are passed to glTexImage2D, and how big they are
+struct PixelFormat
+{
+    uint32_t format;
+    uint32_t type;
+    int channels;
+    int bytesPerPixel;
+    bool depth;
+    bool stencil;
+
+    static PixelFormat Get(uint32_t internalFormat)
+    {
+        switch (internalFormat)
+        {
+        case GL_R8:                 return {GL_RED, GL_UNSIGNED_BYTE, 1, 1, false, false};
+        case GL_RG8:                return {GL_RG, GL_UNSIGNED_BYTE, 2, 2, false, false};
+        case GL_RGB8:               return {GL_RGB, GL_UNSIGNED_BYTE, 3, 3, false, false};
+        case GL_RGBA8:              return {GL_RGBA, GL_UNSIGNED_BYTE, 4, 4, false, false};
+        case GL_R16F:               return {GL_RED, GL_HALF_FLOAT, 1, 2, false, false};
+        case GL_RG16F:              return {GL_RG, GL_HALF_FLOAT, 2, 4, false, false};
+        case GL_RGBA16F:            return {GL_RGBA, GL_HALF_FLOAT, 4, 8, false, false};
+        case GL_R11F_G11F_B10F:     return {GL_RGB, GL_FLOAT, 3, 4, false, false};
+        case GL_R32F:               return {GL_RED, GL_FLOAT, 1, 4, false, false};
+        case GL_RGBA32F:            return {GL_RGBA, GL_FLOAT, 4, 16, false, false};
+        case GL_DEPTH_COMPONENT24:  return {GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 1, 4, true, false};
+        case GL_DEPTH_COMPONENT32F: return {GL_DEPTH_COMPONENT, GL_FLOAT, 1, 4, true, false};
+        case GL_DEPTH24_STENCIL8:   return {GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, 2, 4, true, true};
+        }
+        throw std::runtime_error("Unsupported texture format " + std::to_string(internalFormat));
+    }
+};
 
 class Texture
 {
 private:
-    uint32_t m_RendererID;
+    UniqueResource m_Resource;
     std::string m_Filepath;
-    uint8_t *m_LocalBuffer;
     int m_Width, m_Height, m_BPP;
+    uint32_t m_InternalFormat;
 
 public:
 
     Texture(const std::string &filepath) 
-        : m_Filepath(filepath), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+        : Texture(TextureImage::Decode(filepath), true)
     {
-        stbi_set_flip_vertically_on_load(true);
-        m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+    }
 
-        glGenTextures(1, &m_RendererID);
-        glBindTexture(GL_TEXTURE_2D, m_RendererID);
+    // Uploads an image decoded beforehand. The image keeps its pixels unless freeImage is set.
+    Texture(TextureImage image, bool freeImage = false)
+        : m_Filepath(image.filepath), m_Width(image.width), m_Height(image.height), m_BPP(image.bpp), m_InternalFormat(GL_RGBA8)
+    {
+        uint32_t rendererID;
+        glGenTextures(1, &rendererID);
+        glBindTexture(GL_TEXTURE_2D, rendererID);
+        m_Resource = UniqueResource(ResourceType::Texture, rendererID);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels);
         glBindTexture(GL_TEXTURE_2D, 0);
 
-        if (m_LocalBuffer) {
-            stbi_image_free(m_LocalBuffer);
-            m_LocalBuffer = nullptr;
-        }
+        if (freeImage)
+            image.Free();
+    }
+
+    // Empty texture to render into (see Framebuffer and RenderGraph), e.g. GL_RGBA8, GL_RGBA16F or GL_DEPTH24_STENCIL8
+    Texture(int width, int height, uint32_t internalFormat)
+        : m_Width(width), m_Height(height), m_InternalFormat(internalFormat)
+    {
+        PixelFormat pixelFormat = PixelFormat::Get(internalFormat);
+        m_BPP = pixelFormat.channels;
+
+        uint32_t rendererID;
+        glGenTextures(1, &rendererID);
+        glBindTexture(GL_TEXTURE_2D, rendererID);
+        m_Resource = UniqueResource(ResourceType::Texture, rendererID);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, pixelFormat.format, pixelFormat.type, nullptr);
+        glBindTexture(GL_TEXTURE_2D, 0);
     }
 
-    ~Texture() 
+    // Replaces a rectangle of the texture. rowLength is the width of the rows of pixels (0: width),
+    // to upload part of a larger image. pixels must be in the format of the internal format (see PixelFormat).
+    void SetData(int x, int y, int width, int height, const void *pixels, int rowLength = 0)
     {
-        glDeleteTextures(1, &m_RendererID);
+        PixelFormat pixelFormat = PixelFormat::Get(m_InternalFormat);
+
+        glBindTexture(GL_TEXTURE_2D, m_Resource.GetRendererID());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, rowLength);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, pixelFormat.format, pixelFormat.type, pixels);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
     }
 
     void Bind(uint32_t slot = 0) const
     {
         glActiveTexture(GL_TEXTURE0 + slot);
-        glBindTexture(GL_TEXTURE_2D, m_RendererID);
+        glBindTexture(GL_TEXTURE_2D, m_Resource.GetRendererID());
     }
 
     void Unbind() const
@@ -59,4 +161,6 @@ public:
     inline int GetWidth() const { return m_Width; }
     inline int GetHeight() const { return m_Height; }
     inline int GetBPP() const { return m_BPP; }
+    inline uint32_t GetInternalFormat() const { return m_InternalFormat; }
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
 };
@@ -0,0 +1,154 @@
+#include <GL/glew.h>
+
+#include "TextureArray.hpp"
+
+#include <stdint.h>
+#include <stdexcept>
+#include <string>
+
+// --- TextureArray ---
+
+TextureArray::TextureArray(int width, int height, uint32_t layerCount, uint32_t internalFormat)
+    : m_Width(width), m_Height(height), m_LayerCount(layerCount), m_InternalFormat(internalFormat)
+{
+    PixelFormat pixelFormat = PixelFormat::Get(internalFormat);
+
+    uint32_t rendererID;
+    glGenTextures(1, &rendererID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, rendererID);
+    m_Resource = UniqueResource(ResourceType::Texture, rendererID);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layerCount, 0, pixelFormat.format, pixelFormat.type, nullptr);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::SetLayerData(uint32_t layer, const void *pixels)
+{
+    if (layer >= m_LayerCount)
+        throw std::runtime_error("Texture array layer " + std::to_string(layer) + " out of range");
+
+    PixelFormat pixelFormat = PixelFormat::Get(m_InternalFormat);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_Resource.GetRendererID());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, m_Width, m_Height, 1, pixelFormat.format, pixelFormat.type, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void TextureArray::Bind(uint32_t slot) const
+{
+    glActiveTexture(GL_TEXTURE0 + slot);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_Resource.GetRendererID());
+}
+
+// --- TextureArrayManager ---
+
+TextureArrayManager::TextureArrayManager(uint32_t layersPerArray)
+{
+    GLint maxLayers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    m_LayersPerArray = layersPerArray < (uint32_t)maxLayers ? layersPerArray : (uint32_t)maxLayers;
+    m_LayersPerArray = m_LayersPerArray < UINT16_MAX ? m_LayersPerArray : UINT16_MAX;
+    if (m_LayersPerArray == 0)
+        throw std::runtime_error("A texture array needs at least one layer");
+}
+
+TextureLayer TextureArrayManager::Allocate(int width, int height, uint32_t internalFormat)
+{
+    // The first array of that kind with room, then a deleted array's index, then a new one
+    uint32_t free = UINT32_MAX;
+    for (uint32_t i = 0; i < m_Arrays.size(); i++)
+    {
+        const TextureArray *array = m_Arrays[i].array.get();
+        if (!array)
+        {
+            free = free == UINT32_MAX ? i : free;
+            continue;
+        }
+        if (array->GetWidth() == width && array->GetHeight() == height && array->GetInternalFormat() == internalFormat &&
+            !m_Arrays[i].freeLayers.empty())
+        {
+            TextureLayer layer;
+            layer.array = (uint16_t)i;
+            layer.layer = m_Arrays[i].freeLayers.back();
+            m_Arrays[i].freeLayers.pop_back();
+            m_Arrays[i].allocated[layer.layer] = true;
+            return layer;
+        }
+    }
+
+    if (free == UINT32_MAX)
+    {
+        if (m_Arrays.size() >= UINT16_MAX)
+            throw std::runtime_error("Too many texture arrays");
+        free = (uint32_t)m_Arrays.size();
+        m_Arrays.emplace_back();
+    }
+
+    ArraySlot &slot = m_Arrays[free];
+    slot.array.reset(new TextureArray(width, height, m_LayersPerArray, internalFormat));
+    slot.freeLayers.clear();
+    for (uint32_t layer = m_LayersPerArray; layer-- > 1;)
+        slot.freeLayers.push_back((uint16_t)layer);
+    slot.allocated.assign(m_LayersPerArray, false);
+    slot.allocated[0] = true;
+
+    TextureLayer layer;
+    layer.array = (uint16_t)free;
+    layer.layer = 0;
+    return layer;
+}
+
+void TextureArrayManager::Free(TextureLayer layer)
+{
+    if (!layer.IsValid() || layer.array >= m_Arrays.size() || !m_Arrays[layer.array].array ||
+        layer.layer >= m_LayersPerArray || !m_Arrays[layer.array].allocated[layer.layer])
+        throw std::runtime_error("Freeing a texture layer that isn't allocated");
+
+    ArraySlot &slot = m_Arrays[layer.array];
+    slot.allocated[layer.layer] = false;
+    slot.freeLayers.push_back(layer.layer);
+    if (slot.freeLayers.size() == m_LayersPerArray)
+    {
+        // Deleted after the frames in flight that may still sample it (see ResourceRegistry)
+        slot.array.reset();
+        slot.freeLayers.clear();
+    }
+}
+
+void TextureArrayManager::Upload(TextureLayer layer, const void *pixels)
+{
+    m_Arrays[layer.array].array->SetLayerData(layer.layer, pixels);
+}
+
+TextureLayer TextureArrayManager::Add(const TextureImage &image)
+{
+    if (!image.pixels)
+        return TextureLayer();
+
+    TextureLayer layer = Allocate(image.width, image.height, GL_RGBA8);
+    Upload(layer, image.pixels);
+    return layer;
+}
+
+TextureArrayManagerStats TextureArrayManager::GetStats() const
+{
+    TextureArrayManagerStats stats;
+    for (const ArraySlot &slot : m_Arrays)
+    {
+        if (!slot.array)
+            continue;
+
+        const TextureArray &array = *slot.array;
+        stats.arrayCount++;
+        stats.layerCapacity += array.GetLayerCount();
+        stats.usedLayers += array.GetLayerCount() - (uint32_t)slot.freeLayers.size();
+        stats.bytes += (uint64_t)array.GetWidth() * array.GetHeight() * array.GetLayerCount() * PixelFormat::Get(array.GetInternalFormat()).bytesPerPixel;
+    }
+    return stats;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "ResourceRegistry.hpp"
+#include "Texture.hpp"
+
+// Images of the same size and format as the layers of one GL_TEXTURE_2D_ARRAY. A shader samples it with a
+// sampler2DArray and a layer index (texture(u_Textures, vec3(texCoord, layer))), so quads using different
+// images can share a draw call as long as their images are in the same array.
+class TextureArray
+{
+public:
+    TextureArray(int width, int height, uint32_t layerCount, uint32_t internalFormat = GL_RGBA8);
+
+    // Replaces a whole layer. pixels must be in the format of the internal format (see PixelFormat).
+    void SetLayerData(uint32_t layer, const void *pixels);
+
+    void Bind(uint32_t slot = 0) const;
+
+    inline int GetWidth() const { return m_Width; }
+    inline int GetHeight() const { return m_Height; }
+    inline uint32_t GetLayerCount() const { return m_LayerCount; }
+    inline uint32_t GetInternalFormat() const { return m_InternalFormat; }
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
+
+private:
+    UniqueResource m_Resource;
+    int m_Width, m_Height;
+    uint32_t m_LayerCount;
+    uint32_t m_InternalFormat;
+};
+
+// A layer of one of the arrays of a TextureArrayManager
+struct TextureLayer
+{
+    uint16_t array = UINT16_MAX;
+    uint16_t layer = 0;
+
+    inline bool IsValid() const { return array != UINT16_MAX; }
+};
+
+struct TextureArrayManagerStats
+{
+    uint32_t arrayCount = 0;
+    uint32_t usedLayers = 0;
+    uint32_t layerCapacity = 0; // Of the arrays that exist
+    uint64_t bytes = 0;         // Of the arrays, used layers or not
+};
+
+// Texture storage for batching: every texture is a layer of an array holding textures of the same size
+// and format. Layers are allocated from a free list per array, a new array is created when the ones of a
+// size are full, and an array is deleted once its last layer is freed.
+//
+// Allocations fill the arrays in order, so N textures of a size end up in about N / layersPerArray
+// arrays, and a batch needs one draw call per array instead of one per texture: the layer goes in a
+// vertex or instance attribute, and only the array is bound.
+class TextureArrayManager
+{
+public:
+    // Arrays get layersPerArray layers, at most GL_MAX_ARRAY_TEXTURE_LAYERS (256 or more)
+    explicit TextureArrayManager(uint32_t layersPerArray = 64);
+
+    TextureArrayManager(const TextureArrayManager &) = delete;
+    TextureArrayManager &operator=(const TextureArrayManager &) = delete;
+
+    // A free layer of this size and format, the contents are undefined until Upload()
+    TextureLayer Allocate(int width, int height, uint32_t internalFormat = GL_RGBA8);
+    // Throws std::runtime_error if the layer isn't allocated (freed twice, or never allocated here)
+    void Free(TextureLayer layer);
+
+    void Upload(TextureLayer layer, const void *pixels);
+
+    // Allocate() and Upload() of a decoded image (RGBA8). Invalid if the image has no pixels.
+    TextureLayer Add(const TextureImage &image);
+
+    inline const TextureArray &GetArray(TextureLayer layer) const { return *m_Arrays[layer.array].array; }
+    inline uint32_t GetArrayCount() const { return (uint32_t)m_Arrays.size(); } // Including deleted arrays, whose index is reused
+    inline bool IsArrayAlive(uint32_t array) const { return m_Arrays[array].array != nullptr; }
+
+    TextureArrayManagerStats GetStats() const;
+
+private:
+    struct ArraySlot
+    {
+        std::unique_ptr<TextureArray> array; // Null once deleted
+        std::vector<uint16_t> freeLayers;    // Lowest last, so the layers are used in order
+        std::vector<bool> allocated;         // By layer, so freeing a layer twice is caught
+    };
+
+private:
+    uint32_t m_LayersPerArray;
+    std::vector<ArraySlot> m_Arrays;
+};
@@ -0,0 +1,261 @@
+#include <GL/glew.h>
+
+#include "TileMap.hpp"
+
+#include <stdint.h>
+#include <math.h>
+#include <string.h>
+#include <stdexcept>
+
+TileMap::TileMap(uint32_t width, uint32_t height, uint32_t atlasColumns, uint32_t atlasRows, JobSystem *jobSystem)
+    : m_Width(width), m_Height(height),
+      m_ChunksX((width + CHUNK_SIZE - 1) / CHUNK_SIZE), m_ChunksY((height + CHUNK_SIZE - 1) / CHUNK_SIZE),
+      m_AtlasColumns(atlasColumns), m_AtlasRows(atlasRows), m_JobSystem(jobSystem)
+{
+    // Vertices store tile coordinates as 16-bit integers
+    if (width == 0 || height == 0 || width > UINT16_MAX || height > UINT16_MAX)
+        throw std::runtime_error("Tile maps must be between 1 and 65535 tiles wide and high");
+    if (atlasColumns == 0 || atlasRows == 0)
+        throw std::runtime_error("Tile atlas must have at least one column and one row");
+
+    m_Tiles.resize((size_t)m_ChunksX * m_ChunksY * CHUNK_TILES, 0);
+    m_Chunks.resize((size_t)m_ChunksX * m_ChunksY);
+    m_Stats.chunkCount = (uint32_t)m_Chunks.size();
+
+    std::vector<uint32_t> indices(CHUNK_TILES * 6);
+    for (uint32_t quad = 0; quad < CHUNK_TILES; quad++)
+    {
+        uint32_t first = quad * 4;
+        uint32_t *index = &indices[quad * 6];
+        index[0] = first + 0;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first + 2;
+        index[4] = first + 3;
+        index[5] = first + 0;
+    }
+    m_QuadIndices.reset(new IndexBuffer(indices.data(), (uint32_t)indices.size(), GL_STATIC_DRAW));
+    m_QuadIndices->Unbind();
+
+    m_Layout.Push<uint16_t>(2); // Position, in tiles
+    m_Layout.Push<uint16_t>(2); // Atlas corner, in tiles
+}
+
+TileMap::~TileMap()
+{
+    // The jobs write into the builds, they must be done before the builds go away
+    if (m_JobSystem)
+        m_JobSystem->Wait(m_PendingBuilds);
+    for (uint32_t chunkIndex : m_BuildingChunks)
+        m_BuildPool.Destroy(m_Chunks[chunkIndex].build);
+}
+
+void TileMap::SetTile(uint32_t x, uint32_t y, TileId tile)
+{
+    if (x >= m_Width || y >= m_Height)
+        return;
+
+    TileId &current = m_Tiles[GetTileIndex(x, y)];
+    if (current == tile)
+        return;
+
+    current = tile;
+    MarkDirty((y / CHUNK_SIZE) * m_ChunksX + x / CHUNK_SIZE);
+}
+
+TileId TileMap::GetTile(uint32_t x, uint32_t y) const
+{
+    if (x >= m_Width || y >= m_Height)
+        return 0;
+    return m_Tiles[GetTileIndex(x, y)];
+}
+
+void TileMap::MarkDirty(uint32_t chunkIndex)
+{
+    Chunk &chunk = m_Chunks[chunkIndex];
+    chunk.version++;
+    if (!chunk.queued)
+    {
+        chunk.queued = true;
+        m_DirtyChunks.push_back(chunkIndex);
+    }
+}
+
+void TileMap::Update()
+{
+    // Start a build for every dirty chunk that is not already being built. The ones that are get
+    // rebuilt once their current build lands, since their version will still be newer.
+    size_t kept = 0;
+    for (uint32_t chunkIndex : m_DirtyChunks)
+    {
+        Chunk &chunk = m_Chunks[chunkIndex];
+        if (chunk.building)
+        {
+            m_DirtyChunks[kept++] = chunkIndex;
+            continue;
+        }
+        chunk.queued = false;
+        StartBuild(chunkIndex);
+    }
+    m_DirtyChunks.resize(kept);
+
+    // Help with the builds that no worker has picked up yet, but never wait for the ones running
+    // elsewhere: they are uploaded by a later Update()
+    if (m_JobSystem)
+    {
+        while (!m_PendingBuilds.IsDone() && m_JobSystem->TryRunJob())
+        {
+        }
+    }
+
+    // Upload what is ready (everything, without a job system)
+    kept = 0;
+    for (uint32_t chunkIndex : m_BuildingChunks)
+    {
+        Chunk &chunk = m_Chunks[chunkIndex];
+        if (!chunk.build->ready.load(std::memory_order_acquire))
+        {
+            m_BuildingChunks[kept++] = chunkIndex;
+            continue;
+        }
+        Upload(chunkIndex);
+    }
+    m_BuildingChunks.resize(kept);
+
+    m_Stats.pendingBuilds = (uint32_t)m_BuildingChunks.size();
+}
+
+void TileMap::StartBuild(uint32_t chunkIndex)
+{
+    Chunk &chunk = m_Chunks[chunkIndex];
+    chunk.build = m_BuildPool.Create();
+
+    ChunkBuild &build = *chunk.build;
+    build.originX = (chunkIndex % m_ChunksX) * CHUNK_SIZE;
+    build.originY = (chunkIndex / m_ChunksX) * CHUNK_SIZE;
+    build.atlasColumns = m_AtlasColumns;
+    build.version = chunk.version;
+    memcpy(build.tiles, &m_Tiles[(size_t)chunkIndex * CHUNK_TILES], sizeof(build.tiles));
+    build.ready.store(false, std::memory_order_relaxed);
+
+    chunk.building = true;
+    m_BuildingChunks.push_back(chunkIndex);
+
+    if (m_JobSystem)
+    {
+        ChunkBuild *job = &build;
+        m_JobSystem->Submit([job]() {
+            BuildMesh(*job);
+            job->ready.store(true, std::memory_order_release);
+        }, &m_PendingBuilds);
+    }
+    else
+    {
+        BuildMesh(build);
+        build.ready.store(true, std::memory_order_relaxed);
+    }
+}
+
+void TileMap::BuildMesh(ChunkBuild &build)
+{
+    Vertex *vertex = build.vertices;
+
+    for (uint32_t y = 0; y < CHUNK_SIZE; y++)
+    {
+        for (uint32_t x = 0; x < CHUNK_SIZE; x++)
+        {
+            TileId tile = build.tiles[y * CHUNK_SIZE + x];
+            if (tile == 0)
+                continue;
+
+            uint16_t x0 = (uint16_t)(build.originX + x), y0 = (uint16_t)(build.originY + y);
+            uint16_t u0 = (uint16_t)((tile - 1) % build.atlasColumns), v0 = (uint16_t)((tile - 1) / build.atlasColumns);
+
+            // Atlas rows count from the top, so the bottom of the quad is the row below (v0 + 1)
+            *vertex++ = {x0, y0, u0, (uint16_t)(v0 + 1)};
+            *vertex++ = {(uint16_t)(x0 + 1), y0, (uint16_t)(u0 + 1), (uint16_t)(v0 + 1)};
+            *vertex++ = {(uint16_t)(x0 + 1), (uint16_t)(y0 + 1), (uint16_t)(u0 + 1), v0};
+            *vertex++ = {x0, (uint16_t)(y0 + 1), u0, v0};
+        }
+    }
+    build.vertexCount = (uint32_t)(vertex - build.vertices);
+}
+
+void TileMap::Upload(uint32_t chunkIndex)
+{
+    Chunk &chunk = m_Chunks[chunkIndex];
+    ChunkBuild &build = *chunk.build;
+
+    chunk.building = false;
+    chunk.uploadedVersion = build.version;
+    chunk.quadCount = build.vertexCount / 4;
+    m_Stats.meshesBuilt++;
+
+    if (chunk.quadCount != 0)
+    {
+        uint32_t size = build.vertexCount * (uint32_t)sizeof(Vertex);
+        if (!chunk.vbo)
+        {
+            chunk.vbo.reset(new VertexBuffer(build.vertices, size, GL_STATIC_DRAW));
+            chunk.vao.reset(new VertexArray());
+            chunk.vao->AddVBO(*chunk.vbo, m_Layout);
+            chunk.vao->Unbind();
+        }
+        else
+        {
+            chunk.vbo->SetData(build.vertices, size, GL_STATIC_DRAW);
+        }
+        chunk.vbo->Unbind();
+    }
+
+    m_BuildPool.Destroy(chunk.build);
+    chunk.build = nullptr;
+}
+
+uint32_t TileMap::Draw(const Renderer &renderer, const Shader &shader, float minX, float minY, float maxX, float maxY)
+{
+    m_Stats.drawCalls = 0;
+    m_Stats.drawnTiles = 0;
+
+    auto toChunk = [](float tiles, uint32_t chunkCount) {
+        float chunk = floorf(tiles / (float)CHUNK_SIZE);
+        if (chunk < 0.0f)
+            return 0u;
+        if (chunk >= (float)chunkCount)
+            return chunkCount - 1;
+        return (uint32_t)chunk;
+    };
+
+    if (maxX < 0.0f || maxY < 0.0f || minX >= (float)m_Width || minY >= (float)m_Height)
+        return 0;
+
+    uint32_t chunkMinX = toChunk(minX, m_ChunksX), chunkMaxX = toChunk(maxX, m_ChunksX);
+    uint32_t chunkMinY = toChunk(minY, m_ChunksY), chunkMaxY = toChunk(maxY, m_ChunksY);
+
+    for (uint32_t cy = chunkMinY; cy <= chunkMaxY; cy++)
+    {
+        for (uint32_t cx = chunkMinX; cx <= chunkMaxX; cx++)
+        {
+            const Chunk &chunk = m_Chunks[cy * m_ChunksX + cx];
+            if (!chunk.vao || chunk.quadCount == 0)
+                continue;
+
+            DrawCommand command;
+            command.vertexArray = chunk.vao->GetHandle();
+            command.indexBuffer = m_QuadIndices->GetHandle();
+            command.shader = shader.GetHandle();
+            command.indexCount = chunk.quadCount * 6;
+            renderer.Draw(command);
+
+            m_Stats.drawCalls++;
+            m_Stats.drawnTiles += chunk.quadCount;
+        }
+    }
+    return m_Stats.drawCalls;
+}
+
+void TileMap::SetUniforms(const Shader &shader, float tileSize) const
+{
+    shader.SetUniform("u_TileSize", tileSize);
+    shader.SetUniform("u_AtlasSize", Vec2{(float)m_AtlasColumns, (float)m_AtlasRows});
+}
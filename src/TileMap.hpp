@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "IndexBuffer.hpp"
+#include "ObjectPool.hpp"
+#include "Renderer.hpp"
+#include "Shader.hpp"
+#include "VertexArray.hpp"
+#include "VertexBuffer.hpp"
+
+// Index of a tile in the atlas texture, 0 means no tile.
+// Tile t is in column (t - 1) % atlasColumns and row (t - 1) / atlasColumns, counting rows from the top of the image.
+using TileId = uint16_t;
+
+struct TileMapStats
+{
+    uint32_t chunkCount = 0;
+    uint32_t pendingBuilds = 0;  // Chunk meshes being built right now
+    uint64_t meshesBuilt = 0;    // Since the map was created
+    uint32_t drawCalls = 0;      // In the last Draw()
+    uint32_t drawnTiles = 0;     // In the last Draw()
+};
+
+// Large 2D tile world drawn from cached chunk meshes.
+//
+// The map is split into CHUNK_SIZE x CHUNK_SIZE chunks. Each chunk has a static vertex buffer with
+// one quad per non-empty tile, built on the job system (or inline without one) from a copy of its
+// tiles, so the map can keep changing while meshes are being built. Changing a tile only marks its
+// chunk dirty: Update() rebuilds the dirty chunks and uploads the finished meshes, and Draw() issues
+// one draw call per chunk overlapping the view. A 1024x1024 map is 256 chunks, of which only a few
+// are on screen at once.
+//
+// Vertices are 8 bytes (tile coordinates and atlas corner, as integers), see res/shaders/tilemap.vs.
+class TileMap
+{
+public:
+    static constexpr uint32_t CHUNK_SIZE = 64;
+    static constexpr uint32_t CHUNK_TILES = CHUNK_SIZE * CHUNK_SIZE;
+
+    // jobSystem may be nullptr, meshes are then built during Update()
+    TileMap(uint32_t width, uint32_t height, uint32_t atlasColumns, uint32_t atlasRows, JobSystem *jobSystem = nullptr);
+    ~TileMap();
+
+    TileMap(const TileMap &) = delete;
+    TileMap &operator=(const TileMap &) = delete;
+
+    void SetTile(uint32_t x, uint32_t y, TileId tile);
+    TileId GetTile(uint32_t x, uint32_t y) const;
+
+    // GL thread, once per frame: starts building the dirty chunks, runs the builds no worker has taken
+    // yet, and uploads the meshes that are ready
+    void Update();
+
+    // Draws the chunks overlapping the rectangle [minX, maxX] x [minY, maxY], in tiles.
+    // The shader must be bound, with u_ViewProjection set and SetUniforms() called.
+    // Returns the number of draw calls.
+    uint32_t Draw(const Renderer &renderer, const Shader &shader, float minX, float minY, float maxX, float maxY);
+
+    // Sets the uniforms of res/shaders/tilemap.vs that depend on the map
+    void SetUniforms(const Shader &shader, float tileSize) const;
+
+    inline uint32_t GetWidth() const { return m_Width; }
+    inline uint32_t GetHeight() const { return m_Height; }
+    inline const TileMapStats &GetStats() const { return m_Stats; }
+
+private:
+    struct Vertex
+    {
+        uint16_t x, y; // Corner of the tile in the map, in tiles
+        uint16_t u, v; // Corner of the tile in the atlas, in tiles
+    };
+
+    // Work area of one mesh build (136 KiB, mostly the vertices), taken from m_BuildPool when the build
+    // starts and given back once its mesh is uploaded, so only the chunks being built hold one
+    struct ChunkBuild
+    {
+        uint32_t originX, originY;
+        uint32_t atlasColumns;
+        uint32_t version;
+        TileId tiles[CHUNK_TILES];
+        uint32_t vertexCount;
+        Vertex vertices[CHUNK_TILES * 4];
+        std::atomic<bool> ready{false};
+    };
+
+    struct Chunk
+    {
+        uint32_t version = 1;        // Bumped by every change
+        uint32_t uploadedVersion = 0;
+        uint32_t quadCount = 0;
+        bool queued = false;         // In m_DirtyChunks
+        bool building = false;       // In m_BuildingChunks
+        ChunkBuild *build = nullptr; // While building
+        std::unique_ptr<VertexBuffer> vbo;
+        std::unique_ptr<VertexArray> vao;
+    };
+
+    static void BuildMesh(ChunkBuild &build);
+    void StartBuild(uint32_t chunkIndex);
+    void Upload(uint32_t chunkIndex);
+    void MarkDirty(uint32_t chunkIndex);
+
+    inline uint32_t GetTileIndex(uint32_t x, uint32_t y) const
+    {
+        // Chunk-major, so the tiles of a chunk are contiguous (one memcpy to snapshot them)
+        uint32_t chunk = (y / CHUNK_SIZE) * m_ChunksX + x / CHUNK_SIZE;
+        return chunk * CHUNK_TILES + (y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE;
+    }
+
+private:
+    uint32_t m_Width, m_Height;
+    uint32_t m_ChunksX, m_ChunksY;
+    uint32_t m_AtlasColumns, m_AtlasRows;
+    JobSystem *m_JobSystem;
+
+    std::vector<TileId> m_Tiles;
+    std::vector<Chunk> m_Chunks;
+    std::vector<uint32_t> m_DirtyChunks;
+    std::vector<uint32_t> m_BuildingChunks;
+    JobCounter m_PendingBuilds;
+    ObjectPool<ChunkBuild, 4> m_BuildPool; // 544 KiB per pool chunk
+
+    // Every chunk uses the same quad indices (0 1 2 2 3 0, 4 5 6 6 7 4, ...)
+    std::unique_ptr<IndexBuffer> m_QuadIndices;
+    VertexBufferLayout m_Layout;
+
+    TileMapStats m_Stats;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <chrono>
+
+// CPU timings of the stats and the benchmarks, in milliseconds on the steady clock
+inline double ElapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+inline double ElapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return ElapsedMs(start, std::chrono::steady_clock::now());
+}
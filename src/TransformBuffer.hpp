@@ -0,0 +1,73 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <stdint.h>
+
+#include "TransformHierarchy.hpp"
+#include "ResourceRegistry.hpp"
+
+// GPU copy of the world matrices of a TransformHierarchy, all of them in a single buffer.
+//
+// The buffer is exposed to the shaders as a buffer texture (samplerBuffer), where each matrix
+// takes 4 RGBA32F texels (one per column). Any number of objects can then pick their matrix
+// with texelFetch(u_Transforms, index * 4 + column), without a uniform upload per draw.
+class TransformBuffer
+{
+public:
+    TransformBuffer()
+        : m_Capacity(0)
+    {
+        uint32_t bufferID, textureID;
+        glGenBuffers(1, &bufferID);
+        glGenTextures(1, &textureID);
+        m_Buffer = UniqueResource(ResourceType::Buffer, bufferID);
+        m_Texture = UniqueResource(ResourceType::Texture, textureID);
+    }
+
+    // Uploads the matrices that changed since the last upload (nothing at all for a static scene).
+    // Should be called once per frame, after hierarchy.Update().
+    void Upload(TransformHierarchy &hierarchy)
+    {
+        uint32_t count = hierarchy.GetCount();
+        glBindBuffer(GL_TEXTURE_BUFFER, m_Buffer.GetRendererID());
+
+        if (count > m_Capacity)
+        {
+            // Grow geometrically so adding nodes one by one does not reallocate every frame
+            m_Capacity = count > m_Capacity * 2 ? count : m_Capacity * 2;
+            glBufferData(GL_TEXTURE_BUFFER, m_Capacity * sizeof(TransformMatrix), nullptr, GL_DYNAMIC_DRAW);
+            glBufferSubData(GL_TEXTURE_BUFFER, 0, count * sizeof(TransformMatrix), hierarchy.GetWorldMatrices());
+
+            glBindTexture(GL_TEXTURE_BUFFER, m_Texture.GetRendererID());
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_Buffer.GetRendererID());
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        }
+        else if (hierarchy.HasChanges())
+        {
+            uint32_t begin = hierarchy.GetChangedBegin();
+            uint32_t end = hierarchy.GetChangedEnd() < count ? hierarchy.GetChangedEnd() : count;
+            if (begin < end)
+                glBufferSubData(GL_TEXTURE_BUFFER, begin * sizeof(TransformMatrix), (end - begin) * sizeof(TransformMatrix), hierarchy.GetWorldMatrices() + begin);
+        }
+
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        hierarchy.ClearChangedRange();
+    }
+
+    void Bind(uint32_t slot = 0) const
+    {
+        glActiveTexture(GL_TEXTURE0 + slot);
+        glBindTexture(GL_TEXTURE_BUFFER, m_Texture.GetRendererID());
+    }
+
+    void Unbind() const
+    {
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+private:
+    UniqueResource m_Buffer;
+    UniqueResource m_Texture;
+    uint32_t m_Capacity;
+};
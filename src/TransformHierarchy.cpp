@@ -0,0 +1,227 @@
+#include "TransformHierarchy.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+static constexpr uint32_t NO_PARENT = 0xFFFFFFFF;
+
+TransformId TransformHierarchy::Create(TransformId parent)
+{
+    return Create(Mat4::Identity(), parent);
+}
+
+TransformId TransformHierarchy::Create(const TransformMatrix &local, TransformId parent)
+{
+    TransformId id;
+    if (!m_FreeIds.empty())
+    {
+        id = m_FreeIds.back();
+        m_FreeIds.pop_back();
+    }
+    else
+    {
+        id = (TransformId)m_IndexOf.size();
+        m_IndexOf.push_back(0);
+        m_IsDirty.push_back(0);
+    }
+
+    // Appending keeps parents before children, but breaks the depth-first order
+    // (the new node is not next to its siblings), so the arrays are sorted in the next Update()
+    uint32_t index = (uint32_t)m_Local.size();
+    m_IndexOf[id] = index;
+    m_Local.push_back(local);
+    m_World.push_back(local);
+    m_Parent.push_back(parent == INVALID_TRANSFORM ? NO_PARENT : m_IndexOf[parent]);
+    m_SubtreeEnd.push_back(index + 1);
+    m_Id.push_back(id);
+    m_Destroyed.push_back(0);
+
+    m_NeedsSort = true;
+    MarkDirty(id);
+    return id;
+}
+
+void TransformHierarchy::Destroy(TransformId id)
+{
+    // Descendants are collected (and their ids freed) when the arrays are sorted again
+    m_Destroyed[m_IndexOf[id]] = 1;
+    m_NeedsSort = true;
+}
+
+void TransformHierarchy::SetParent(TransformId id, TransformId parent)
+{
+    uint32_t index = m_IndexOf[id];
+    if (parent == INVALID_TRANSFORM)
+    {
+        m_Parent[index] = NO_PARENT;
+    }
+    else
+    {
+        // Walk up from the new parent to make sure we are not creating a cycle
+        for (uint32_t ancestor = m_IndexOf[parent]; ancestor != NO_PARENT; ancestor = m_Parent[ancestor])
+        {
+            if (ancestor == index)
+                throw std::runtime_error("Cannot parent a transform to one of its descendants");
+        }
+        m_Parent[index] = m_IndexOf[parent];
+    }
+
+    m_NeedsSort = true;
+    MarkDirty(id);
+}
+
+TransformId TransformHierarchy::GetParent(TransformId id) const
+{
+    uint32_t parent = m_Parent[m_IndexOf[id]];
+    return parent == NO_PARENT ? INVALID_TRANSFORM : m_Id[parent];
+}
+
+void TransformHierarchy::SetLocal(TransformId id, const TransformMatrix &local)
+{
+    m_Local[m_IndexOf[id]] = local;
+    MarkDirty(id);
+}
+
+void TransformHierarchy::MarkDirty(TransformId id)
+{
+    if (m_IsDirty[id])
+        return;
+
+    m_IsDirty[id] = 1;
+    m_DirtyIds.push_back(id);
+}
+
+void TransformHierarchy::MarkChanged(uint32_t begin, uint32_t end)
+{
+    m_ChangedBegin = std::min(m_ChangedBegin, begin);
+    m_ChangedEnd = std::max(m_ChangedEnd, end);
+}
+
+void TransformHierarchy::Update()
+{
+    if (m_NeedsSort)
+        Sort();
+
+    if (m_DirtyIds.empty())
+        return;
+
+    // Processing dirty nodes in depth-first order lets us skip the ones
+    // that are inside a subtree we have already recomputed.
+    std::vector<uint32_t> &dirty = m_DirtyIds;
+    for (uint32_t &id : dirty)
+    {
+        m_IsDirty[id] = 0;
+        id = m_IndexOf[id];
+    }
+    std::sort(dirty.begin(), dirty.end());
+
+    uint32_t coveredEnd = 0;
+    for (uint32_t first : dirty)
+    {
+        if (first < coveredEnd)
+            continue;
+
+        uint32_t end = m_SubtreeEnd[first];
+        for (uint32_t i = first; i < end; i++)
+        {
+            uint32_t parent = m_Parent[i];
+            m_World[i] = parent == NO_PARENT ? m_Local[i] : m_World[parent] * m_Local[i];
+        }
+
+        MarkChanged(first, end);
+        coveredEnd = end;
+    }
+    dirty.clear();
+}
+
+void TransformHierarchy::Sort()
+{
+    uint32_t count = (uint32_t)m_Local.size();
+
+    // Children lists as linked lists inside two flat arrays
+    std::vector<uint32_t> firstChild(count, NO_PARENT), nextSibling(count, NO_PARENT);
+    std::vector<uint32_t> stack;
+    for (uint32_t i = count; i-- > 0;)
+    {
+        if (m_Parent[i] == NO_PARENT)
+        {
+            stack.push_back(i);
+        }
+        else
+        {
+            nextSibling[i] = firstChild[m_Parent[i]];
+            firstChild[m_Parent[i]] = i;
+        }
+    }
+
+    std::vector<TransformMatrix> local, world;
+    std::vector<uint32_t> parent, subtreeEnd;
+    std::vector<TransformId> ids;
+    std::vector<uint32_t> newIndex(count, NO_PARENT);
+    local.reserve(count);
+    world.reserve(count);
+    parent.reserve(count);
+    ids.reserve(count);
+
+    // Pre-order depth-first traversal: each subtree ends up in a contiguous range
+    while (!stack.empty())
+    {
+        uint32_t old = stack.back();
+        stack.pop_back();
+
+        if (m_Destroyed[old])
+        {
+            // Free the whole subtree
+            std::vector<uint32_t> doomed{old};
+            while (!doomed.empty())
+            {
+                uint32_t node = doomed.back();
+                doomed.pop_back();
+                m_FreeIds.push_back(m_Id[node]);
+                m_IsDirty[m_Id[node]] = 0;
+                for (uint32_t child = firstChild[node]; child != NO_PARENT; child = nextSibling[child])
+                    doomed.push_back(child);
+            }
+            continue;
+        }
+
+        newIndex[old] = (uint32_t)local.size();
+        local.push_back(m_Local[old]);
+        world.push_back(m_World[old]);
+        parent.push_back(m_Parent[old] == NO_PARENT ? NO_PARENT : newIndex[m_Parent[old]]);
+        ids.push_back(m_Id[old]);
+
+        for (uint32_t child = firstChild[old]; child != NO_PARENT; child = nextSibling[child])
+            stack.push_back(child);
+    }
+
+    // A subtree ends where the last of its descendants ends
+    uint32_t newCount = (uint32_t)local.size();
+    subtreeEnd.resize(newCount);
+    for (uint32_t i = 0; i < newCount; i++)
+        subtreeEnd[i] = i + 1;
+    for (uint32_t i = newCount; i-- > 0;)
+    {
+        if (parent[i] != NO_PARENT)
+            subtreeEnd[parent[i]] = std::max(subtreeEnd[parent[i]], subtreeEnd[i]);
+    }
+
+    for (uint32_t i = 0; i < newCount; i++)
+        m_IndexOf[ids[i]] = i;
+
+    // Destroyed ids may still be in the dirty list
+    m_DirtyIds.erase(std::remove_if(m_DirtyIds.begin(), m_DirtyIds.end(), [this](TransformId id) { return !m_IsDirty[id]; }), m_DirtyIds.end());
+
+    m_Local.swap(local);
+    m_World.swap(world);
+    m_Parent.swap(parent);
+    m_SubtreeEnd.swap(subtreeEnd);
+    m_Id.swap(ids);
+    m_Destroyed.assign(newCount, 0);
+    m_NeedsSort = false;
+
+    // Every index moved, so the whole buffer has to be uploaded again
+    MarkChanged(0, newCount);
+}
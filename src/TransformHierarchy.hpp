@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "Math.hpp"
+
+// Column-major, so the world matrices can be uploaded as they are
+using TransformMatrix = Mat4;
+
+// Stable handle to a node of the hierarchy.
+// The node's position inside the world matrix array can change (see GetIndex), the id never does.
+using TransformId = uint32_t;
+static constexpr TransformId INVALID_TRANSFORM = 0xFFFFFFFF;
+
+// Flat transform hierarchy (a scene graph without the graph).
+//
+// Instead of nodes with pointers to their children, every node lives in a few contiguous arrays
+// (parent index, local matrix, world matrix) sorted in depth-first order, which means:
+// - a parent always comes before its children, so world matrices can be computed in a single forward pass
+// - the subtree of a node is the contiguous range [index, subtreeEnd)
+//
+// Changing a local matrix only marks the node as dirty. Update() then recomputes the world
+// matrices of the dirty subtrees and nothing else, so a static scene costs nothing per frame.
+// Structural changes (create, destroy, reparent) are cheap too: they just append or flag nodes,
+// and the arrays are sorted again once, in the next Update().
+class TransformHierarchy
+{
+public:
+    TransformId Create(TransformId parent = INVALID_TRANSFORM);
+    TransformId Create(const TransformMatrix &local, TransformId parent = INVALID_TRANSFORM);
+
+    // Destroys the node and all of its descendants
+    void Destroy(TransformId id);
+
+    void SetParent(TransformId id, TransformId parent);
+    TransformId GetParent(TransformId id) const;
+
+    void SetLocal(TransformId id, const TransformMatrix &local);
+    inline const TransformMatrix &GetLocal(TransformId id) const { return m_Local[m_IndexOf[id]]; }
+
+    // Only up to date after Update()
+    inline const TransformMatrix &GetWorld(TransformId id) const { return m_World[m_IndexOf[id]]; }
+
+    // Position of the node in the world matrix array (and in the GPU buffer it is uploaded to).
+    // Only valid until the next structural change, so it should be queried after every Update().
+    inline uint32_t GetIndex(TransformId id) const { return m_IndexOf[id]; }
+
+    void Update();
+
+    inline uint32_t GetCount() const { return (uint32_t)m_World.size(); }
+    inline const TransformMatrix *GetWorldMatrices() const { return m_World.data(); }
+
+    // Range [begin, end) of world matrices that changed since the last ClearChangedRange().
+    // Lets the GPU copy be updated with a single partial upload.
+    inline uint32_t GetChangedBegin() const { return m_ChangedBegin; }
+    inline uint32_t GetChangedEnd() const { return m_ChangedEnd; }
+    inline bool HasChanges() const { return m_ChangedBegin < m_ChangedEnd; }
+    inline void ClearChangedRange() { m_ChangedBegin = UINT32_MAX, m_ChangedEnd = 0; }
+
+private:
+    void MarkDirty(TransformId id);
+    void MarkChanged(uint32_t begin, uint32_t end);
+    void Sort();
+
+private:
+    // Indexed by position in depth-first order
+    std::vector<TransformMatrix> m_Local;
+    std::vector<TransformMatrix> m_World;
+    std::vector<uint32_t> m_Parent;
+    std::vector<uint32_t> m_SubtreeEnd;
+    std::vector<TransformId> m_Id;
+    std::vector<uint8_t> m_Destroyed;
+
+    // Indexed by id
+    std::vector<uint32_t> m_IndexOf;
+    std::vector<uint8_t> m_IsDirty;
+    std::vector<TransformId> m_FreeIds;
+
+    std::vector<TransformId> m_DirtyIds;
+    bool m_NeedsSort = false;
+
+    uint32_t m_ChangedBegin = UINT32_MAX;
+    uint32_t m_ChangedEnd = 0;
+};
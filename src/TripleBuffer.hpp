@@ -0,0 +1,68 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free single producer / single consumer triple buffer.
+//
+// The writer always owns one buffer (back), the reader always owns another (front), and the third
+// one (middle) holds the latest published value. Publishing and reading just swap an index with
+// the middle buffer atomically, so neither side ever blocks or waits for the other, and the
+// reader always gets the most recent complete value (intermediate ones may be skipped).
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : m_Middle(2), m_Back(0), m_Front(1)
+    {
+    }
+
+    TripleBuffer(const T &initial)
+        : TripleBuffer()
+    {
+        for (Slot &slot : m_Buffers)
+            slot.value = initial;
+    }
+
+    // --- Writer thread ---
+
+    inline T &GetWriteBuffer() { return m_Buffers[m_Back].value; }
+
+    // Makes the write buffer the latest value, and takes the old middle buffer to write the next one
+    void Publish()
+    {
+        uint8_t old = m_Middle.exchange(m_Back | FRESH_BIT, std::memory_order_acq_rel);
+        m_Back = old & INDEX_MASK;
+    }
+
+    // --- Reader thread ---
+
+    // Grabs the latest published value, if there is a new one. Returns whether the read buffer changed.
+    bool Update()
+    {
+        if (!(m_Middle.load(std::memory_order_relaxed) & FRESH_BIT))
+            return false;
+
+        uint8_t old = m_Middle.exchange(m_Front, std::memory_order_acq_rel);
+        m_Front = old & INDEX_MASK;
+        return true;
+    }
+
+    inline const T &GetReadBuffer() const { return m_Buffers[m_Front].value; }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH_BIT = 0x4;
+
+    // Each buffer on its own cache line, so the two threads don't fight over the same line
+    struct alignas(64) Slot
+    {
+        T value;
+    };
+
+    Slot m_Buffers[3];
+    alignas(64) std::atomic<uint8_t> m_Middle;
+    alignas(64) uint8_t m_Back;  // Only touched by the writer
+    alignas(64) uint8_t m_Front; // Only touched by the reader
+};
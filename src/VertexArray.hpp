@@ -7,40 +7,47 @@
 #include "VertexBuffer.hpp"
 #include "IndexBuffer.hpp"
 #include "VertexBufferLayout.hpp"
+#include "ResourceRegistry.hpp"
 
 class VertexArray
 {
 public:
     VertexArray() {
-        glGenVertexArrays(1, &m_RendererID);
-    }
-
-    ~VertexArray() {
-        glDeleteVertexArrays(1, &m_RendererID);
+        uint32_t rendererID;
+        glGenVertexArrays(1, &rendererID);
+        m_Resource = UniqueResource(ResourceType::VertexArray, rendererID);
     }
 
     void Bind() const {
-        glBindVertexArray(m_RendererID);
+        glBindVertexArray(m_Resource.GetRendererID());
     }
 
     void Unbind() const {
         glBindVertexArray(0);
     }
 
-    void AddVBO(const VertexBuffer& vbo, const VertexBufferLayout& layout) {
+    // vbo is a VertexBuffer, or a StreamBuffer for vertices written every frame. The attributes
+    // start at baseOffset bytes in the buffer, calling AddVBO again moves them (e.g. to this frame's region).
+    template <typename Buffer>
+    void AddVBO(const Buffer& vbo, const VertexBufferLayout& layout, uint32_t baseOffset = 0) {
         this->Bind();
         vbo.Bind();
 
-        const auto& elements = layout.GetElements();
-        
-        uint32_t offset = 0;
-        for (size_t i = 0; i < elements.size(); ++i) {
+        uint32_t offset = baseOffset;
+        for (uint32_t i = 0; i < layout.GetElementCount(); ++i) {
+            const auto& element = layout.GetElement(i);
             glEnableVertexAttribArray(i);
-            glVertexAttribPointer(i, elements[i].count, elements[i].type, elements[i].normalized, layout.GetStride(), (const void*) (int*) offset);
-            offset += elements[i].count * VertexBufferLayoutElement::GetSize(elements[i].type);
+            if (element.integer)
+                glVertexAttribIPointer(i, element.count, element.type, layout.GetStride(), (const void*) (int*) offset);
+            else
+                glVertexAttribPointer(i, element.count, element.type, element.normalized, layout.GetStride(), (const void*) (int*) offset);
+            glVertexAttribDivisor(i, layout.GetDivisor());
+            offset += element.count * VertexBufferLayoutElement::GetSize(element.type);
         }
     }
 
+    inline ResourceHandle GetHandle() const { return m_Resource.GetHandle(); }
+
 private:
-    uint32_t m_RendererID;
+    UniqueResource m_Resource;
 };
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <stdint.h>
 #include <GL/glew.h>
 
+#include "ResourceRegistry.hpp"
+
 // Vertex buffer is a set of vertices that are passed to the shader in the form of different attributes glued together.
 // That means a vertex buffer can be represented as folloiwng:
 // vertexBuffer = [ vertex1, vertex2, vertex3, vertex4, ... ]
@@ -14,19 +16,24 @@ class VertexBuffer
 public:
     VertexBuffer(void *data, uint32_t size, uint32_t usage)
     {
-        glGenBuffers(1, &m_RendererID);
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        uint32_t rendererID;
+        glGenBuffers(1, &rendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, rendererID);
         glBufferData(GL_ARRAY_BUFFER, size, data, usage);
+        m_Resource = UniqueResource(ResourceType::Buffer, rendererID);
     }
 
-    ~VertexBuffer(void)
+    // Replaces the whole contents. The old storage is orphaned, so frames still in flight
+    // keep drawing from it and the driver doesn't have to wait for them.
+    void SetData(const void *data, uint32_t size, uint32_t usage)
     {
-        glDeleteBuffers(1, &m_RendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, m_Resource.GetRendererID());
+        glBufferData(GL_ARRAY_BUFFER, size, data, usage);
     }
 
     void Bind(void) const
     {
-        glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+        glBindBuffer(GL_ARRAY_BUFFER, m_Resource.GetRendererID());
     }
 
     void Unbind(void) const
@@ -34,6 +41,8 @@ public:
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
+    inline ResourceHandle GetHandle(void) const { return m_Resource.GetHandle(); }
+
 private:
-    uint32_t m_RendererID;
+    UniqueResource m_Resource;
 };
\ No newline at end of file
@@ -2,7 +2,8 @@
 
 #include <GL/glew.h>
 
-#include <vector>
+#include <array>
+#include <stdexcept>
 #include <stdint.h>
 #include <signal.h>
 
@@ -11,6 +12,7 @@ struct VertexBufferLayoutElement
     uint32_t type;
     uint32_t count;
     uint32_t normalized;
+    bool integer; // Read as integers by the shader (ivec/uvec inputs), see VertexArray::AddVBO
 
     static uint32_t GetSize(uint32_t type)
     {
@@ -37,45 +39,93 @@ struct VertexBufferLayoutElement
     }
 };
 
+// The elements are stored inline (no heap allocation), since OpenGL only guarantees
+// 16 vertex attributes (GL_MAX_VERTEX_ATTRIBS) anyway.
 class VertexBufferLayout
 {
+public:
+    static constexpr uint32_t MAX_ELEMENTS = 16;
+
 private:
-    std::vector<VertexBufferLayoutElement> m_Elements;
+    std::array<VertexBufferLayoutElement, MAX_ELEMENTS> m_Elements;
+    uint32_t m_ElementCount;
     uint32_t m_Stride;
+    uint32_t m_Divisor;
 
 public:
     VertexBufferLayout()
-        : m_Stride(0)
+        : m_ElementCount(0), m_Stride(0), m_Divisor(0)
     {
     }
 
+    // 1 to advance the attributes once per instance instead of once per vertex (glVertexAttribDivisor)
+    void SetDivisor(uint32_t divisor) { m_Divisor = divisor; }
+    inline uint32_t GetDivisor() const { return m_Divisor; }
+
     template <typename T>
     void Push(uint32_t count)
     {
     }
 
-    inline const std::vector<VertexBufferLayoutElement> &GetElements() const { return m_Elements; }
+    // Same as Push, for attributes the shader declares as int/uint (e.g. bit-packed vertices),
+    // which glVertexAttribPointer would convert to floats
+    template <typename T>
+    void PushInteger(uint32_t count)
+    {
+    }
+
+    inline const VertexBufferLayoutElement &GetElement(uint32_t index) const { return m_Elements[index]; }
+    inline uint32_t GetElementCount() const { return m_ElementCount; }
     inline uint32_t GetStride() const { return m_Stride; }
+
+private:
+    void PushElement(uint32_t type, uint32_t count, bool integer = false)
+    {
+        if (m_ElementCount == MAX_ELEMENTS)
+            throw std::runtime_error("VertexBufferLayout supports at most 16 elements");
+
+        m_Elements[m_ElementCount++] = {
+            type,
+            count,
+            GL_FALSE,
+            integer,
+        };
+        m_Stride += VertexBufferLayoutElement::GetSize(type) * count;
+    }
 };
 
 template <>
-void VertexBufferLayout::Push<float>(uint32_t count)
+inline void VertexBufferLayout::Push<float>(uint32_t count)
+{
+    PushElement(GL_FLOAT, count);
+}
+
+template <>
+inline void VertexBufferLayout::Push<uint32_t>(uint32_t count)
+{
+    PushElement(GL_UNSIGNED_INT, count);
+}
+
+template <>
+inline void VertexBufferLayout::Push<uint16_t>(uint32_t count)
+{
+    PushElement(GL_UNSIGNED_SHORT, count);
+}
+
+template <>
+inline void VertexBufferLayout::Push<uint8_t>(uint32_t count)
+{
+    PushElement(GL_UNSIGNED_BYTE, count);
+}
+
+template <>
+inline void VertexBufferLayout::PushInteger<uint32_t>(uint32_t count)
 {
-    m_Elements.push_back({
-        GL_FLOAT,
-        count,
-        GL_FALSE,
-    });
-    m_Stride += VertexBufferLayoutElement::GetSize(GL_FLOAT) * count;
+    PushElement(GL_UNSIGNED_INT, count, true);
 }
 
 template <>
-void VertexBufferLayout::Push<uint32_t>(uint32_t count)
+inline void VertexBufferLayout::PushInteger<int32_t>(uint32_t count)
 {
-    m_Elements.push_back({
-        GL_UNSIGNED_INT,
-        count,
-        GL_FALSE,
-    });
-    m_Stride += sizeof(uint32_t) * count;
+    PushElement(GL_INT, count, true);
 }
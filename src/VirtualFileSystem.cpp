@@ -0,0 +1,124 @@
+#include "VirtualFileSystem.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+VirtualFileSystem &VirtualFileSystem::Get()
+{
+    static VirtualFileSystem fileSystem;
+    return fileSystem;
+}
+
+void VirtualFileSystem::Mount(const std::string &archivePath)
+{
+    m_Archives.emplace_back(new ResourceArchive(archivePath));
+}
+
+bool VirtualFileSystem::ReadFile(const std::string &path, FileData &file) const
+{
+    file.storage.clear();
+    file.data = nullptr;
+    file.size = 0;
+
+    if (!m_Archives.empty())
+    {
+        std::string normalized = NormalizePath(path);
+        for (size_t i = m_Archives.size(); i-- > 0;)
+        {
+            const ResourceArchive &archive = *m_Archives[i];
+            const ArchiveEntry *entry = archive.Find(normalized);
+            if (!entry)
+                continue;
+
+            if (entry->compression == ArchiveCompression::None)
+            {
+                file.data = archive.GetStoredData(*entry);
+            }
+            else
+            {
+                archive.Read(*entry, file.storage);
+                file.data = file.storage.data();
+            }
+            file.size = entry->size;
+            return true;
+        }
+    }
+
+    // One read of the whole file, rather than the chunks of a stream
+    FILE *loose = fopen(path.c_str(), "rb");
+    if (!loose)
+        return false;
+
+    bool ok = fseek(loose, 0, SEEK_END) == 0;
+    long size = ok ? ftell(loose) : -1;
+    ok = size >= 0 && fseek(loose, 0, SEEK_SET) == 0;
+    if (ok)
+    {
+        file.storage.resize((size_t)size);
+        ok = fread(file.storage.data(), 1, file.storage.size(), loose) == file.storage.size();
+    }
+    fclose(loose);
+
+    if (!ok)
+    {
+        file.storage.clear();
+        return false;
+    }
+    file.data = file.storage.data();
+    file.size = file.storage.size();
+    return true;
+}
+
+bool VirtualFileSystem::Exists(const std::string &path) const
+{
+    if (!m_Archives.empty())
+    {
+        std::string normalized = NormalizePath(path);
+        for (const std::unique_ptr<ResourceArchive> &archive : m_Archives)
+        {
+            if (archive->Find(normalized))
+                return true;
+        }
+    }
+
+    FILE *loose = fopen(path.c_str(), "rb");
+    if (loose)
+        fclose(loose);
+    return loose != nullptr;
+}
+
+std::string VirtualFileSystem::NormalizePath(const std::string &path)
+{
+    std::vector<std::string> components;
+    size_t start = 0;
+    bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+    while (start <= path.size())
+    {
+        size_t end = path.find_first_of("/\\", start);
+        if (end == std::string::npos)
+            end = path.size();
+
+        std::string component = path.substr(start, end - start);
+        if (component == "..")
+        {
+            if (!components.empty() && components.back() != "..")
+                components.pop_back();
+            else if (!absolute)
+                components.push_back(component); // Above the working directory, kept
+        }
+        else if (!component.empty() && component != ".")
+        {
+            components.push_back(component);
+        }
+        start = end + 1;
+    }
+
+    std::string normalized = absolute ? "/" : "";
+    for (size_t i = 0; i < components.size(); i++)
+        normalized += (i > 0 ? "/" : "") + components[i];
+    return normalized;
+}
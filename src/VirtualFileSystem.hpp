@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ResourceArchive.hpp"
+
+// The contents of a file. Points into a mapped archive when the file is stored uncompressed there
+// (nothing is copied), otherwise into its own storage. Move-only, so data never dangles.
+struct FileData
+{
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> storage; // Empty when data points into an archive
+
+    FileData() = default;
+    FileData(const FileData &) = delete;
+    FileData &operator=(const FileData &) = delete;
+    FileData(FileData &&) = default;
+    FileData &operator=(FileData &&) = default;
+
+    inline std::string ToString() const { return std::string((const char *)data, size); }
+};
+
+// Where the loaders (ShaderPreprocessor, TextureImage, Font) get their files: the mounted archives first,
+// the most recently mounted one first, then the loose files on disk. So a packed build runs from
+// one archive, and a file can still be overridden on disk when it's not in any archive.
+//
+// Mount the archives at startup: reading is thread safe (textures are decoded on jobs), mounting isn't.
+class VirtualFileSystem
+{
+public:
+    static VirtualFileSystem &Get();
+
+    VirtualFileSystem(const VirtualFileSystem &) = delete;
+    VirtualFileSystem &operator=(const VirtualFileSystem &) = delete;
+
+    // Throws std::runtime_error if the file isn't a valid archive
+    void Mount(const std::string &archivePath);
+    void UnmountAll() { m_Archives.clear(); }
+    inline size_t GetMountCount() const { return m_Archives.size(); }
+
+    // Returns false if the file is in no archive and can't be read from disk.
+    // Throws std::runtime_error if its archive entry is corrupt.
+    bool ReadFile(const std::string &path, FileData &file) const;
+    bool Exists(const std::string &path) const;
+
+    // The form of the paths in the archives: '/' separators, no "." or "dir/.." components, e.g.
+    // "./res/shaders/include/../voxel.vs" is "res/shaders/voxel.vs"
+    static std::string NormalizePath(const std::string &path);
+
+private:
+    VirtualFileSystem() = default;
+
+private:
+    std::vector<std::unique_ptr<ResourceArchive>> m_Archives;
+};
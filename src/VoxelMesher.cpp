@@ -0,0 +1,156 @@
+#include "VoxelMesher.hpp"
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+static constexpr int S = (int)VoxelChunk::CHUNK_SIZE;
+
+// Whether the block at (x, y, z) is solid. At most one coordinate may be outside the chunk,
+// the block is then looked up in the neighbor on that side.
+static inline bool IsSolid(const VoxelChunk &chunk, const VoxelNeighbors &neighbors, int x, int y, int z)
+{
+    const VoxelChunk *const *n = neighbors.chunks;
+    if (x < 0)
+        return n[FACE_NEGATIVE_X] && n[FACE_NEGATIVE_X]->GetBlock(x + S, y, z) != 0;
+    if (x >= S)
+        return n[FACE_POSITIVE_X] && n[FACE_POSITIVE_X]->GetBlock(x - S, y, z) != 0;
+    if (y < 0)
+        return n[FACE_NEGATIVE_Y] && n[FACE_NEGATIVE_Y]->GetBlock(x, y + S, z) != 0;
+    if (y >= S)
+        return n[FACE_POSITIVE_Y] && n[FACE_POSITIVE_Y]->GetBlock(x, y - S, z) != 0;
+    if (z < 0)
+        return n[FACE_NEGATIVE_Z] && n[FACE_NEGATIVE_Z]->GetBlock(x, y, z + S) != 0;
+    if (z >= S)
+        return n[FACE_POSITIVE_Z] && n[FACE_POSITIVE_Z]->GetBlock(x, y, z - S) != 0;
+    return chunk.GetBlock(x, y, z) != 0;
+}
+
+// Quad on the plane pos[d] = plane, covering [i, i + w] x [j, j + h] on the u and v axes.
+// Counter-clockwise seen from the side the face points to.
+static inline void EmitQuad(std::vector<uint32_t> &vertices, int d, int u, int v, int plane, int i, int j, int w, int h,
+                            uint32_t face, BlockId block, bool positive)
+{
+    auto corner = [&](int a, int b) {
+        int pos[3];
+        pos[d] = plane;
+        pos[u] = a;
+        pos[v] = b;
+        return VoxelVertex::Pack(pos[0], pos[1], pos[2], face, block);
+    };
+
+    // e_u x e_v = e_d, so (u, then v) winds counter-clockwise when looking down -d
+    if (positive)
+    {
+        vertices.push_back(corner(i, j));
+        vertices.push_back(corner(i + w, j));
+        vertices.push_back(corner(i + w, j + h));
+        vertices.push_back(corner(i, j + h));
+    }
+    else
+    {
+        vertices.push_back(corner(i, j));
+        vertices.push_back(corner(i, j + h));
+        vertices.push_back(corner(i + w, j + h));
+        vertices.push_back(corner(i + w, j));
+    }
+}
+
+template <bool Greedy>
+static uint32_t Mesh(const VoxelChunk &chunk, const VoxelNeighbors &neighbors, std::vector<uint32_t> &vertices)
+{
+    size_t start = vertices.size();
+
+    // Visible faces of one slice, by block (0 = no face)
+    BlockId mask[S * S];
+
+    for (uint32_t face = 0; face < 6; face++)
+    {
+        int d = (int)face / 2, u = (d + 1) % 3, v = (d + 2) % 3;
+        bool positive = face % 2 == 0;
+        int step = positive ? 1 : -1;
+
+        for (int slice = 0; slice < S; slice++)
+        {
+            int pos[3];
+            pos[d] = slice;
+            for (int j = 0; j < S; j++)
+            {
+                pos[v] = j;
+                for (int i = 0; i < S; i++)
+                {
+                    pos[u] = i;
+                    BlockId block = chunk.GetBlock(pos[0], pos[1], pos[2]);
+
+                    int next[3] = {pos[0], pos[1], pos[2]};
+                    next[d] += step;
+                    mask[j * S + i] = block != 0 && !IsSolid(chunk, neighbors, next[0], next[1], next[2]) ? block : 0;
+                }
+            }
+
+            int plane = positive ? slice + 1 : slice;
+            for (int j = 0; j < S; j++)
+            {
+                for (int i = 0; i < S;)
+                {
+                    BlockId block = mask[j * S + i];
+                    if (block == 0)
+                    {
+                        i++;
+                        continue;
+                    }
+
+                    int w = 1, h = 1;
+                    if (Greedy)
+                    {
+                        // Widest run of this block on the row, then as many rows below as match it entirely
+                        while (i + w < S && mask[j * S + i + w] == block)
+                            w++;
+
+                        for (; j + h < S; h++)
+                        {
+                            const BlockId *row = &mask[(j + h) * S + i];
+                            int k = 0;
+                            while (k < w && row[k] == block)
+                                k++;
+                            if (k < w)
+                                break;
+                        }
+
+                        for (int y = 0; y < h; y++)
+                            memset(&mask[(j + y) * S + i], 0, w);
+                    }
+
+                    EmitQuad(vertices, d, u, v, plane, i, j, w, h, face, block, positive);
+                    i += w;
+                }
+            }
+        }
+    }
+
+    return (uint32_t)((vertices.size() - start) / 4);
+}
+
+uint32_t VoxelMesher::MeshGreedy(const VoxelChunk &chunk, const VoxelNeighbors &neighbors, std::vector<uint32_t> &vertices)
+{
+    return Mesh<true>(chunk, neighbors, vertices);
+}
+
+uint32_t VoxelMesher::MeshCulled(const VoxelChunk &chunk, const VoxelNeighbors &neighbors, std::vector<uint32_t> &vertices)
+{
+    return Mesh<false>(chunk, neighbors, vertices);
+}
+
+uint32_t VoxelMesher::CountAllFaces(const VoxelChunk &chunk)
+{
+    uint32_t solid = 0;
+    for (uint32_t y = 0; y < VoxelChunk::CHUNK_SIZE; y++)
+    {
+        for (uint32_t z = 0; z < VoxelChunk::CHUNK_SIZE; z++)
+        {
+            for (uint32_t x = 0; x < VoxelChunk::CHUNK_SIZE; x++)
+                solid += chunk.GetBlock(x, y, z) != 0;
+        }
+    }
+    return solid * 6;
+}
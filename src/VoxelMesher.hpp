@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// Type of a voxel, 0 is air. Block b uses cell b - 1 of the texture atlas (see res/shaders/voxel.vs).
+using BlockId = uint8_t;
+
+// Cube of CHUNK_SIZE^3 blocks
+class VoxelChunk
+{
+public:
+    static constexpr uint32_t CHUNK_SIZE = 32;
+    static constexpr uint32_t CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+    VoxelChunk()
+    {
+        memset(m_Blocks, 0, sizeof(m_Blocks));
+    }
+
+    inline BlockId GetBlock(uint32_t x, uint32_t y, uint32_t z) const { return m_Blocks[GetIndex(x, y, z)]; }
+    inline void SetBlock(uint32_t x, uint32_t y, uint32_t z, BlockId block) { m_Blocks[GetIndex(x, y, z)] = block; }
+
+    void Fill(BlockId block) { memset(m_Blocks, block, sizeof(m_Blocks)); }
+
+    static inline uint32_t GetIndex(uint32_t x, uint32_t y, uint32_t z) { return (y * CHUNK_SIZE + z) * CHUNK_SIZE + x; }
+
+private:
+    BlockId m_Blocks[CHUNK_VOLUME];
+};
+
+// Faces, in the order of VoxelNeighbors and of the face field of a packed vertex
+enum VoxelFace : uint32_t
+{
+    FACE_POSITIVE_X,
+    FACE_NEGATIVE_X,
+    FACE_POSITIVE_Y,
+    FACE_NEGATIVE_Y,
+    FACE_POSITIVE_Z,
+    FACE_NEGATIVE_Z,
+};
+
+// The chunks touching each face of the chunk being meshed, so faces against a solid neighbor are culled.
+// nullptr counts as air (the face is emitted).
+struct VoxelNeighbors
+{
+    const VoxelChunk *chunks[6] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+};
+
+// A vertex packed in 32 bits, decoded by res/shaders/voxel.vs:
+//   bits  0-5   x (0-32, in blocks, relative to the chunk)
+//   bits  6-11  y
+//   bits 12-17  z
+//   bits 18-20  face (VoxelFace)
+//   bits 21-28  block
+// Texture coordinates are not stored: the shader derives them from the position on the face plane,
+// so a merged quad repeats the block texture once per block.
+struct VoxelVertex
+{
+    static inline uint32_t Pack(uint32_t x, uint32_t y, uint32_t z, uint32_t face, BlockId block)
+    {
+        return x | (y << 6) | (z << 12) | (face << 18) | ((uint32_t)block << 21);
+    }
+
+    static inline uint32_t GetX(uint32_t vertex) { return vertex & 63; }
+    static inline uint32_t GetY(uint32_t vertex) { return (vertex >> 6) & 63; }
+    static inline uint32_t GetZ(uint32_t vertex) { return (vertex >> 12) & 63; }
+    static inline uint32_t GetFace(uint32_t vertex) { return (vertex >> 18) & 7; }
+    static inline BlockId GetBlock(uint32_t vertex) { return (BlockId)(vertex >> 21); }
+};
+
+// Builds chunk meshes as quads (4 packed vertices each, drawn with the 0 1 2 2 3 0 index pattern).
+//
+// Both meshers skip faces between two solid blocks. The greedy one also merges neighboring coplanar
+// faces of the same block into rectangles (Mikola Lysenko, "Meshing in a Minecraft Game"), which
+// typically cuts the triangle count of terrain several times (see bench/VoxelMeshingBench.cpp).
+// Meshing only reads the chunks, so different chunks can be meshed in parallel (e.g. one job each).
+class VoxelMesher
+{
+public:
+    // Appends the quads of the chunk to vertices, returns the number of quads added
+    static uint32_t MeshGreedy(const VoxelChunk &chunk, const VoxelNeighbors &neighbors, std::vector<uint32_t> &vertices);
+
+    // One quad per visible block face, as a reference
+    static uint32_t MeshCulled(const VoxelChunk &chunk, const VoxelNeighbors &neighbors, std::vector<uint32_t> &vertices);
+
+    // Quads of the most naive mesh (all 6 faces of every solid block), for comparison
+    static uint32_t CountAllFaces(const VoxelChunk &chunk);
+};
@@ -0,0 +1,230 @@
+#include <GL/glew.h>
+
+#include "VoxelWorld.hpp"
+
+#include <stdint.h>
+#include <stdexcept>
+
+VoxelWorld::VoxelWorld(uint32_t chunksX, uint32_t chunksY, uint32_t chunksZ, JobSystem *jobSystem)
+    : m_ChunksX(chunksX), m_ChunksY(chunksY), m_ChunksZ(chunksZ), m_JobSystem(jobSystem)
+{
+    if (chunksX == 0 || chunksY == 0 || chunksZ == 0)
+        throw std::runtime_error("Voxel worlds must be at least one chunk in every direction");
+
+    m_Chunks.resize((size_t)chunksX * chunksY * chunksZ);
+    for (std::unique_ptr<Chunk> &chunk : m_Chunks)
+        chunk.reset(new Chunk());
+    m_Stats.chunkCount = (uint32_t)m_Chunks.size();
+
+    for (uint32_t cy = 0; cy < chunksY; cy++)
+    {
+        for (uint32_t cz = 0; cz < chunksZ; cz++)
+        {
+            for (uint32_t cx = 0; cx < chunksX; cx++)
+            {
+                auto get = [&](int x, int y, int z) -> const VoxelChunk * {
+                    if (x < 0 || y < 0 || z < 0 || x >= (int)chunksX || y >= (int)chunksY || z >= (int)chunksZ)
+                        return nullptr;
+                    return &m_Chunks[GetChunkIndex(x, y, z)]->blocks;
+                };
+
+                VoxelNeighbors &neighbors = m_Chunks[GetChunkIndex(cx, cy, cz)]->neighbors;
+                neighbors.chunks[FACE_POSITIVE_X] = get(cx + 1, cy, cz);
+                neighbors.chunks[FACE_NEGATIVE_X] = get(cx - 1, cy, cz);
+                neighbors.chunks[FACE_POSITIVE_Y] = get(cx, cy + 1, cz);
+                neighbors.chunks[FACE_NEGATIVE_Y] = get(cx, cy - 1, cz);
+                neighbors.chunks[FACE_POSITIVE_Z] = get(cx, cy, cz + 1);
+                neighbors.chunks[FACE_NEGATIVE_Z] = get(cx, cy, cz - 1);
+
+                m_DirtyChunks.push_back(GetChunkIndex(cx, cy, cz));
+            }
+        }
+    }
+
+    // Whole chunks: the boxes don't follow the blocks, but they never change
+    const float halfChunk = CHUNK_SIZE * 0.5f;
+    m_Bounds.Reserve((uint32_t)m_Chunks.size());
+    for (uint32_t i = 0; i < m_Chunks.size(); i++)
+    {
+        uint32_t cx = i % chunksX, cz = i / chunksX % chunksZ, cy = i / (chunksX * chunksZ);
+        m_Bounds.Add(cx * CHUNK_SIZE + halfChunk, cy * CHUNK_SIZE + halfChunk, cz * CHUNK_SIZE + halfChunk, halfChunk, halfChunk, halfChunk);
+    }
+    m_VisibleChunks.reserve(m_Chunks.size());
+
+    m_Layout.PushInteger<uint32_t>(1); // Packed vertex
+}
+
+void VoxelWorld::SetBlock(uint32_t x, uint32_t y, uint32_t z, BlockId block)
+{
+    if (x >= GetSizeX() || y >= GetSizeY() || z >= GetSizeZ())
+        return;
+
+    uint32_t cx = x / CHUNK_SIZE, cy = y / CHUNK_SIZE, cz = z / CHUNK_SIZE;
+    uint32_t lx = x % CHUNK_SIZE, ly = y % CHUNK_SIZE, lz = z % CHUNK_SIZE;
+
+    VoxelChunk &blocks = m_Chunks[GetChunkIndex(cx, cy, cz)]->blocks;
+    if (blocks.GetBlock(lx, ly, lz) == block)
+        return;
+    blocks.SetBlock(lx, ly, lz, block);
+
+    MarkDirty(cx, cy, cz);
+
+    // Only a change between air and solid can show or hide a face of the neighbor
+    if (lx == 0 && cx > 0)
+        MarkDirty(cx - 1, cy, cz);
+    if (lx == CHUNK_SIZE - 1 && cx + 1 < m_ChunksX)
+        MarkDirty(cx + 1, cy, cz);
+    if (ly == 0 && cy > 0)
+        MarkDirty(cx, cy - 1, cz);
+    if (ly == CHUNK_SIZE - 1 && cy + 1 < m_ChunksY)
+        MarkDirty(cx, cy + 1, cz);
+    if (lz == 0 && cz > 0)
+        MarkDirty(cx, cy, cz - 1);
+    if (lz == CHUNK_SIZE - 1 && cz + 1 < m_ChunksZ)
+        MarkDirty(cx, cy, cz + 1);
+}
+
+BlockId VoxelWorld::GetBlock(uint32_t x, uint32_t y, uint32_t z) const
+{
+    if (x >= GetSizeX() || y >= GetSizeY() || z >= GetSizeZ())
+        return 0;
+
+    const VoxelChunk &blocks = m_Chunks[GetChunkIndex(x / CHUNK_SIZE, y / CHUNK_SIZE, z / CHUNK_SIZE)]->blocks;
+    return blocks.GetBlock(x % CHUNK_SIZE, y % CHUNK_SIZE, z % CHUNK_SIZE);
+}
+
+void VoxelWorld::MarkDirty(uint32_t cx, uint32_t cy, uint32_t cz)
+{
+    uint32_t chunkIndex = GetChunkIndex(cx, cy, cz);
+    Chunk &chunk = *m_Chunks[chunkIndex];
+    if (!chunk.dirty)
+    {
+        chunk.dirty = true;
+        m_DirtyChunks.push_back(chunkIndex);
+    }
+}
+
+void VoxelWorld::Update()
+{
+    if (m_DirtyChunks.empty())
+        return;
+
+    // Each job only writes the vertices of its own chunk, and the blocks don't change until it's done
+    auto meshRange = [this](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            Chunk &chunk = *m_Chunks[m_DirtyChunks[i]];
+            chunk.vertices.clear();
+            VoxelMesher::MeshGreedy(chunk.blocks, chunk.neighbors, chunk.vertices);
+        }
+    };
+
+    uint32_t dirtyCount = (uint32_t)m_DirtyChunks.size();
+    if (m_JobSystem)
+        m_JobSystem->ParallelFor(dirtyCount, 1, meshRange);
+    else
+        meshRange(0, dirtyCount);
+
+    for (uint32_t chunkIndex : m_DirtyChunks)
+        Upload(*m_Chunks[chunkIndex]);
+    m_DirtyChunks.clear();
+}
+
+void VoxelWorld::Upload(Chunk &chunk)
+{
+    chunk.dirty = false;
+    chunk.quadCount = (uint32_t)chunk.vertices.size() / 4;
+    m_Stats.meshesBuilt++;
+
+    if (chunk.quadCount == 0)
+        return;
+
+    ReserveQuadIndices(chunk.quadCount);
+
+    uint32_t size = (uint32_t)(chunk.vertices.size() * sizeof(uint32_t));
+    if (!chunk.vbo)
+    {
+        chunk.vbo.reset(new VertexBuffer(chunk.vertices.data(), size, GL_STATIC_DRAW));
+        chunk.vao.reset(new VertexArray());
+        chunk.vao->AddVBO(*chunk.vbo, m_Layout);
+        chunk.vao->Unbind();
+    }
+    else
+    {
+        chunk.vbo->SetData(chunk.vertices.data(), size, GL_STATIC_DRAW);
+    }
+    chunk.vbo->Unbind();
+}
+
+void VoxelWorld::ReserveQuadIndices(uint32_t quadCount)
+{
+    if (quadCount <= m_QuadIndexCapacity)
+        return;
+
+    // Doubles, so a world growing chunk by chunk only rebuilds the buffer a few times
+    uint32_t capacity = m_QuadIndexCapacity ? m_QuadIndexCapacity : 1024;
+    while (capacity < quadCount)
+        capacity *= 2;
+
+    std::vector<uint32_t> indices((size_t)capacity * 6);
+    for (uint32_t quad = 0; quad < capacity; quad++)
+    {
+        uint32_t first = quad * 4;
+        uint32_t *index = &indices[(size_t)quad * 6];
+        index[0] = first + 0;
+        index[1] = first + 1;
+        index[2] = first + 2;
+        index[3] = first + 2;
+        index[4] = first + 3;
+        index[5] = first + 0;
+    }
+    m_QuadIndices.reset(new IndexBuffer(indices.data(), (uint32_t)indices.size(), GL_STATIC_DRAW));
+    m_QuadIndices->Unbind();
+    m_QuadIndexCapacity = capacity;
+}
+
+uint32_t VoxelWorld::Draw(const Renderer &renderer, const Shader &shader, const Frustum *frustum)
+{
+    m_Stats.drawCalls = 0;
+    m_Stats.drawnQuads = 0;
+    m_Stats.culledChunks = 0;
+
+    // In chunk order either way, the visible indices come out sorted
+    if (frustum)
+    {
+        m_Culler.Cull(*frustum, m_Bounds, m_VisibleChunks);
+        m_Stats.culledChunks = (uint32_t)(m_Chunks.size() - m_VisibleChunks.size());
+    }
+    else
+    {
+        m_VisibleChunks.resize(m_Chunks.size());
+        for (uint32_t i = 0; i < m_Chunks.size(); i++)
+            m_VisibleChunks[i] = i;
+    }
+
+    for (uint32_t index : m_VisibleChunks)
+    {
+        const Chunk &chunk = *m_Chunks[index];
+        if (!chunk.vao || chunk.quadCount == 0)
+            continue;
+
+        uint32_t cx = index % m_ChunksX, cz = index / m_ChunksX % m_ChunksZ, cy = index / (m_ChunksX * m_ChunksZ);
+        shader.SetUniform("u_ChunkOffset", Vec3{(float)(cx * CHUNK_SIZE), (float)(cy * CHUNK_SIZE), (float)(cz * CHUNK_SIZE)});
+
+        DrawCommand command;
+        command.vertexArray = chunk.vao->GetHandle();
+        command.indexBuffer = m_QuadIndices->GetHandle();
+        command.shader = shader.GetHandle();
+        command.indexCount = chunk.quadCount * 6;
+        renderer.Draw(command);
+
+        m_Stats.drawCalls++;
+        m_Stats.drawnQuads += chunk.quadCount;
+    }
+    return m_Stats.drawCalls;
+}
+
+void VoxelWorld::SetUniforms(const Shader &shader, uint32_t atlasColumns, uint32_t atlasRows) const
+{
+    shader.SetUniform("u_AtlasSize", Vec2{(float)atlasColumns, (float)atlasRows});
+}
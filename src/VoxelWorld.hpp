@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "FrustumCuller.hpp"
+#include "IndexBuffer.hpp"
+#include "JobSystem.hpp"
+#include "Renderer.hpp"
+#include "Shader.hpp"
+#include "VertexArray.hpp"
+#include "VertexBuffer.hpp"
+#include "VoxelMesher.hpp"
+
+struct VoxelWorldStats
+{
+    uint32_t chunkCount = 0;
+    uint64_t meshesBuilt = 0;  // Since the world was created
+    uint32_t drawCalls = 0;    // In the last Draw()
+    uint32_t drawnQuads = 0;   // In the last Draw()
+    uint32_t culledChunks = 0; // Outside the frustum in the last Draw()
+};
+
+// Grid of voxel chunks, each drawn from a greedy mesh of packed 32-bit vertices (see VoxelMesher).
+//
+// Changing a block marks its chunk dirty, and the neighbor chunks too when the block is on a border,
+// since their hidden faces depend on it. Update() remeshes every dirty chunk, one job per chunk on
+// the job system, waits for them and uploads the meshes. Unlike TileMap the builds are not left
+// running across frames: meshing reads the neighbor chunks, which could be changing meanwhile,
+// and a greedy chunk mesh only takes a couple of milliseconds.
+class VoxelWorld
+{
+public:
+    static constexpr uint32_t CHUNK_SIZE = VoxelChunk::CHUNK_SIZE;
+
+    // jobSystem may be nullptr, meshes are then built one after the other
+    VoxelWorld(uint32_t chunksX, uint32_t chunksY, uint32_t chunksZ, JobSystem *jobSystem = nullptr);
+
+    VoxelWorld(const VoxelWorld &) = delete;
+    VoxelWorld &operator=(const VoxelWorld &) = delete;
+
+    // In blocks, from the corner of the world
+    void SetBlock(uint32_t x, uint32_t y, uint32_t z, BlockId block);
+    BlockId GetBlock(uint32_t x, uint32_t y, uint32_t z) const;
+
+    // GL thread: remeshes and uploads the dirty chunks
+    void Update();
+
+    // Draws every non-empty chunk, or only the ones inside the frustum. The shader must be bound, with
+    // u_ViewProjection set and SetUniforms() called. Returns the number of draw calls.
+    uint32_t Draw(const Renderer &renderer, const Shader &shader, const Frustum *frustum = nullptr);
+
+    // Sets the uniforms of res/shaders/voxel.vs that depend on the world
+    void SetUniforms(const Shader &shader, uint32_t atlasColumns, uint32_t atlasRows) const;
+
+    inline uint32_t GetSizeX() const { return m_ChunksX * CHUNK_SIZE; }
+    inline uint32_t GetSizeY() const { return m_ChunksY * CHUNK_SIZE; }
+    inline uint32_t GetSizeZ() const { return m_ChunksZ * CHUNK_SIZE; }
+    inline const VoxelWorldStats &GetStats() const { return m_Stats; }
+
+private:
+    struct Chunk
+    {
+        VoxelChunk blocks;
+        VoxelNeighbors neighbors;
+        bool dirty = true;
+        uint32_t quadCount = 0;
+        std::vector<uint32_t> vertices; // Keeps its capacity, so remeshing doesn't allocate
+        std::unique_ptr<VertexBuffer> vbo;
+        std::unique_ptr<VertexArray> vao;
+    };
+
+    void MarkDirty(uint32_t cx, uint32_t cy, uint32_t cz);
+    void Upload(Chunk &chunk);
+    void ReserveQuadIndices(uint32_t quadCount);
+
+    inline uint32_t GetChunkIndex(uint32_t cx, uint32_t cy, uint32_t cz) const { return (cy * m_ChunksZ + cz) * m_ChunksX + cx; }
+
+private:
+    uint32_t m_ChunksX, m_ChunksY, m_ChunksZ;
+    JobSystem *m_JobSystem;
+
+    std::vector<std::unique_ptr<Chunk>> m_Chunks;
+    std::vector<uint32_t> m_DirtyChunks;
+
+    // One box per chunk, in the order of m_Chunks
+    BoundingBoxes m_Bounds;
+    FrustumCuller m_Culler;
+    std::vector<uint32_t> m_VisibleChunks; // Keeps its capacity, so culling doesn't allocate
+
+    // Shared by every chunk (0 1 2 2 3 0, 4 5 6 6 7 4, ...), grown to the largest mesh
+    std::unique_ptr<IndexBuffer> m_QuadIndices;
+    uint32_t m_QuadIndexCapacity = 0;
+    VertexBufferLayout m_Layout;
+
+    VoxelWorldStats m_Stats;
+};
@@ -7,46 +7,185 @@
 #include <string>
 #include <stdexcept>
 #include <array>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <algorithm>
 
 #include "Shader.hpp"
+#include "ShaderVariants.hpp"
 #include "VertexBuffer.hpp"
 #include "IndexBuffer.hpp"
 #include "VertexArray.hpp"
 #include "Renderer.hpp"
 #include "Texture.hpp"
+#include "TransformHierarchy.hpp"
+#include "TransformBuffer.hpp"
+#include "FrustumCuller.hpp"
+#include "FrameArena.hpp"
+#include "AllocationCounter.hpp"
+#include "ResourceRegistry.hpp"
+#include "FramePacer.hpp"
+#include "FixedTimestepSimulation.hpp"
+#include "RenderGraph.hpp"
+#include "JobSystem.hpp"
+#include "TileMap.hpp"
+#include "VoxelWorld.hpp"
+#include "TextRenderer.hpp"
+#include "GLDebugLog.hpp"
+#include "GLTrace.hpp"
+#include "FrameCapture.hpp"
+#include "ParticleSystem.hpp"
+#include "LODMesh.hpp"
+#include "OcclusionCuller.hpp"
+#include "DynamicResolution.hpp"
+#include "VirtualFileSystem.hpp"
 
 using namespace std::string_literals;
 
-#ifdef __WIN32__
-#define DBG_BREAK() __debugbreak()
-#else
-#include <signal.h>
-#define DBG_BREAK() raise(SIGTRAP)
-#endif
+// Color of the rectangle, animated by the simulation thread at a fixed timestep
+// (the rates are per second, so the speed no longer depends on the frame rate)
+struct ColorAnimation
+{
+    float r, g, b;
+    float dr, dg, db;
+
+    static void Step(ColorAnimation &state, double dt)
+    {
+        state.r += state.dr * (float)dt;
+        state.g += state.dg * (float)dt;
+        state.b += state.db * (float)dt;
+
+        if (state.r > 1.0f || state.r < 0.25f)
+            state.dr *= -1.0f;
+
+        if (state.g > 1.0f || state.g < 0.25f)
+            state.dg *= -1.0f;
+
+        if (state.b > 1.0f || state.b < 0.25f)
+            state.db *= -1.0f;
+    }
+
+    static ColorAnimation Interpolate(const ColorAnimation &previous, const ColorAnimation &current, float alpha)
+    {
+        ColorAnimation result = current;
+        result.r = previous.r + (current.r - previous.r) * alpha;
+        result.g = previous.g + (current.g - previous.g) * alpha;
+        result.b = previous.b + (current.b - previous.b) * alpha;
+        return result;
+    }
+};
 
 void onError(int error, const char *description)
 {
     std::cerr << "OpenGL Error: (" << error << ") " << description << std::endl;
 }
 
-void onOpenGLMessage(GLenum source,
-                     GLenum type,
-                     GLuint id,
-                     GLenum severity,
-                     GLsizei length,
-                     const GLchar *message,
-                     const void *userParam)
+int main(int argc, char **argv)
 {
-    fprintf(stderr, "GL CALLBACK: %s type = 0x%x, severity = 0x%x, message = %s\n",
-            (type == GL_DEBUG_TYPE_ERROR ? "** GL ERROR **" : ""),
-            type, severity, message);
+    // --frames-in-flight N: how many frames the CPU may run ahead of the GPU (throughput vs latency)
+    // --low-latency: wait for the GPU to go idle right before sampling input
+    // --tilemap N: draws a scrolling N x N tile map behind the quad
+    // --voxels N: draws N x N chunks of voxel terrain, seen from an orbiting camera
+    // --labels N: draws N labels that change every frame over the scene
+    // --particles N: simulates and draws N particles on the GPU (e.g. 1000000)
+    // --lod N: draws N x N detailed meshes, each at the level of detail its distance allows
+    // --occlusion: with --lod, skips the meshes hidden behind closer ones (CPU depth buffer, see OcclusionCuller.hpp)
+    // --dynamic-resolution MS: scales the scene resolution to keep the GPU frame time under MS milliseconds
+    // --sharpness S: sharpening of the upscaled scene with --dynamic-resolution, 0 for bilinear only (default: 0.5)
+    // --no-tint: uses the variant of the quad shader without the color tint
+    // --gl-debug-severity high|medium|low|notification: least severe GL debug messages logged (default: low)
+    // --gl-debug-sync: synchronous GL debug output, stops in the debugger on GL errors
+    // --capture PATH: records the GL calls into a trace for bin/gl-replay (see GLTrace.hpp), needs make main-capture
+    // --capture-frames N: how many frames the trace captures (default: 3), after CAPTURE_FIRST_FRAME frames
+    // --archive PATH: loads the resources from an archive made by bin/pack-archive (see make archive)
+    // --record PATH: writes every frame, as PATH_000000.png, ... if PATH ends with .png, as raw RGB8 frames in PATH otherwise
+    uint32_t framesInFlight = 2;
+    bool lowLatency = false;
+    uint32_t tileMapSize = 0;
+    uint32_t voxelChunks = 0;
+    uint32_t labelCount = 0;
+    uint32_t particleCount = 0;
+    uint32_t lodGridSize = 0;
+    bool occlusionCulling = false;
+    float dynamicResolutionMs = 0.0f;
+    float sharpness = 0.5f;
+    bool tint = true;
+    GLenum debugSeverity = GL_DEBUG_SEVERITY_LOW;
+    bool debugSync = false;
+    const char *capturePath = nullptr;
+    uint32_t captureFrames = 3;
+    const uint32_t CAPTURE_FIRST_FRAME = 60;
+    const char *recordPath = nullptr;
+    const char *archivePath = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+            framesInFlight = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--low-latency") == 0)
+            lowLatency = true;
+        else if (strcmp(argv[i], "--tilemap") == 0 && i + 1 < argc)
+            tileMapSize = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--voxels") == 0 && i + 1 < argc)
+            voxelChunks = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--labels") == 0 && i + 1 < argc)
+            labelCount = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc)
+            particleCount = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--lod") == 0 && i + 1 < argc)
+            lodGridSize = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--occlusion") == 0)
+            occlusionCulling = true;
+        else if (strcmp(argv[i], "--dynamic-resolution") == 0 && i + 1 < argc)
+            dynamicResolutionMs = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--sharpness") == 0 && i + 1 < argc)
+            sharpness = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--no-tint") == 0)
+            tint = false;
+        else if (strcmp(argv[i], "--gl-debug-severity") == 0 && i + 1 < argc)
+        {
+            GLenum severity = GLDebugLog::ParseSeverity(argv[++i]);
+            debugSeverity = severity ? severity : debugSeverity;
+        }
+        else if (strcmp(argv[i], "--gl-debug-sync") == 0)
+            debugSync = true;
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            capturePath = argv[++i];
+        else if (strcmp(argv[i], "--capture-frames") == 0 && i + 1 < argc)
+            captureFrames = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordPath = argv[++i];
+        else if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc)
+            archivePath = argv[++i];
+    }
+    if (framesInFlight == 0 || framesInFlight > FramePacer::MAX_FRAMES_IN_FLIGHT)
+    {
+        std::cerr << "--frames-in-flight must be between 1 and " << FramePacer::MAX_FRAMES_IN_FLIGHT << std::endl;
+        return -1;
+    }
+    if (capturePath && !GLTraceRecorder::IsAvailable())
+    {
+        std::cerr << "--capture needs a capture build, make main-capture and run bin/main-capture" << std::endl;
+        return -1;
+    }
 
-    if (GL_DEBUG_TYPE_ERROR == type)
-        DBG_BREAK();
-}
+    // Files it doesn't have are still read from disk
+    if (archivePath)
+    {
+        try
+        {
+            VirtualFileSystem::Get().Mount(archivePath);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
 
-int main()
-{
     GLFWwindow *window;
 
     if (!glfwInit())
@@ -75,8 +214,15 @@ int main()
         return -1;
     }
 
-    glEnable(GL_DEBUG_OUTPUT);
-    glDebugMessageCallback(onOpenGLMessage, NULL);
+    // The driver callback only queues the messages, a logger thread prints them
+    GLDebugLog debugLog;
+    if (!debugLog.Install(debugSeverity, debugSync))
+        std::cerr << "GL debug output is not available" << std::endl;
+
+    // Started before any GL object is created, the trace must contain everything the captured frames use
+    std::unique_ptr<GLTraceRecorder> traceRecorder;
+    if (capturePath)
+        traceRecorder.reset(new GLTraceRecorder(capturePath, CAPTURE_FIRST_FRAME, captureFrames));
 
     std::cout << "OpenGL " << glGetString(GL_VERSION) << " GLSL " << glGetString(GL_SHADING_LANGUAGE_VERSION) << std::endl;
     {
@@ -151,23 +297,32 @@ int main()
         texture.Bind(textureSlot);
         // ---
 
+        // --- Code related to transforms ---
+
+        // Every object gets a node in the transform hierarchy, and the vertex shader
+        // reads its world matrix from the transform buffer (one buffer for all objects).
+        TransformHierarchy transforms;
+        TransformId sceneRoot = transforms.Create();
+        TransformId quadTransform = transforms.Create(sceneRoot);
+
+        TransformBuffer transformBuffer;
+        uint32_t transformSlot = 1;
+
+        // ---
+
         // --- Code related to shader program ---
 
-        Shader shaderProgram("res/shaders/vertex-shader.vs", "res/shaders/fragment-shader.fs");
+        // Without the TINT keyword, the per-pixel tint (a pow() and a mix()) is compiled out of the fragment shader
+        ShaderVariants quadShaders("res/shaders/vertex-shader.vs", "res/shaders/fragment-shader.fs");
+        const Shader &shaderProgram = quadShaders.Get(tint ? quadShaders.GetKeyword("TINT") : 0);
         shaderProgram.Bind();
 
         shaderProgram.SetUniform("u_Color", 1.0f, 0.0f, 0.0f, 1.0f);
         shaderProgram.SetUniform("u_Texture", textureSlot);
+        shaderProgram.SetUniform("u_Transforms", (int)transformSlot);
 
         // ---
 
-        float r = 1.0f;
-        float g = 1.0f;
-        float b = 1.0f;
-        float dr = 0.01f;
-        float dg = 0.01f;
-        float db = 0.01f;
-
         // Unbinding just for testing purposes, those lines are not required.
         // The vbo got attached to the vao the time glVertexAttribPointer was called.
         // But the ibo never get attached to the vao, so we willhaveneed to bind it again later
@@ -176,41 +331,583 @@ int main()
         vao.Unbind();
       
         Renderer renderer;
-        while (!glfwWindowShouldClose(window))
+
+        // Scratch memory for data that only lives during one frame, freed all at once at the end of it
+        FrameArena frameArena;
+
+        // After a few warm-up frames (first uniform lookups, buffer creation, ...) a frame should not touch the heap
+        const uint32_t warmUpFrames = 10;
+        uint32_t frameIndex = 0;
+        AllocationScope frameAllocations;
+
+        // The animation runs on its own thread at 60 ticks per second, the render loop only reads
+        // the latest snapshot and interpolates between its last two states
+        FixedTimestepSimulation<ColorAnimation> animation({1.0f, 1.0f, 1.0f, 0.6f, 0.6f, 0.6f}, 1.0 / 60.0,
+                                                          ColorAnimation::Step, ColorAnimation::Interpolate);
+        animation.Start();
+
+        // --- Code related to the tile map ---
+
+        // Chunk meshes are built by the job system, the render loop only uploads and draws them
+        JobSystem jobs;
+        std::unique_ptr<TileMap> tileMap;
+        std::unique_ptr<Shader> tileMapShader;
+        const float tileSize = 1.0f, tilesOnScreen = 48.0f;
+        if (tileMapSize > 0)
+        {
+            tileMap.reset(new TileMap(tileMapSize, tileMapSize, 1, 1, &jobs));
+            for (uint32_t y = 0; y < tileMapSize; y++)
+            {
+                for (uint32_t x = 0; x < tileMapSize; x++)
+                    tileMap->SetTile(x, y, (x * 7 + y * 13) % 5 != 0 ? 1 : 0);
+            }
+
+            tileMapShader.reset(new Shader("res/shaders/tilemap.vs", "res/shaders/tilemap.fs"));
+            tileMapShader->Bind();
+            tileMapShader->SetUniform("u_Atlas", (int)textureSlot);
+            tileMap->SetUniforms(*tileMapShader, tileSize);
+        }
+
+        // ---
+
+        // --- Code related to the voxel terrain ---
+
+        // The chunks are greedy meshed on the job system, and remeshed when blocks change
+        std::unique_ptr<VoxelWorld> voxelWorld;
+        std::unique_ptr<Shader> voxelShader;
+        if (voxelChunks > 0)
         {
-            renderer.Clear();
+            voxelWorld.reset(new VoxelWorld(voxelChunks, 2, voxelChunks, &jobs));
+            for (uint32_t z = 0; z < voxelWorld->GetSizeZ(); z++)
+            {
+                for (uint32_t x = 0; x < voxelWorld->GetSizeX(); x++)
+                {
+                    float height = 24.0f + 10.0f * sinf(x * 0.05f) * cosf(z * 0.04f) + 4.0f * sinf(x * 0.17f + z * 0.11f);
+                    for (uint32_t y = 0; y <= (uint32_t)height; y++)
+                        voxelWorld->SetBlock(x, y, z, 1);
+                }
+            }
+            voxelWorld->Update();
+
+            voxelShader.reset(new Shader("res/shaders/voxel.vs", "res/shaders/voxel.fs"));
+            voxelShader->Bind();
+            voxelShader->SetUniform("u_Atlas", (int)textureSlot);
+            voxelWorld->SetUniforms(*voxelShader, 1, 1);
+        }
 
-            shaderProgram.Bind();
-            shaderProgram.SetUniform("u_Color", r, g, b, 1.0f);
+        // ---
 
-            renderer.Draw(vao, ibo, shaderProgram);
+        // --- Code related to the particles ---
 
-            // Note: the vbo and ibo are already bound to opengl
-            // so all the operations below refer to them.
+        // Simulated with transform feedback, the CPU only sets a few uniforms per frame
+        std::unique_ptr<ParticleSystem> particles;
+        std::unique_ptr<Texture> particleTexture;
+        double lastParticleTime = glfwGetTime();
+        if (particleCount > 0)
+        {
+            particles.reset(new ParticleSystem(particleCount));
+            particles->GetSettings().emitRate = particleCount / 3.0f; // Average lifetime of 3 s: the capacity is always in use
+
+            // Soft white disc, tinted by the particle colors
+            const int spriteSize = 32;
+            std::vector<uint32_t> sprite(spriteSize * spriteSize);
+            for (int y = 0; y < spriteSize; y++)
+            {
+                for (int x = 0; x < spriteSize; x++)
+                {
+                    float dx = (x + 0.5f) / spriteSize * 2.0f - 1.0f, dy = (y + 0.5f) / spriteSize * 2.0f - 1.0f;
+                    float alpha = 1.0f - (dx * dx + dy * dy);
+                    alpha = alpha > 0.0f ? alpha * alpha : 0.0f;
+                    sprite[y * spriteSize + x] = 0x00FFFFFF | (uint32_t)(alpha * 255.0f) << 24;
+                }
+            }
+            particleTexture.reset(new Texture(spriteSize, spriteSize, GL_RGBA8));
+            particleTexture->SetData(0, 0, spriteSize, spriteSize, sprite.data());
+        }
 
-            // Using a index buffer:
-            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        // ---
 
-            // --- Code to animate the rectangle
-            r += dr;
-            g += dg;
-            b += db;
+        // --- Code related to the levels of detail ---
 
-            if (r > 1.0f || r < 0.25f)
-                dr *= -1.0f;
+        // A bumpy sphere of about 65000 triangles, simplified at load time. The camera flies over a grid of them.
+        std::unique_ptr<LODMesh> lodMesh;
+        std::unique_ptr<Shader> lodShader;
+        std::vector<uint32_t> lodLevels;
+        const float lodSpacing = 6.0f;
+        uint32_t lodDrawnTriangles = 0;
 
-            if (g > 1.0f || g < 0.25f)
-                dg *= -1.0f;
+        // Only the meshes in the view frustum are submitted, one bounding sphere per mesh of the grid.
+        // The visible list and the draw list are rebuilt every frame in the frame arena.
+        struct LODDraw
+        {
+            Vec3 offset;
+            uint32_t level;
+        };
+        FrustumCuller sceneCuller;
+        BoundingSpheres lodBounds;
+        uint32_t lodVisibleCount = 0;
+
+        // With --occlusion, each mesh also hides what is behind it: a cube inscribed in it is its occluder,
+        // and the meshes left by the frustum are tested with their bounding boxes
+        std::unique_ptr<OcclusionCuller> occlusionCuller;
+        BoundingBoxes lodBoxes;
+        uint32_t lodOccludedCount = 0;
+        if (lodGridSize > 0)
+        {
+            const uint32_t rings = 128, segments = 256;
+            auto surface = [](float theta, float phi) {
+                Vec3 direction{sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi)};
+                float bumps = 0.08f * sinf(theta * 9.0f) * sinf(phi * 7.0f) + 0.03f * sinf(theta * 23.0f + phi * 17.0f);
+                return direction * (1.0f + bumps);
+            };
+
+            // Position and normal; one vertex per pole and per ring crossing, so the sphere is closed
+            std::vector<Vec3> positions;
+            positions.push_back(surface(0.0f, 0.0f));
+            for (uint32_t ring = 1; ring < rings; ring++)
+            {
+                for (uint32_t segment = 0; segment < segments; segment++)
+                    positions.push_back(surface(3.14159265f * ring / rings, 6.28318531f * segment / segments));
+            }
+            positions.push_back(surface(3.14159265f, 0.0f));
+            uint32_t southPole = (uint32_t)positions.size() - 1;
+
+            auto ringVertex = [segments](uint32_t ring, uint32_t segment) { return 1 + (ring - 1) * segments + segment % segments; };
+            std::vector<uint32_t> indices;
+            for (uint32_t segment = 0; segment < segments; segment++)
+            {
+                indices.insert(indices.end(), {0, ringVertex(1, segment + 1), ringVertex(1, segment)});
+                indices.insert(indices.end(), {southPole, ringVertex(rings - 1, segment), ringVertex(rings - 1, segment + 1)});
+                for (uint32_t ring = 1; ring + 1 < rings; ring++)
+                {
+                    uint32_t a = ringVertex(ring, segment), b = ringVertex(ring, segment + 1);
+                    uint32_t c = ringVertex(ring + 1, segment), d = ringVertex(ring + 1, segment + 1);
+                    indices.insert(indices.end(), {a, b, d, a, d, c});
+                }
+            }
+
+            // Normals weighted by the triangle areas (the length of the cross products)
+            std::vector<Vec3> normals(positions.size(), Vec3{0.0f, 0.0f, 0.0f});
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                const Vec3 &p0 = positions[indices[i]], &p1 = positions[indices[i + 1]], &p2 = positions[indices[i + 2]];
+                Vec3 normal = Cross(p1 - p0, p2 - p0);
+                for (size_t j = 0; j < 3; j++)
+                    normals[indices[i + j]] = normals[indices[i + j]] + normal;
+            }
+            std::vector<float> vertices;
+            vertices.reserve(positions.size() * 6);
+            for (size_t i = 0; i < positions.size(); i++)
+            {
+                Vec3 normal = Normalize(normals[i]);
+                vertices.insert(vertices.end(), {positions[i].x, positions[i].y, positions[i].z, normal.x, normal.y, normal.z});
+            }
+
+            VertexBufferLayout lodLayout;
+            lodLayout.Push<float>(3);
+            lodLayout.Push<float>(3);
+            lodMesh.reset(new LODMesh(vertices.data(), (uint32_t)positions.size(), lodLayout, indices.data(), (uint32_t)indices.size()));
+            lodShader.reset(new Shader("res/shaders/lod.vs", "res/shaders/lod.fs"));
+            lodLevels.assign(lodGridSize * lodGridSize, 0);
+
+            for (uint32_t row = 0; row < lodGridSize; row++)
+            {
+                for (uint32_t column = 0; column < lodGridSize; column++)
+                {
+                    Vec3 center = Vec3{(column + 0.5f) * lodSpacing, 0.0f, (row + 0.5f) * lodSpacing} + lodMesh->GetCenter();
+                    lodBounds.Add(center.x, center.y, center.z, lodMesh->GetRadius());
+                }
+            }
+
+            if (occlusionCulling)
+            {
+                // Half the side of the cube inside the closest vertex, a bit less for the flat triangles between the vertices
+                float innerRadius = lodMesh->GetRadius();
+                for (const Vec3 &position : positions)
+                    innerRadius = std::min(innerRadius, Length(position - lodMesh->GetCenter()));
+                float halfSide = innerRadius * 0.95f / sqrtf(3.0f);
+
+                // Unit cube, counter-clockwise from the outside
+                const Vec3 cube[8] = {{-1, -1, -1}, {1, -1, -1}, {1, 1, -1}, {-1, 1, -1}, {-1, -1, 1}, {1, -1, 1}, {1, 1, 1}, {-1, 1, 1}};
+                const uint32_t cubeIndices[36] = {0, 2, 1, 0, 3, 2, 4, 5, 6, 4, 6, 7, 0, 1, 5, 0, 5, 4,
+                                                  3, 6, 2, 3, 7, 6, 0, 4, 7, 0, 7, 3, 1, 2, 6, 1, 6, 5};
+                occlusionCuller.reset(new OcclusionCuller(256, 128, &jobs));
+                uint32_t cubeMesh = occlusionCuller->AddMesh(cube, 8, cubeIndices, 36);
+                float radius = lodMesh->GetRadius();
+                for (uint32_t i = 0; i < lodBounds.GetCount(); i++)
+                {
+                    Vec3 center{lodBounds.GetCenterX()[i], lodBounds.GetCenterY()[i], lodBounds.GetCenterZ()[i]};
+                    occlusionCuller->AddOccluder(cubeMesh, Mat4::Translate(center) * Mat4::Scale(Vec3{halfSide, halfSide, halfSide}));
+                    lodBoxes.Add(center.x, center.y, center.z, radius, radius, radius);
+                }
+            }
+        }
 
-            if (b > 1.0f || b < 0.25f)
-                db *= -1.0f;
-            // ---
+        // ---
 
-            glfwSwapBuffers(window);
+        // --- Code related to the text overlay ---
+
+        // Glyphs are rasterized into the atlas on first use, the whole overlay is one draw call per atlas page
+        Font font = Font::GetBuiltin();
+        try
+        {
+            font = Font::LoadTrueType("res/fonts/Lato-Regular.ttf");
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << e.what() << ", using the built-in font" << std::endl;
+        }
+        TextRenderer text(framesInFlight, 65536 + labelCount * 32, font);
+        char statsText[256] = "Waiting for stats...";
+        char labelText[64];
+        uint32_t frameSlot = 0;
 
+        // ---
+
+        // --- Code related to the render graph ---
+
+        // The scene is drawn into an offscreen texture, then copied to the window. Post-processing
+        // passes go between the two: the graph orders them and shares textures between them.
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+
+        // With dynamic resolution, the scene only uses the bottom-left part of its targets, and a
+        // shader stretches that part to the window instead of the copy
+        std::unique_ptr<DynamicResolution> dynamicResolution;
+        std::unique_ptr<Shader> upscaleShader;
+        VertexArray upscaleVao; // Empty, the vertices come from gl_VertexID
+        if (dynamicResolutionMs > 0.0f)
+        {
+            DynamicResolutionSettings settings;
+            settings.targetMs = dynamicResolutionMs;
+            dynamicResolution.reset(new DynamicResolution(framebufferWidth, framebufferHeight, settings));
+            upscaleShader.reset(new Shader("res/shaders/upscale.vs", "res/shaders/upscale.fs"));
+        }
+
+        RenderGraph renderGraph;
+        RenderResource backbuffer = renderGraph.ImportBackbuffer("Backbuffer", framebufferWidth, framebufferHeight);
+        RenderResource sceneColor = renderGraph.CreateTexture("SceneColor", {framebufferWidth, framebufferHeight, GL_RGBA8});
+        RenderResource sceneDepth = renderGraph.CreateTexture("SceneDepth", {framebufferWidth, framebufferHeight, GL_DEPTH24_STENCIL8});
+
+        ColorAnimation color{};
+        renderGraph.AddPass("Scene",
+            [&](RenderPassBuilder &builder) {
+                sceneColor = builder.Write(sceneColor, LoadOp::Clear);
+                if (voxelWorld || lodMesh)
+                    sceneDepth = builder.WriteDepth(sceneDepth, LoadOp::Clear);
+            },
+            [&](const RenderPassContext &context) {
+                int sceneHeight = context.GetHeight();
+                if (dynamicResolution)
+                {
+                    glViewport(0, 0, dynamicResolution->GetWidth(), dynamicResolution->GetHeight());
+                    sceneHeight = dynamicResolution->GetHeight();
+                }
+
+                if (voxelWorld)
+                {
+                    float aspect = (float)context.GetWidth() / (float)context.GetHeight();
+                    float angle = (float)glfwGetTime() * 0.2f;
+                    Vec3 center{voxelWorld->GetSizeX() * 0.5f, 24.0f, voxelWorld->GetSizeZ() * 0.5f};
+                    float radius = voxelWorld->GetSizeX() * 0.6f;
+                    Vec3 eye{center.x + radius * cosf(angle), 80.0f, center.z + radius * sinf(angle)};
+
+                    Mat4 viewProjection = Mat4::Perspective(1.0f, aspect, 0.5f, 1000.0f) * Mat4::LookAt(eye, center, Vec3{0.0f, 1.0f, 0.0f});
+                    Frustum frustum = Frustum::FromViewProjection(viewProjection.Data());
+
+                    glEnable(GL_DEPTH_TEST);
+                    glEnable(GL_CULL_FACE);
+                    voxelShader->Bind();
+                    voxelShader->SetUniform("u_ViewProjection", viewProjection);
+                    voxelWorld->Draw(renderer, *voxelShader, &frustum);
+                    glDisable(GL_CULL_FACE);
+                    glDisable(GL_DEPTH_TEST);
+                }
+
+                if (lodMesh)
+                {
+                    // Flies back and forth along the grid, low over the meshes
+                    float aspect = (float)context.GetWidth() / (float)context.GetHeight();
+                    float length = lodGridSize * lodSpacing;
+                    float z = length * 0.5f * (1.0f - cosf((float)glfwGetTime() * 0.1f));
+                    Vec3 eye{length * 0.5f, 4.0f, z - 8.0f};
+                    Vec3 target{length * 0.5f, 0.0f, z + 8.0f};
+
+                    // A level is drawn when its error covers at most a pixel
+                    float projectionScale = LODMesh::GetProjectionScale(1.0f, (float)sceneHeight);
+                    const Vec4 levelColors[] = {{1.0f, 1.0f, 1.0f, 1.0f}, {0.6f, 1.0f, 0.6f, 1.0f}, {0.6f, 0.8f, 1.0f, 1.0f},
+                                                {1.0f, 1.0f, 0.5f, 1.0f}, {1.0f, 0.7f, 0.4f, 1.0f}, {1.0f, 0.5f, 0.5f, 1.0f}};
+
+                    Mat4 viewProjection = Mat4::Perspective(1.0f, aspect, 0.5f, 1000.0f) * Mat4::LookAt(eye, target, Vec3{0.0f, 1.0f, 0.0f});
+                    uint32_t *visible = frameArena.NewArray<uint32_t>(lodBounds.GetCount());
+                    lodVisibleCount = sceneCuller.Cull(Frustum::FromViewProjection(viewProjection.Data()), lodBounds, visible);
+                    if (occlusionCuller)
+                    {
+                        occlusionCuller->RenderOccluders(viewProjection);
+                        uint32_t inView = lodVisibleCount;
+                        lodVisibleCount = occlusionCuller->Cull(lodBoxes, visible, lodVisibleCount);
+                        lodOccludedCount = inView - lodVisibleCount;
+                    }
+
+                    // Sorted by level, so the draws of a level share their index buffer and color
+                    LODDraw *draws = frameArena.NewArray<LODDraw>(lodVisibleCount);
+                    for (uint32_t i = 0; i < lodVisibleCount; i++)
+                    {
+                        uint32_t row = visible[i] / lodGridSize, column = visible[i] % lodGridSize;
+                        Vec3 offset{(column + 0.5f) * lodSpacing, 0.0f, (row + 0.5f) * lodSpacing};
+                        float distance = Length(offset + lodMesh->GetCenter() - eye) - lodMesh->GetRadius();
+                        uint32_t &level = lodLevels[visible[i]];
+                        level = lodMesh->SelectLevel(distance, projectionScale, 1.0f, level);
+                        draws[i] = {offset, level};
+                    }
+                    std::sort(draws, draws + lodVisibleCount, [](const LODDraw &a, const LODDraw &b) { return a.level < b.level; });
+
+                    glEnable(GL_DEPTH_TEST);
+                    glEnable(GL_CULL_FACE);
+                    lodShader->Bind();
+                    lodShader->SetUniform("u_ViewProjection", viewProjection);
+                    lodDrawnTriangles = 0;
+                    for (uint32_t i = 0; i < lodVisibleCount; i++)
+                    {
+                        if (i == 0 || draws[i].level != draws[i - 1].level)
+                            lodShader->SetUniform("u_Color", levelColors[draws[i].level % 6]);
+                        lodShader->SetUniform("u_Offset", draws[i].offset);
+                        lodDrawnTriangles += lodMesh->Draw(renderer, *lodShader, draws[i].level);
+                    }
+                    glDisable(GL_CULL_FACE);
+                    glDisable(GL_DEPTH_TEST);
+                }
+
+                if (tileMap)
+                {
+                    // Scrolls diagonally across the map, only the chunks in view are drawn
+                    float aspect = (float)context.GetWidth() / (float)context.GetHeight();
+                    float halfWidth = tilesOnScreen * 0.5f, halfHeight = halfWidth / aspect;
+                    float span = tileMapSize * tileSize - 2.0f * halfWidth;
+                    float scroll = span > 0.0f ? fmodf((float)glfwGetTime() * 8.0f, span) : 0.0f;
+                    float centerX = halfWidth + scroll, centerY = halfHeight + scroll;
+
+                    tileMapShader->Bind();
+                    tileMapShader->SetUniform("u_ViewProjection", Mat4::Ortho(centerX - halfWidth, centerX + halfWidth,
+                                                                            centerY - halfHeight, centerY + halfHeight, -1.0f, 1.0f));
+                    tileMap->Draw(renderer, *tileMapShader, (centerX - halfWidth) / tileSize, (centerY - halfHeight) / tileSize,
+                                  (centerX + halfWidth) / tileSize, (centerY + halfHeight) / tileSize);
+                }
+
+                if (particles)
+                {
+                    // Orbits around the fountain
+                    float aspect = (float)context.GetWidth() / (float)context.GetHeight();
+                    float angle = (float)glfwGetTime() * 0.3f;
+                    Vec3 target{0.0f, 6.0f, 0.0f};
+                    Vec3 eye{24.0f * cosf(angle), 10.0f, 24.0f * sinf(angle)};
+                    Vec3 right = Normalize(Cross(target - eye, Vec3{0.0f, 1.0f, 0.0f}));
+                    Vec3 up = Cross(right, Normalize(target - eye));
+
+                    particles->Draw(renderer, *particleTexture, Mat4::Perspective(1.0f, aspect, 0.1f, 200.0f) *
+                                                                    Mat4::LookAt(eye, target, Vec3{0.0f, 1.0f, 0.0f}),
+                                    right, up);
+                }
+
+                shaderProgram.Bind();
+                shaderProgram.SetUniform("u_Color", color.r, color.g, color.b, 1.0f);
+                shaderProgram.SetUniform("u_TransformIndex", (int)transforms.GetIndex(quadTransform));
+
+                renderer.Draw(vao, ibo, shaderProgram);
+
+                // Note: the vbo and ibo are already bound to opengl
+                // so all the operations below refer to them.
+
+                // Using a index buffer:
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            });
+        if (dynamicResolution)
+        {
+            renderGraph.AddPass("Upscale",
+                [&](RenderPassBuilder &builder) {
+                    builder.Read(sceneColor);
+                    backbuffer = builder.Write(backbuffer, LoadOp::DontCare);
+                },
+                [&](const RenderPassContext &context) {
+                    context.BindTexture(sceneColor, 0);
+                    float scaleX = (float)dynamicResolution->GetWidth() / dynamicResolution->GetFullWidth();
+                    float scaleY = (float)dynamicResolution->GetHeight() / dynamicResolution->GetFullHeight();
+                    upscaleShader->Bind();
+                    upscaleShader->SetUniform("u_Source", 0);
+                    upscaleShader->SetUniform("u_Scale", Vec2{scaleX, scaleY});
+                    upscaleShader->SetUniform("u_Sharpness", scaleX < 1.0f || scaleY < 1.0f ? sharpness : 0.0f);
+                    renderer.DrawInstanced(upscaleVao, *upscaleShader, GL_TRIANGLES, 3, 1);
+                });
+        }
+        else
+        {
+            backbuffer = renderGraph.AddBlitPass("Present", sceneColor, backbuffer);
+        }
+        renderGraph.AddPass("Text",
+            [&](RenderPassBuilder &builder) {
+                backbuffer = builder.Write(backbuffer, LoadOp::Load);
+            },
+            [&](const RenderPassContext &context) {
+                for (uint32_t i = 0; i < labelCount; i++)
+                {
+                    snprintf(labelText, sizeof(labelText), "#%u: %u", i, frameIndex + i);
+                    text.AddText(labelText, (float)(i % 16) * 80.0f, 40.0f + (float)(i / 16 % 64) * 12.0f, 10.0f, 0xFF80FFFF);
+                }
+                text.AddText(statsText, 8.0f, 8.0f, 16.0f);
+                text.Draw(renderer, context.GetWidth(), context.GetHeight(), frameSlot);
+            });
+        renderGraph.Compile();
+
+        // ---
+
+        // --- Code related to frame recording ---
+
+        // Read back through a ring of pixel buffers and written by a worker thread, the render thread never waits
+        std::unique_ptr<FrameCapture> frameCapture;
+        if (recordPath)
+        {
+            size_t length = strlen(recordPath);
+            bool png = length >= 4 && strcmp(recordPath + length - 4, ".png") == 0;
+            frameCapture.reset(new FrameCapture(recordPath, png ? CaptureFormat::PNG : CaptureFormat::Raw));
+            if (!png)
+                std::cout << "Recording " << framebufferWidth << "x" << framebufferHeight << " RGB8 frames to " << recordPath << std::endl;
+        }
+
+        // ---
+
+        FramePacer pacer(framesInFlight, lowLatency);
+        ResourceRegistry::Get().SetFramesInFlight(framesInFlight);
+        const uint32_t statsInterval = 300;
+
+        while (!glfwWindowShouldClose(window))
+        {
+            frameAllocations.Reset();
+
+            // Blocks until the GPU is done with the frame that used this frame's resources
+            // (or, in low latency mode, until it is idle), then samples input as late as possible
+            pacer.BeginFrame();
             glfwPollEvents();
+            pacer.MarkInputSampled();
+            frameSlot = pacer.GetFrameSlot();
+
+            // GL objects released the last time this slot was recorded are only deleted here, once the GPU is done with them
+            ResourceRegistry::Get().BeginFrame(frameSlot);
+
+            // Only the dirty subtrees are recomputed and uploaded (nothing, while the scene is static)
+            transforms.Update();
+            transformBuffer.Upload(transforms);
+            transformBuffer.Bind(transformSlot);
+
+            color = animation.Sample();
+
+            // Uploads the chunk meshes built since the last frame and starts the rebuilds
+            if (tileMap)
+                tileMap->Update();
+
+            if (particles)
+            {
+                double now = glfwGetTime();
+                particles->Update(renderer, (float)(now - lastParticleTime));
+                lastParticleTime = now;
+            }
+
+            // Clears, draws and copies to the window (the passes clear their own targets)
+            if (dynamicResolution)
+                dynamicResolution->BeginFrame();
+            renderGraph.Execute();
+            if (dynamicResolution)
+                dynamicResolution->EndFrame();
+
+            if (frameCapture)
+            {
+                frameCapture->Update();
+                frameCapture->Capture(0, framebufferWidth, framebufferHeight);
+            }
+
+            glfwSwapBuffers(window);
+            pacer.EndFrame();
+            debugLog.EndFrame();
+
+            frameArena.Reset();
+
+            if (traceRecorder)
+            {
+                traceRecorder->EndFrame();
+                if (!traceRecorder->IsRecording())
+                {
+                    std::cout << "GL trace of " << captureFrames << " frames written to " << capturePath << std::endl;
+                    traceRecorder.reset();
+                }
+            }
+
+            if (frameIndex++ >= warmUpFrames && frameAllocations.GetAllocationCount() != 0)
+                std::cerr << "Frame " << frameIndex << " made " << frameAllocations.GetAllocationCount() << " heap allocations ("
+                          << frameAllocations.GetAllocatedBytes() << " bytes)" << std::endl;
+
+            if (pacer.GetFrameNumber() % statsInterval == 0)
+            {
+                FramePacerStats stats = pacer.GetStats();
+                GLDebugStats debugStats = debugLog.GetStats();
+                std::cout << "Frames in flight: " << pacer.GetFramesInFlight() << (pacer.IsLowLatency() ? " (low latency)" : "")
+                          << ", CPU frame " << stats.cpuFrameMs << " ms, GPU wait " << stats.fenceWaitMs << " ms"
+                          << ", input to present " << stats.inputToPresentMs << " ms"
+                          << ", CPU/GPU overlap " << stats.overlap * 100.0 << "%" << std::endl;
+                snprintf(statsText, sizeof(statsText), "CPU frame %.2f ms, GPU wait %.2f ms, input to present %.2f ms\n"
+                                                       "Text: %u glyphs, %u draw calls\n"
+                                                       "GL debug: %u messages (%u errors) last frame",
+                         stats.cpuFrameMs, stats.fenceWaitMs, stats.inputToPresentMs, text.GetStats().glyphs, text.GetStats().drawCalls,
+                         debugStats.messages, debugStats.errors);
+                if (debugStats.dropped != 0 || debugStats.suppressed != 0)
+                    std::cout << "GL debug: " << debugStats.dropped << " messages dropped (queue full), "
+                              << debugStats.suppressed << " repeats not printed" << std::endl;
+                if (frameCapture)
+                    std::cout << "Recording: " << frameCapture->GetStats().written << " frames written, " << frameCapture->GetStats().dropped
+                              << " dropped, " << frameCapture->GetStats().renderThreadMs << " ms per frame on the render thread" << std::endl;
+                if (particles)
+                    std::cout << "Particles: " << particles->GetStats().capacity << ", " << particles->GetStats().cpuMs
+                              << " ms of CPU per frame" << std::endl;
+                if (tileMap)
+                    std::cout << "Tile map: " << tileMap->GetStats().drawCalls << " draw calls for " << tileMap->GetStats().drawnTiles
+                              << " tiles (" << tileMap->GetStats().chunkCount << " chunks)" << std::endl;
+                if (dynamicResolution)
+                {
+                    const DynamicResolutionStats &resolutionStats = dynamicResolution->GetStats();
+                    uint32_t frames = resolutionStats.frameCount ? resolutionStats.frameCount : 1;
+                    std::cout << "Dynamic resolution: " << resolutionStats.gpuMs / frames << " ms of GPU per frame (target "
+                              << dynamicResolutionMs << " ms), scale " << resolutionStats.scale / frames << " (" << resolutionStats.minScale
+                              << " to " << resolutionStats.maxScale << "), now " << dynamicResolution->GetWidth() << "x"
+                              << dynamicResolution->GetHeight() << std::endl;
+                    dynamicResolution->ResetStats();
+                }
+                if (lodMesh)
+                {
+                    std::cout << "LOD: " << lodDrawnTriangles << " of " << lodGridSize * lodGridSize * lodMesh->GetLevel(0).triangleCount
+                              << " triangles drawn (" << lodVisibleCount << " of " << lodGridSize * lodGridSize
+                              << " meshes in view), levels of";
+                    for (uint32_t level = 0; level < lodMesh->GetLevelCount(); level++)
+                        std::cout << " " << lodMesh->GetLevel(level).triangleCount;
+                    std::cout << " triangles (simplified in " << lodMesh->GetBuildMs() << " ms)" << std::endl;
+                }
+                if (occlusionCuller)
+                {
+                    const OcclusionCullerStats &occlusionStats = occlusionCuller->GetStats();
+                    std::cout << "Occlusion: " << lodOccludedCount << " of " << occlusionStats.tested << " meshes in view hidden, "
+                              << occlusionStats.rasterizedTriangles << " occluder triangles rasterized in " << occlusionStats.rasterMs
+                              << " ms, pyramid " << occlusionStats.pyramidMs << " ms, test " << occlusionStats.testMs << " ms" << std::endl;
+                }
+                if (voxelWorld)
+                    std::cout << "Voxels: " << voxelWorld->GetStats().drawCalls << " draw calls for " << voxelWorld->GetStats().drawnQuads
+                              << " quads (" << voxelWorld->GetStats().chunkCount << " chunks, " << voxelWorld->GetStats().culledChunks
+                              << " outside the view)" << std::endl;
+                pacer.ResetStats();
+            }
         }
     }
+    // The wrappers are gone, delete their GL objects while the context still exists
+    ResourceRegistry::Get().Flush();
+
+    // The logger thread still prints the queued messages when debugLog goes out of scope
+    debugLog.Uninstall();
     glfwDestroyWindow(window);
 
     glfwTerminate();